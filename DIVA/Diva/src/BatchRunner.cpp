@@ -0,0 +1,156 @@
+//===-- Diva/BatchRunner.cpp ------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Processes many input files on a pool of threads.
+///
+//===----------------------------------------------------------------------===//
+
+#include "BatchRunner.h"
+#include "Error.h"
+#include "PrintContext.h"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace LibScopeView;
+
+namespace {
+
+// Number of files that can be finished ahead of the next one to write, for
+// each thread.
+const size_t FilesAheadPerThread = 4;
+
+// Writes a stream to a C file, in order with the text printed to the file
+// through a print context.
+class FileStreamBuffer : public std::streambuf {
+public:
+  FileStreamBuffer(FILE *File) : File(File) {}
+
+private:
+  int_type overflow(int_type C) override {
+    if (traits_type::eq_int_type(C, traits_type::eof()))
+      return traits_type::not_eof(C);
+    return fputc(C, File) == EOF ? traits_type::eof() : C;
+  }
+  std::streamsize xsputn(const char *Data, std::streamsize Count) override {
+    return static_cast<std::streamsize>(
+        fwrite(Data, 1, static_cast<size_t>(Count), File));
+  }
+
+  FILE *File;
+};
+
+size_t getFileSize(const std::string &FilePath) {
+  std::ifstream File(FilePath, std::ios::binary | std::ios::ate);
+  std::streamoff Size = File ? static_cast<std::streamoff>(File.tellg()) : 0;
+  return Size > 0 ? static_cast<size_t>(Size) : 0;
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(unsigned Jobs, size_t MemoryLimit)
+    : Pool(Jobs), MemoryLimit(MemoryLimit) {}
+
+void BatchRunner::run(const std::vector<std::string> &InputFiles,
+                      const LoadFunc &Load, const PrintFunc &Print,
+                      std::ostream &Output) {
+  this->InputFiles = &InputFiles;
+  this->Load = &Load;
+  this->Print = &Print;
+  this->Output = &Output;
+
+  FileSizes.clear();
+  for (const std::string &InputFile : InputFiles)
+    FileSizes.push_back(getFileSize(InputFile));
+  Outputs.assign(InputFiles.size(), nullptr);
+  Finished.assign(InputFiles.size(), false);
+  NextToWrite = 0;
+  UsedMemory = 0;
+  PeakMemory = 0;
+
+  Pool.run(InputFiles.size(), [this](size_t Index) { process(Index); },
+           [this](size_t Index) { return reserve(Index); });
+}
+
+bool BatchRunner::reserve(size_t Index) {
+  std::lock_guard<std::mutex> Lock(StateMutex);
+  if (Index >= NextToWrite + FilesAheadPerThread * Pool.getThreadCount())
+    return false;
+  if (MemoryLimit && UsedMemory && UsedMemory + FileSizes[Index] > MemoryLimit)
+    return false;
+  UsedMemory += FileSizes[Index];
+  PeakMemory = std::max(PeakMemory, UsedMemory);
+  return true;
+}
+
+void BatchRunner::process(size_t Index) {
+  FILE *File = tmpfile();
+  if (!File)
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE,
+                              "temporary file");
+
+  {
+    GlobalPrintContext = std::make_unique<PrintContext>(File);
+    FileStreamBuffer Buffer(File);
+    std::ostream Stream(&Buffer);
+    std::unique_ptr<Reader> TheReader((*Load)((*InputFiles)[Index]));
+    (*Print)(*TheReader, Stream);
+    Stream.flush();
+    GlobalPrintContext.reset();
+  }
+
+  {
+    std::lock_guard<std::mutex> Lock(StateMutex);
+    UsedMemory -= FileSizes[Index];
+    Outputs[Index] = File;
+    Finished[Index] = true;
+  }
+  writeFinished();
+  Pool.notify();
+}
+
+void BatchRunner::writeFinished() {
+  std::lock_guard<std::mutex> OutputLock(OutputMutex);
+  while (true) {
+    FILE *File;
+    {
+      std::lock_guard<std::mutex> Lock(StateMutex);
+      if (NextToWrite == Finished.size() || !Finished[NextToWrite])
+        return;
+      File = Outputs[NextToWrite];
+    }
+
+    rewind(File);
+    char Data[64 * 1024];
+    size_t Count;
+    while ((Count = fread(Data, 1, sizeof(Data), File)) > 0)
+      Output->write(Data, static_cast<std::streamsize>(Count));
+    fclose(File);
+
+    std::lock_guard<std::mutex> Lock(StateMutex);
+    Outputs[NextToWrite] = nullptr;
+    ++NextToWrite;
+  }
+}
@@ -0,0 +1,100 @@
+//===-- Diva/BatchRunner.h --------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Processes many input files on a pool of threads.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef BATCHRUNNER_H_
+#define BATCHRUNNER_H_
+
+#include "Reader.h"
+#include "WorkStealingPool.h"
+
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// \brief Loads, prints and frees each input file of a batch on a pool of
+/// threads.
+///
+/// Each file is printed to a temporary file, through its own thread's print
+/// context for the text output and through a stream for the other formats.
+/// The temporary files are copied to the output in input order, and only a
+/// few files can be finished ahead of the next one to copy.
+///
+/// The memory of a scope tree is estimated from the size of its input file.
+/// A file is only loaded while the total size of the files being processed
+/// stays under the memory limit, or when it's the only one.
+class BatchRunner {
+public:
+  typedef std::function<std::unique_ptr<LibScopeView::Reader>(
+      const std::string &)>
+      LoadFunc;
+  typedef std::function<void(LibScopeView::Reader &, std::ostream &)>
+      PrintFunc;
+
+  /// \brief Creates a runner with Jobs threads, or one per hardware thread
+  /// if Jobs is 0, and a memory limit in bytes, or none if MemoryLimit is 0.
+  BatchRunner(unsigned Jobs, size_t MemoryLimit);
+
+  /// \brief Processes the input files and writes their outputs to Output.
+  void run(const std::vector<std::string> &InputFiles, const LoadFunc &Load,
+           const PrintFunc &Print, std::ostream &Output);
+
+  /// \brief Returns the largest total size of the input files processed at
+  /// once by the last run.
+  size_t getPeakMemory() const { return PeakMemory; }
+
+private:
+  void process(size_t Index);
+  bool reserve(size_t Index);
+  void writeFinished();
+
+  WorkStealingPool Pool;
+  size_t MemoryLimit;
+
+  const std::vector<std::string> *InputFiles = nullptr;
+  const LoadFunc *Load = nullptr;
+  const PrintFunc *Print = nullptr;
+  std::ostream *Output = nullptr;
+
+  // The state of the files, guarded by StateMutex.
+  std::mutex StateMutex;
+  std::vector<size_t> FileSizes;
+  std::vector<FILE *> Outputs;
+  std::vector<bool> Finished;
+  size_t NextToWrite = 0;
+  size_t UsedMemory = 0;
+  size_t PeakMemory = 0;
+  // Serializes the copies to the output.
+  std::mutex OutputMutex;
+};
+
+#endif // BATCHRUNNER_H_
@@ -84,6 +84,15 @@ void compileRegexs(std::vector<std::string> &Patterns,
   }
 }
 
+// Reads the non-negative number given as Value to the argument Name.
+size_t parseCount(const std::string &Name, const std::string &Value) {
+  // Limit the digits so the number can't overflow.
+  if (Value.empty() || Value.size() > 9 ||
+      Value.find_first_not_of("0123456789") != std::string::npos)
+    throw ArgumentParser::InvalidChoice("--" + Name, Value);
+  return std::stoul(Value);
+}
+
 } // end anonymous namespace.
 
 DivaOptions::DivaOptions(const std::vector<std::string> &CMDArgs,
@@ -119,6 +128,8 @@ DivaOptions::DivaOptions(const std::vector<std::string> &CMDArgs,
     OutputFormats.emplace(OutputFormat::TEXT);
   if (OutputFormatStrings.count("yaml"))
     OutputFormats.emplace(OutputFormat::YAML);
+  if (OutputFormatStrings.count("binary"))
+    OutputFormats.emplace(OutputFormat::BINARY);
 
   // Set sort key.
   if (SortKeyString == "line")
@@ -131,6 +142,7 @@ DivaOptions::DivaOptions(const std::vector<std::string> &CMDArgs,
   // Compile filter regexs.
   compileRegexs(RawFilters, PrintingSettings.Filters);
   compileRegexs(RawWithChildrenFilters, PrintingSettings.WithChildrenFilters);
+  compileRegexs(RawCompileUnitFilters, PrintingSettings.CompileUnitFilters);
 }
 
 void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
@@ -184,6 +196,12 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
                [&](const Parser &) { PrintingSettings.showBrief(); }),
       Argument::switchArg('t', "show-summary", "Print the summary table",
                           BasicHelp, PrintingSettings.ShowSummary),
+      Argument::switchArg(
+          NSC, "summary-only",
+          "Only print the summary table, counting the objects without "
+          "creating the scope tree. Much faster than --show-summary with "
+          "--quiet, with the same totals.",
+          BasicHelp, PrintingSettings.SummaryOnly),
       Argument('d', "output-dir", "[=<dir>]",
                "Print the output into a directory with each compile unit's "
                "output in a separate file. If no dir is given, then diva will "
@@ -199,7 +217,7 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
       Argument::multiChoiceArg(
           NSC, "output",
           "A comma separated list of output formats.", BasicHelp,
-          {"text", "yaml"}, OutputFormatStrings)
+          {"text", "yaml", "binary"}, OutputFormatStrings)
     }),
 
     ArgumentGroup("Sort options", {
@@ -230,6 +248,105 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
           NSC, "tree-any", "text",
           "Same as --filter-any with the whole subtree.", BasicHelp,
         PrintingSettings.WithChildrenFilterAnys),
+      Argument::multiStringArg(
+          NSC, "find", "name",
+          "Only show the objects with the given qualified name, such as "
+          "\"ns::Class::method\", found through an index of the names "
+          "instead of matching every object. Takes precedence over the other "
+          "filters.",
+          BasicHelp, PrintingSettings.Finds),
+      Argument::stringArg(
+          NSC, "lookup-address", "file",
+          "Only show the line and the chain of scopes, from the innermost "
+          "inlined function out to the compile unit, of each code address "
+          "listed in <file>, given in hex one per line.",
+          BasicHelp, AddressFile),
+    }),
+
+    ArgumentGroup("Input options", {
+      Argument::switchArg(
+          NSC, "dedup-types",
+          "Read each class, structure, union and enum defined identically in "
+          "several compile units only once. Later compile units refer to the "
+          "first copy instead of containing their own.",
+          BasicHelp, PrintingSettings.DedupTypes),
+      Argument::switchArg(
+          NSC, "native-dwarf",
+          "Decode the attribute values of the debug information entries "
+          "directly from the section bytes, using libdwarf only for what the "
+          "native decoder doesn't support. The output is the same.",
+          BasicHelp, PrintingSettings.NativeDwarf),
+      Argument::switchArg(
+          NSC, "lazy-scopes",
+          "Only read the contents of each compile unit when they are first "
+          "needed, e.g. by a query of the server. Has no effect with the "
+          "options that need the whole tree, such as the filters.",
+          BasicHelp, PrintingSettings.LazyScopes),
+      Argument::stringArg(
+          NSC, "cache-dir", "dir",
+          "Cache the scope tree read from each input file in the given "
+          "directory and reuse it while the input file is unchanged.",
+          BasicHelp, PrintingSettings.CacheDirectory),
+      Argument::multiStringArg(
+          NSC, "cu", "regex",
+          "Only read the compile units whose name or compilation directory "
+          "matches <regex>. The other compile units are skipped without "
+          "reading their contents.",
+          BasicHelp, RawCompileUnitFilters),
+      Argument::multiStringArg(
+          NSC, "cu-any", "text",
+          "Same as --cu, for the compile units with <text> in their name or "
+          "compilation directory.",
+          BasicHelp, PrintingSettings.CompileUnitFilterAnys),
+    }),
+
+    ArgumentGroup("Server options", {
+      Argument(NSC, "serve", "[=<socket>]",
+               "Keep the input files loaded and answer requests about them, "
+               "one per line, read from stdin or from the clients of the "
+               "given Unix domain socket. See the user guide for the "
+               "requests.",
+               BasicHelp,
+               // This argument behaves like a switch that can also set a value.
+               [&](const Parser &) { Serve = true; },
+               [&](const Parser &, const std::string &Opt) {
+                 Serve = true;
+                 ServeSocket = Opt;
+               },
+               [&](const Parser &) { Serve = false; }),
+    }),
+
+    ArgumentGroup("Batch options", {
+      Argument(NSC, "batch", "[=<manifest>]",
+               "Load, print and free the input files on a pool of threads, "
+               "printing the outputs in input order. The input files listed "
+               "in the given manifest, one per line, follow the ones on the "
+               "command line.",
+               BasicHelp,
+               // This argument behaves like a switch that can also set a value.
+               [&](const Parser &) { Batch = true; },
+               [&](const Parser &, const std::string &Opt) {
+                 Batch = true;
+                 BatchManifest = Opt;
+               },
+               [&](const Parser &) { Batch = false; }),
+      Argument(NSC, "jobs", "=<n>",
+               "Number of threads of --batch. Default is one per hardware "
+               "thread.",
+               BasicHelp, nullptr,
+               [&](const Parser &, const std::string &Opt) {
+                 BatchJobs = static_cast<unsigned>(parseCount("jobs", Opt));
+               },
+               nullptr),
+      Argument(NSC, "batch-memory", "=<MiB>",
+               "Only start loading an input file in --batch while the total "
+               "size of the input files being processed stays under the "
+               "limit. A larger file is processed on its own.",
+               BasicHelp, nullptr,
+               [&](const Parser &, const std::string &Opt) {
+                 BatchMemory = parseCount("batch-memory", Opt);
+               },
+               nullptr),
     }),
 
     ArgumentGroup("More object options", {
@@ -347,7 +464,7 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
 
     ArgumentGroup("Developer options", {
       Argument::switchArg(NSC, "performance-time",
-                          "Print time taken to run diva",
+                          "Print time taken to run diva and each of its passes",
                           DeveloperHelp, ShowPerformanceTime),
       Argument::switchArg(NSC, "performance-memory", "Print peak memory usage",
                           DeveloperHelp, ShowPerformanceMemory),
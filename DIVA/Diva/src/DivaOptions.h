@@ -37,7 +37,7 @@
 #include <string>
 #include <vector>
 
-enum class OutputFormat { TEXT, YAML };
+enum class OutputFormat { TEXT, YAML, BINARY };
 
 /// \brief Class that parses command line arguments into DIVA's options (using
 /// ArgumentParser).
@@ -57,6 +57,23 @@ public:
 
   LibScopeView::PrintSettings PrintingSettings;
 
+  // Answer requests about the loaded files instead of printing them.
+  bool Serve = false;
+  // Unix domain socket to serve on, stdin and stdout if empty.
+  std::string ServeSocket;
+
+  // Load, print and free the input files on a pool of threads.
+  bool Batch = false;
+  // File listing more input files, one per line.
+  std::string BatchManifest;
+  // Number of threads of the batch, 0 for one per hardware thread.
+  unsigned BatchJobs = 0;
+  // Limit in MiB for the size of the input files loaded at once, 0 for none.
+  size_t BatchMemory = 0;
+
+  // File listing the code addresses to look up, one per line.
+  std::string AddressFile;
+
   bool ShowPerformanceTime = false;
   bool ShowPerformanceMemory = false;
   bool ShowScopeAllocation = false;
@@ -73,6 +90,7 @@ private:
   // Or from strings to regular expressions.
   std::vector<std::string> RawFilters;
   std::vector<std::string> RawWithChildrenFilters;
+  std::vector<std::string> RawCompileUnitFilters;
 };
 
 #endif // DIVAOPTIONS_H_
@@ -0,0 +1,395 @@
+//===-- Diva/QueryServer.cpp ------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Answers queries about scope trees that are kept loaded between them.
+///
+//===----------------------------------------------------------------------===//
+
+#include "QueryServer.h"
+#include "Line.h"
+#include "Platform.h"
+#include "PrintContext.h"
+#include "ScopeVisitor.h"
+#include "ScopeYAMLPrinter.h"
+#include "Sort.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+#ifndef PLATFORM_WIN
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace LibScopeView;
+
+namespace {
+
+std::string getOkResponse(const std::string &Output) {
+  return "ok " + std::to_string(Output.size()) + "\n" + Output;
+}
+
+std::string getErrorResponse(const std::string &Message) {
+  return "error " + Message + "\n";
+}
+
+// Splits the next argument from Args, the last argument takes the rest.
+std::string getArgument(std::string &Args, bool Last) {
+  std::string Arg;
+  size_t End = Last ? std::string::npos : Args.find(' ');
+  Arg = Args.substr(0, End);
+  Args = End == std::string::npos ? "" : Args.substr(End + 1);
+  return Arg;
+}
+
+// Collects the objects of a tree that match a predicate, in tree order.
+class ObjectCollector : public ScopeVisitor {
+public:
+  typedef std::function<bool(const Object *)> Predicate;
+  ObjectCollector(Predicate Matches) : Matches(Matches) {}
+
+  std::vector<Object *> Objects;
+
+private:
+  void visitImpl(Object *Obj) override {
+    if (Matches(Obj))
+      Objects.push_back(Obj);
+    visitChildren(Obj);
+    if (auto *Scp = dynamic_cast<Scope *>(Obj))
+      for (Line *Ln : Scp->getLines())
+        visit(Ln);
+  }
+
+  Predicate Matches;
+};
+
+// Description of an object used to compare two trees.
+std::string getObjectDescription(const Object *Obj) {
+  std::string Description("{");
+  Description += Obj->getKindAsString();
+  Description += "} \"" + Obj->getPrintedName() + "\"";
+  std::string TypeName;
+  if (Obj->getPrintedTypeName(TypeName))
+    Description += " -> \"" + TypeName + "\"";
+  return Description;
+}
+
+std::vector<std::string> getObjectDescriptions(const Reader &TheReader) {
+  ObjectCollector Collector([](const Object *Obj) {
+    return !Obj->getIsLine() && Obj->getIsPrintedAsObject() &&
+           !(Obj->getIsScope() && static_cast<const Scope *>(Obj)->getIsRoot());
+  });
+  Collector.visit(TheReader.getScopesRoot());
+
+  std::vector<std::string> Descriptions;
+  Descriptions.reserve(Collector.Objects.size());
+  for (const Object *Obj : Collector.Objects)
+    Descriptions.push_back(getObjectDescription(Obj));
+  std::sort(Descriptions.begin(), Descriptions.end());
+  return Descriptions;
+}
+
+} // namespace
+
+QueryServer::QueryServer(const std::vector<Reader *> &Readers,
+                         const PrintSettings &Settings)
+    : Readers(Readers), Settings(Settings),
+      PrintMutexes(new std::mutex[Readers.size()]), Stopping(false),
+      ListenSocket(-1), LiveSessions(0U) {}
+
+Reader *QueryServer::findReader(const std::string &File) const {
+  for (size_t Index = 0; Index < Readers.size(); ++Index)
+    if (File == std::to_string(Index) || File == Readers[Index]->getInputFile())
+      return Readers[Index];
+  return nullptr;
+}
+
+std::string QueryServer::handleRequest(const std::string &Request,
+                                       Session &State) {
+  std::string Args(Request);
+  if (!Args.empty() && Args.back() == '\r')
+    Args.pop_back();
+  std::string Command(getArgument(Args, /*Last=*/false));
+
+  if (Command == "files") {
+    std::string Output;
+    for (size_t Index = 0; Index < Readers.size(); ++Index)
+      Output += std::to_string(Index) + " " + Readers[Index]->getInputFile() +
+                "\n";
+    return getOkResponse(Output);
+  }
+
+  if (Command == "format") {
+    if (Args != "text" && Args != "yaml")
+      return getErrorResponse("unknown format '" + Args + "'");
+    State.YAMLOutput = Args == "yaml";
+    return getOkResponse("");
+  }
+
+  if (Command == "quit" || Command == "shutdown") {
+    State.Quit = true;
+    if (Command == "shutdown") {
+      Stopping = true;
+#ifndef PLATFORM_WIN
+      // Wake up the thread waiting for new clients.
+      if (ListenSocket != -1)
+        ::shutdown(ListenSocket, SHUT_RDWR);
+#endif
+    }
+    return getOkResponse("");
+  }
+
+  if (Command == "tree" || Command == "print-scope" || Command == "filter") {
+    std::string File(getArgument(Args, /*Last=*/Command == "tree"));
+    Reader *TheReader = findReader(File);
+    if (!TheReader)
+      return getErrorResponse("unknown file '" + File + "'");
+
+    if (Command == "tree")
+      return printTree(*TheReader, {TheReader->getScopesRoot()}, false, State);
+
+    if (Command == "print-scope") {
+      std::vector<Object *> Scopes;
+      for (Object *Obj : TheReader->findObjects(Args))
+        if (Obj->getIsScope())
+          Scopes.push_back(Obj);
+      if (Scopes.empty())
+        return getErrorResponse("no scope named '" + Args + "'");
+      return printTree(*TheReader, Scopes, false, State);
+    }
+
+    std::regex Pattern;
+    try {
+      Pattern = std::regex(Args);
+    } catch (std::regex_error &) {
+      return getErrorResponse("invalid regular expression '" + Args + "'");
+    }
+    ObjectCollector Collector([&Pattern](const Object *Obj) {
+      if (Obj->getIsLine())
+        return std::regex_match(
+            trim(static_cast<const Line *>(Obj)->getLineNumberAsString()),
+            Pattern);
+      return Obj->isNamed() && std::regex_match(Obj->getName(), Pattern);
+    });
+    Collector.visit(TheReader->getScopesRoot());
+    SortFunction SortFunc = getSortFunction(Settings.SortKey);
+    if (SortFunc)
+      std::stable_sort(Collector.Objects.begin(), Collector.Objects.end(),
+                       SortFunc);
+    return printTree(*TheReader, Collector.Objects, true, State);
+  }
+
+  if (Command == "compare") {
+    std::string FirstFile(getArgument(Args, /*Last=*/false));
+    const Reader *First = findReader(FirstFile);
+    if (!First)
+      return getErrorResponse("unknown file '" + FirstFile + "'");
+    const Reader *Second = findReader(Args);
+    if (!Second)
+      return getErrorResponse("unknown file '" + Args + "'");
+    return getOkResponse(compareTrees(*First, *Second));
+  }
+
+  return getErrorResponse("unknown command '" + Command + "'");
+}
+
+std::string QueryServer::printTree(Reader &TheReader,
+                                   const std::vector<Object *> &Objects,
+                                   bool AsList, const Session &State) {
+  if (State.YAMLOutput) {
+    // The YAML printer only reads the tree. Each object is given as a
+    // separate document.
+    std::ostringstream Output;
+    for (const Object *Obj : Objects) {
+      if (Obj != Objects.front())
+        Output << "---\n";
+      ScopeYAMLPrinter(TheReader.getInputFile(), YAML_OUTPUT_VERSION_STR)
+          .print(Obj, Output);
+    }
+    return getOkResponse(Output.str());
+  }
+
+  // The text printing uses the global reader and print context, so redirect
+  // them while printing into a temporary file. They are thread_local, so only
+  // the requests printing the same reader wait for each other.
+  size_t ReaderIndex = static_cast<size_t>(
+      std::find(Readers.begin(), Readers.end(), &TheReader) - Readers.begin());
+  std::lock_guard<std::mutex> Lock(PrintMutexes[ReaderIndex]);
+  FILE *File = std::tmpfile();
+  if (!File)
+    return getErrorResponse("can't create a temporary file");
+  Reader *SavedReader = getReader();
+  setReader(&TheReader);
+  std::unique_ptr<PrintContext> SavedContext(std::move(GlobalPrintContext));
+  GlobalPrintContext = std::make_unique<PrintContext>(File);
+  Object::resetFileIndex();
+
+  bool Match = !Settings.WithChildrenFilters.empty() ||
+               !Settings.WithChildrenFilterAnys.empty();
+  if (AsList && !Objects.empty())
+    TheReader.getScopesRoot()->dump(Settings);
+  for (Object *Obj : Objects) {
+    if (AsList)
+      Obj->dump(Settings);
+    else
+      Obj->print(/*SplitCU=*/false, Match, /*IsNull=*/true, Settings);
+  }
+
+  GlobalPrintContext = std::move(SavedContext);
+  setReader(SavedReader);
+
+  std::string Output;
+  long Size = std::ftell(File);
+  if (Size > 0) {
+    Output.resize(static_cast<size_t>(Size));
+    std::rewind(File);
+    Output.resize(std::fread(&Output[0], 1, Output.size(), File));
+  }
+  std::fclose(File);
+  return getOkResponse(Output);
+}
+
+std::string QueryServer::compareTrees(const Reader &First,
+                                      const Reader &Second) const {
+  std::vector<std::string> FirstObjects(getObjectDescriptions(First));
+  std::vector<std::string> SecondObjects(getObjectDescriptions(Second));
+
+  std::vector<std::string> Missing;
+  std::set_difference(FirstObjects.begin(), FirstObjects.end(),
+                      SecondObjects.begin(), SecondObjects.end(),
+                      std::back_inserter(Missing));
+  std::vector<std::string> Added;
+  std::set_difference(SecondObjects.begin(), SecondObjects.end(),
+                      FirstObjects.begin(), FirstObjects.end(),
+                      std::back_inserter(Added));
+
+  std::string Output;
+  for (const std::string &Description : Missing)
+    Output += "- " + Description + "\n";
+  for (const std::string &Description : Added)
+    Output += "+ " + Description + "\n";
+  return Output;
+}
+
+void QueryServer::serve(std::istream &Input, std::ostream &Output) {
+  Session State;
+  std::string Request;
+  while (!State.Quit && std::getline(Input, Request)) {
+    Output << handleRequest(Request, State);
+    Output.flush();
+  }
+}
+
+void QueryServer::serveClient(int Client) {
+#ifdef PLATFORM_WIN
+  (void)Client;
+#else
+  Session State;
+  std::string Buffer;
+  char Data[4096];
+  while (!State.Quit) {
+    ssize_t Count = recv(Client, Data, sizeof(Data), 0);
+    if (Count <= 0)
+      break;
+    Buffer.append(Data, static_cast<size_t>(Count));
+    size_t End;
+    while (!State.Quit && (End = Buffer.find('\n')) != std::string::npos) {
+      std::string Response(handleRequest(Buffer.substr(0, End), State));
+      Buffer.erase(0, End + 1);
+      for (size_t Sent = 0; Sent < Response.size();) {
+        ssize_t Written = send(Client, Response.data() + Sent,
+                               Response.size() - Sent, MSG_NOSIGNAL);
+        if (Written <= 0) {
+          State.Quit = true;
+          break;
+        }
+        Sent += static_cast<size_t>(Written);
+      }
+    }
+  }
+  close(Client);
+
+  // Notified under the lock, so serveSocket can't return before this thread
+  // is done with the server.
+  std::lock_guard<std::mutex> Lock(SessionMutex);
+  --LiveSessions;
+  SessionEnded.notify_all();
+#endif
+}
+
+bool QueryServer::serveSocket(const std::string &Path) {
+#ifdef PLATFORM_WIN
+  (void)Path;
+  return false;
+#else
+  sockaddr_un Address = {};
+  Address.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Address.sun_path))
+    return false;
+  Path.copy(Address.sun_path, Path.size());
+
+  ListenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (ListenSocket == -1)
+    return false;
+  // Replace any socket left by a previous server.
+  unlink(Path.c_str());
+  if (bind(ListenSocket, reinterpret_cast<sockaddr *>(&Address),
+           sizeof(Address)) != 0 ||
+      listen(ListenSocket, SOMAXCONN) != 0) {
+    close(ListenSocket);
+    ListenSocket = -1;
+    return false;
+  }
+
+  // Each client is served by a detached thread, so the threads of ended
+  // sessions don't pile up while the server runs.
+  while (!Stopping) {
+    int Client = accept(ListenSocket, nullptr, nullptr);
+    if (Client == -1)
+      break;
+    {
+      std::lock_guard<std::mutex> Lock(SessionMutex);
+      ++LiveSessions;
+    }
+    std::thread([this, Client]() { serveClient(Client); }).detach();
+  }
+
+  // Wait for the connected clients to end their sessions.
+  {
+    std::unique_lock<std::mutex> Lock(SessionMutex);
+    SessionEnded.wait(Lock, [this]() { return LiveSessions == 0U; });
+  }
+  close(ListenSocket);
+  ListenSocket = -1;
+  unlink(Path.c_str());
+  return true;
+#endif
+}
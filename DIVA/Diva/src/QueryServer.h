@@ -0,0 +1,120 @@
+//===-- Diva/QueryServer.h --------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Answers queries about scope trees that are kept loaded between them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUERYSERVER_H_
+#define QUERYSERVER_H_
+
+#include "PrintSettings.h"
+#include "Reader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// \brief Answers requests about the scope trees of already loaded readers.
+///
+/// Each request is a single line holding a command and its arguments,
+/// separated by spaces. The last argument of a command takes the rest of the
+/// line, so it can contain spaces. The commands are:
+///
+///   files                      List the loaded input files.
+///   format <text|yaml>         Output format of the next requests.
+///   tree <file>                Print the whole tree of a file.
+///   print-scope <file> <name>  Print the scopes with the given full name.
+///   filter <file> <regex>      Print the objects with a matching name.
+///   compare <file> <file>      List the objects only found in one file.
+///   quit                       End the session.
+///   shutdown                   End the session and stop the server.
+///
+/// A file is given by its index in the 'files' list or by its name. Each
+/// response starts with a status line, either "ok <size>" followed by <size>
+/// bytes of output or "error <message>".
+///
+/// The requests only read the trees, so several sessions can be answered at
+/// the same time. The text printing counts the printed objects in the reader,
+/// so text output is produced by one request at a time for each file.
+class QueryServer {
+public:
+  QueryServer(const std::vector<LibScopeView::Reader *> &Readers,
+              const LibScopeView::PrintSettings &Settings);
+
+  /// \brief State kept between the requests of a session.
+  struct Session {
+    bool YAMLOutput = false;
+    bool Quit = false;
+  };
+
+  /// \brief Returns the response to a single request.
+  std::string handleRequest(const std::string &Request, Session &State);
+
+  /// \brief Answers the requests read from Input until it ends or the session
+  /// is ended.
+  void serve(std::istream &Input, std::ostream &Output);
+
+  /// \brief Answers the requests from the clients connecting to the Unix
+  /// domain socket at Path, each client from its own thread. Returns false if
+  /// the socket can not be created.
+  bool serveSocket(const std::string &Path);
+
+private:
+  LibScopeView::Reader *findReader(const std::string &File) const;
+
+  // Returns the response giving the Objects in the session's format.
+  std::string printTree(LibScopeView::Reader &TheReader,
+                        const std::vector<LibScopeView::Object *> &Objects,
+                        bool AsList, const Session &State);
+  std::string compareTrees(const LibScopeView::Reader &First,
+                           const LibScopeView::Reader &Second) const;
+
+  // Answer the requests of a client of serveSocket, then close its socket.
+  void serveClient(int Client);
+
+  std::vector<LibScopeView::Reader *> Readers;
+  const LibScopeView::PrintSettings &Settings;
+
+  // Serializes the text printing of each reader, which updates the printed
+  // counts of its summary table.
+  std::unique_ptr<std::mutex[]> PrintMutexes;
+
+  // Set by the 'shutdown' command.
+  std::atomic<bool> Stopping;
+  int ListenSocket;
+
+  // The number of client sessions still running, which serveSocket waits for
+  // before returning.
+  std::mutex SessionMutex;
+  std::condition_variable SessionEnded;
+  unsigned LiveSessions;
+};
+
+#endif // QUERYSERVER_H_
@@ -0,0 +1,109 @@
+//===-- Diva/WorkStealingPool.cpp -------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Runs numbered tasks on a pool of threads that steal from each other.
+///
+//===----------------------------------------------------------------------===//
+
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned ThreadCount)
+    : ThreadCount(ThreadCount) {
+  if (this->ThreadCount == 0)
+    this->ThreadCount = std::max(1U, std::thread::hardware_concurrency());
+}
+
+void WorkStealingPool::run(size_t Count, const TaskFunc &Task,
+                           const CanStartFunc &CanStart) {
+  this->Task = Task;
+  this->CanStart = CanStart;
+  Queues.assign(ThreadCount, std::deque<size_t>());
+  for (size_t Index = 0; Index < Count; ++Index)
+    Queues[Index % ThreadCount].push_back(Index);
+  Unfinished = Count;
+
+  std::vector<std::thread> Threads;
+  for (unsigned Worker = 1; Worker < ThreadCount; ++Worker)
+    Threads.emplace_back(&WorkStealingPool::work, this, Worker);
+  work(0);
+  for (std::thread &Thread : Threads)
+    Thread.join();
+}
+
+void WorkStealingPool::notify() {
+  // Lock so a worker can't miss the notification between checking the
+  // condition and waiting.
+  std::lock_guard<std::mutex> Lock(QueueMutex);
+  QueueChanged.notify_all();
+}
+
+void WorkStealingPool::work(unsigned Worker) {
+  std::unique_lock<std::mutex> Lock(QueueMutex);
+  while (Unfinished) {
+    size_t Index;
+    if (!takeTask(Worker, Index)) {
+      QueueChanged.wait(Lock);
+      continue;
+    }
+
+    Lock.unlock();
+    Task(Index);
+    Lock.lock();
+    --Unfinished;
+    QueueChanged.notify_all();
+  }
+}
+
+bool WorkStealingPool::takeTask(unsigned Worker, size_t &Index) {
+  auto Take = [&](std::deque<size_t> &Queue, bool Back) {
+    if (Queue.empty())
+      return false;
+    size_t Candidate = Back ? Queue.back() : Queue.front();
+    if (CanStart && !CanStart(Candidate))
+      return false;
+    Index = Candidate;
+    if (Back)
+      Queue.pop_back();
+    else
+      Queue.pop_front();
+    return true;
+  };
+
+  // Run the own tasks first.
+  if (Take(Queues[Worker], /*Back*/ false))
+    return true;
+
+  // Steal the last task of another worker, or its first one if the last one
+  // can't be started yet.
+  for (unsigned Offset = 1; Offset < ThreadCount; ++Offset) {
+    std::deque<size_t> &Other = Queues[(Worker + Offset) % ThreadCount];
+    if (Take(Other, /*Back*/ true) || Take(Other, /*Back*/ false))
+      return true;
+  }
+  return false;
+}
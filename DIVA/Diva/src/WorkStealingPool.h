@@ -0,0 +1,88 @@
+//===-- Diva/WorkStealingPool.h ---------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Runs numbered tasks on a pool of threads that steal from each other.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef WORKSTEALINGPOOL_H_
+#define WORKSTEALINGPOOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/// \brief Runs numbered tasks on a fixed number of threads.
+///
+/// Task I is first queued on worker I % ThreadCount, and each worker runs its
+/// own tasks in increasing order. A worker that runs out of tasks steals the
+/// highest numbered task queued on another worker, so the tasks are mostly
+/// started in order while a few slow tasks don't hold up the others.
+///
+/// A task is only started once the CanStart condition given to run() accepts
+/// it, which is checked again each time a task ends or notify() is called. The
+/// lowest numbered task that has not been started is always considered, so the
+/// condition must eventually accept it once the running tasks have ended.
+class WorkStealingPool {
+public:
+  typedef std::function<void(size_t)> TaskFunc;
+  typedef std::function<bool(size_t)> CanStartFunc;
+
+  /// \brief Creates a pool of ThreadCount threads, or of one thread per
+  /// hardware thread if ThreadCount is 0.
+  explicit WorkStealingPool(unsigned ThreadCount);
+
+  unsigned getThreadCount() const { return ThreadCount; }
+
+  /// \brief Runs Task(0) to Task(Count - 1) and returns once they have all
+  /// ended.
+  void run(size_t Count, const TaskFunc &Task,
+           const CanStartFunc &CanStart = nullptr);
+
+  /// \brief Checks again the start condition of the waiting workers.
+  void notify();
+
+private:
+  void work(unsigned Worker);
+  // Removes the next task for Worker from the queues. Returns false if no task
+  // can be started.
+  bool takeTask(unsigned Worker, size_t &Index);
+
+  unsigned ThreadCount;
+  TaskFunc Task;
+  CanStartFunc CanStart;
+
+  // The queued tasks of each worker, all guarded by QueueMutex. The tasks take
+  // long enough to make a single lock cheap.
+  std::vector<std::deque<size_t>> Queues;
+  std::mutex QueueMutex;
+  std::condition_variable QueueChanged;
+  size_t Unfinished = 0;
+};
+
+#endif // WORKSTEALINGPOOL_H_
@@ -27,18 +27,29 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "BatchRunner.h"
 #include "DivaOptions.h"
 #include "ElfDwarfReader.h"
 #include "Error.h"
 #include "FileUtilities.h"
+#include "Platform.h"
 #include "PrintSettings.h"
+#include "QueryServer.h"
+#include "ScopeBinaryPrinter.h"
 #include "ScopeYAMLPrinter.h"
 #include "StringPool.h"
 #include "Utilities.h"
 
 #include <assert.h>
+#include <fstream>
+#include <iomanip>
 #include <memory>
 
+#ifdef PLATFORM_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
 namespace {
 
 typedef std::unique_ptr<LibScopeView::Reader> ReaderUPtr;
@@ -51,6 +62,148 @@ ReaderUPtr createReader(const std::string &InputFilePath) {
   fatalError(LibScopeError::ErrorCode::ERR_INVALID_FILE, InputFilePath);
 }
 
+/// \brief Create a reader and load the given file.
+ReaderUPtr loadReader(const std::string &InputFilePath,
+                      const DivaOptions &Options) {
+  // Check that the file exists.
+  if (!LibScopeView::doesFileExist(InputFilePath))
+    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, InputFilePath);
+
+  ReaderUPtr AReader(createReader(InputFilePath));
+  assert(AReader);
+  bool Result = AReader->loadFile(InputFilePath, Options.PrintingSettings);
+
+  if (!Result)
+    // Currently the ElfDwarfReader will always call fatalError itself so we
+    // should never reach this code.
+    fatalError(LibScopeError::ErrorCode::ERR_READ_FAILED, InputFilePath);
+  return AReader;
+}
+
+/// \brief Stop any newline bytes in the binary output being translated.
+void setBinaryStdout() {
+#ifdef PLATFORM_WIN
+  std::cout.flush();
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+/// \brief Print the scope view of a reader in the requested formats. The text
+/// goes to the global print context and the other formats to Output.
+void printReader(LibScopeView::Reader &AReader, const DivaOptions &Options,
+                 std::ostream &Output) {
+  // Count the printed objects in the summary of this reader.
+  LibScopeView::setReader(&AReader);
+
+  // Print the Logical View. With --summary-only there is only the summary
+  // table, and no tree for the other formats.
+  bool SummaryOnly = Options.PrintingSettings.SummaryOnly;
+  if (SummaryOnly || Options.OutputFormats.count(OutputFormat::TEXT)) {
+    AReader.print(Options.PrintingSettings);
+  }
+  // Print YAML.
+  if (!SummaryOnly && Options.OutputFormats.count(OutputFormat::YAML)) {
+    // YAML_OUTPUT_VERSION_STR is defined by CMake.
+    LibScopeView::ScopeYAMLPrinter YAMLPrinter(AReader.getInputFile(),
+                                               YAML_OUTPUT_VERSION_STR);
+    if (Options.PrintingSettings.SplitOutput) {
+      YAMLPrinter.print(
+          static_cast<LibScopeView::ScopeRoot *>(AReader.getScopesRoot()),
+          Options.PrintingSettings.OutputDirectory);
+    } else {
+      YAMLPrinter.print(AReader.getScopesRoot(), Output);
+    }
+  }
+  // Print the binary scope tree.
+  if (!SummaryOnly && Options.OutputFormats.count(OutputFormat::BINARY)) {
+    LibScopeView::ScopeBinaryPrinter BinaryPrinter(AReader.getInputFile());
+    if (Options.PrintingSettings.SplitOutput) {
+      BinaryPrinter.print(
+          static_cast<LibScopeView::ScopeRoot *>(AReader.getScopesRoot()),
+          Options.PrintingSettings.OutputDirectory);
+    } else {
+      if (&Output == &std::cout)
+        setBinaryStdout();
+      BinaryPrinter.print(AReader.getScopesRoot(), Output);
+    }
+  }
+  // Print the time taken by each pass over the file.
+  if (Options.ShowPerformanceTime) {
+    Output << "\nTime taken by each pass over " << AReader.getInputFile()
+           << ":\n";
+    for (const auto &PassTime : AReader.getPassTimes())
+      Output << "  " << std::left << std::setw(12) << PassTime.first
+             << std::setprecision(2) << PassTime.second << " seconds\n";
+  }
+}
+
+/// \brief Read the input files listed in a manifest, one per line. Empty lines
+/// and lines starting with '#' are skipped.
+std::vector<std::string> readManifest(const std::string &ManifestPath) {
+  std::ifstream Manifest(ManifestPath);
+  if (!Manifest)
+    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, ManifestPath);
+
+  std::vector<std::string> InputFiles;
+  std::string Line;
+  while (std::getline(Manifest, Line)) {
+    Line = LibScopeView::trim(Line);
+    if (!Line.empty() && Line[0] != '#')
+      InputFiles.push_back(Line);
+  }
+  return InputFiles;
+}
+
+/// \brief Read the code addresses listed in a file, in hex one per line with
+/// or without "0x". Empty lines and lines starting with '#' are skipped.
+std::vector<uint64_t> readAddresses(const std::string &AddressPath) {
+  std::ifstream AddressFile(AddressPath);
+  if (!AddressFile)
+    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, AddressPath);
+
+  std::vector<uint64_t> Addresses;
+  std::string Line;
+  while (std::getline(AddressFile, Line)) {
+    Line = LibScopeView::trim(Line);
+    if (Line.empty() || Line[0] == '#')
+      continue;
+    size_t End = 0;
+    uint64_t Address = 0;
+    try {
+      Address = std::stoull(Line, &End, 16);
+    } catch (const std::logic_error &) {
+    }
+    if (End == Line.size())
+      Addresses.push_back(Address);
+    else
+      LibScopeError::warning("Invalid address '" + Line + "' in '" +
+                             AddressPath + "'.");
+  }
+  return Addresses;
+}
+
+/// \brief Load, print and free the batch input files on a pool of threads.
+void runBatch(const DivaOptions &Options) {
+  std::vector<std::string> InputFiles(Options.InputFiles);
+  if (!Options.BatchManifest.empty()) {
+    std::vector<std::string> Listed(readManifest(Options.BatchManifest));
+    InputFiles.insert(InputFiles.end(), Listed.begin(), Listed.end());
+  }
+  if (Options.OutputFormats.count(OutputFormat::BINARY) &&
+      !Options.PrintingSettings.SplitOutput)
+    setBinaryStdout();
+
+  BatchRunner Runner(Options.BatchJobs, Options.BatchMemory * 1024 * 1024);
+  Runner.run(InputFiles,
+             [&](const std::string &InputFilePath) {
+               return loadReader(InputFilePath, Options);
+             },
+             [&](LibScopeView::Reader &AReader, std::ostream &Output) {
+               printReader(AReader, Options, Output);
+             },
+             std::cout);
+}
+
 } // namespace
 
 int main(int argc, char *argv[]) {
@@ -61,53 +214,49 @@ int main(int argc, char *argv[]) {
 
   // Argument parsing.
   const std::vector<std::string> CMDArgs(argv + 1, argv + argc);
-  const DivaOptions Options(CMDArgs, /*HelpOut*/ std::cout,
-                            /*VersionOut*/ std::cerr,
-                            /*ErrOut*/ std::cerr);
+  DivaOptions Options(CMDArgs, /*HelpOut*/ std::cout,
+                      /*VersionOut*/ std::cerr,
+                      /*ErrOut*/ std::cerr);
+  if (!Options.AddressFile.empty()) {
+    Options.PrintingSettings.Addresses = readAddresses(Options.AddressFile);
+    Options.PrintingSettings.LookupAddresses = true;
+  }
 
   std::vector<ReaderUPtr> Readers;
 
-  // Create readers and load the input files.
-  for (const std::string &InputFilePath : Options.InputFiles) {
-    // Check that the file exists.
-    if (!LibScopeView::doesFileExist(InputFilePath))
-      fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, InputFilePath);
-
-    Readers.push_back(createReader(InputFilePath));
-    assert(Readers.back());
-    bool Result =
-        Readers.back()->loadFile(InputFilePath, Options.PrintingSettings);
-
-    if (!Result)
-      // Currently the ElfDwarfReader will always call fatalError itself so we
-      // should never reach this code.
-      fatalError(LibScopeError::ErrorCode::ERR_READ_FAILED, InputFilePath);
+  if (Options.Batch && !Options.Serve) {
+    // Load, print and free each input file on a pool of threads.
+    runBatch(Options);
+  } else {
+    // Create readers and load the input files.
+    for (const std::string &InputFilePath : Options.InputFiles)
+      Readers.push_back(loadReader(InputFilePath, Options));
   }
 
   if (Options.ShowScopeAllocation)
     LibScopeView::printAllocationInfo();
 
-  // Print the scope views in the readers.
-  for (auto &AReader : Readers) {
-    // Print the Logical View.
-    if (Options.OutputFormats.count(OutputFormat::TEXT)) {
-      AReader->print(Options.PrintingSettings);
-    }
-    // Print YAML.
-    if (Options.OutputFormats.count(OutputFormat::YAML)) {
-      // YAML_OUTPUT_VERSION_STR is defined by CMake.
-      LibScopeView::ScopeYAMLPrinter YAMLPrinter(AReader->getInputFile(),
-                                                 YAML_OUTPUT_VERSION_STR);
-      if (Options.PrintingSettings.SplitOutput) {
-        YAMLPrinter.print(
-            static_cast<LibScopeView::ScopeRoot *>(AReader->getScopesRoot()),
-            Options.PrintingSettings.OutputDirectory);
-      } else {
-        YAMLPrinter.print(AReader->getScopesRoot(), std::cout);
-      }
+  // Answer requests about the loaded trees instead of printing them.
+  if (Options.Serve) {
+    std::vector<LibScopeView::Reader *> ServedReaders;
+    for (auto &AReader : Readers) {
+      AReader->propagatePatternMatch();
+      ServedReaders.push_back(AReader.get());
     }
+    QueryServer Server(ServedReaders, Options.PrintingSettings);
+    if (Options.ServeSocket.empty())
+      Server.serve(std::cin, std::cout);
+    else if (!Server.serveSocket(Options.ServeSocket))
+      fatalError(LibScopeError::ErrorCode::ERR_SERVE_SOCKET,
+                 Options.ServeSocket);
+    // The served files are not printed.
+    Readers.clear();
   }
 
+  // Print the scope views in the readers.
+  for (auto &AReader : Readers)
+    printReader(*AReader, Options, std::cout);
+
   // Print string pool data.
   if (Options.DumpStringPool)
     LibScopeView::StringPool::dumpPool();
@@ -0,0 +1,622 @@
+//===-- DivaGenDwarf/DwarfGenerator.cpp -------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Writes ELF objects holding synthetic DWARF, for profiling DIVA.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfGenerator.h"
+
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Symbol of the code section, which the addresses are relative to. The
+// debug sections get the symbols following it.
+const Dwarf_Unsigned TextSymbol = 1;
+const Dwarf_Unsigned FirstSectionSymbol = 2;
+
+// Address of the code of the first compile unit.
+const uint64_t CodeStart = 0x1000;
+// Size of the code of each line table row.
+const uint64_t RowSize = 4;
+
+// ELF constants, so the object can be written without libelf.
+const size_t ElfHeaderSize = 64;
+const size_t SectionHeaderSize = 64;
+const uint32_t SHT_PROGBITS = 1;
+const uint32_t SHT_STRTAB = 3;
+const uint32_t SHT_NOBITS = 8;
+const uint64_t SHF_ALLOC = 0x2;
+const uint64_t SHF_EXECINSTR = 0x4;
+const uint16_t ET_REL = 1;
+const uint16_t EM_X86_64 = 62;
+
+void writeLE(unsigned char *Data, uint64_t Value, size_t Length) {
+  for (size_t I = 0; I < Length; ++I)
+    Data[I] = static_cast<unsigned char>(Value >> (8 * I));
+}
+
+uint64_t readLE(const unsigned char *Data, size_t Length) {
+  uint64_t Value = 0;
+  for (size_t I = 0; I < Length; ++I)
+    Value |= static_cast<uint64_t>(Data[I]) << (8 * I);
+  return Value;
+}
+
+void appendLE(std::vector<unsigned char> &Data, uint64_t Value,
+              size_t Length) {
+  Data.resize(Data.size() + Length);
+  writeLE(Data.data() + Data.size() - Length, Value, Length);
+}
+
+/// \brief Collects the sections of the compile units and writes them as a
+/// single ELF object.
+///
+/// The .debug_info section is written straight to the output, following the
+/// ELF header, while the other sections are kept in temporary files until
+/// all the compile units have been added.
+class ObjectWriter {
+public:
+  ObjectWriter() : Output(nullptr), CodeSize(0) {}
+  ~ObjectWriter();
+
+  bool open(const std::string &Path);
+
+  /// \brief Index of the output section with the given name.
+  size_t getSection(const std::string &Name);
+
+  /// \brief Offset of the data of the next unit in the section.
+  uint64_t getSize(size_t Section) const { return Sections[Section].Size; }
+
+  bool append(size_t Section, const std::vector<unsigned char> &Data);
+
+  /// \brief Offset of an identical abbreviation table already written, or
+  /// NoTable.
+  uint64_t findAbbrevTable(const std::vector<unsigned char> &Data) const;
+  void addAbbrevTable(const std::vector<unsigned char> &Data, uint64_t Offset);
+  static const uint64_t NoTable = static_cast<uint64_t>(-1);
+
+  void setCodeSize(uint64_t Size) { CodeSize = Size; }
+
+  /// \brief Write the other sections and the headers. Returns the size of the
+  /// output, or 0 if it can not be written.
+  uint64_t finish();
+
+private:
+  struct OutputSection {
+    std::string Name;
+    std::FILE *Data;
+    uint64_t Size;
+    uint64_t Offset;
+  };
+
+  bool write(const std::vector<unsigned char> &Data);
+
+  std::FILE *Output;
+  std::vector<OutputSection> Sections;
+  std::unordered_map<std::string, uint64_t> AbbrevTables;
+  uint64_t CodeSize;
+};
+
+ObjectWriter::~ObjectWriter() {
+  for (OutputSection &Section : Sections)
+    if (Section.Data != Output)
+      std::fclose(Section.Data);
+  if (Output)
+    std::fclose(Output);
+}
+
+bool ObjectWriter::open(const std::string &Path) {
+  Output = std::fopen(Path.c_str(), "wb");
+  if (!Output)
+    return false;
+  // The ELF header is written once the sections are known.
+  if (!write(std::vector<unsigned char>(ElfHeaderSize)))
+    return false;
+  Sections.push_back({".debug_info", Output, 0, ElfHeaderSize});
+  return true;
+}
+
+size_t ObjectWriter::getSection(const std::string &Name) {
+  for (size_t Index = 0; Index < Sections.size(); ++Index)
+    if (Sections[Index].Name == Name)
+      return Index;
+  Sections.push_back({Name, std::tmpfile(), 0, 0});
+  return Sections.size() - 1;
+}
+
+bool ObjectWriter::append(size_t Section,
+                          const std::vector<unsigned char> &Data) {
+  OutputSection &Out = Sections[Section];
+  if (!Out.Data ||
+      std::fwrite(Data.data(), 1, Data.size(), Out.Data) != Data.size())
+    return false;
+  Out.Size += Data.size();
+  return true;
+}
+
+uint64_t
+ObjectWriter::findAbbrevTable(const std::vector<unsigned char> &Data) const {
+  auto Found = AbbrevTables.find(std::string(Data.begin(), Data.end()));
+  return Found == AbbrevTables.end() ? NoTable : Found->second;
+}
+
+void ObjectWriter::addAbbrevTable(const std::vector<unsigned char> &Data,
+                                  uint64_t Offset) {
+  AbbrevTables.emplace(std::string(Data.begin(), Data.end()), Offset);
+}
+
+bool ObjectWriter::write(const std::vector<unsigned char> &Data) {
+  return std::fwrite(Data.data(), 1, Data.size(), Output) == Data.size();
+}
+
+uint64_t ObjectWriter::finish() {
+  // Copy the sections kept in temporary files after .debug_info.
+  uint64_t Offset = ElfHeaderSize + Sections[0].Size;
+  std::vector<unsigned char> Buffer(1 << 20);
+  for (size_t Index = 1; Index < Sections.size(); ++Index) {
+    OutputSection &Section = Sections[Index];
+    Section.Offset = Offset;
+    std::rewind(Section.Data);
+    size_t Read;
+    while ((Read = std::fread(Buffer.data(), 1, Buffer.size(), Section.Data)))
+      if (std::fwrite(Buffer.data(), 1, Read, Output) != Read)
+        return 0;
+    Offset += Section.Size;
+  }
+
+  // The section names. The null section comes first and the code section
+  // second, followed by the debug sections.
+  std::vector<unsigned char> Names(1, 0);
+  auto addName = [&Names](const std::string &Name) {
+    uint32_t NameOffset = static_cast<uint32_t>(Names.size());
+    Names.insert(Names.end(), Name.begin(), Name.end());
+    Names.push_back(0);
+    return NameOffset;
+  };
+  std::vector<unsigned char> Headers(SectionHeaderSize);
+  auto addHeader = [&Headers](uint32_t Name, uint32_t Type, uint64_t Flags,
+                              uint64_t SectionOffset, uint64_t Size,
+                              uint64_t Align) {
+    appendLE(Headers, Name, 4);
+    appendLE(Headers, Type, 4);
+    appendLE(Headers, Flags, 8);
+    appendLE(Headers, 0, 8); // Address.
+    appendLE(Headers, SectionOffset, 8);
+    appendLE(Headers, Size, 8);
+    appendLE(Headers, 0, 4); // Link.
+    appendLE(Headers, 0, 4); // Info.
+    appendLE(Headers, Align, 8);
+    appendLE(Headers, 0, 8); // Entry size.
+  };
+  addHeader(addName(".text"), SHT_NOBITS, SHF_ALLOC | SHF_EXECINSTR, Offset,
+            CodeSize, 16);
+  for (const OutputSection &Section : Sections)
+    addHeader(addName(Section.Name), SHT_PROGBITS, 0, Section.Offset,
+              Section.Size, 1);
+  uint32_t NamesName = addName(".shstrtab");
+  addHeader(NamesName, SHT_STRTAB, 0, Offset, Names.size(), 1);
+  uint64_t HeadersOffset = Offset + Names.size();
+  uint16_t SectionCount = static_cast<uint16_t>(Sections.size() + 3);
+  if (!write(Names) || !write(Headers))
+    return 0;
+
+  std::vector<unsigned char> Header = {0x7f, 'E', 'L', 'F',
+                                       2, // 64-bit.
+                                       1, // Little endian.
+                                       1, // Current version.
+                                       0, 0, 0, 0, 0, 0, 0, 0, 0};
+  appendLE(Header, ET_REL, 2);
+  appendLE(Header, EM_X86_64, 2);
+  appendLE(Header, 1, 4);             // Version.
+  appendLE(Header, 0, 8);             // Entry point.
+  appendLE(Header, 0, 8);             // Program headers.
+  appendLE(Header, HeadersOffset, 8); // Section headers.
+  appendLE(Header, 0, 4);             // Flags.
+  appendLE(Header, ElfHeaderSize, 2);
+  appendLE(Header, 0, 2); // Program header size.
+  appendLE(Header, 0, 2); // Program header count.
+  appendLE(Header, SectionHeaderSize, 2);
+  appendLE(Header, SectionCount, 2);
+  appendLE(Header, SectionCount - 1U, 2); // Index of the section names.
+  std::rewind(Output);
+  if (!write(Header) || std::fflush(Output) != 0)
+    return 0;
+  return HeadersOffset + Headers.size();
+}
+
+void recordError(Dwarf_Error Err, Dwarf_Ptr Message) {
+  std::string &Text = *static_cast<std::string *>(Message);
+  if (Text.empty())
+    Text = dwarf_errmsg(Err);
+}
+
+/// \brief Builds one compile unit with its own libdwarf producer and adds its
+/// sections to the output.
+class UnitGenerator {
+public:
+  UnitGenerator(const GeneratorOptions &Options, size_t Unit,
+                uint64_t Address)
+      : Options(Options), Unit(Unit), Address(Address), Dbg(nullptr),
+        Writer(nullptr), IntType(nullptr), NextLine(1) {}
+  ~UnitGenerator() {
+    if (Dbg)
+      dwarf_producer_finish(Dbg, nullptr);
+  }
+
+  bool generate(ObjectWriter &Writer, std::string &Error);
+
+  /// \brief Address following the code of the unit.
+  uint64_t getEndAddress() const { return Address; }
+
+private:
+  static int createSection(const char *Name, int Size, Dwarf_Unsigned Type,
+                           Dwarf_Unsigned Flags, Dwarf_Unsigned Link,
+                           Dwarf_Unsigned Info, Dwarf_Unsigned *SymbolIndex,
+                           void *UserData, int *Error);
+  bool writeSections(ObjectWriter &Writer);
+
+  Dwarf_P_Die newDie(Dwarf_Half Tag, Dwarf_P_Die Parent,
+                     const std::string &Name);
+  void addType(Dwarf_P_Die Die, Dwarf_P_Die Type);
+  void addDecl(Dwarf_P_Die Die, Dwarf_Unsigned File, Dwarf_Unsigned Line);
+  void addRange(Dwarf_P_Die Die, uint64_t Start, uint64_t Size);
+  std::string makeName(const std::string &Base) const;
+
+  void addTemplates(Dwarf_P_Die CU);
+  void addNamespaces(Dwarf_P_Die Parent, size_t Level,
+                     const std::string &Suffix);
+  void addFunction(Dwarf_P_Die Parent, const std::string &Suffix);
+
+  const GeneratorOptions &Options;
+  const size_t Unit;
+  uint64_t Address;
+  Dwarf_P_Debug Dbg;
+  std::string Message;
+
+  ObjectWriter *Writer;
+  // Output section of each producer section, or NoSection for the
+  // relocation sections.
+  std::vector<size_t> OutputSections;
+  static const size_t NoSection = static_cast<size_t>(-1);
+
+  Dwarf_P_Die IntType;
+  std::vector<Dwarf_P_Die> TemplatePointers;
+  Dwarf_Unsigned NextLine;
+};
+
+int UnitGenerator::createSection(const char *Name, int, Dwarf_Unsigned,
+                                 Dwarf_Unsigned, Dwarf_Unsigned,
+                                 Dwarf_Unsigned, Dwarf_Unsigned *SymbolIndex,
+                                 void *UserData, int *) {
+  UnitGenerator &Generator = *static_cast<UnitGenerator *>(UserData);
+  std::string SectionName(Name);
+  size_t Section = NoSection;
+  if (SectionName.compare(0, 5, ".rel.") != 0) {
+    Section = Generator.Writer->getSection(SectionName);
+    *SymbolIndex = FirstSectionSymbol + Section;
+  }
+  Generator.OutputSections.push_back(Section);
+  // The producer section indexes start at 1.
+  return static_cast<int>(Generator.OutputSections.size());
+}
+
+Dwarf_P_Die UnitGenerator::newDie(Dwarf_Half Tag, Dwarf_P_Die Parent,
+                                  const std::string &Name) {
+  Dwarf_P_Die Die =
+      dwarf_new_die(Dbg, Tag, Parent, nullptr, nullptr, nullptr, nullptr);
+  if (!Name.empty())
+    dwarf_add_AT_name(Die, const_cast<char *>(Name.c_str()), nullptr);
+  return Die;
+}
+
+void UnitGenerator::addType(Dwarf_P_Die Die, Dwarf_P_Die Type) {
+  dwarf_add_AT_reference(Dbg, Die, DW_AT_type, Type, nullptr);
+}
+
+void UnitGenerator::addDecl(Dwarf_P_Die Die, Dwarf_Unsigned File,
+                            Dwarf_Unsigned Line) {
+  dwarf_add_AT_unsigned_const(Dbg, Die, DW_AT_decl_file, File, nullptr);
+  dwarf_add_AT_unsigned_const(Dbg, Die, DW_AT_decl_line, Line, nullptr);
+}
+
+void UnitGenerator::addRange(Dwarf_P_Die Die, uint64_t Start, uint64_t Size) {
+  dwarf_add_AT_targ_address_b(Dbg, Die, DW_AT_low_pc, Start, TextSymbol,
+                              nullptr);
+  dwarf_add_AT_targ_address_b(Dbg, Die, DW_AT_high_pc, Start + Size,
+                              TextSymbol, nullptr);
+}
+
+std::string UnitGenerator::makeName(const std::string &Base) const {
+  static const char Letters[] = "abcdefghijklmnopqrstuvwxyz";
+  std::string Name(Base);
+  if (Name.size() < Options.StringSize)
+    Name += '_';
+  while (Name.size() < Options.StringSize)
+    Name += Letters[Name.size() % 26];
+  return Name;
+}
+
+// The template-like classes are the same in every unit, as if they came from
+// a header included by all of them.
+void UnitGenerator::addTemplates(Dwarf_P_Die CU) {
+  for (size_t Index = 0; Index < Options.Templates; ++Index) {
+    std::string Number(std::to_string(Index));
+    Dwarf_P_Die Class = newDie(DW_TAG_class_type, CU,
+                               makeName("Container") + "<int, " + Number + ">");
+    dwarf_add_AT_unsigned_const(Dbg, Class, DW_AT_byte_size, 16, nullptr);
+    addDecl(Class, 2, 10 * Index + 1);
+
+    Dwarf_P_Die Param = newDie(DW_TAG_template_type_parameter, Class, "T");
+    addType(Param, IntType);
+    Param = newDie(DW_TAG_template_value_parameter, Class, "N");
+    addType(Param, IntType);
+    dwarf_add_AT_const_value_unsignedint(Param, Index, nullptr);
+
+    Dwarf_P_Die Pointer = newDie(DW_TAG_pointer_type, CU, "");
+    dwarf_add_AT_unsigned_const(Dbg, Pointer, DW_AT_byte_size, 8, nullptr);
+    addType(Pointer, Class);
+    TemplatePointers.push_back(Pointer);
+
+    Dwarf_P_Die Member = newDie(DW_TAG_member, Class, makeName("Value"));
+    addType(Member, IntType);
+    addDecl(Member, 2, 10 * Index + 2);
+    dwarf_add_AT_any_value_uleb(Member, DW_AT_data_member_location, 0,
+                                nullptr);
+    Member = newDie(DW_TAG_member, Class, makeName("Next"));
+    addType(Member, Pointer);
+    addDecl(Member, 2, 10 * Index + 3);
+    dwarf_add_AT_any_value_uleb(Member, DW_AT_data_member_location, 8,
+                                nullptr);
+
+    Dwarf_P_Die Method = newDie(DW_TAG_subprogram, Class, makeName("get"));
+    addType(Method, IntType);
+    addDecl(Method, 2, 10 * Index + 4);
+    dwarf_add_AT_flag(Dbg, Method, DW_AT_declaration, 1, nullptr);
+    dwarf_add_AT_flag(Dbg, Method, DW_AT_external, 1, nullptr);
+    Dwarf_P_Die This = newDie(DW_TAG_formal_parameter, Method, "");
+    addType(This, Pointer);
+    dwarf_add_AT_flag(Dbg, This, DW_AT_artificial, 1, nullptr);
+  }
+}
+
+void UnitGenerator::addNamespaces(Dwarf_P_Die Parent, size_t Level,
+                                  const std::string &Suffix) {
+  for (size_t Index = 0; Index < Options.FanOut; ++Index) {
+    std::string ChildSuffix(Suffix + "_" + std::to_string(Index));
+    if (Level == Options.Depth) {
+      addFunction(Parent, ChildSuffix);
+      continue;
+    }
+    Dwarf_P_Die Namespace =
+        newDie(DW_TAG_namespace, Parent, makeName("ns" + ChildSuffix));
+    addNamespaces(Namespace, Level + 1, ChildSuffix);
+  }
+}
+
+void UnitGenerator::addFunction(Dwarf_P_Die Parent, const std::string &Suffix) {
+  size_t Rows = Options.LinesPerFunction ? Options.LinesPerFunction : 1;
+  uint64_t Size = Rows * RowSize;
+  Dwarf_Unsigned Line = NextLine;
+  NextLine += Rows + 2;
+
+  Dwarf_P_Die Function = newDie(DW_TAG_subprogram, Parent,
+                                makeName("function" + Suffix));
+  addType(Function, IntType);
+  addDecl(Function, 1, Line);
+  dwarf_add_AT_flag(Dbg, Function, DW_AT_external, 1, nullptr);
+  addRange(Function, Address, Size);
+
+  Dwarf_P_Die Param =
+      newDie(DW_TAG_formal_parameter, Function, makeName("Item"));
+  if (!TemplatePointers.empty())
+    addType(Param, TemplatePointers[Line % TemplatePointers.size()]);
+  else
+    addType(Param, IntType);
+  addDecl(Param, 1, Line);
+
+  Dwarf_P_Die Block = newDie(DW_TAG_lexical_block, Function, "");
+  addRange(Block, Address, Size);
+  Dwarf_P_Die Local = newDie(DW_TAG_variable, Block, makeName("Local"));
+  addType(Local, IntType);
+  addDecl(Local, 1, Line + 1);
+
+  for (size_t Row = 0; Row < Rows; ++Row)
+    dwarf_add_line_entry(Dbg, 1, Address + Row * RowSize, Line + Row, 0, 1, 0,
+                         nullptr);
+  Address += Size;
+}
+
+bool UnitGenerator::generate(ObjectWriter &Output, std::string &Error) {
+  Writer = &Output;
+  // The producer writes DWARF 2 with 32-bit offsets, which only limits the
+  // size of the sections referred to by offsets: .debug_info can grow past
+  // 4 GB as the units only refer to their own DIEs.
+  Dwarf_Unsigned Flags = DW_DLC_WRITE | DW_DLC_SIZE_64 |
+                         DW_DLC_SYMBOLIC_RELOCATIONS |
+                         DW_DLC_TARGET_LITTLEENDIAN;
+  if (dwarf_producer_init(Flags, createSection, recordError, &Message, this,
+                          "x86_64", "V2", "", &Dbg,
+                          nullptr) != DW_DLV_OK) {
+    Error = "failed to create the DWARF producer";
+    return false;
+  }
+
+  std::string Number(std::to_string(Unit));
+  std::string FileName(makeName("unit" + Number) + ".cpp");
+  Dwarf_P_Die CU = newDie(DW_TAG_compile_unit, nullptr, FileName);
+  dwarf_add_AT_producer(CU, const_cast<char *>("DivaGenDwarf"), nullptr);
+  dwarf_add_AT_comp_dir(CU, const_cast<char *>("/gen"), nullptr);
+  dwarf_add_AT_unsigned_const(Dbg, CU, DW_AT_language, DW_LANG_C_plus_plus,
+                              nullptr);
+  Dwarf_Unsigned Directory =
+      dwarf_add_directory_decl(Dbg, const_cast<char *>("/gen"), nullptr);
+  dwarf_add_file_decl(Dbg, const_cast<char *>(FileName.c_str()), Directory, 0,
+                      0, nullptr);
+  dwarf_add_file_decl(Dbg, const_cast<char *>("templates.h"), Directory, 0, 0,
+                      nullptr);
+
+  IntType = newDie(DW_TAG_base_type, CU, "int");
+  dwarf_add_AT_unsigned_const(Dbg, IntType, DW_AT_byte_size, 4, nullptr);
+  dwarf_add_AT_unsigned_const(Dbg, IntType, DW_AT_encoding, DW_ATE_signed,
+                              nullptr);
+  addTemplates(CU);
+
+  uint64_t Start = Address;
+  NextLine = 1;
+  dwarf_lne_set_address(Dbg, Start, TextSymbol, nullptr);
+  addNamespaces(CU, 0, "_" + Number);
+  dwarf_lne_end_sequence(Dbg, Address, nullptr);
+  addRange(CU, Start, Address - Start);
+  dwarf_add_die_to_debug(Dbg, CU, nullptr);
+
+  if (Message.empty() && !writeSections(Output) && Message.empty())
+    Message = "failed to write the sections";
+  if (!Message.empty()) {
+    Error = "compile unit " + Number + ": " + Message;
+    return false;
+  }
+  return true;
+}
+
+bool UnitGenerator::writeSections(ObjectWriter &Output) {
+  Dwarf_Signed BufferCount = dwarf_transform_to_disk_form(Dbg, nullptr);
+  if (BufferCount == DW_DLV_NOCOUNT)
+    return false;
+
+  // The data of each producer section, which may come in several buffers.
+  std::vector<std::vector<unsigned char>> Data(OutputSections.size());
+  for (Dwarf_Signed Buffer = 0; Buffer < BufferCount; ++Buffer) {
+    Dwarf_Signed Section = 0;
+    Dwarf_Unsigned Length = 0;
+    auto Bytes = static_cast<const unsigned char *>(
+        dwarf_get_section_bytes(Dbg, Buffer, &Section, &Length, nullptr));
+    if (!Bytes || Section < 1 ||
+        static_cast<size_t>(Section) > OutputSections.size())
+      return false;
+    Data[Section - 1].insert(Data[Section - 1].end(), Bytes, Bytes + Length);
+  }
+
+  // The offset of the data of this unit in each output section. A unit with
+  // an abbreviation table already written refers to that one.
+  std::vector<uint64_t> Bases(OutputSections.size());
+  std::vector<bool> Shared(OutputSections.size());
+  for (size_t Section = 0; Section < OutputSections.size(); ++Section) {
+    size_t Out = OutputSections[Section];
+    if (Out == NoSection)
+      continue;
+    Bases[Section] = Output.getSize(Out);
+    if (Output.getSection(".debug_abbrev") == Out) {
+      uint64_t Table = Output.findAbbrevTable(Data[Section]);
+      Shared[Section] = Table != ObjectWriter::NoTable;
+      if (Shared[Section])
+        Bases[Section] = Table;
+      else
+        Output.addAbbrevTable(Data[Section], Bases[Section]);
+    }
+  }
+  // Section symbol of each producer section.
+  std::unordered_map<Dwarf_Unsigned, size_t> SymbolSections;
+  for (size_t Section = 0; Section < OutputSections.size(); ++Section)
+    if (OutputSections[Section] != NoSection)
+      SymbolSections[FirstSectionSymbol + OutputSections[Section]] = Section;
+
+  // Resolve the references to other sections, so the output needs no
+  // relocations. The addresses are already absolute.
+  Dwarf_Unsigned RelocationSections = 0;
+  int Version = 0;
+  if (dwarf_get_relocation_info_count(Dbg, &RelocationSections, &Version,
+                                      nullptr) != DW_DLV_OK)
+    return false;
+  for (Dwarf_Unsigned Index = 0; Index < RelocationSections; ++Index) {
+    Dwarf_Signed Section = 0;
+    Dwarf_Signed Target = 0;
+    Dwarf_Unsigned Count = 0;
+    Dwarf_Relocation_Data Relocations = nullptr;
+    if (dwarf_get_relocation_info(Dbg, &Section, &Target, &Count,
+                                  &Relocations, nullptr) != DW_DLV_OK ||
+        Target < 1 || static_cast<size_t>(Target) > Data.size())
+      return false;
+    std::vector<unsigned char> &TargetData = Data[Target - 1];
+    for (Dwarf_Unsigned Reloc = 0; Reloc < Count; ++Reloc) {
+      const Dwarf_Relocation_Data_s &Relocation = Relocations[Reloc];
+      auto Found = SymbolSections.find(Relocation.drd_symbol_index);
+      if (Found == SymbolSections.end())
+        continue;
+      size_t Length = Relocation.drd_length;
+      if (Relocation.drd_offset + Length > TargetData.size())
+        return false;
+      unsigned char *Field = TargetData.data() + Relocation.drd_offset;
+      uint64_t Value = readLE(Field, Length) + Bases[Found->second];
+      if (Length < 8 && (Value >> (8 * Length))) {
+        Message = "section offset too large for 32-bit DWARF";
+        return false;
+      }
+      writeLE(Field, Value, Length);
+    }
+  }
+
+  for (size_t Section = 0; Section < OutputSections.size(); ++Section)
+    if (OutputSections[Section] != NoSection && !Shared[Section] &&
+        !Output.append(OutputSections[Section], Data[Section]))
+      return false;
+  return true;
+}
+
+} // namespace
+
+DwarfGenerator::DwarfGenerator(const GeneratorOptions &Options)
+    : Options(Options), OutputSize(0) {}
+
+bool DwarfGenerator::generate(const std::string &Path, std::string &Error) {
+  OutputSize = 0;
+  ObjectWriter Writer;
+  if (!Writer.open(Path)) {
+    Error = "can not write '" + Path + "'";
+    return false;
+  }
+
+  uint64_t Address = CodeStart;
+  for (size_t Unit = 0; Unit < Options.CompileUnits; ++Unit) {
+    UnitGenerator Generator(Options, Unit, Address);
+    if (!Generator.generate(Writer, Error))
+      return false;
+    Address = Generator.getEndAddress();
+  }
+  Writer.setCodeSize(Address);
+
+  OutputSize = Writer.finish();
+  if (!OutputSize) {
+    Error = "can not write '" + Path + "'";
+    return false;
+  }
+  return true;
+}
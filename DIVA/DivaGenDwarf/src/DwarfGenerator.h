@@ -0,0 +1,77 @@
+//===-- DivaGenDwarf/DwarfGenerator.h ---------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Writes ELF objects holding synthetic DWARF, for profiling DIVA.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DWARFGENERATOR_H_
+#define DWARFGENERATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// \brief Shape of the debug information written by the DwarfGenerator.
+struct GeneratorOptions {
+  /// Number of compile units.
+  size_t CompileUnits = 16;
+  /// Levels of namespaces in each compile unit.
+  size_t Depth = 3;
+  /// Namespaces in each namespace, and functions in the innermost ones.
+  size_t FanOut = 4;
+  /// Template-like classes defined identically in every compile unit.
+  size_t Templates = 8;
+  /// Line table rows of each function.
+  size_t LinesPerFunction = 8;
+  /// Minimum length of the generated names.
+  size_t StringSize = 16;
+};
+
+/// \brief Writes an x86-64 ELF object with the DWARF described by the given
+/// options.
+///
+/// Each compile unit is built by its own libdwarf producer and its sections
+/// are appended to the output, so the memory used doesn't grow with the
+/// number of compile units. The compile units only differ in their names and
+/// addresses, so they all share a single abbreviation table. The output only
+/// depends on the options.
+class DwarfGenerator {
+public:
+  explicit DwarfGenerator(const GeneratorOptions &Options);
+
+  /// \brief Write the object to Path. Returns false and sets Error if it
+  /// fails.
+  bool generate(const std::string &Path, std::string &Error);
+
+  /// \brief Size of the file written by the last call to generate().
+  uint64_t getOutputSize() const { return OutputSize; }
+
+private:
+  const GeneratorOptions Options;
+  uint64_t OutputSize;
+};
+
+#endif // DWARFGENERATOR_H_
@@ -0,0 +1,115 @@
+//===-- DivaGenDwarf/main.cpp -----------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Contains the entry point for the DivaGenDwarf executable, which writes
+/// reproducible inputs of any size for profiling DIVA.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ArgumentParser.h"
+#include "DwarfGenerator.h"
+
+#include <iostream>
+
+namespace {
+
+using namespace ArgumentParser;
+
+const Argument::HelpLevel GeneralHelp = 1;
+
+// An argument setting a non-negative number.
+Argument countArg(const std::string &Name, const std::string &Help,
+                  size_t &Value) {
+  return Argument(
+      Argument::NoShortcut, Name, "=<n>", Help, GeneralHelp, nullptr,
+      [Name, &Value](const Parser &, const std::string &Text) {
+        // Limit the digits so the number can't overflow.
+        if (Text.empty() || Text.size() > 9 ||
+            Text.find_first_not_of("0123456789") != std::string::npos)
+          throw InvalidChoice("--" + Name, Text);
+        Value = std::stoul(Text);
+      },
+      nullptr);
+}
+
+} // end anonymous namespace.
+
+int main(int argc, char *argv[]) {
+  static const std::string Usage("DivaGenDwarf [options] output_file");
+
+  GeneratorOptions Options;
+  bool HelpPrinted = false;
+
+  // clang-format off
+  Parser ArgParser({
+    ArgumentGroup("General options", {
+      Argument::helpArg('h', "help", "Display help information", GeneralHelp,
+                        Usage, {GeneralHelp}, HelpPrinted, std::cout),
+    }),
+    ArgumentGroup("Shape options", {
+      countArg("units", "Number of compile units", Options.CompileUnits),
+      countArg("depth", "Levels of namespaces in each compile unit",
+               Options.Depth),
+      countArg("fan-out",
+               "Namespaces in each namespace, and functions in the innermost "
+               "ones", Options.FanOut),
+      countArg("templates",
+               "Template-like classes defined identically in every compile "
+               "unit", Options.Templates),
+      countArg("lines", "Line table rows of each function",
+               Options.LinesPerFunction),
+      countArg("string-size", "Minimum length of the generated names",
+               Options.StringSize),
+    }),
+  });
+  // clang-format on
+
+  std::vector<std::string> Positional;
+  try {
+    Positional =
+        ArgParser.parseCommandLineArgs(std::vector<std::string>(argv + 1,
+                                                                argv + argc));
+  } catch (ArgumentException &Err) {
+    std::cerr << Err.what() << "\n";
+    return 1;
+  }
+  if (HelpPrinted)
+    return 0;
+  if (Positional.size() != 1) {
+    ArgParser.outputHelp(Usage, GeneralHelp, std::cerr);
+    return 1;
+  }
+
+  DwarfGenerator Generator(Options);
+  std::string Error;
+  if (!Generator.generate(Positional[0], Error)) {
+    std::cerr << "Error: " << Error << "\n";
+    return 1;
+  }
+  std::cout << "Wrote " << Options.CompileUnits << " compile units, "
+            << Generator.getOutputSize() << " bytes, to " << Positional[0]
+            << "\n";
+  return 0;
+}
@@ -33,9 +33,13 @@
 #include "FileUtilities.h"
 #include "LibDwarfHelpers.h"
 #include "Line.h"
+#include "StringPool.h"
 #include "Symbol.h"
 #include "Type.h"
+#include "Utilities.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -44,10 +48,11 @@ using namespace ElfDwarfReader;
 
 namespace {
 
-// Create a mapping from DWARF file IDs to the file paths.
-std::vector<std::string> getSourceFileMapping(const DwarfDebugData &DebugData,
-                                              const DwarfDie &CUDie) {
-  std::vector<std::string> Mapping;
+// Create a mapping from DWARF file IDs to the StringPool indexes of the
+// unified file paths, so each path is unified and interned once per unit.
+std::vector<size_t> getSourceFileMapping(const DwarfDebugData &DebugData,
+                                         const DwarfDie &CUDie) {
+  std::vector<size_t> Mapping;
   char **SourceFiles = nullptr;
   Dwarf_Signed SourceFilesCount;
 
@@ -56,10 +61,11 @@ std::vector<std::string> getSourceFileMapping(const DwarfDebugData &DebugData,
     return Mapping;
 
   // A file ID of 0 always means no file, so set [0] to empty string.
-  Mapping.emplace_back("");
+  Mapping.push_back(0U);
 
   for (Dwarf_Signed i = 0; i < SourceFilesCount; ++i) {
-    Mapping.emplace_back(SourceFiles[i]);
+    Mapping.push_back(LibScopeView::StringPool::getStringIndex(
+        LibScopeView::unifyFilePath(SourceFiles[i])));
     dwarf_dealloc(*DebugData, SourceFiles[i], DW_DLA_STRING);
   }
   dwarf_dealloc(*DebugData, SourceFiles, DW_DLA_LIST);
@@ -69,7 +75,7 @@ std::vector<std::string> getSourceFileMapping(const DwarfDebugData &DebugData,
 
 // Set the source file of an Object from a DWARF file ID.
 static void setSourceFile(LibScopeView::Object &Obj,
-                          const std::vector<std::string> &Mapping,
+                          const std::vector<size_t> &Mapping,
                           Dwarf_Unsigned ID) {
   if (ID == 0)
     return;
@@ -78,7 +84,7 @@ static void setSourceFile(LibScopeView::Object &Obj,
   // problem unless there are 2^32 file names in the ELF.
   assert(ID < std::numeric_limits<size_t>::max());
   if (ID < Mapping.size()) {
-    Obj.setFileName(Mapping[static_cast<size_t>(ID)].c_str());
+    Obj.setFileNameIndex(Mapping[static_cast<size_t>(ID)]);
   } else {
     Obj.setFileNameIndex(static_cast<size_t>(ID));
     Obj.setInvalidFileName();
@@ -99,6 +105,13 @@ void addObjectReference(LibScopeView::Object *Obj,
   }
 }
 
+// Return true if Dies with Tag are types that can be shared between compile
+// units with --dedup-types.
+bool isCanonicalTypeTag(Dwarf_Half Tag) {
+  return Tag == DW_TAG_class_type || Tag == DW_TAG_structure_type ||
+         Tag == DW_TAG_union_type || Tag == DW_TAG_enumeration_type;
+}
+
 // Write the Str to Out, unless it is empty then write Val as hex.
 //
 // Used when printing DWARF codes.
@@ -110,54 +123,491 @@ void writeStringOrHex(std::ostream &Out, const std::string Str,
     Out << Str;
 }
 
+// Return true if only some of the compile units are read (--cu).
+bool selectsCompileUnits(const LibScopeView::PrintSettings &Settings) {
+  return !Settings.CompileUnitFilters.empty() ||
+         !Settings.CompileUnitFilterAnys.empty();
+}
+
+// Get the compile units whose name or compilation directory matches a --cu
+// pattern, or all of them if there are none.
+std::vector<DwarfCompileUnit>
+getSelectedCompileUnits(const DwarfDebugData &DebugData,
+                        const LibScopeView::PrintSettings &Settings) {
+  if (!selectsCompileUnits(Settings))
+    return DebugData.getCompileUnits();
+  return DebugData.getCompileUnits(
+      [&Settings](const std::string &Name, const std::string &CompDir) {
+        return Settings.matchesCompileUnitPattern(Name) ||
+               Settings.matchesCompileUnitPattern(CompDir);
+      });
+}
+
+// Stop reading a file whose debug data is not valid.
+void reportInvalidDwarf(const std::string &Message,
+                        const std::string &FileName) {
+#ifndef NDEBUG
+  std::cerr << Message;
+#else
+  static_cast<void>(Message);
+#endif
+  LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_INVALID_DWARF,
+                            FileName);
+}
+
+void reportInvalidDwarf(LibDwarfError &Err, const std::string &FileName) {
+  reportInvalidDwarf(Err.getErrorMessage(), FileName);
+}
+
+// Stop reading a file with a unit that the cursor couldn't finish decoding,
+// rather than carry on with the part of the unit before the bad entry.
+void checkCursor(const DwarfDieCursor &Cursor, const std::string &FileName) {
+  if (Cursor.hasFailed())
+    reportInvalidDwarf("A Die could not be decoded.\n", FileName);
+}
+
 } // end anonymous namespace
 
-bool DwarfReader::createScopes() {
+// The file read by a DwarfReader and its debug data, kept while the compile
+// units create their children lazily.
+struct DwarfReader::LazyFile {
+  // The debug data is created in place: libdwarf's error handler holds the
+  // address of its Dwarf_Debug, which a moved DwarfDebugData would leave.
+  explicit LazyFile(const std::string &FileName)
+      : FD(FileName), DebugData(FD.get()) {
+    Map.open(FileName);
+  }
+
+  LibScopeView::FileDescriptor FD;
+  LibScopeView::MappedFile Map;
+  DwarfDebugData DebugData;
+  // The compile units whose children have not been created yet.
+  std::unordered_map<const LibScopeView::Scope *, DwarfCompileUnit> Units;
+};
+
+// FNV-1a hash used to compare the structure of type Die trees.
+class DwarfReader::StructuralHasher {
+public:
+  void add(uint64_t Val) {
+    for (unsigned i = 0; i < sizeof(Val); ++i)
+      addByte(static_cast<uint8_t>(Val >> (8U * i)));
+  }
+  void add(const std::string &Str) {
+    for (char C : Str)
+      addByte(static_cast<uint8_t>(C));
+    addByte(0U);
+  }
+
+  uint64_t get() const { return Hash; }
+
+private:
+  void addByte(uint8_t Byte) { Hash = (Hash ^ Byte) * 0x100000001b3ULL; }
+
+  uint64_t Hash = 0xcbf29ce484222325ULL;
+};
+
+// The Dies of the current unit in offset order, along with their parents, so
+// the types that type members refer to can be found and named.
+struct DwarfReader::UnitDieIndex {
+  struct Entry {
+    DwarfDieHandle Handle;
+    // The index of the parent, 0 for the unit Die itself.
+    size_t Parent;
+  };
+
+  // Add the Die at the cursor and then recursively its children.
+  void add(DwarfDieCursor &Cursor, size_t Parent) {
+    size_t Index = Entries.size();
+    Entries.push_back({Cursor.getHandle(), Parent});
+    unsigned Depth = Cursor.getDepth();
+    while (Cursor.nextChild(Depth))
+      add(Cursor, Index);
+  }
+
+  // Get the entry for the Die at Offset, or nullptr if it isn't in the unit.
+  const Entry *find(Dwarf_Off Offset) const {
+    auto IT = std::lower_bound(Entries.begin(), Entries.end(), Offset,
+                               [](const Entry &E, Dwarf_Off Off) {
+                                 return E.Handle.getOffset() < Off;
+                               });
+    if (IT == Entries.end() || IT->Handle.getOffset() != Offset)
+      return nullptr;
+    return &*IT;
+  }
+
+  // Get the qualified name of the Die of an entry, or an empty string if it
+  // is anonymous or local to a function.
+  std::string getQualifiedName(const Entry &E) const {
+    std::string Name(E.Handle.getDie().getName());
+    if (Name.empty())
+      return Name;
+    for (size_t P = E.Parent; P != 0U; P = Entries[P].Parent) {
+      Dwarf_Half Tag = Entries[P].Handle.getTag();
+      if (Tag == DW_TAG_subprogram || Tag == DW_TAG_inlined_subroutine ||
+          Tag == DW_TAG_lexical_block)
+        return std::string();
+      std::string ParentName(Entries[P].Handle.getDie().getName());
+      if (!ParentName.empty())
+        Name.insert(0, ParentName + "::");
+    }
+    return Name;
+  }
+
+  std::vector<Entry> Entries;
+};
+
+DwarfReader::DwarfReader()
+    : LibScopeView::Reader(), DedupTypes(false),
+      RecordingCanonicalType(nullptr), CurrentCUBaseAddress(0U),
+      TypeUnitsCreated(false), CreatingLazyUnits(false) {}
+
+DwarfReader::~DwarfReader() {}
+
+bool DwarfReader::createScopes(const LibScopeView::PrintSettings &Settings) {
+  DedupTypes = Settings.DedupTypes;
+
   auto *Root = new LibScopeView::ScopeRoot(0U);
   Root->setIsRoot();
   Root->setName(getInputFile().c_str());
   Scopes = Root;
 
-  LibScopeView::FileDescriptor FD(getInputFile());
+  // The Dies are decoded from the mapped file where possible, the rest is
+  // read through libdwarf.
   try {
-    const DwarfDebugData DebugData(FD.get());
-    createCompileUnits(DebugData, *Root);
+    TheLazyFile.reset(new LazyFile(getInputFile()));
+    DwarfDebugData &DebugData = TheLazyFile->DebugData;
+    DebugData.setFileData(TheLazyFile->Map.data(), TheLazyFile->Map.size(),
+                          Settings.NativeDwarf);
+    createTypeUnits(DebugData, *Root);
+    createCompileUnits(DebugData, *Root, Settings);
   } catch (LibDwarfError &Err) {
-#ifndef NDEBUG
-    std::cerr << Err.getErrorMessage();
-#else
-    static_cast<void>(Err);
-#endif
-    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_INVALID_DWARF,
-                              getInputFile());
+    reportInvalidDwarf(Err, getInputFile());
   }
 
+  // The file is only kept for the compile units to be created lazily.
+  if (TheLazyFile->Units.empty())
+    TheLazyFile.reset();
+
   if (Root->getChildren().empty())
-    LibScopeError::warning("No DWARF debug data found.");
+    LibScopeError::warning(selectsCompileUnits(Settings)
+                               ? "No compile units match the --cu patterns."
+                               : "No DWARF debug data found.");
 
   return true;
 }
 
-void DwarfReader::createCompileUnits(const DwarfDebugData &DebugData,
-                                     LibScopeView::ScopeRoot &Root) {
-  for (const auto &CU : DebugData.getCompileUnits()) {
+void DwarfReader::createTypeUnits(const DwarfDebugData &DebugData,
+                                  LibScopeView::ScopeRoot &Root) {
+  for (const auto &TU : DebugData.getTypeUnits()) {
+    // Type units can be duplicated across object files, only keep the first.
+    if (TypeUnitTypes.count(TU.Signature))
+      continue;
+
+    CurrentCURange = std::make_pair(TU.HeaderOffset, TU.NextHeaderOffset);
+    SourceFileMapping = getSourceFileMapping(DebugData, TU.TUDie);
+    indexUnitDies(DebugData, TU.TUDie, TU);
+
+    // Recursively create the tree of Objects from the TU and down.
+    DwarfDieCursor Cursor(DebugData, TU.TUDie, TU);
+    createObject(Cursor, Root, 0U);
+    checkCursor(Cursor, getInputFile());
+
+    auto UnitIT = CreatedObjects.find(TU.TUDie.getGlobalOffset());
+    if (UnitIT == CreatedObjects.end())
+      continue;
+
+    // Type units have no name, so name them after their signature.
+    std::stringstream UnitName;
+    UnitName << "type_unit_0x" << std::setw(16) << std::setfill('0')
+             << std::hex << TU.Signature;
+    UnitIT->second->setName(UnitName.str().c_str());
+
+    auto TypeIT = CreatedObjects.find(TU.TypeOffset);
+    if (TypeIT == CreatedObjects.end())
+      continue;
+    LibScopeView::Object *TypeObj = TypeIT->second;
+    TypeUnitTypes[TU.Signature] = TypeObj;
+
+    // Type units can reference each other, so set any waiting on this one.
+    auto FoundRange = TypesToBeSetBySignature.equal_range(TU.Signature);
+    for (auto IT = FoundRange.first; IT != FoundRange.second; ++IT) {
+      IT->second->setType(TypeObj);
+      TypeObj->setIsGlobalReference();
+    }
+    TypesToBeSetBySignature.erase(FoundRange.first, FoundRange.second);
+  }
+
+  // Offsets in .debug_types overlap with those in .debug_info, and compile
+  // units can only refer to type units by signature, so forget the offsets.
+  CreatedObjects.clear();
+  TypesToBeSet.clear();
+  ReferencesToBeSet.clear();
+  TypeUnitsCreated = true;
+
+  // Any type signatures still waiting have no matching type unit.
+  for (const auto &Pending : TypesToBeSetBySignature)
+    setTypeFromSignature(*Pending.second, Pending.first);
+  TypesToBeSetBySignature.clear();
+}
+
+void DwarfReader::createCompileUnits(
+    const DwarfDebugData &DebugData, LibScopeView::ScopeRoot &Root,
+    const LibScopeView::PrintSettings &Settings) {
+  // The code of each compile unit listed in .debug_aranges, used for the
+  // compile units that don't give their own.
+  std::unordered_multimap<Dwarf_Off, DwarfAddressRange> Aranges;
+  for (const DwarfArange &Arange : DebugData.getAranges())
+    Aranges.emplace(Arange.CUDieOffset, Arange.Range);
+
+  std::vector<DwarfCompileUnit> Units(
+      getSelectedCompileUnits(DebugData, Settings));
+  CreatingLazyUnits = getReadsLazily() && canCreateLazily(DebugData, Units);
+
+  for (auto &CU : Units) {
     CurrentCURange = std::make_pair(CU.HeaderOffset, CU.NextHeaderOffset);
     SourceFileMapping = getSourceFileMapping(DebugData, CU.CUDie);
+    indexUnitDies(DebugData, CU.CUDie, CU);
+    CurrentCUBaseAddress = 0U;
+    CU.CUDie.getLowPC(CurrentCUBaseAddress);
 
     // Recursively create the tree of Objects from the CU and down.
-    createObject(DebugData, CU.CUDie, Root, 0U);
+    DwarfDieCursor Cursor(DebugData, CU.CUDie, CU);
+    createObject(Cursor, Root, 0U);
+    checkCursor(Cursor, getInputFile());
+
+    auto CUIT = CreatedObjects.find(CU.CUDie.getGlobalOffset());
+    if (CUIT == CreatedObjects.end())
+      continue;
+    auto *CUObj = static_cast<LibScopeView::Scope *>(CUIT->second);
+    if (CUObj->getAddressRanges().empty()) {
+      auto FoundRange = Aranges.equal_range(CUIT->first);
+      for (auto IT = FoundRange.first; IT != FoundRange.second; ++IT)
+        CUObj->addAddressRange(IT->second.Low, IT->second.High);
+    }
+
+    // Only the unit Die of a lazy compile unit has been read, so count its
+    // children and keep the unit for createLazyChildren.
+    if (CreatingLazyUnits) {
+      uint32_t ChildCount = 0U;
+      const unsigned Depth = Cursor.getDepth();
+      while (Cursor.nextChild(Depth))
+        ++ChildCount;
+      checkCursor(Cursor, getInputFile());
+      addLazyUnit(CUObj, ChildCount);
+      TheLazyFile->Units.emplace(CUObj, std::move(CU));
+      continue;
+    }
+
+    // The compile unit is complete, so its children can be stored compactly.
+    CUObj->compactChildren();
   }
+  CreatingLazyUnits = false;
 
-  // If we didn't skip any Dies (because of unknown tags) then we should have
-  // resolved all the types and references.
-  assert(!(!TypesToBeSet.empty() && UnknownDWTags.empty()) &&
+  // If we didn't skip any Dies (because of unknown tags or compile units that
+  // were not selected) then we should have resolved all the types and
+  // references.
+  assert(!(!TypesToBeSet.empty() && UnknownDWTags.empty() &&
+           !selectsCompileUnits(Settings)) &&
          "Some objects had a type that was not created");
-  assert(!(!ReferencesToBeSet.empty() && UnknownDWTags.empty()) &&
+  assert(!(!ReferencesToBeSet.empty() && UnknownDWTags.empty() &&
+           !selectsCompileUnits(Settings)) &&
          "Some objects had a reference that was not created");
 }
 
-void DwarfReader::createObject(const DwarfDebugData &DebugData,
-                               const DwarfDie &Die,
+bool DwarfReader::canCreateLazily(const DwarfDebugData &DebugData,
+                                  const std::vector<DwarfCompileUnit> &Units) {
+  // The objects of a unit can only be resolved on their own if they don't
+  // refer to the objects of other units, which DW_FORM_ref_addr does (and
+  // DW_FORM_indirect may hide).
+  for (const DwarfCompileUnit &CU : Units) {
+    const DwarfAbbrevTable *Abbrevs = DebugData.getAbbrevTable(CU);
+    if (!Abbrevs || Abbrevs->usesForm(DW_FORM_ref_addr) ||
+        Abbrevs->usesForm(DW_FORM_indirect))
+      return false;
+  }
+  return true;
+}
+
+void DwarfReader::createLazyChildren(LibScopeView::Scope &Unit) {
+  auto UnitIT = TheLazyFile->Units.find(&Unit);
+  assert(UnitIT != TheLazyFile->Units.end() && "Not a lazy compile unit");
+  const DwarfDebugData &DebugData = TheLazyFile->DebugData;
+  const DwarfCompileUnit &CU = UnitIT->second;
+
+  CurrentCURange = std::make_pair(CU.HeaderOffset, CU.NextHeaderOffset);
+  SourceFileMapping = getSourceFileMapping(DebugData, CU.CUDie);
+  indexUnitDies(DebugData, CU.CUDie, CU);
+  CurrentCUBaseAddress = 0U;
+  CU.CUDie.getLowPC(CurrentCUBaseAddress);
+  try {
+    // The lines that createObject creates for the unit Die of a compile unit
+    // that isn't lazy.
+    auto *CUObj = dynamic_cast<LibScopeView::ScopeCompileUnit *>(&Unit);
+    if (CUObj && CU.CUDie.getTag() == DW_TAG_compile_unit)
+      createLines(CU.CUDie, *CUObj);
+
+    DwarfDieCursor Cursor(DebugData, CU.CUDie, CU);
+    const unsigned Depth = Cursor.getDepth();
+    while (Cursor.nextChild(Depth))
+      createObject(Cursor, Unit, Unit.getLevel() + 1);
+    checkCursor(Cursor, getInputFile());
+  } catch (LibDwarfError &Err) {
+    reportInvalidDwarf(Err, getInputFile());
+  }
+
+  // No other unit refers to the objects of this one.
+  CreatedObjects.clear();
+  TypesToBeSet.clear();
+  ReferencesToBeSet.clear();
+
+  TheLazyFile->Units.erase(UnitIT);
+  if (TheLazyFile->Units.empty())
+    TheLazyFile.reset();
+}
+
+bool DwarfReader::countObjects(const LibScopeView::PrintSettings &Settings) {
+  auto *Root = new LibScopeView::ScopeRoot(0U);
+  Root->setIsRoot();
+  Root->setName(getInputFile().c_str());
+  Scopes = Root;
+
+  // Only the tags of the Dies and the number of line rows are needed, which
+  // don't need the relocations of an object file, so no values are decoded.
+  LibScopeView::FileDescriptor FD(getInputFile());
+  LibScopeView::MappedFile File;
+  File.open(getInputFile());
+  bool FoundUnits = false;
+  try {
+    DwarfDebugData DebugData(FD.get());
+    DebugData.setFileData(File.data(), File.size());
+
+    // A unit to count, along with its line table if it has one.
+    struct UnitCount {
+      UnitCount(const DwarfDebugData &DbgData, const DwarfDie &UnitDie,
+                const DwarfUnitHeader &Header)
+          : Cursor(new DwarfDieCursor(DbgData, UnitDie, Header)),
+            LineDie(nullptr), LineOffset(0U), LinesDecoded(false),
+            LineRows(0U) {}
+      std::unique_ptr<DwarfDieCursor> Cursor;
+      TagCounts Counts;
+      const DwarfDie *LineDie;
+      Dwarf_Off LineOffset;
+      bool LinesDecoded;
+      size_t LineRows;
+    };
+
+    // The units are the ones createScopes creates, with each type unit
+    // signature only once.
+    std::vector<DwarfTypeUnit> TypeUnits(DebugData.getTypeUnits());
+    std::vector<DwarfCompileUnit> CompileUnits(
+        getSelectedCompileUnits(DebugData, Settings));
+    std::vector<UnitCount> Units;
+    std::unordered_set<Dwarf_Unsigned> Signatures;
+    for (const auto &TU : TypeUnits)
+      if (Signatures.insert(TU.Signature).second)
+        Units.emplace_back(DebugData, TU.TUDie, TU);
+    for (const auto &CU : CompileUnits) {
+      Units.emplace_back(DebugData, CU.CUDie, CU);
+      // Type units have a file table but no line rows.
+      if (CU.CUDie.getTag() != DW_TAG_compile_unit)
+        continue;
+      // DWARF 2 and 3 give the offset with a data form.
+      DwarfAttrValue StmtList = CU.CUDie.getAttr(DW_AT_stmt_list);
+      Units.back().LineDie = &CU.CUDie;
+      if (StmtList.getKind() == DwarfAttrValueKind::Reference)
+        Units.back().LineOffset = StmtList.getReference();
+      else if (StmtList.getKind() == DwarfAttrValueKind::Unsigned)
+        Units.back().LineOffset = StmtList.getUnsigned();
+      else
+        Units.back().LineDie = nullptr;
+    }
+    for (const UnitCount &Unit : Units)
+      FoundUnits = FoundUnits || getTagKind(Unit.Cursor->getTag()).IsKnown;
+
+    // Each unit is counted on its own, and in parallel unless a cursor has to
+    // fall back to libdwarf, which can only be used from one thread.
+    auto CountUnit = [&](size_t Index) {
+      UnitCount &Unit = Units[Index];
+      countObject(*Unit.Cursor, Unit.Counts);
+      if (Unit.LineDie) {
+        std::vector<DwarfLineRow> Rows;
+        Unit.LinesDecoded = DwarfLineTable::decodeRows(
+            DebugData.getLineSection(), Unit.LineOffset, Rows);
+        Unit.LineRows = Rows.size();
+      }
+    };
+    if (std::all_of(Units.begin(), Units.end(), [](const UnitCount &Unit) {
+          return Unit.Cursor->isDecoding();
+        })) {
+      LibScopeView::parallelFor(Units.size(), CountUnit);
+    } else {
+      for (size_t Index = 0U; Index < Units.size(); ++Index)
+        CountUnit(Index);
+    }
+
+    for (UnitCount &Unit : Units) {
+      checkCursor(*Unit.Cursor, getInputFile());
+      for (const auto &Count : Unit.Counts)
+        if (Count.second.first->IsKnown)
+          addFound(Count.second.first->Kind, Count.second.second);
+
+      // The line tables the decoder doesn't support are read by libdwarf.
+      if (Unit.LineDie && !Unit.LinesDecoded) {
+        std::vector<DwarfLineRow> Rows;
+        Unit.LineDie->getLineRows(Rows);
+        Unit.LineRows = Rows.size();
+      }
+      addFound(LibScopeView::ObjectKind::CodeLine,
+               static_cast<uint32_t>(Unit.LineRows));
+    }
+  } catch (LibDwarfError &Err) {
+    reportInvalidDwarf(Err, getInputFile());
+  }
+
+  if (!FoundUnits)
+    LibScopeError::warning(selectsCompileUnits(Settings)
+                               ? "No compile units match the --cu patterns."
+                               : "No DWARF debug data found.");
+
+  return true;
+}
+
+void DwarfReader::countObject(DwarfDieCursor &Cursor, TagCounts &Counts) {
+  Dwarf_Half Tag = Cursor.getTag();
+  auto &Count = Counts[Tag];
+  if (!Count.first)
+    Count.first = &getTagKind(Tag);
+  if (!Count.first->IsKnown)
+    return;
+  ++Count.second;
+
+  // The children of objects other than scopes are not created.
+  if (!Count.first->IsScope)
+    return;
+  unsigned Depth = Cursor.getDepth();
+  while (Cursor.nextChild(Depth))
+    countObject(Cursor, Counts);
+}
+
+const DwarfReader::TagKind &DwarfReader::getTagKind(Dwarf_Half Tag) {
+  std::lock_guard<std::mutex> Lock(TagKindsMutex);
+  auto IT = TagKinds.find(Tag);
+  if (IT != TagKinds.end())
+    return IT->second;
+
+  // Ask an Object created for the tag, which also warns about unknown tags
+  // once as createObject does.
+  TagKind Kind = {false, false, LibScopeView::ObjectKind::Other};
+  std::unique_ptr<LibScopeView::Object> Obj(createObjectByTag(Tag, 0U));
+  if (Obj) {
+    Kind.IsKnown = true;
+    Kind.Kind = Obj->getKind();
+    Kind.IsScope = Obj->getIsScope();
+  }
+  return TagKinds.emplace(Tag, Kind).first->second;
+}
+
+void DwarfReader::createObject(DwarfDieCursor &Cursor,
                                LibScopeView::Object &ParentObj,
                                LibScopeView::LevelType Level) {
   // For now do nothing if the parent is not a scope.
@@ -165,11 +615,37 @@ void DwarfReader::createObject(const DwarfDebugData &DebugData,
     return;
   auto &ParentScope = dynamic_cast<LibScopeView::Scope &>(ParentObj);
 
-  auto ObjOffset = Die.getGlobalOffset();
+  const DwarfDie Die(Cursor.getDie());
+  auto ObjOffset = Cursor.getOffset();
   auto ObjTag = Die.getTag();
 
+  // With --dedup-types, share types already created by an earlier CU.
+  bool IsCanonicalType = false;
+  if (DedupTypes && !RecordingCanonicalType && isCanonicalTypeTag(ObjTag)) {
+    std::string Name;
+    uint64_t Hash;
+    if (getCanonicalTypeKey(Die, ParentScope, Name, Hash)) {
+      auto &Candidates = CanonicalTypes[Name];
+      for (const auto &Candidate : Candidates) {
+        if (Candidate.Hash == Hash) {
+          size_t Index = 0U;
+          shareCanonicalType(Cursor, Candidate.Objects, Index);
+          return;
+        }
+      }
+
+      // This is the first copy of the type, so record the Objects created for
+      // it to be shared later.
+      Candidates.emplace_back(Hash);
+      RecordingCanonicalType = &Candidates.back().Objects;
+      IsCanonicalType = true;
+    }
+  }
+
   // Create the object from the DWARF tag.
   LibScopeView::Object *Obj = createObjectByTag(ObjTag, Level);
+  if (RecordingCanonicalType)
+    RecordingCanonicalType->push_back(Obj);
   if (!Obj)
     return;
 
@@ -201,9 +677,168 @@ void DwarfReader::createObject(const DwarfDebugData &DebugData,
   // Update any references to this object.
   updateReferencesToObject(*Obj, ObjOffset);
 
+  // The children of a lazy compile unit are created by createLazyChildren.
+  if (CreatingLazyUnits)
+    return;
+
   // Recurse on the DIE children.
-  for (auto IT = Die.childrenBegin(), End = Die.childrenEnd(); IT != End; ++IT)
-    createObject(DebugData, *IT, *Obj, Level + 1);
+  unsigned Depth = Cursor.getDepth();
+  while (Cursor.nextChild(Depth))
+    createObject(Cursor, *Obj, Level + 1);
+
+  if (IsCanonicalType)
+    RecordingCanonicalType = nullptr;
+}
+
+bool DwarfReader::getCanonicalTypeKey(const DwarfDie &Die,
+                                      const LibScopeView::Scope &ParentScope,
+                                      std::string &Name, uint64_t &Hash) {
+  // Anonymous types can't be matched between compile units.
+  Name = Die.getName();
+  if (Name.empty())
+    return false;
+
+  // Build the qualified name, giving up on types local to a function.
+  const LibScopeView::Scope *Parent = &ParentScope;
+  while (Parent && !Parent->getIsCompileUnit() && !Parent->getIsRoot()) {
+    if (Parent->getIsFunction())
+      return false;
+    if (strlen(Parent->getName()) != 0) {
+      Name.insert(0, "::");
+      Name.insert(0, Parent->getName());
+    }
+    Parent = Parent->getParent();
+  }
+
+  StructuralHasher Hasher;
+  std::vector<Dwarf_Off> Referencing;
+  hashTypeStructure(Die, Hasher, Referencing);
+  Hash = Hasher.get();
+  return true;
+}
+
+void DwarfReader::hashTypeStructure(const DwarfDie &Die,
+                                    StructuralHasher &Hasher,
+                                    std::vector<Dwarf_Off> &Referencing) {
+  static const Dwarf_Half HashedAttrs[] = {
+      DW_AT_decl_file,     DW_AT_decl_line,
+      DW_AT_byte_size,     DW_AT_bit_size,
+      DW_AT_accessibility, DW_AT_data_member_location,
+      DW_AT_const_value,   DW_AT_declaration,
+      DW_AT_external,      DW_AT_virtuality,
+      DW_AT_lower_bound,   DW_AT_upper_bound,
+      DW_AT_count};
+
+  Hasher.add(Die.getTag());
+  Hasher.add(Die.getName());
+
+  for (Dwarf_Half Attr : HashedAttrs) {
+    DwarfAttrValue Val(Die.getAttr(Attr));
+    Hasher.add(static_cast<uint64_t>(Val.getKind()));
+    if (Val.getKind() == DwarfAttrValueKind::Unsigned) {
+      // File IDs differ between CUs, so hash the file path's index instead.
+      if (Attr == DW_AT_decl_file &&
+          Val.getUnsigned() < SourceFileMapping.size())
+        Hasher.add(static_cast<uint64_t>(
+            SourceFileMapping[static_cast<size_t>(Val.getUnsigned())]));
+      else
+        Hasher.add(Val.getUnsigned());
+    } else if (Val.getKind() == DwarfAttrValueKind::Signed)
+      Hasher.add(static_cast<uint64_t>(Val.getSigned()));
+    else if (Val.getKind() == DwarfAttrValueKind::Boolean)
+      Hasher.add(static_cast<uint64_t>(Val.getBool()));
+  }
+
+  hashTypeReference(Die, Hasher, Referencing);
+
+  uint64_t ChildCount = 0U;
+  for (auto IT = Die.childrenBegin(), End = Die.childrenEnd(); IT != End;
+       ++IT) {
+    hashTypeStructure(*IT, Hasher, Referencing);
+    ++ChildCount;
+  }
+  Hasher.add(ChildCount);
+}
+
+void DwarfReader::hashTypeReference(const DwarfDie &Die,
+                                    StructuralHasher &Hasher,
+                                    std::vector<Dwarf_Off> &Referencing) {
+  DwarfAttrValue Type(Die.getAttr(DW_AT_type));
+  Hasher.add(static_cast<uint64_t>(Type.getKind()));
+  if (Type.getKind() == DwarfAttrValueKind::Signature) {
+    Hasher.add(Type.getSignature());
+    return;
+  }
+  if (Type.getKind() != DwarfAttrValueKind::Reference)
+    return;
+
+  // A type that refers back to one being hashed, through pointers say, hashes
+  // how far back it is.
+  Dwarf_Off TypeOffset = Type.getReference();
+  auto Back = std::find(Referencing.begin(), Referencing.end(), TypeOffset);
+  if (Back != Referencing.end()) {
+    Hasher.add(static_cast<uint64_t>(Referencing.end() - Back));
+    return;
+  }
+
+  // The types of other units can only match if they are the same Die.
+  const UnitDieIndex::Entry *TypeEntry =
+      TheUnitDies ? TheUnitDies->find(TypeOffset) : nullptr;
+  if (!TypeEntry) {
+    Hasher.add(TypeOffset);
+    return;
+  }
+
+  // Named types are matched on their qualified name, the same as the types
+  // being shared, and anonymous ones on their structure.
+  DwarfDie TypeDie(TypeEntry->Handle.getDie());
+  std::string TypeName(TheUnitDies->getQualifiedName(*TypeEntry));
+  if (!TypeName.empty()) {
+    Hasher.add(TypeDie.getTag());
+    Hasher.add(TypeName);
+    return;
+  }
+  Referencing.push_back(TypeOffset);
+  hashTypeStructure(TypeDie, Hasher, Referencing);
+  Referencing.pop_back();
+}
+
+void DwarfReader::indexUnitDies(const DwarfDebugData &DebugData,
+                                const DwarfDie &UnitDie,
+                                const DwarfUnitHeader &Header) {
+  TheUnitDies.reset();
+  if (!DedupTypes)
+    return;
+  TheUnitDies.reset(new UnitDieIndex);
+  DwarfDieCursor Cursor(DebugData, UnitDie, Header);
+  TheUnitDies->add(Cursor, 0U);
+  checkCursor(Cursor, getInputFile());
+}
+
+void DwarfReader::shareCanonicalType(
+    DwarfDieCursor &Cursor, const std::vector<LibScopeView::Object *> &Objects,
+    size_t &Index) {
+  // The Dies have the same structure as those the Objects were created from,
+  // so visit them in the same order as createObject.
+  if (Index >= Objects.size())
+    return;
+  LibScopeView::Object *Obj = Objects[Index++];
+  if (!Obj)
+    return;
+
+  // The type is now referenced from more than one CU.
+  if (Index == 1U)
+    Obj->setIsGlobalReference();
+
+  auto ObjOffset = Cursor.getOffset();
+  CreatedObjects[ObjOffset] = Obj;
+  updateReferencesToObject(*Obj, ObjOffset);
+
+  if (!Obj->getIsScope())
+    return;
+  unsigned Depth = Cursor.getDepth();
+  while (Cursor.nextChild(Depth))
+    shareCanonicalType(Cursor, Objects, Index);
 }
 
 LibScopeView::Object *
@@ -337,7 +972,8 @@ DwarfReader::createObjectByTag(Dwarf_Half Tag, LibScopeView::LevelType Level) {
     Obj->setIsTryBlock();
     return Obj;
   }
-  case DW_TAG_compile_unit: {
+  case DW_TAG_compile_unit:
+  case DW_TAG_type_unit: {
     auto Obj = new LibScopeView::ScopeCompileUnit(0);
     Obj->setIsCompileUnit();
     return Obj;
@@ -449,14 +1085,23 @@ void DwarfReader::initScopeFromAttrs(LibScopeView::Scope &Scp,
                                      const DwarfDie &Die) {
   Scp.resolveQualifiedName();
 
+  // The code covered by the scopes that can hold code.
+  if (Scp.getCanHaveLines())
+    for (const DwarfAddressRange &Range :
+         Die.getAddressRanges(CurrentCUBaseAddress))
+      Scp.addAddressRange(Range.Low, Range.High);
+
   // Parents of template packs are templates.
   if (Scp.getIsTemplatePack())
     if (auto ScpParent = dynamic_cast<LibScopeView::Scope *>(Scp.getParent()))
       ScpParent->setIsTemplate();
 
-  // CU lines.
-  if (auto CU = dynamic_cast<LibScopeView::ScopeCompileUnit *>(&Scp))
-    createLines(Die, *CU);
+  // CU lines. Type units have a file table but no line rows. The lines of a
+  // lazy compile unit are created with its children.
+  if (auto CU = dynamic_cast<LibScopeView::ScopeCompileUnit *>(&Scp)) {
+    if (Die.getTag() == DW_TAG_compile_unit && !CreatingLazyUnits)
+      createLines(Die, *CU);
+  }
   // Enum class.
   else if (auto ScpEnum =
                dynamic_cast<LibScopeView::ScopeEnumeration *>(&Scp)) {
@@ -573,31 +1218,31 @@ void DwarfReader::initSymbolFromAttrs(LibScopeView::Symbol &Sym,
 
 void DwarfReader::createLines(const DwarfDie &CUDie,
                               LibScopeView::ScopeCompileUnit &CUObj) {
-  auto LineTable = CUDie.getLineTable();
+  std::vector<DwarfLineRow> Rows;
+  CUDie.getLineRows(Rows);
 
-  for (size_t LineIndex = 0; LineIndex < LineTable.size(); ++LineIndex) {
-    auto DwarfLine = LineTable[LineIndex];
+  for (const DwarfLineRow &Row : Rows) {
     auto *Ln = new LibScopeView::Line(1U);
 
     Ln->setIsLineRecord();
     CUObj.addObject(Ln);
-    Ln->setLineNumber(DwarfLine.LineNo);
-    Ln->setAddress(DwarfLine.LineAddr);
-    Ln->setDieOffset(static_cast<Dwarf_Off>(DwarfLine.LineAddr));
+    Ln->setLineNumber(Row.LineNo);
+    Ln->setAddress(Row.LineAddr);
+    Ln->setDieOffset(static_cast<Dwarf_Off>(Row.LineAddr));
 
-    setSourceFile(*Ln, SourceFileMapping, DwarfLine.SrcFileID);
+    setSourceFile(*Ln, SourceFileMapping, Row.SrcFileID);
 
     // set DWARF qualifiers.
-    Ln->setDiscriminator(static_cast<Dwarf_Half>(DwarfLine.Discriminator));
-    if (DwarfLine.IsBeginStatement)
+    Ln->setDiscriminator(static_cast<Dwarf_Half>(Row.Discriminator));
+    if (Row.Flags & DwarfLineRow::IsBeginStatement)
       Ln->setIsNewStatement();
-    if (DwarfLine.IsBeginBlock)
+    if (Row.Flags & DwarfLineRow::IsBeginBlock)
       Ln->setIsNewBasicBlock();
-    if (DwarfLine.IsEndSequence)
+    if (Row.Flags & DwarfLineRow::IsEndSequence)
       Ln->setIsLineEndSequence();
-    if (DwarfLine.IsEpilogueBegin)
+    if (Row.Flags & DwarfLineRow::IsEpilogueBegin)
       Ln->setIsEpilogueBegin();
-    if (DwarfLine.IsPrologEnd)
+    if (Row.Flags & DwarfLineRow::IsPrologEnd)
       Ln->setIsPrologueEnd();
   }
 }
@@ -605,15 +1250,24 @@ void DwarfReader::createLines(const DwarfDie &CUDie,
 void DwarfReader::initObjectReferences(LibScopeView::Object &Obj,
                                        const DwarfDie &Die) {
   // Set type or add to missing list to be resolved later.
-  DwarfAttrValue TypeRef(
-      getAttrExpectingKind(Die, DW_AT_type, DwarfAttrValueKind::Reference));
+  DwarfAttrValue TypeRef(getAttrExpectingKinds(
+      Die, DW_AT_type,
+      {DwarfAttrValueKind::Reference, DwarfAttrValueKind::Signature}));
+
+  // A declaration of a type defined in a type unit refers to it with
+  // DW_AT_signature.
+  if (TypeRef.empty())
+    TypeRef = getAttrExpectingKind(Die, DW_AT_signature,
+                                   DwarfAttrValueKind::Signature);
 
   // DW_AT_import is treated as a type by LibScopeView.
   if (TypeRef.empty())
     TypeRef =
         getAttrExpectingKind(Die, DW_AT_import, DwarfAttrValueKind::Reference);
 
-  if (!TypeRef.empty()) {
+  if (TypeRef.getKind() == DwarfAttrValueKind::Signature)
+    setTypeFromSignature(Obj, TypeRef.getSignature());
+  else if (!TypeRef.empty()) {
     auto TypeOffset = TypeRef.getReference();
     auto IT = CreatedObjects.find(TypeOffset);
     if (IT != CreatedObjects.end()) {
@@ -681,6 +1335,32 @@ void DwarfReader::updateReferencesToObject(LibScopeView::Object &Obj,
   ReferencesToBeSet.erase(RefFoundRange.first, RefFoundRange.second);
 }
 
+void DwarfReader::setTypeFromSignature(LibScopeView::Object &Obj,
+                                       Dwarf_Unsigned Signature) {
+  auto IT = TypeUnitTypes.find(Signature);
+  if (IT != TypeUnitTypes.end()) {
+    Obj.setType(IT->second);
+    // Type units are shared between CUs, so their types are always global.
+    IT->second->setIsGlobalReference();
+    return;
+  }
+
+  // Type units are all created before compile units, so if we are reading a
+  // compile unit then the signature has no type unit.
+  if (TypeUnitsCreated) {
+    if (!MissingTypeSignatures.count(Signature)) {
+      MissingTypeSignatures.insert(Signature);
+      std::stringstream Msg;
+      Msg << "No type unit found for type signature '0x" << std::setw(16)
+          << std::setfill('0') << std::hex << Signature << "'.";
+      LibScopeError::warning(Msg.str());
+    }
+    return;
+  }
+
+  TypesToBeSetBySignature.emplace(Signature, &Obj);
+}
+
 DwarfAttrValue
 DwarfReader::getAttrExpectingKind(const DwarfDie &Die, const Dwarf_Half Attr,
                                   const DwarfAttrValueKind ExpectedKind) {
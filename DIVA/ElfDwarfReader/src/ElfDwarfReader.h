@@ -34,6 +34,8 @@
 
 #include "Reader.h"
 
+#include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -42,31 +44,101 @@ namespace ElfDwarfReader {
 
 class DwarfDebugData;
 class DwarfDie;
+class DwarfDieCursor;
 class DwarfAttrValue;
+struct DwarfCompileUnit;
+struct DwarfUnitHeader;
 enum class DwarfAttrValueKind;
 
 class DwarfReader : public LibScopeView::Reader {
 public:
-  DwarfReader() : LibScopeView::Reader() {}
-  ~DwarfReader() override {}
+  DwarfReader();
+  ~DwarfReader() override;
 
   DwarfReader(const DwarfReader &) = delete;
   DwarfReader &operator=(const DwarfReader &) = delete;
 
 private:
   /// Create the full scope tree.
-  bool createScopes() override;
+  bool createScopes(const LibScopeView::PrintSettings &Settings) override;
 
-  /// Create each compile unit.
+  /// Create each type unit, recording the type it defines by signature.
+  void createTypeUnits(const DwarfDebugData &DebugData,
+                       LibScopeView::ScopeRoot &Root);
+
+  /// Create each compile unit selected by the --cu patterns of Settings.
+  /// With --lazy-scopes, only the unit Dies are read, if possible.
   void createCompileUnits(const DwarfDebugData &DebugData,
-                          LibScopeView::ScopeRoot &Root);
+                          LibScopeView::ScopeRoot &Root,
+                          const LibScopeView::PrintSettings &Settings);
+
+  /// Return true if the children of Units can be created lazily: their
+  /// abbreviations show that their Dies can't refer to the Dies of another
+  /// unit (DW_FORM_ref_addr).
+  bool canCreateLazily(const DwarfDebugData &DebugData,
+                       const std::vector<DwarfCompileUnit> &Units);
+
+  /// Create the children and lines of a compile unit whose unit Die was read
+  /// by createCompileUnits.
+  void createLazyChildren(LibScopeView::Scope &Unit) override;
+
+  // The kind of Object created for a DWARF tag.
+  struct TagKind {
+    // False for the unknown tags, whose Dies are skipped with their children.
+    bool IsKnown;
+    bool IsScope;
+    LibScopeView::ObjectKind Kind;
+  };
+
+  // The kind of each tag seen in a unit and the number of its Dies.
+  typedef std::unordered_map<Dwarf_Half, std::pair<const TagKind *, uint32_t>>
+      TagCounts;
+
+  /// Count the Objects of each kind that createScopes would create, without
+  /// creating them (--summary-only).
+  bool countObjects(const LibScopeView::PrintSettings &Settings) override;
+
+  /// Count the Die at the cursor and then recursively its children, skipping
+  /// the same Dies as createObject.
+  void countObject(DwarfDieCursor &Cursor, TagCounts &Counts);
 
-  /// Create a LibScopeView::Object from a Die and then recursivly create its
-  /// children.
-  void createObject(const DwarfDebugData &DebugData, const DwarfDie &Die,
-                    LibScopeView::Object &ParentObj,
+  /// Get the kind of Object created for Tag. Can be called from any thread.
+  const TagKind &getTagKind(Dwarf_Half Tag);
+
+  /// Create a LibScopeView::Object from the Die at the cursor and then
+  /// recursivly create its children.
+  void createObject(DwarfDieCursor &Cursor, LibScopeView::Object &ParentObj,
                     LibScopeView::LevelType Level);
 
+  /// Get the key used to match a type Die against identical types in other
+  /// compile units. Returns false if the type cannot be shared (e.g. it is
+  /// anonymous or local to a function).
+  bool getCanonicalTypeKey(const DwarfDie &Die,
+                           const LibScopeView::Scope &ParentScope,
+                           std::string &Name, uint64_t &Hash);
+
+  /// Hash everything in a type Die tree that has to match for two definitions
+  /// of a type with the same qualified name to be treated as the same type.
+  /// Referencing holds the anonymous types being hashed through DW_AT_type.
+  class StructuralHasher;
+  void hashTypeStructure(const DwarfDie &Die, StructuralHasher &Hasher,
+                         std::vector<Dwarf_Off> &Referencing);
+
+  /// Hash the type a Die refers to with DW_AT_type: its qualified name if it
+  /// has one, otherwise its structure.
+  void hashTypeReference(const DwarfDie &Die, StructuralHasher &Hasher,
+                         std::vector<Dwarf_Off> &Referencing);
+
+  /// Index the Dies of the unit about to be created, if types are shared.
+  void indexUnitDies(const DwarfDebugData &DebugData, const DwarfDie &UnitDie,
+                     const DwarfUnitHeader &Header);
+
+  /// Use the Objects already created for an identical type in place of the
+  /// Die at the cursor and all its children.
+  void shareCanonicalType(DwarfDieCursor &Cursor,
+                          const std::vector<LibScopeView::Object *> &Objects,
+                          size_t &Index);
+
   /// Create the appropriate subclass of LibScopeView::Object for the given
   /// DWARF tag.
   LibScopeView::Object *createObjectByTag(Dwarf_Half Tag,
@@ -93,6 +165,11 @@ private:
   /// Set any references from other objects to this object now that it exists.
   void updateReferencesToObject(LibScopeView::Object &Obj, Dwarf_Off ObjOffset);
 
+  /// Set the type of Obj to the type defined by the type unit with Signature,
+  /// or record it to be set once that type unit has been created.
+  void setTypeFromSignature(LibScopeView::Object &Obj,
+                            Dwarf_Unsigned Signature);
+
   /// Get an attribute, but produce a warning an return an empty DwarfAttrValue
   /// if the value is not the ExpectedKind or ValueKind::Empty.
   DwarfAttrValue getAttrExpectingKind(const DwarfDie &Die,
@@ -111,11 +188,37 @@ private:
   /// Get the access specifier (Public, Private, etc.) of a Die.
   LibScopeView::AccessSpecifier getAccessSpecifier(const DwarfDie &Die);
 
+  // Share identical types between compile units (--dedup-types).
+  bool DedupTypes;
+
+  // A type that has been created and can be shared with other compile units.
+  struct CanonicalType {
+    explicit CanonicalType(uint64_t StructuralHash) : Hash(StructuralHash) {}
+    uint64_t Hash;
+    // The Object created for each Die in the type, in pre-order, with nullptr
+    // for Dies that were skipped.
+    std::vector<LibScopeView::Object *> Objects;
+  };
+
+  // Mapping from qualified type names to the types with that name.
+  std::unordered_map<std::string, std::vector<CanonicalType>> CanonicalTypes;
+
+  // The Dies of the current unit, only indexed with --dedup-types.
+  struct UnitDieIndex;
+  std::unique_ptr<UnitDieIndex> TheUnitDies;
+
+  // The Objects of the canonical type currently being created, if any.
+  std::vector<LibScopeView::Object *> *RecordingCanonicalType;
+
   // Offset range of the current CU.
   std::pair<Dwarf_Off, Dwarf_Off> CurrentCURange;
 
-  // Mapping from DWARF file IDs to the file paths in the current CU.
-  std::vector<std::string> SourceFileMapping;
+  // Base address of the DW_AT_ranges entries in the current CU.
+  Dwarf_Addr CurrentCUBaseAddress;
+
+  // Mapping from DWARF file IDs to the StringPool indexes of the unified file
+  // paths in the current CU.
+  std::vector<size_t> SourceFileMapping;
 
   // Mapping from DWARF offsets to already created Objects.
   std::unordered_map<Dwarf_Off, LibScopeView::Object *> CreatedObjects;
@@ -130,6 +233,35 @@ private:
   // reference set to the Object that will be created from that Die.
   std::unordered_multimap<Dwarf_Off, LibScopeView::Object *> ReferencesToBeSet;
 
+  // Mapping from type signatures to the Object for the type defined by that
+  // type unit. Each type unit is only created once and then shared by every
+  // Object that references its signature.
+  std::unordered_map<Dwarf_Unsigned, LibScopeView::Object *> TypeUnitTypes;
+
+  // Map of type signatures to multiple Objects, where the type unit with that
+  // signature hasn't been created yet.
+  std::unordered_multimap<Dwarf_Unsigned, LibScopeView::Object *>
+      TypesToBeSetBySignature;
+
+  // True once all the type units have been created.
+  bool TypeUnitsCreated;
+
+  // Type signatures with no matching type unit (avoids duplicate warnings).
+  std::set<Dwarf_Unsigned> MissingTypeSignatures;
+
+  // The file and its debug data, kept while the compile units create their
+  // children lazily, along with those units.
+  struct LazyFile;
+  std::unique_ptr<LazyFile> TheLazyFile;
+
+  // True while reading the unit Dies of the compile units whose children are
+  // created lazily.
+  bool CreatingLazyUnits;
+
+  // The kind of each DWARF tag counted by countObjects.
+  std::unordered_map<Dwarf_Half, TagKind> TagKinds;
+  std::mutex TagKindsMutex;
+
   // Unknown DWARF tags that have already been seen (avoids duplicate warnings).
   std::set<Dwarf_Half> UnknownDWTags;
   // Unrecognised Attr-Form combinations that have already been seen.
@@ -0,0 +1,184 @@
+//===-- ElfDwarfReader/Leb128.h ---------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Functions for reading the LEB128 numbers of DWARF sections.
+///
+/// Abbreviation codes, attribute and form numbers, and most line program
+/// operands fit in one or two bytes, so those are read without a loop. Longer
+/// numbers are skipped eight bytes at a time, by finding the bytes without the
+/// continuation bit in a 64-bit word.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LEB128_H
+#define LEB128_H
+
+#include "libdwarf.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ElfDwarfReader {
+
+namespace Leb128Detail {
+
+// The high bit of each byte of a word.
+const uint64_t HighBits = 0x8080808080808080ULL;
+// The low bit of each byte of a word.
+const uint64_t LowBits = 0x0101010101010101ULL;
+
+// Read 8 bytes as a little endian word.
+inline uint64_t readWord(const uint8_t *Data) {
+  uint64_t Word = 0U;
+  for (unsigned I = 0; I < 8U; ++I)
+    Word |= static_cast<uint64_t>(Data[I]) << (8U * I);
+  return Word;
+}
+
+// Get the number of bytes up to and including the one holding the lowest set
+// bit of Stops, where Stops only has the high bits of bytes set.
+inline unsigned bytesThroughFirstStop(uint64_t Stops) {
+  uint64_t Below = (Stops & (~Stops + 1U)) - 1U;
+  return static_cast<unsigned>(((Below & LowBits) * LowBits) >> 56U);
+}
+
+// Get the number of bytes that have their high bit set in Stops.
+inline unsigned countStops(uint64_t Stops) {
+  return static_cast<unsigned>(((Stops >> 7U) * LowBits) >> 56U);
+}
+
+} // end namespace Leb128Detail
+
+/// \brief Read an unsigned LEB128 number, moving Data past it. Returns false
+/// if it doesn't end before End.
+inline bool readULEB128(const uint8_t *&Data, const uint8_t *End,
+                        uint64_t &Value) {
+  if (Data != End && *Data < 0x80U) {
+    Value = *Data++;
+    return true;
+  }
+  if (End - Data >= 2 && Data[1] < 0x80U) {
+    Value = (Data[0] & 0x7fU) | (static_cast<uint64_t>(Data[1]) << 7U);
+    Data += 2;
+    return true;
+  }
+
+  Value = 0U;
+  for (unsigned Shift = 0; Data != End; Shift += 7) {
+    uint8_t Byte = *Data++;
+    if (Shift < 64)
+      Value |= static_cast<uint64_t>(Byte & 0x7f) << Shift;
+    if ((Byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+/// \brief Read a signed LEB128 number, moving Data past it. Returns false if
+/// it doesn't end before End.
+inline bool readSLEB128(const uint8_t *&Data, const uint8_t *End,
+                        Dwarf_Signed &Value) {
+  if (Data != End && *Data < 0x80U) {
+    // Bit 6 is the sign bit.
+    Dwarf_Signed Byte0 = *Data++;
+    Value = Byte0 - ((Byte0 & 0x40) << 1);
+    return true;
+  }
+  if (End - Data >= 2 && Data[1] < 0x80U) {
+    // Bit 13 is the sign bit.
+    Dwarf_Signed Byte0 = Data[0];
+    Dwarf_Signed Byte1 = Data[1];
+    Value = ((Byte0 & 0x7f) | (Byte1 << 7)) - ((Byte1 & 0x40) << 8);
+    Data += 2;
+    return true;
+  }
+
+  uint64_t Result = 0U;
+  for (unsigned Shift = 0; Data != End;) {
+    uint8_t Byte = *Data++;
+    if (Shift < 64)
+      Result |= static_cast<uint64_t>(Byte & 0x7f) << Shift;
+    Shift += 7;
+    if ((Byte & 0x80) == 0) {
+      // Extend the sign bit.
+      if (Shift < 64 && (Byte & 0x40) != 0)
+        Result |= ~static_cast<uint64_t>(0) << Shift;
+      Value = static_cast<Dwarf_Signed>(Result);
+      return true;
+    }
+  }
+  return false;
+}
+
+/// \brief Move Data past a LEB128 number. Returns false if it doesn't end
+/// before End.
+inline bool skipLEB128(const uint8_t *&Data, const uint8_t *End) {
+  if (Data != End && *Data < 0x80U) {
+    ++Data;
+    return true;
+  }
+  if (End - Data >= 8) {
+    uint64_t Stops = ~Leb128Detail::readWord(Data) & Leb128Detail::HighBits;
+    if (Stops != 0U) {
+      Data += Leb128Detail::bytesThroughFirstStop(Stops);
+      return true;
+    }
+  }
+  while (Data != End)
+    if ((*Data++ & 0x80) == 0)
+      return true;
+  return false;
+}
+
+/// \brief Move Data past Count LEB128 numbers. Returns false if they don't
+/// all end before End.
+///
+/// The numbers ending in each 8 bytes are counted together, so a run of
+/// short numbers takes a few steps rather than one per byte.
+inline bool skipLEB128s(const uint8_t *&Data, const uint8_t *End,
+                        size_t Count) {
+  while (Count != 0U && End - Data >= 8) {
+    uint64_t Stops = ~Leb128Detail::readWord(Data) & Leb128Detail::HighBits;
+    unsigned Ending = Leb128Detail::countStops(Stops);
+    if (Ending < Count) {
+      Data += 8;
+      Count -= Ending;
+      continue;
+    }
+    // The last number ends in this word, at the Count-th stop.
+    for (; Count > 1U; --Count)
+      Stops &= Stops - 1U;
+    Data += Leb128Detail::bytesThroughFirstStop(Stops);
+    return true;
+  }
+  for (; Count != 0U; --Count)
+    if (!skipLEB128(Data, End))
+      return false;
+  return true;
+}
+
+} // end namespace ElfDwarfReader
+
+#endif // LEB128_H
@@ -29,8 +29,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "LibDwarfHelpers.h"
+#include "Leb128.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
 
 using namespace ElfDwarfReader;
 
@@ -38,6 +42,434 @@ namespace {
 
 const bool IsInfo = true;
 
+// Opening and closing a file go through the global state of libelf, so they
+// are done by one thread at a time.
+std::mutex InitMutex;
+
+// Read an 8 byte type signature as a little endian number, which matches how
+// other DWARF tools display signatures.
+Dwarf_Unsigned getSignatureValue(const Dwarf_Sig8 &Sig) {
+  Dwarf_Unsigned Result = 0U;
+  for (unsigned i = 0; i < sizeof(Sig.signature); ++i)
+    Result |= static_cast<Dwarf_Unsigned>(
+                  static_cast<unsigned char>(Sig.signature[i]))
+              << (8U * i);
+  return Result;
+}
+
+// DWARF 5 forms missing from the libdwarf headers.
+const Dwarf_Half DW_FORM_ref_sup8 = 0x24;
+const Dwarf_Half DW_FORM_strx1 = 0x25;
+const Dwarf_Half DW_FORM_strx2 = 0x26;
+const Dwarf_Half DW_FORM_strx3 = 0x27;
+const Dwarf_Half DW_FORM_strx4 = 0x28;
+const Dwarf_Half DW_FORM_addrx1 = 0x29;
+const Dwarf_Half DW_FORM_addrx2 = 0x2a;
+const Dwarf_Half DW_FORM_addrx3 = 0x2b;
+const Dwarf_Half DW_FORM_addrx4 = 0x2c;
+
+// Read a little endian number of Size bytes.
+uint64_t readFixed(const uint8_t *Data, unsigned Size) {
+  uint64_t Result = 0U;
+  for (unsigned i = 0; i < Size; ++i)
+    Result |= static_cast<uint64_t>(Data[i]) << (8U * i);
+  return Result;
+}
+
+// The size of the values of forms that have no length of their own.
+const int VariableSize = -1;
+const int UnknownForm = -2;
+
+// Get the size of a value of Form in a unit with Header, VariableSize if
+// the value gives its own length or UnknownForm.
+int getFormSize(Dwarf_Half Form, const DwarfUnitHeader &Header) {
+  switch (Form) {
+  case DW_FORM_flag_present:
+  case DW_FORM_implicit_const:
+    return 0;
+  case DW_FORM_data1:
+  case DW_FORM_ref1:
+  case DW_FORM_flag:
+  case DW_FORM_strx1:
+  case DW_FORM_addrx1:
+    return 1;
+  case DW_FORM_data2:
+  case DW_FORM_ref2:
+  case DW_FORM_strx2:
+  case DW_FORM_addrx2:
+    return 2;
+  case DW_FORM_strx3:
+  case DW_FORM_addrx3:
+    return 3;
+  case DW_FORM_data4:
+  case DW_FORM_ref4:
+  case DW_FORM_ref_sup:
+  case DW_FORM_strx4:
+  case DW_FORM_addrx4:
+    return 4;
+  case DW_FORM_data8:
+  case DW_FORM_ref8:
+  case DW_FORM_ref_sig8:
+  case DW_FORM_ref_sup8:
+    return 8;
+  case DW_FORM_data16:
+    return 16;
+  case DW_FORM_addr:
+    return Header.AddressSize;
+  case DW_FORM_ref_addr:
+    // DWARF 2 used the address size for DW_FORM_ref_addr.
+    return Header.Version <= 2 ? Header.AddressSize : Header.OffsetSize;
+  case DW_FORM_strp:
+  case DW_FORM_sec_offset:
+  case DW_FORM_line_strp:
+  case DW_FORM_strp_sup:
+  case DW_FORM_GNU_ref_alt:
+  case DW_FORM_GNU_strp_alt:
+    return Header.OffsetSize;
+  case DW_FORM_sdata:
+  case DW_FORM_udata:
+  case DW_FORM_ref_udata:
+  case DW_FORM_strx:
+  case DW_FORM_addrx:
+  case DW_FORM_loclistx:
+  case DW_FORM_rnglistx:
+  case DW_FORM_GNU_addr_index:
+  case DW_FORM_GNU_str_index:
+  case DW_FORM_string:
+  case DW_FORM_block1:
+  case DW_FORM_block2:
+  case DW_FORM_block4:
+  case DW_FORM_block:
+  case DW_FORM_exprloc:
+  case DW_FORM_indirect:
+    return VariableSize;
+  default:
+    return UnknownForm;
+  }
+}
+
+// Move Value past a value of Form in a unit with Header. Returns false if it
+// doesn't end before End.
+bool skipValue(const uint8_t *&Value, const uint8_t *End, Dwarf_Half Form,
+               const DwarfUnitHeader &Header) {
+  int Size = getFormSize(Form, Header);
+  uint64_t Length = 0U;
+  if (Size >= 0)
+    Length = static_cast<uint64_t>(Size);
+  else if (Size == UnknownForm)
+    return false;
+  else {
+    switch (Form) {
+    case DW_FORM_string: {
+      const void *Null = std::memchr(Value, '\0', End - Value);
+      if (!Null)
+        return false;
+      Length = static_cast<const uint8_t *>(Null) - Value + 1U;
+      break;
+    }
+    case DW_FORM_block1:
+    case DW_FORM_block2:
+    case DW_FORM_block4: {
+      unsigned LengthSize =
+          Form == DW_FORM_block1 ? 1U : (Form == DW_FORM_block2 ? 2U : 4U);
+      if (static_cast<size_t>(End - Value) < LengthSize)
+        return false;
+      Length = LengthSize + readFixed(Value, LengthSize);
+      break;
+    }
+    case DW_FORM_block:
+    case DW_FORM_exprloc: {
+      const uint8_t *Block = Value;
+      if (!readULEB128(Block, End, Length))
+        return false;
+      Length += static_cast<uint64_t>(Block - Value);
+      break;
+    }
+    case DW_FORM_indirect: {
+      uint64_t ActualForm;
+      if (!readULEB128(Value, End, ActualForm) ||
+          ActualForm == DW_FORM_indirect || ActualForm > 0xffffU)
+        return false;
+      return skipValue(Value, End, static_cast<Dwarf_Half>(ActualForm),
+                       Header);
+    }
+    default: {
+      // The rest are LEB128 numbers.
+      const uint8_t *Number = Value;
+      if (!skipLEB128(Number, End))
+        return false;
+      Length = static_cast<uint64_t>(Number - Value);
+      break;
+    }
+    }
+  }
+  if (Length > static_cast<uint64_t>(End - Value))
+    return false;
+  Value += Length;
+  return true;
+}
+
+// Check if the values of Form are single LEB128 numbers.
+bool isLEB128Form(Dwarf_Half Form) {
+  switch (Form) {
+  case DW_FORM_sdata:
+  case DW_FORM_udata:
+  case DW_FORM_ref_udata:
+  case DW_FORM_strx:
+  case DW_FORM_addrx:
+  case DW_FORM_loclistx:
+  case DW_FORM_rnglistx:
+  case DW_FORM_GNU_addr_index:
+  case DW_FORM_GNU_str_index:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Run the line number program of the table from its version field at Data
+// to End, appending the rows to Rows. Returns false if it can't be decoded.
+bool decodeLineProgram(const uint8_t *Data, const uint8_t *End,
+                       unsigned OffsetSize, std::vector<DwarfLineRow> &Rows) {
+  // Read the header fields, up to the standard opcode lengths. The file
+  // names are skipped, as the program starts header_length bytes on.
+  if (End - Data < 2)
+    return false;
+  uint64_t Version = readFixed(Data, 2U);
+  Data += 2;
+  if (Version < 2U || Version > 5U)
+    return false;
+  // DWARF 5 adds the address and segment selector sizes.
+  unsigned SizesSize = Version >= 5U ? 2U : 0U;
+  if (End - Data < static_cast<ptrdiff_t>(SizesSize + OffsetSize))
+    return false;
+  Data += SizesSize;
+  uint64_t HeaderLength = readFixed(Data, OffsetSize);
+  Data += OffsetSize;
+  unsigned FieldsSize = Version >= 4U ? 6U : 5U;
+  if (HeaderLength > static_cast<uint64_t>(End - Data) ||
+      HeaderLength < FieldsSize)
+    return false;
+  const uint8_t *Program = Data + HeaderLength;
+  unsigned MinInstLength = *Data++;
+  unsigned MaxOpsPerInst = Version >= 4U ? *Data++ : 1U;
+  bool DefaultIsStmt = *Data++ != 0U;
+  auto LineBase = static_cast<int8_t>(*Data++);
+  unsigned LineRange = *Data++;
+  unsigned OpcodeBase = *Data++;
+  const uint8_t *OpcodeLengths = Data;
+  if (MaxOpsPerInst == 0U || LineRange == 0U || OpcodeBase == 0U ||
+      OpcodeBase - 1U > static_cast<uint64_t>(Program - Data))
+    return false;
+
+  // The registers of the state machine, apart from the column and ISA,
+  // which aren't kept.
+  DwarfLineRow Row;
+  uint64_t OpIndex;
+  auto Reset = [&]() {
+    Row = DwarfLineRow{0U, 1U, 1U, 0U, 0U};
+    if (DefaultIsStmt)
+      Row.Flags = DwarfLineRow::IsBeginStatement;
+    OpIndex = 0U;
+  };
+  auto AppendRow = [&]() {
+    Rows.push_back(Row);
+    Row.Discriminator = 0U;
+    Row.Flags &= DwarfLineRow::IsBeginStatement;
+  };
+  auto Advance = [&](uint64_t Operations) {
+    if (MaxOpsPerInst == 1U) {
+      Row.LineAddr += MinInstLength * Operations;
+      return;
+    }
+    OpIndex += Operations;
+    Row.LineAddr += MinInstLength * (OpIndex / MaxOpsPerInst);
+    OpIndex %= MaxOpsPerInst;
+  };
+
+  Reset();
+  for (Data = Program; Data != End;) {
+    unsigned Opcode = *Data++;
+    if (Opcode >= OpcodeBase) {
+      // A special opcode advances the address and line and appends a row.
+      unsigned Adjusted = Opcode - OpcodeBase;
+      Advance(Adjusted / LineRange);
+      Row.LineNo += static_cast<uint32_t>(LineBase + Adjusted % LineRange);
+      AppendRow();
+      continue;
+    }
+
+    uint64_t Operand;
+    switch (Opcode) {
+    case 0U: {
+      // An extended opcode, after its length.
+      if (!readULEB128(Data, End, Operand) ||
+          Operand > static_cast<uint64_t>(End - Data))
+        return false;
+      const uint8_t *Next = Data + Operand;
+      if (Operand == 0U)
+        break;
+      switch (*Data++) {
+      case DW_LNE_end_sequence:
+        Row.Flags |= DwarfLineRow::IsEndSequence;
+        AppendRow();
+        Reset();
+        break;
+      case DW_LNE_set_address:
+        if (Operand - 1U > 8U)
+          return false;
+        Row.LineAddr = readFixed(Data, static_cast<unsigned>(Operand - 1U));
+        OpIndex = 0U;
+        break;
+      case DW_LNE_set_discriminator:
+        if (!readULEB128(Data, Next, Operand))
+          return false;
+        Row.Discriminator = static_cast<uint32_t>(Operand);
+        break;
+      default:
+        // DW_LNE_define_file and vendor opcodes don't change the rows.
+        break;
+      }
+      Data = Next;
+      break;
+    }
+    case DW_LNS_copy:
+      AppendRow();
+      break;
+    case DW_LNS_advance_pc:
+      if (!readULEB128(Data, End, Operand))
+        return false;
+      Advance(Operand);
+      break;
+    case DW_LNS_advance_line: {
+      Dwarf_Signed Lines;
+      if (!readSLEB128(Data, End, Lines))
+        return false;
+      Row.LineNo += static_cast<uint32_t>(Lines);
+      break;
+    }
+    case DW_LNS_set_file:
+      if (!readULEB128(Data, End, Operand))
+        return false;
+      Row.SrcFileID = static_cast<uint32_t>(Operand);
+      break;
+    case DW_LNS_negate_stmt:
+      Row.Flags ^= DwarfLineRow::IsBeginStatement;
+      break;
+    case DW_LNS_set_basic_block:
+      Row.Flags |= DwarfLineRow::IsBeginBlock;
+      break;
+    case DW_LNS_const_add_pc:
+      Advance((255U - OpcodeBase) / LineRange);
+      break;
+    case DW_LNS_fixed_advance_pc:
+      if (End - Data < 2)
+        return false;
+      Row.LineAddr += readFixed(Data, 2U);
+      Data += 2;
+      OpIndex = 0U;
+      break;
+    case DW_LNS_set_prologue_end:
+      Row.Flags |= DwarfLineRow::IsPrologEnd;
+      break;
+    case DW_LNS_set_epilogue_begin:
+      Row.Flags |= DwarfLineRow::IsEpilogueBegin;
+      break;
+    default:
+      // DW_LNS_set_column, DW_LNS_set_isa and unknown opcodes are skipped,
+      // using the operand counts from the header.
+      if (!skipLEB128s(Data, End, OpcodeLengths[Opcode - 1U]))
+        return false;
+      break;
+    }
+  }
+  return true;
+}
+
+// The fields of an ELF section header that are needed to find its contents
+// and apply relocations to it.
+struct ElfSection {
+  uint32_t Name;
+  uint32_t Type;
+  uint64_t Flags;
+  uint64_t Offset;
+  uint64_t Size;
+  uint32_t Link;
+  uint32_t Info;
+};
+
+const uint32_t SHT_RELA = 4U;
+const uint32_t SHT_NOBITS = 8U;
+const uint32_t SHT_REL = 9U;
+const uint64_t SHF_COMPRESSED = 0x800U;
+
+// Get the size of the value written by a relocation of Type for Machine, 0
+// for relocations that write nothing, or -1 if it isn't supported. These are
+// the relocations found in the debug sections of object files.
+int getRelocationSize(uint16_t Machine, uint32_t Type) {
+  const uint16_t EM_386 = 3U;
+  const uint16_t EM_X86_64 = 62U;
+  const uint16_t EM_AARCH64 = 183U;
+  switch (Machine) {
+  case EM_386:
+    // R_386_NONE, R_386_32.
+    return Type == 0U ? 0 : (Type == 1U ? 4 : -1);
+  case EM_X86_64:
+    switch (Type) {
+    case 0U: // R_X86_64_NONE.
+      return 0;
+    case 1U:  // R_X86_64_64.
+    case 17U: // R_X86_64_DTPOFF64.
+      return 8;
+    case 10U: // R_X86_64_32.
+    case 11U: // R_X86_64_32S.
+    case 21U: // R_X86_64_DTPOFF32.
+      return 4;
+    default:
+      return -1;
+    }
+  case EM_AARCH64:
+    // R_AARCH64_NONE, R_AARCH64_ABS64, R_AARCH64_ABS32.
+    if (Type == 0U)
+      return 0;
+    return Type == 257U ? 8 : (Type == 258U ? 4 : -1);
+  default:
+    return -1;
+  }
+}
+
+// Apply the RELA relocations in Relocations, using the symbols in Symbols, to
+// Data, a copy of a section. Returns false if any of them can't be applied.
+bool applyRelocations(const uint8_t *File, bool Is64, uint16_t Machine,
+                      const ElfSection &Relocations,
+                      const ElfSection &Symbols, std::vector<uint8_t> &Data) {
+  const unsigned WordSize = Is64 ? 8U : 4U;
+  const uint64_t EntrySize = 3U * WordSize;
+  const uint64_t SymbolSize = Is64 ? 24U : 16U;
+  const uint64_t SymbolCount = Symbols.Size / SymbolSize;
+  const uint8_t *Entry = File + Relocations.Offset;
+  for (uint64_t I = 0U; I < Relocations.Size / EntrySize; ++I) {
+    uint64_t Offset = readFixed(Entry, WordSize);
+    uint64_t Info = readFixed(Entry + WordSize, WordSize);
+    uint64_t Addend = readFixed(Entry + 2U * WordSize, WordSize);
+    Entry += EntrySize;
+
+    uint64_t Symbol = Is64 ? Info >> 32U : Info >> 8U;
+    auto Type = static_cast<uint32_t>(Is64 ? Info & 0xffffffffU : Info & 0xffU);
+    int Size = getRelocationSize(Machine, Type);
+    if (Size < 0 || Symbol >= SymbolCount || Offset > Data.size() ||
+        static_cast<uint64_t>(Size) > Data.size() - Offset)
+      return false;
+
+    // The value is the symbol's value plus the addend.
+    const uint8_t *Sym = File + Symbols.Offset + Symbol * SymbolSize;
+    uint64_t Value = readFixed(Sym + (Is64 ? 8U : 4U), WordSize) + Addend;
+    for (int Byte = 0; Byte < Size; ++Byte)
+      Data[Offset + Byte] = static_cast<uint8_t>(Value >> (8U * Byte));
+  }
+  return true;
+}
+
 [[noreturn]] void dwarfErrorHandler(Dwarf_Error Error, Dwarf_Ptr PtrToDbg) {
   Dwarf_Debug Dbg = *static_cast<Dwarf_Debug *>(PtrToDbg);
   throw LibDwarfError(Error, Dbg);
@@ -87,12 +519,114 @@ std::string ElfDwarfReader::getDwarfFormAsString(Dwarf_Half Form) {
   return std::string();
 }
 
+// DwarfAbbrev and DwarfAbbrevTable methods.
+
+const DwarfAbbrevAttr *DwarfAbbrev::findAttr(Dwarf_Half Attr) const {
+  for (const DwarfAbbrevAttr *A = Attrs, *End = Attrs + AttrCount; A != End;
+       ++A)
+    if (A->Attr == Attr)
+      return A;
+  return nullptr;
+}
+
+bool DwarfAbbrevTable::compile(const DwarfSectionData &Section,
+                               const DwarfUnitHeader &Header) {
+  // Limit the codes, as the abbreviations are indexed by code.
+  const uint64_t MaxCode = 0xffffU;
+  Abbrevs.clear();
+  Attrs.clear();
+  if (!Section.Data || Header.AbbrevOffset >= Section.Size)
+    return false;
+
+  // Read the table, with the attributes given as indexes into Attrs until
+  // it stops growing.
+  std::vector<size_t> FirstAttrs;
+  const uint8_t *Abbr = Section.Data + Header.AbbrevOffset;
+  const uint8_t *AbbrEnd = Section.Data + Section.Size;
+  for (;;) {
+    uint64_t Code, Tag;
+    if (!readULEB128(Abbr, AbbrEnd, Code) || Code > MaxCode)
+      return false;
+    if (Code == 0U)
+      break;
+    if (!readULEB128(Abbr, AbbrEnd, Tag) || Tag == 0U || Tag > 0xffffU ||
+        Abbr == AbbrEnd)
+      return false;
+    if (Code >= Abbrevs.size()) {
+      Abbrevs.resize(Code + 1U);
+      FirstAttrs.resize(Code + 1U);
+    }
+    DwarfAbbrev &Entry = Abbrevs[Code];
+    Entry = DwarfAbbrev();
+    Entry.Tag = static_cast<Dwarf_Half>(Tag);
+    Entry.HasChildren = *Abbr++ == DW_CHILDREN_yes;
+    FirstAttrs[Code] = Attrs.size();
+
+    bool Fixed = true;
+    for (;;) {
+      uint64_t Attr, Form;
+      if (!readULEB128(Abbr, AbbrEnd, Attr) ||
+          !readULEB128(Abbr, AbbrEnd, Form))
+        return false;
+      if (Attr == 0U && Form == 0U)
+        break;
+      if (Attr > 0xffffU || Form > 0xffffU)
+        return false;
+      DwarfAbbrevAttr Value{static_cast<Dwarf_Half>(Attr),
+                            static_cast<Dwarf_Half>(Form), 0, 0U, 0, 0U};
+      Value.Size = getFormSize(Value.Form, Header);
+      if (Value.Size == UnknownForm)
+        return false;
+      // The value of an implicit constant is in the abbreviation.
+      if (Value.Form == DW_FORM_implicit_const &&
+          !readSLEB128(Abbr, AbbrEnd, Value.ImplicitConst))
+        return false;
+
+      Fixed = Fixed && Value.Size != VariableSize;
+      if (Fixed) {
+        Value.Offset = Entry.FixedSize;
+        Entry.FixedSize += static_cast<unsigned>(Value.Size);
+        ++Entry.FixedAttrCount;
+      }
+      ++Entry.AttrCount;
+      Attrs.push_back(Value);
+    }
+  }
+
+  for (size_t Code = 0U; Code < Abbrevs.size(); ++Code) {
+    DwarfAbbrev &Entry = Abbrevs[Code];
+    if (Entry.Tag == 0U)
+      continue;
+    Entry.Attrs = Attrs.data() + FirstAttrs[Code];
+    Entry.Sibling = Entry.findAttr(DW_AT_sibling);
+
+    // Count the LEB128 numbers that follow each attribute, which are skipped
+    // together. The sibling is left out, as the cursor reads it.
+    unsigned Run = 0U;
+    for (unsigned I = Entry.AttrCount; I-- > Entry.FixedAttrCount;) {
+      DwarfAbbrevAttr &Attr = Attrs[FirstAttrs[Code] + I];
+      bool Leb128 = isLEB128Form(Attr.Form) && &Attr != Entry.Sibling;
+      Run = Leb128 ? Run + 1U : 0U;
+      Attr.LEB128Run = Run;
+    }
+  }
+  return true;
+}
+
+bool DwarfAbbrevTable::usesForm(Dwarf_Half Form) const {
+  for (const DwarfAbbrevAttr &Attr : Attrs)
+    if (Attr.Form == Form)
+      return true;
+  return false;
+}
+
 // DwarfDebugData methods.
 
 DwarfDebugData::DwarfDebugData(int FileDescriptor) : Dbg(nullptr) {
   // Errors in dwarf_init occur before the handler is setup, so use the error
   // pointer interface here, and then throw the exception 'manually'.
   Dwarf_Error Err;
+  std::unique_lock<std::mutex> Lock(InitMutex);
   int ret = dwarf_init(FileDescriptor, DW_DLC_READ, dwarfErrorHandler,
                        /*errarg*/ &Dbg, &Dbg, &Err);
   if (ret == DW_DLV_NO_ENTRY) {
@@ -101,6 +635,7 @@ DwarfDebugData::DwarfDebugData(int FileDescriptor) : Dbg(nullptr) {
   }
   if (ret != DW_DLV_OK) {
     LibDwarfError LibErr(Err, Dbg); // Create the error before freeing Dbg.
+    Lock.unlock();
     freeDbg();                      // If Dbg was set we need to free it.
     throw LibErr;
   }
@@ -108,54 +643,307 @@ DwarfDebugData::DwarfDebugData(int FileDescriptor) : Dbg(nullptr) {
 
 DwarfDebugData::DwarfDebugData(DwarfDebugData &&Other) : Dbg(nullptr) {
   std::swap(Dbg, Other.Dbg);
+  std::swap(InfoSection, Other.InfoSection);
+  std::swap(TypesSection, Other.TypesSection);
+  std::swap(AbbrevSection, Other.AbbrevSection);
+  std::swap(StrSection, Other.StrSection);
+  std::swap(StrOffsetsSection, Other.StrOffsetsSection);
+  std::swap(LineSection, Other.LineSection);
+  std::swap(DecodingValues, Other.DecodingValues);
+  std::swap(RelocatedSections, Other.RelocatedSections);
+  std::swap(AbbrevTables, Other.AbbrevTables);
+  std::swap(UnitContexts, Other.UnitContexts);
 }
 
 DwarfDebugData &DwarfDebugData::operator=(DwarfDebugData &&Other) {
   if (Dbg != Other.Dbg) {
     freeDbg();
     std::swap(Dbg, Other.Dbg);
+    std::swap(InfoSection, Other.InfoSection);
+    std::swap(TypesSection, Other.TypesSection);
+    std::swap(AbbrevSection, Other.AbbrevSection);
+    std::swap(StrSection, Other.StrSection);
+    std::swap(StrOffsetsSection, Other.StrOffsetsSection);
+    std::swap(LineSection, Other.LineSection);
+    std::swap(DecodingValues, Other.DecodingValues);
+    std::swap(RelocatedSections, Other.RelocatedSections);
+    std::swap(AbbrevTables, Other.AbbrevTables);
+    std::swap(UnitContexts, Other.UnitContexts);
   }
   return *this;
 }
 
+void DwarfDebugData::setFileData(const char *FileData, size_t FileSize,
+                                 bool DecodeValues) {
+  InfoSection = DwarfSectionData();
+  TypesSection = DwarfSectionData();
+  AbbrevSection = DwarfSectionData();
+  StrSection = DwarfSectionData();
+  StrOffsetsSection = DwarfSectionData();
+  LineSection = DwarfSectionData();
+  DecodingValues = false;
+  RelocatedSections.clear();
+  AbbrevTables.clear();
+  UnitContexts.clear();
+
+  // Only little endian ELF files are read, anything else is left to libdwarf.
+  static const char Magic[] = {0x7f, 'E', 'L', 'F'};
+  const auto *File = reinterpret_cast<const uint8_t *>(FileData);
+  if (!File || FileSize < 64U || std::memcmp(File, Magic, sizeof(Magic)) != 0)
+    return;
+  bool Is64 = File[4] == 2U;
+  if ((!Is64 && File[4] != 1U) || File[5] != 1U)
+    return;
+
+  auto Machine = static_cast<uint16_t>(readFixed(File + 0x12, 2));
+  uint64_t HeadersOffset = readFixed(File + (Is64 ? 0x28 : 0x20), Is64 ? 8 : 4);
+  uint64_t HeaderSize = readFixed(File + (Is64 ? 0x3a : 0x2e), 2);
+  uint64_t HeaderCount = readFixed(File + (Is64 ? 0x3c : 0x30), 2);
+  uint64_t NamesIndex = readFixed(File + (Is64 ? 0x3e : 0x32), 2);
+  if (HeadersOffset == 0U || HeaderSize < (Is64 ? 64U : 40U) ||
+      HeadersOffset > FileSize || HeaderSize > FileSize)
+    return;
+
+  // Read a section header, returning false if it is outside the file.
+  auto ReadHeader = [&](uint64_t Index, ElfSection &Section) {
+    if (Index >= (FileSize - HeadersOffset) / HeaderSize)
+      return false;
+    const uint8_t *Header = File + HeadersOffset + Index * HeaderSize;
+    unsigned WordSize = Is64 ? 8U : 4U;
+    Section.Name = static_cast<uint32_t>(readFixed(Header, 4));
+    Section.Type = static_cast<uint32_t>(readFixed(Header + 4, 4));
+    Section.Flags = readFixed(Header + 8, WordSize);
+    Section.Offset = readFixed(Header + 8 + 2 * WordSize, WordSize);
+    Section.Size = readFixed(Header + 8 + 3 * WordSize, WordSize);
+    Section.Link =
+        static_cast<uint32_t>(readFixed(Header + 8 + 4 * WordSize, 4));
+    Section.Info =
+        static_cast<uint32_t>(readFixed(Header + 12 + 4 * WordSize, 4));
+    return Section.Type == SHT_NOBITS ||
+           (Section.Offset <= FileSize &&
+            Section.Size <= FileSize - Section.Offset);
+  };
+
+  // Large section counts and indexes are kept in the first section header.
+  ElfSection Section;
+  if (!ReadHeader(0U, Section))
+    return;
+  if (HeaderCount == 0U)
+    HeaderCount = Section.Size;
+  if (NamesIndex == 0xffffU)
+    NamesIndex = Section.Link;
+
+  ElfSection Names;
+  if (!ReadHeader(NamesIndex, Names) || Names.Type == SHT_NOBITS)
+    return;
+  const char *NamesBegin = FileData + Names.Offset;
+
+  std::vector<ElfSection> Sections;
+  for (uint64_t Index = 0U; Index < HeaderCount; ++Index) {
+    Sections.emplace_back();
+    if (!ReadHeader(Index, Sections.back()))
+      return;
+  }
+
+  // The debug sections found, by index.
+  std::map<uint64_t, DwarfSectionData *> DebugSections;
+  for (uint64_t Index = 1U; Index < Sections.size(); ++Index) {
+    const ElfSection &Section = Sections[Index];
+    if (Section.Type == SHT_NOBITS || (Section.Flags & SHF_COMPRESSED) != 0U ||
+        Section.Name >= Names.Size)
+      continue;
+    const char *Name = NamesBegin + Section.Name;
+    if (!std::memchr(Name, '\0', Names.Size - Section.Name))
+      continue;
+    DwarfSectionData *Data = nullptr;
+    if (std::strcmp(Name, ".debug_info") == 0)
+      Data = &InfoSection;
+    else if (std::strcmp(Name, ".debug_types") == 0)
+      Data = &TypesSection;
+    else if (std::strcmp(Name, ".debug_abbrev") == 0)
+      Data = &AbbrevSection;
+    else if (std::strcmp(Name, ".debug_str") == 0)
+      Data = &StrSection;
+    else if (std::strcmp(Name, ".debug_str_offsets") == 0)
+      Data = &StrOffsetsSection;
+    else if (std::strcmp(Name, ".debug_line") == 0)
+      Data = &LineSection;
+    if (!Data)
+      continue;
+    *Data = DwarfSectionData{File + Section.Offset,
+                             static_cast<size_t>(Section.Size)};
+    DebugSections[Index] = Data;
+  }
+  if (!DecodeValues)
+    return;
+
+  // The Dies are walked the same with or without the relocations in an
+  // object file, but the values need them. They are applied to copies of the
+  // sections, and if any can't be the values are left to libdwarf.
+  std::map<DwarfSectionData *, std::vector<uint8_t>> Copies;
+  for (const ElfSection &Relocations : Sections) {
+    auto Target = DebugSections.find(Relocations.Info);
+    if ((Relocations.Type != SHT_RELA && Relocations.Type != SHT_REL) ||
+        Target == DebugSections.end())
+      continue;
+    if (Relocations.Type == SHT_REL || Relocations.Link >= Sections.size() ||
+        Sections[Relocations.Link].Type == SHT_NOBITS)
+      return;
+    std::vector<uint8_t> &Copy = Copies[Target->second];
+    if (Copy.empty())
+      Copy.assign(Target->second->Data,
+                  Target->second->Data + Target->second->Size);
+    if (!applyRelocations(File, Is64, Machine, Relocations,
+                          Sections[Relocations.Link], Copy))
+      return;
+  }
+  for (auto &Copy : Copies) {
+    RelocatedSections.push_back(std::move(Copy.second));
+    *Copy.first = DwarfSectionData{RelocatedSections.back().data(),
+                                   RelocatedSections.back().size()};
+  }
+  DecodingValues = true;
+}
+
 void DwarfDebugData::freeDbg() {
   if (Dbg) {
     Dwarf_Error Err; // To prevent throwing a LibDwarfError.
+    std::lock_guard<std::mutex> Lock(InitMutex);
     dwarf_finish(Dbg, &Err);
     Dbg = nullptr;
   }
 }
 
-std::vector<DwarfCompileUnit> DwarfDebugData::getCompileUnits() const {
+const DwarfAbbrevTable *
+DwarfDebugData::getAbbrevTable(const DwarfUnitHeader &Header) const {
+  auto Key = std::make_tuple(Header.AbbrevOffset, Header.AddressSize,
+                             Header.OffsetSize, Header.Version <= 2U);
+  auto IT = AbbrevTables.find(Key);
+  if (IT != AbbrevTables.end())
+    return IT->second.get();
+
+  std::unique_ptr<DwarfAbbrevTable> Table(new DwarfAbbrevTable());
+  if (!Table->compile(AbbrevSection, Header))
+    Table.reset();
+  return AbbrevTables.emplace(Key, std::move(Table)).first->second.get();
+}
+
+const DwarfUnitContext *
+DwarfDebugData::getUnitContext(const DwarfUnitHeader &Header, bool IsInfo,
+                               Dwarf_Off UnitOffset,
+                               const DwarfAbbrev &UnitAbbrev) const {
+  std::unique_ptr<DwarfUnitContext> &Context =
+      UnitContexts[std::make_pair(IsInfo, Header.HeaderOffset)];
+  if (!Context) {
+    Context.reset(new DwarfUnitContext());
+    Context->Header = Header;
+    Context->IsInfo = IsInfo;
+    DwarfAttrValue Base(DwarfDie(*this, *Context, UnitOffset, UnitAbbrev)
+                            .getAttr(DW_AT_str_offsets_base));
+    if (Base.getKind() == DwarfAttrValueKind::Reference)
+      Context->StrOffsetsBase = Base.getReference();
+  }
+  return Context.get();
+}
+
+std::vector<DwarfCompileUnit>
+DwarfDebugData::getCompileUnits(const CompileUnitFilter &Select) const {
   std::vector<DwarfCompileUnit> Result;
   if (empty())
     return Result;
 
+  readUnits(IsInfo, &Result, nullptr, Select);
+  return Result;
+}
+
+std::vector<DwarfTypeUnit> DwarfDebugData::getTypeUnits() const {
+  std::vector<DwarfTypeUnit> Result;
+  if (empty())
+    return Result;
+
+  // DWARF 5 type units are in .debug_info, DWARF 4 ones are in .debug_types.
+  readUnits(IsInfo, nullptr, &Result);
+  readUnits(!IsInfo, nullptr, &Result);
+  return Result;
+}
+
+void DwarfDebugData::readUnits(bool InfoSection,
+                               std::vector<DwarfCompileUnit> *CompileUnits,
+                               std::vector<DwarfTypeUnit> *TypeUnits,
+                               const CompileUnitFilter &Select) const {
   Dwarf_Unsigned CurrentHeader = 0U;
   for (;;) {
+    DwarfUnitHeader Header;
     Dwarf_Unsigned NextHeader;
+    Dwarf_Sig8 Signature;
+    Dwarf_Unsigned TypeOffset;
+    Dwarf_Half UnitType;
     int ret = dwarf_next_cu_header_d(
-        Dbg, IsInfo, /*cu_header_length*/ nullptr, /*version_stamp*/ nullptr,
-        /*abbrev_offset*/ nullptr, /*address_size*/ nullptr,
-        /*offset_size*/ nullptr, /*extension_size*/ nullptr,
-        /*signature*/ nullptr, /*typeoffse*/ nullptr, &NextHeader,
-        /*header_cu_type*/ nullptr, /*error*/ nullptr);
+        Dbg, InfoSection, /*cu_header_length*/ nullptr, &Header.Version,
+        &Header.AbbrevOffset, &Header.AddressSize, &Header.OffsetSize,
+        /*extension_size*/ nullptr, &Signature, &TypeOffset, &NextHeader,
+        &UnitType, /*error*/ nullptr);
     if (ret != DW_DLV_OK)
       break;
+    Header.HeaderOffset = CurrentHeader;
+    Header.NextHeaderOffset = NextHeader;
 
-    // Each CU header should have a CU sibling.
-    Dwarf_Die RawCUDie;
-    ret = dwarf_siblingof_b(Dbg, /*die*/ nullptr, IsInfo, &RawCUDie, nullptr);
+    // Each unit header should have a unit sibling.
+    Dwarf_Die RawUnitDie;
+    ret = dwarf_siblingof_b(Dbg, /*die*/ nullptr, InfoSection, &RawUnitDie,
+                            nullptr);
     if (ret != DW_DLV_OK)
       break;
 
-    Result.emplace_back(DwarfDie(*this, RawCUDie));
-    Result.back().HeaderOffset = CurrentHeader;
-    Result.back().NextHeaderOffset = NextHeader;
+    if (UnitType == DW_UT_type) {
+      if (TypeUnits) {
+        TypeUnits->emplace_back(DwarfDie(*this, RawUnitDie));
+        static_cast<DwarfUnitHeader &>(TypeUnits->back()) = Header;
+        TypeUnits->back().Signature = getSignatureValue(Signature);
+        TypeUnits->back().TypeOffset = CurrentHeader + TypeOffset;
+      } else
+        dwarf_dealloc(Dbg, RawUnitDie, DW_DLA_DIE);
+    } else {
+      if (CompileUnits) {
+        DwarfDie UnitDie(*this, RawUnitDie);
+        bool Selected = true;
+        if (Select) {
+          DwarfAttrValue CompDir = UnitDie.getAttr(DW_AT_comp_dir);
+          Selected = Select(UnitDie.getName(),
+                            CompDir.getKind() == DwarfAttrValueKind::String
+                                ? CompDir.getString()
+                                : std::string());
+        }
+        if (Selected) {
+          CompileUnits->emplace_back(std::move(UnitDie));
+          static_cast<DwarfUnitHeader &>(CompileUnits->back()) = Header;
+        }
+      } else
+        dwarf_dealloc(Dbg, RawUnitDie, DW_DLA_DIE);
+    }
 
     CurrentHeader = NextHeader;
   }
+}
+
+std::vector<DwarfArange> DwarfDebugData::getAranges() const {
+  std::vector<DwarfArange> Result;
+  Dwarf_Arange *Aranges = nullptr;
+  Dwarf_Signed Count = 0;
+  if (empty() || dwarf_get_aranges(Dbg, &Aranges, &Count, nullptr) != DW_DLV_OK)
+    return Result;
 
+  for (Dwarf_Signed I = 0; I < Count; ++I) {
+    Dwarf_Addr Start;
+    Dwarf_Unsigned Length;
+    Dwarf_Off CUDieOffset;
+    if (dwarf_get_arange_info(Aranges[I], &Start, &Length, &CUDieOffset,
+                              nullptr) == DW_DLV_OK &&
+        Length != 0)
+      Result.push_back({{Start, Start + Length}, CUDieOffset});
+    dwarf_dealloc(Dbg, Aranges[I], DW_DLA_ARANGE);
+  }
+  dwarf_dealloc(Dbg, Aranges, DW_DLA_LIST);
   return Result;
 }
 
@@ -168,16 +956,22 @@ std::string DwarfDebugData::copyAndFreeDwarfString(char *DwarfStr) const {
 // DwarfDie methods.
 
 DwarfDie::DwarfDie(DwarfDie &&Other)
-    : DebugData(Other.DebugData), Die(nullptr) {
+    : DebugData(Other.DebugData), Die(nullptr), Abbrev(Other.Abbrev),
+      Unit(Other.Unit), Offset(Other.Offset) {
   std::swap(Die, Other.Die);
 }
 
 DwarfDie &DwarfDie::operator=(DwarfDie &&Other) {
-  assert(DebugData.get() == Other.DebugData.get() &&
+  assert((!DebugData || !Other.DebugData ||
+          DebugData->get() == Other.DebugData->get()) &&
          "Assigning DIE to DIE from other debug data.");
-  if (Die != Other.Die) {
+  if (this != &Other) {
     freeDie();
     std::swap(Die, Other.Die);
+    DebugData = Other.DebugData;
+    Abbrev = Other.Abbrev;
+    Unit = Other.Unit;
+    Offset = Other.Offset;
   }
   return *this;
 }
@@ -191,20 +985,38 @@ DwarfDieChildIterator DwarfDie::childrenEnd() {
 }
 
 Dwarf_Off DwarfDie::getGlobalOffset() const {
-  Dwarf_Off Offset;
-  dwarf_dieoffset(Die, &Offset, nullptr);
-  return Offset;
+  if (Unit)
+    return Offset;
+  Dwarf_Off Result;
+  dwarf_dieoffset(Die, &Result, nullptr);
+  return Result;
+}
+
+bool DwarfDie::isInfo() const {
+  if (Unit)
+    return Unit->IsInfo;
+  return dwarf_get_die_infotypes_flag(Die) != 0;
 }
 
 std::string DwarfDie::getName() const {
+  const DwarfAbbrevAttr *NameAttr = Abbrev ? Abbrev->findAttr(DW_AT_name)
+                                           : nullptr;
+  if (Abbrev && !NameAttr)
+    return "";
+  DwarfAttrValue Value;
+  if (Unit && decodeAttr(*NameAttr, Value) &&
+      Value.getKind() == DwarfAttrValueKind::String)
+    return Value.getString();
   char *Name;
-  int ret = dwarf_diename(Die, &Name, nullptr);
-  return (ret == DW_DLV_OK) ? DebugData.copyAndFreeDwarfString(Name) : "";
+  int ret = dwarf_diename(get(), &Name, nullptr);
+  return (ret == DW_DLV_OK) ? DebugData->copyAndFreeDwarfString(Name) : "";
 }
 
 Dwarf_Half DwarfDie::getTag() const {
+  if (Abbrev)
+    return Abbrev->Tag;
   Dwarf_Half Result;
-  dwarf_tag(Die, &Result, nullptr);
+  dwarf_tag(get(), &Result, nullptr);
   return Result;
 }
 
@@ -214,25 +1026,135 @@ std::string DwarfDie::getTagName() const {
   return (ret == DW_DLV_OK) ? TagName : "";
 }
 
+bool DwarfDie::getLowPC(Dwarf_Addr &LowPC) const {
+  if (Unit) {
+    DwarfAttrValue Value(getAttr(DW_AT_low_pc));
+    if (Value.empty())
+      return false;
+    if (Value.getKind() == DwarfAttrValueKind::Address) {
+      LowPC = Value.getAddress();
+      return true;
+    }
+  }
+  return dwarf_lowpc(get(), &LowPC, nullptr) == DW_DLV_OK;
+}
+
+bool DwarfDie::getHighPC(Dwarf_Addr LowPC, Dwarf_Addr &HighPC) const {
+  if (Unit) {
+    DwarfAttrValue Value(getAttr(DW_AT_high_pc));
+    if (Value.empty())
+      return false;
+    if (Value.getKind() == DwarfAttrValueKind::Address) {
+      HighPC = Value.getAddress();
+      return true;
+    }
+    // A constant DW_AT_high_pc is the size of the range.
+    if (Value.getKind() == DwarfAttrValueKind::Unsigned) {
+      HighPC = LowPC + Value.getUnsigned();
+      return true;
+    }
+  }
+  Dwarf_Half Form;
+  enum Dwarf_Form_Class Class;
+  if (dwarf_highpc_b(get(), &HighPC, &Form, &Class, nullptr) != DW_DLV_OK)
+    return false;
+  if (Class == DW_FORM_CLASS_CONSTANT)
+    HighPC += LowPC;
+  return true;
+}
+
+std::vector<DwarfAddressRange>
+DwarfDie::getAddressRanges(Dwarf_Addr BaseAddress) const {
+  std::vector<DwarfAddressRange> Result;
+  if (Abbrev && !Abbrev->findAttr(DW_AT_low_pc) &&
+      !Abbrev->findAttr(DW_AT_ranges))
+    return Result;
+
+  Dwarf_Addr LowPC;
+  Dwarf_Addr HighPC;
+  if (getLowPC(LowPC) && getHighPC(LowPC, HighPC) && HighPC > LowPC)
+    Result.push_back({LowPC, HighPC});
+
+  DwarfAttrValue RangesAttr(getAttr(DW_AT_ranges));
+  Dwarf_Off RangesOffset;
+  if (RangesAttr.getKind() == DwarfAttrValueKind::Reference)
+    RangesOffset = RangesAttr.getReference();
+  else if (RangesAttr.getKind() == DwarfAttrValueKind::Unsigned)
+    RangesOffset = RangesAttr.getUnsigned();
+  else
+    return Result;
+
+  Dwarf_Ranges *Entries = nullptr;
+  Dwarf_Signed Count = 0;
+  Dwarf_Unsigned ByteCount;
+  if (dwarf_get_ranges_a(**DebugData, RangesOffset, get(), &Entries, &Count,
+                         &ByteCount, nullptr) != DW_DLV_OK)
+    return Result;
+  for (Dwarf_Signed I = 0; I < Count; ++I) {
+    const Dwarf_Ranges &Entry = Entries[I];
+    if (Entry.dwr_type == DW_RANGES_ADDRESS_SELECTION)
+      BaseAddress = Entry.dwr_addr2;
+    else if (Entry.dwr_type == DW_RANGES_ENTRY &&
+             Entry.dwr_addr2 > Entry.dwr_addr1)
+      Result.push_back(
+          {BaseAddress + Entry.dwr_addr1, BaseAddress + Entry.dwr_addr2});
+  }
+  dwarf_ranges_dealloc(**DebugData, Entries, Count);
+  return Result;
+}
+
 DwarfLineTable DwarfDie::getLineTable() const { return DwarfLineTable(*this); }
 
+void DwarfDie::getLineRows(std::vector<DwarfLineRow> &Rows) const {
+  if (DebugData && DebugData->isDecodingValues()) {
+    // DWARF 2 and 3 give the offset with a data form.
+    DwarfAttrValue StmtList = getAttr(DW_AT_stmt_list);
+    if ((StmtList.getKind() == DwarfAttrValueKind::Reference &&
+         DwarfLineTable::decodeRows(DebugData->getLineSection(),
+                                    StmtList.getReference(), Rows)) ||
+        (StmtList.getKind() == DwarfAttrValueKind::Unsigned &&
+         DwarfLineTable::decodeRows(DebugData->getLineSection(),
+                                    StmtList.getUnsigned(), Rows)))
+      return;
+  }
+  Rows.clear();
+  getLineTable().getRows(Rows);
+}
+
+void DwarfDie::createDie() const {
+  dwarf_offdie_b(**DebugData, Offset, Unit->IsInfo, &Die, nullptr);
+}
+
 void DwarfDie::freeDie() {
   if (Die) {
-    dwarf_dealloc(*DebugData, Die, DW_DLA_DIE);
+    dwarf_dealloc(**DebugData, Die, DW_DLA_DIE);
     Die = nullptr;
   }
 }
 
 bool DwarfDie::hasAttr(Dwarf_Half Attr) const {
+  if (Abbrev)
+    return Abbrev->findAttr(Attr) != nullptr;
   Dwarf_Bool Result;
-  dwarf_hasattr(Die, Attr, &Result, nullptr);
+  dwarf_hasattr(get(), Attr, &Result, nullptr);
   return Result != 0;
 }
 
 DwarfAttrValue DwarfDie::getAttr(Dwarf_Half Attr) const {
+  // Most lookups are for attributes the Die doesn't have, which the
+  // abbreviation answers without libdwarf.
+  if (Abbrev) {
+    const DwarfAbbrevAttr *AbbrevAttr = Abbrev->findAttr(Attr);
+    if (!AbbrevAttr)
+      return DwarfAttrValue(); // Empty.
+    DwarfAttrValue Result;
+    if (Unit && decodeAttr(*AbbrevAttr, Result))
+      return Result;
+  }
+
   // Get attr.
   Dwarf_Attribute Attribute;
-  int ret = dwarf_attr(Die, Attr, &Attribute, nullptr);
+  int ret = dwarf_attr(get(), Attr, &Attribute, nullptr);
   if (ret != DW_DLV_OK)
     return DwarfAttrValue(); // Empty.
 
@@ -245,12 +1167,19 @@ DwarfAttrValue DwarfDie::getAttr(Dwarf_Half Attr) const {
   case DW_FORM_ref4:
   case DW_FORM_ref8:
   case DW_FORM_ref_udata:
-  case DW_FORM_ref_sig8:
   case DW_FORM_sec_offset: {
     Dwarf_Off Reference;
     dwarf_global_formref(Attribute, &Reference, nullptr);
     return DwarfAttrValue(Reference, DwarfAttrValueKind::Reference, Form);
   }
+  case DW_FORM_ref_sig8: {
+    // The referenced Die is in a type unit, which is identified by signature
+    // rather than by offset.
+    Dwarf_Sig8 Signature;
+    dwarf_formsig8(Attribute, &Signature, nullptr);
+    return DwarfAttrValue(getSignatureValue(Signature),
+                          DwarfAttrValueKind::Signature, Form);
+  }
   case DW_FORM_addr:
   case DW_FORM_addrx:
   case DW_FORM_GNU_addr_index: {
@@ -289,7 +1218,7 @@ DwarfAttrValue DwarfDie::getAttr(Dwarf_Half Attr) const {
     DwarfAttrValue Result(std::vector<uint8_t>(Data, Data + Blocks->bl_len),
                           DwarfAttrValueKind::Bytes, Form);
 
-    dwarf_dealloc(DebugData.get(), Blocks, DW_DLA_BLOCK);
+    dwarf_dealloc(**DebugData, Blocks, DW_DLA_BLOCK);
     return Result;
   }
   case DW_FORM_exprloc: {
@@ -308,36 +1237,408 @@ DwarfAttrValue DwarfDie::getAttr(Dwarf_Half Attr) const {
   case DW_FORM_GNU_str_index: {
     char *Str;
     dwarf_formstring(Attribute, &Str, nullptr);
-    return DwarfAttrValue(DebugData.copyAndFreeDwarfString(Str), Form);
+    return DwarfAttrValue(DebugData->copyAndFreeDwarfString(Str), Form);
   }
   default:
     return DwarfAttrValue(Form); // Unknown Form.
   }
 }
 
+bool DwarfDie::decodeAttr(const DwarfAbbrevAttr &AbbrevAttr,
+                          DwarfAttrValue &Result) const {
+  const DwarfUnitHeader &Header = Unit->Header;
+  const DwarfSectionData &Info = DebugData->getInfoSection(Unit->IsInfo);
+  const uint8_t *Value = Info.Data + Offset;
+  const uint8_t *End = Info.Data + Header.NextHeaderOffset;
+
+  // Find the value after the abbreviation code. The cursor has checked the
+  // entry is in the unit.
+  skipLEB128(Value, End);
+  auto Index = static_cast<unsigned>(&AbbrevAttr - Abbrev->Attrs);
+  if (Index < Abbrev->FixedAttrCount)
+    Value += AbbrevAttr.Offset;
+  else {
+    Value += Abbrev->FixedSize;
+    for (unsigned I = Abbrev->FixedAttrCount; I < Index;) {
+      unsigned Run = std::min(Abbrev->Attrs[I].LEB128Run, Index - I);
+      if (Run > 1U)
+        skipLEB128s(Value, End, Run);
+      else {
+        skipValue(Value, End, Abbrev->Attrs[I].Form, Header);
+        Run = 1U;
+      }
+      I += Run;
+    }
+  }
+
+  Dwarf_Half Form = AbbrevAttr.Form;
+  if (Form == DW_FORM_indirect) {
+    uint64_t ActualForm;
+    if (!readULEB128(Value, End, ActualForm) || ActualForm > 0xffffU)
+      return false;
+    Form = static_cast<Dwarf_Half>(ActualForm);
+  }
+
+  // Get a string from .debug_str.
+  auto GetString = [&](uint64_t StrOffset) {
+    const DwarfSectionData &Str = DebugData->getStrSection();
+    if (StrOffset >= Str.Size)
+      return false;
+    const auto *Begin = reinterpret_cast<const char *>(Str.Data + StrOffset);
+    const void *Null = std::memchr(Begin, '\0', Str.Size - StrOffset);
+    if (!Null)
+      return false;
+    Result = DwarfAttrValue(
+        std::string(Begin, static_cast<const char *>(Null)), Form);
+    return true;
+  };
+
+  // References outside the unit are left to libdwarf, which reports them.
+  const uint64_t UnitSize = Header.NextHeaderOffset - Header.HeaderOffset;
+  int Size = getFormSize(Form, Header);
+  switch (Form) {
+  case DW_FORM_ref1:
+  case DW_FORM_ref2:
+  case DW_FORM_ref4:
+  case DW_FORM_ref8: {
+    uint64_t UnitOffset = readFixed(Value, static_cast<unsigned>(Size));
+    if (UnitOffset >= UnitSize)
+      return false;
+    Result = DwarfAttrValue(Header.HeaderOffset + UnitOffset,
+                            DwarfAttrValueKind::Reference, Form);
+    return true;
+  }
+  case DW_FORM_ref_udata: {
+    uint64_t UnitOffset;
+    if (!readULEB128(Value, End, UnitOffset) || UnitOffset >= UnitSize)
+      return false;
+    Result = DwarfAttrValue(Header.HeaderOffset + UnitOffset,
+                            DwarfAttrValueKind::Reference, Form);
+    return true;
+  }
+  case DW_FORM_ref_addr:
+  case DW_FORM_sec_offset:
+    Result = DwarfAttrValue(readFixed(Value, static_cast<unsigned>(Size)),
+                            DwarfAttrValueKind::Reference, Form);
+    return true;
+  case DW_FORM_ref_sig8:
+    Result = DwarfAttrValue(readFixed(Value, 8U),
+                            DwarfAttrValueKind::Signature, Form);
+    return true;
+  case DW_FORM_addr:
+    Result = DwarfAttrValue(readFixed(Value, static_cast<unsigned>(Size)),
+                            DwarfAttrValueKind::Address, Form);
+    return true;
+  case DW_FORM_flag:
+    Result = DwarfAttrValue(static_cast<Dwarf_Bool>(*Value != 0U), Form);
+    return true;
+  case DW_FORM_flag_present:
+    Result = DwarfAttrValue(static_cast<Dwarf_Bool>(1), Form);
+    return true;
+  case DW_FORM_data1:
+  case DW_FORM_data2:
+  case DW_FORM_data4:
+  case DW_FORM_data8:
+    Result = DwarfAttrValue(readFixed(Value, static_cast<unsigned>(Size)),
+                            DwarfAttrValueKind::Unsigned, Form);
+    return true;
+  case DW_FORM_udata: {
+    uint64_t Unsigned;
+    if (!readULEB128(Value, End, Unsigned))
+      return false;
+    Result = DwarfAttrValue(Unsigned, DwarfAttrValueKind::Unsigned, Form);
+    return true;
+  }
+  case DW_FORM_implicit_const:
+    if (AbbrevAttr.ImplicitConst < 0)
+      return false;
+    Result = DwarfAttrValue(
+        static_cast<Dwarf_Unsigned>(AbbrevAttr.ImplicitConst),
+        DwarfAttrValueKind::Unsigned, Form);
+    return true;
+  case DW_FORM_sdata: {
+    Dwarf_Signed Signed;
+    if (!readSLEB128(Value, End, Signed))
+      return false;
+    Result = DwarfAttrValue(Signed, Form);
+    return true;
+  }
+  case DW_FORM_block1:
+  case DW_FORM_block2:
+  case DW_FORM_block4:
+  case DW_FORM_block:
+  case DW_FORM_exprloc: {
+    uint64_t Length;
+    if (Form == DW_FORM_block || Form == DW_FORM_exprloc) {
+      if (!readULEB128(Value, End, Length))
+        return false;
+    } else {
+      unsigned LengthSize =
+          Form == DW_FORM_block1 ? 1U : (Form == DW_FORM_block2 ? 2U : 4U);
+      Length = readFixed(Value, LengthSize);
+      Value += LengthSize;
+    }
+    if (Length > static_cast<uint64_t>(End - Value))
+      return false;
+    Result = DwarfAttrValue(std::vector<uint8_t>(Value, Value + Length),
+                            Form == DW_FORM_exprloc
+                                ? DwarfAttrValueKind::Exprloc
+                                : DwarfAttrValueKind::Bytes,
+                            Form);
+    return true;
+  }
+  case DW_FORM_string: {
+    const auto *Begin = reinterpret_cast<const char *>(Value);
+    const void *Null = std::memchr(Begin, '\0', End - Value);
+    if (!Null)
+      return false;
+    Result = DwarfAttrValue(
+        std::string(Begin, static_cast<const char *>(Null)), Form);
+    return true;
+  }
+  case DW_FORM_strp:
+    return GetString(readFixed(Value, Header.OffsetSize));
+  case DW_FORM_strx: {
+    // The index is into the unit's part of .debug_str_offsets.
+    const DwarfSectionData &StrOffsets = DebugData->getStrOffsetsSection();
+    uint64_t StrIndex;
+    if (!readULEB128(Value, End, StrIndex) || Unit->StrOffsetsBase == 0U ||
+        StrIndex >= StrOffsets.Size / Header.OffsetSize)
+      return false;
+    uint64_t Entry = Unit->StrOffsetsBase + StrIndex * Header.OffsetSize;
+    if (Entry > StrOffsets.Size - Header.OffsetSize)
+      return false;
+    return GetString(readFixed(StrOffsets.Data + Entry, Header.OffsetSize));
+  }
+  default:
+    // The rest, such as the forms indexing .debug_addr, are left to libdwarf.
+    return false;
+  }
+}
+
 // DwarfDieChildIterator methods.
 
 DwarfDieChildIterator::DwarfDieChildIterator(const DwarfDie &Parent) {
   Dwarf_Die RawChildDie;
   int ret = dwarf_child(*Parent, &RawChildDie, nullptr);
   if (ret == DW_DLV_OK)
-    Child = std::make_shared<DwarfDie>(Parent.DebugData, RawChildDie);
+    Child = DwarfDie(*Parent.DebugData, RawChildDie);
 }
 
 DwarfDieChildIterator &DwarfDieChildIterator::operator++() {
-  assert(Child && "Incremented end DwarfDieChildIterator");
-  if (Child) {
+  assert(!atEnd() && "Incremented end DwarfDieChildIterator");
+  if (!atEnd()) {
     Dwarf_Die RawChildDie;
-    int ret = dwarf_siblingof_b(Child->DebugData.get(), **Child, IsInfo,
+    int ret = dwarf_siblingof_b(**Child.DebugData, *Child, Child.isInfo(),
                                 &RawChildDie, nullptr);
     if (ret == DW_DLV_OK)
-      Child = std::make_shared<DwarfDie>(Child->DebugData, RawChildDie);
+      Child = DwarfDie(*Child.DebugData, RawChildDie);
     else
-      Child = nullptr;
+      Child = DwarfDie();
   }
   return *this;
 }
 
+// DwarfDieHandle methods.
+
+Dwarf_Half DwarfDieHandle::getTag() const {
+  return Abbrev ? Abbrev->Tag : getDie().getTag();
+}
+
+bool DwarfDieHandle::hasAttr(Dwarf_Half Attr) const {
+  return Abbrev ? Abbrev->findAttr(Attr) != nullptr : getDie().hasAttr(Attr);
+}
+
+DwarfDie DwarfDieHandle::getDie() const {
+  assert(DebugData && "Getting the Die of an empty handle");
+  if (Unit)
+    return DwarfDie(*DebugData, *Unit, Offset, *Abbrev);
+  Dwarf_Die RawDie = nullptr;
+  dwarf_offdie_b(**DebugData, Offset, IsInfo, &RawDie, nullptr);
+  return DwarfDie(*DebugData, RawDie, Abbrev);
+}
+
+// DwarfDieCursor methods.
+
+DwarfDieCursor::DwarfDieCursor(const DwarfDebugData &DbgData,
+                               const DwarfDie &UnitDie,
+                               const DwarfUnitHeader &UnitHeader)
+    : DebugData(DbgData), IsInfo(UnitDie.isInfo()), Header(UnitHeader),
+      Offset(UnitDie.getGlobalOffset()), Depth(1U), CurrentAbbrev(nullptr),
+      Abbrevs(nullptr), Unit(nullptr), Data(nullptr), Pos(0U), End(0U),
+      NextDepth(1U), SiblingPos(0U), BytesDecoded(0U), Failed(false),
+      PathAtEnd(false) {
+  const DwarfSectionData &Info = DebugData.getInfoSection(IsInfo);
+  if (Info.Data && Header.NextHeaderOffset <= Info.Size &&
+      Offset < Header.NextHeaderOffset &&
+      (Header.OffsetSize == 4U || Header.OffsetSize == 8U) &&
+      Header.AddressSize <= 8U) {
+    Abbrevs = DebugData.getAbbrevTable(Header);
+    Data = Abbrevs ? Info.Data : nullptr;
+    Pos = Offset;
+    End = Header.NextHeaderOffset;
+    if (Data && readEntry()) {
+      if (DebugData.isDecodingValues())
+        Unit = DebugData.getUnitContext(Header, IsInfo, Offset,
+                                        *CurrentAbbrev);
+      return;
+    }
+    Data = nullptr;
+    BytesDecoded = 0U;
+    Failed = false;
+  }
+
+  // Fall back to libdwarf.
+  Offset = UnitDie.getGlobalOffset();
+  Depth = 1U;
+  Path.push_back(getDie());
+}
+
+bool DwarfDieCursor::nextChild(unsigned ParentDepth) {
+  if (!Data)
+    return nextChildFromLibDwarf(ParentDepth);
+
+  while (NextDepth > ParentDepth) {
+    // None of the current Die's children have been read, so if they are not
+    // going to be visited skip them all with DW_AT_sibling.
+    if (NextDepth > ParentDepth + 1U && NextDepth == Depth + 1U &&
+        SiblingPos > Pos && SiblingPos <= End) {
+      Pos = SiblingPos;
+      NextDepth = Depth;
+      SiblingPos = 0U;
+      continue;
+    }
+    if (readEntry() && Depth == ParentDepth + 1U)
+      return true;
+  }
+  return false;
+}
+
+DwarfDieHandle DwarfDieCursor::getHandle() const {
+  return DwarfDieHandle(DebugData, Offset, IsInfo,
+                        Data ? CurrentAbbrev : nullptr, Unit);
+}
+
+bool DwarfDieCursor::readEntry() {
+  const uint8_t *Entry = Data + Pos;
+  uint64_t Code;
+  if (Pos >= End || !readULEB128(Entry, Data + End, Code)) {
+    Failed = Pos < End;
+    NextDepth = 0U;
+    return false;
+  }
+  Dwarf_Off EntryPos = Pos;
+  Pos = static_cast<Dwarf_Off>(Entry - Data);
+
+  // A null entry ends the list of children.
+  if (Code == 0U) {
+    --NextDepth;
+    BytesDecoded += Pos - EntryPos;
+    return false;
+  }
+
+  // Stop at anything that can't be decoded.
+  const DwarfAbbrev *EntryAbbrev = Abbrevs->find(Code);
+  if (!EntryAbbrev || EntryAbbrev->FixedSize > End - Pos) {
+    Failed = true;
+    NextDepth = 0U;
+    return false;
+  }
+
+  // The leading fixed size values are skipped in one go, then the rest are
+  // skipped one by one, except for runs of LEB128 numbers.
+  SiblingPos = 0U;
+  const DwarfAbbrevAttr *Sibling = EntryAbbrev->Sibling;
+  if (Sibling && Sibling < EntryAbbrev->Attrs + EntryAbbrev->FixedAttrCount)
+    SiblingPos = readReference(Sibling->Form, Pos + Sibling->Offset);
+  Pos += EntryAbbrev->FixedSize;
+  const DwarfAbbrevAttr *Attr = EntryAbbrev->Attrs;
+  const DwarfAbbrevAttr *AttrEnd = Attr + EntryAbbrev->AttrCount;
+  for (Attr += EntryAbbrev->FixedAttrCount; Attr != AttrEnd; ++Attr) {
+    if (Attr == Sibling)
+      SiblingPos = readReference(Attr->Form, Pos);
+    const uint8_t *Value = Data + Pos;
+    bool Skipped;
+    if (Attr->LEB128Run > 1U) {
+      Skipped = skipLEB128s(Value, Data + End, Attr->LEB128Run);
+      Attr += Attr->LEB128Run - 1U;
+    } else
+      Skipped = skipValue(Value, Data + End, Attr->Form, Header);
+    if (!Skipped) {
+      Failed = true;
+      NextDepth = 0U;
+      return false;
+    }
+    Pos = static_cast<Dwarf_Off>(Value - Data);
+  }
+
+  Offset = EntryPos;
+  Depth = NextDepth;
+  CurrentAbbrev = EntryAbbrev;
+  if (EntryAbbrev->HasChildren)
+    ++NextDepth;
+  BytesDecoded += Pos - EntryPos;
+  return true;
+}
+
+Dwarf_Off DwarfDieCursor::readReference(Dwarf_Half Form,
+                                        Dwarf_Off ValuePos) const {
+  int Size = getFormSize(Form, Header);
+  const uint8_t *Value = Data + ValuePos;
+  switch (Form) {
+  case DW_FORM_ref1:
+  case DW_FORM_ref2:
+  case DW_FORM_ref4:
+  case DW_FORM_ref8:
+    if (End - ValuePos < static_cast<unsigned>(Size))
+      return 0U;
+    return Header.HeaderOffset + readFixed(Value, static_cast<unsigned>(Size));
+  case DW_FORM_ref_udata: {
+    uint64_t UnitOffset;
+    if (!readULEB128(Value, Data + End, UnitOffset))
+      return 0U;
+    return Header.HeaderOffset + UnitOffset;
+  }
+  case DW_FORM_ref_addr:
+    if (End - ValuePos < static_cast<unsigned>(Size))
+      return 0U;
+    return readFixed(Value, static_cast<unsigned>(Size));
+  default:
+    return 0U;
+  }
+}
+
+bool DwarfDieCursor::nextChildFromLibDwarf(unsigned ParentDepth) {
+  if (Path.size() < ParentDepth || (Path.size() == ParentDepth && PathAtEnd))
+    return false;
+  // Leave whatever is left of the subtree of the parent's current child.
+  while (Path.size() > ParentDepth + 1U) {
+    Path.pop_back();
+    PathAtEnd = false;
+  }
+
+  Dwarf_Die RawDie;
+  if (Path.size() == ParentDepth) {
+    if (dwarf_child(*Path.back(), &RawDie, nullptr) != DW_DLV_OK) {
+      PathAtEnd = true;
+      return false;
+    }
+    Path.emplace_back(DebugData, RawDie);
+  } else {
+    if (dwarf_siblingof_b(*DebugData, *Path.back(), IsInfo, &RawDie,
+                          nullptr) != DW_DLV_OK) {
+      Path.pop_back();
+      PathAtEnd = true;
+      return false;
+    }
+    Path.back() = DwarfDie(DebugData, RawDie);
+  }
+  PathAtEnd = false;
+  Depth = static_cast<unsigned>(Path.size());
+  Offset = Path.back().getGlobalOffset();
+  return true;
+}
+
 // DwarfAttrValue methods.
 
 DwarfAttrValue::DwarfAttrValue() : Kind(DwarfAttrValueKind::Empty) {}
@@ -373,6 +1674,9 @@ DwarfAttrValue::DwarfAttrValue(const DwarfAttrValue &Other) {
   case DwarfAttrValueKind::String:
     new (&Value.String) std::string(Other.Value.String);
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   }
 }
 
@@ -407,6 +1711,9 @@ DwarfAttrValue::DwarfAttrValue(DwarfAttrValue &&Other) {
   case DwarfAttrValueKind::String:
     new (&Value.String) std::string(std::move(Other.Value.String));
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   }
 }
 
@@ -443,6 +1750,9 @@ DwarfAttrValue &DwarfAttrValue::operator=(const DwarfAttrValue &Other) {
   case DwarfAttrValueKind::String:
     new (&Value.String) std::string(Other.Value.String);
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   }
   return *this;
 }
@@ -480,6 +1790,9 @@ DwarfAttrValue &DwarfAttrValue::operator=(DwarfAttrValue &&Other) {
   case DwarfAttrValueKind::String:
     new (&Value.String) std::string(std::move(Other.Value.String));
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   }
   return *this;
 }
@@ -524,6 +1837,11 @@ const std::string &DwarfAttrValue::getString() const {
   return Value.String;
 }
 
+Dwarf_Unsigned DwarfAttrValue::getSignature() const {
+  assert(Kind == DwarfAttrValueKind::Signature);
+  return Value.Signature;
+}
+
 DwarfAttrValue::DwarfAttrValue(Dwarf_Half ValForm)
     : Kind(DwarfAttrValueKind::UnknownForm), Form(ValForm) {}
 
@@ -555,6 +1873,7 @@ DwarfAttrValue::DwarfAttrValue(std::vector<uint8_t> &&Val,
   case DwarfAttrValueKind::Unsigned:
   case DwarfAttrValueKind::Signed:
   case DwarfAttrValueKind::String:
+  case DwarfAttrValueKind::Signature:
     assert(false && "Bad DwarfAttrValueKind");
   }
 }
@@ -577,6 +1896,9 @@ DwarfAttrValue::DwarfAttrValue(Dwarf_Unsigned Val, DwarfAttrValueKind ValKind,
   case DwarfAttrValueKind::Unsigned:
     Value.Unsigned = Val;
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Val;
+    break;
   case DwarfAttrValueKind::Empty:
   case DwarfAttrValueKind::UnknownForm:
   case DwarfAttrValueKind::Boolean:
@@ -597,6 +1919,7 @@ void DwarfAttrValue::destroyValue() {
   case DwarfAttrValueKind::Boolean:
   case DwarfAttrValueKind::Unsigned:
   case DwarfAttrValueKind::Signed:
+  case DwarfAttrValueKind::Signature:
     break;
   case DwarfAttrValueKind::Bytes:
     Value.Bytes.~vector();
@@ -668,6 +1991,55 @@ DwarfLineEntry DwarfLineTable::getLine(size_t LineIndex) const {
   return Result;
 }
 
+void DwarfLineTable::getRows(std::vector<DwarfLineRow> &Rows) const {
+  Rows.reserve(Rows.size() + LineCount);
+  for (size_t LineIndex = 0; LineIndex < LineCount; ++LineIndex) {
+    DwarfLineEntry Line = getLine(LineIndex);
+    DwarfLineRow Row{Line.LineAddr, static_cast<uint32_t>(Line.LineNo),
+                     static_cast<uint32_t>(Line.SrcFileID),
+                     static_cast<uint32_t>(Line.Discriminator), 0U};
+    if (Line.IsBeginStatement)
+      Row.Flags |= DwarfLineRow::IsBeginStatement;
+    if (Line.IsEndSequence)
+      Row.Flags |= DwarfLineRow::IsEndSequence;
+    if (Line.IsBeginBlock)
+      Row.Flags |= DwarfLineRow::IsBeginBlock;
+    if (Line.IsPrologEnd)
+      Row.Flags |= DwarfLineRow::IsPrologEnd;
+    if (Line.IsEpilogueBegin)
+      Row.Flags |= DwarfLineRow::IsEpilogueBegin;
+    Rows.push_back(Row);
+  }
+}
+
+bool DwarfLineTable::decodeRows(const DwarfSectionData &Section,
+                                Dwarf_Off Offset,
+                                std::vector<DwarfLineRow> &Rows) {
+  Rows.clear();
+  if (!Section.Data || Offset >= Section.Size || Section.Size - Offset < 4U)
+    return false;
+  const uint8_t *Data = Section.Data + Offset;
+  const uint8_t *End = Section.Data + Section.Size;
+
+  // The unit length, which is followed by a 64-bit length in 64-bit DWARF.
+  unsigned OffsetSize = 4U;
+  uint64_t Length = readFixed(Data, 4U);
+  Data += 4;
+  if (Length == 0xffffffffU) {
+    if (End - Data < 8)
+      return false;
+    OffsetSize = 8U;
+    Length = readFixed(Data, 8U);
+    Data += 8;
+  }
+  if (Length > static_cast<uint64_t>(End - Data) ||
+      !decodeLineProgram(Data, Data + Length, OffsetSize, Rows)) {
+    Rows.clear();
+    return false;
+  }
+  return true;
+}
+
 void DwarfLineTable::freeLines() {
   if (Context)
     dwarf_srclines_dealloc_b(Context);
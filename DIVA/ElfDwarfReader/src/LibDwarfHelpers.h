@@ -46,9 +46,13 @@
 #endif
 
 #include <assert.h>
+#include <cstdint>
 #include <exception>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace ElfDwarfReader {
@@ -57,11 +61,106 @@ std::string getDwarfTagAsString(Dwarf_Half Tag);
 std::string getDwarfAttrAsString(Dwarf_Half Attr);
 std::string getDwarfFormAsString(Dwarf_Half Form);
 
+struct DwarfUnitHeader;
+struct DwarfUnitContext;
 struct DwarfCompileUnit;
+struct DwarfTypeUnit;
 class DwarfDie;
 class DwarfDieChildIterator;
+class DwarfDieHandle;
+class DwarfDieCursor;
 class DwarfAttrValue;
 class DwarfLineTable;
+struct DwarfLineRow;
+
+/// \brief A range of code addresses, from Low up to but not including High.
+struct DwarfAddressRange {
+  Dwarf_Addr Low;
+  Dwarf_Addr High;
+};
+
+/// \brief An entry of .debug_aranges, giving the compile unit that covers a
+/// range of code addresses.
+struct DwarfArange {
+  DwarfAddressRange Range;
+  Dwarf_Off CUDieOffset;
+};
+
+/// \brief The bytes of a section in the file the debug data was read from.
+struct DwarfSectionData {
+  const uint8_t *Data = nullptr;
+  size_t Size = 0U;
+};
+
+/// \brief An attribute of a DwarfAbbrev.
+struct DwarfAbbrevAttr {
+  Dwarf_Half Attr;
+  Dwarf_Half Form;
+  /// The size of the value, or -1 if the value gives its own size.
+  int Size;
+  /// The offset of the value from the end of the abbreviation code. Only set
+  /// for the attributes before the first one without a fixed size.
+  unsigned Offset;
+  /// The value of a DW_FORM_implicit_const.
+  Dwarf_Signed ImplicitConst;
+  /// The number of LEB128 values from this one on, before any other value
+  /// or the sibling. 0 for the leading fixed size values.
+  unsigned LEB128Run;
+};
+
+/// \brief An abbreviation of a DwarfAbbrevTable.
+struct DwarfAbbrev {
+  /// The tag, 0 for codes with no abbreviation.
+  Dwarf_Half Tag = 0U;
+  bool HasChildren = false;
+  /// The attributes, where the first FixedAttrCount of them have fixed size
+  /// values that add up to FixedSize bytes.
+  const DwarfAbbrevAttr *Attrs = nullptr;
+  unsigned AttrCount = 0U;
+  unsigned FixedAttrCount = 0U;
+  unsigned FixedSize = 0U;
+  /// The DW_AT_sibling attribute, if there is one.
+  const DwarfAbbrevAttr *Sibling = nullptr;
+
+  /// \brief Find Attr, returns nullptr if Dies with this abbreviation don't
+  /// have it.
+  const DwarfAbbrevAttr *findAttr(Dwarf_Half Attr) const;
+};
+
+/// \brief An abbreviation table compiled for decoding Dies.
+///
+/// libdwarf decodes the attributes and forms of an abbreviation again for
+/// every attribute it looks up, and keeps a copy of the table for each unit.
+/// A compiled table is a flat array of attributes with the size of each form
+/// and the offsets of the leading fixed size values worked out once, and is
+/// shared by all the units using the table (see
+/// DwarfDebugData::getAbbrevTable()).
+class DwarfAbbrevTable {
+public:
+  DwarfAbbrevTable() = default;
+
+  DwarfAbbrevTable(const DwarfAbbrevTable &) = delete;
+  DwarfAbbrevTable &operator=(const DwarfAbbrevTable &) = delete;
+
+  /// \brief Compile the table at Header.AbbrevOffset in Section, for units
+  /// with Header's version and sizes. Returns false if the table can't be
+  /// read or uses a form whose size is unknown.
+  bool compile(const DwarfSectionData &Section, const DwarfUnitHeader &Header);
+
+  /// \brief Get the abbreviation with Code, or nullptr if there is none.
+  const DwarfAbbrev *find(uint64_t Code) const {
+    return Code < Abbrevs.size() && Abbrevs[Code].Tag != 0U ? &Abbrevs[Code]
+                                                            : nullptr;
+  }
+
+  /// \brief Return true if any attribute of the abbreviations has Form.
+  bool usesForm(Dwarf_Half Form) const;
+
+private:
+  // The abbreviations indexed by code, pointing into Attrs.
+  std::vector<DwarfAbbrev> Abbrevs;
+  std::vector<DwarfAbbrevAttr> Attrs;
+};
 
 /// \brief Exception wrapping a LibDwarf error code.
 class LibDwarfError : public std::exception {
@@ -79,6 +178,11 @@ private:
 };
 
 /// \brief Wrapper around a Dwarf_Debug with resource management.
+///
+/// The libdwarf error handler is given the address of Dbg when the debug data
+/// is created, and the libdwarf this is built with can't change it. So debug
+/// data that is read after being moved reports its errors through the object
+/// it was moved from. Create it where it is used instead.
 class DwarfDebugData {
 public:
   DwarfDebugData() : Dbg(nullptr) {}
@@ -99,18 +203,119 @@ public:
   /// \brief Get the wrapped Dwarf_Debug instance.
   Dwarf_Debug operator*() const { return Dbg; }
 
-  /// \brief Get all the compile units in the debug data.
-  std::vector<DwarfCompileUnit> getCompileUnits() const;
+  /// \brief Selects the compile units to read by the DW_AT_name and
+  /// DW_AT_comp_dir of their unit Die, either of which may be empty.
+  typedef std::function<bool(const std::string &Name,
+                             const std::string &CompDir)>
+      CompileUnitFilter;
+
+  /// \brief Get all the compile units in the debug data, or only those that
+  /// Select returns true for.
+  ///
+  /// Nothing but the unit Die of a compile unit that isn't selected is read,
+  /// so the Dies of its body, its abbreviations and its line table are
+  /// skipped entirely.
+  std::vector<DwarfCompileUnit>
+  getCompileUnits(const CompileUnitFilter &Select = nullptr) const;
+
+  /// \brief Get all the type units in the debug data.
+  ///
+  /// This includes both DWARF 4 .debug_types units and DWARF 5 DW_UT_type
+  /// units in .debug_info.
+  std::vector<DwarfTypeUnit> getTypeUnits() const;
+
+  /// \brief Get the entries of .debug_aranges, if there is one.
+  std::vector<DwarfArange> getAranges() const;
+
+  /// \brief Give the contents of the file the debug data was read from, so
+  /// that a DwarfDieCursor can decode the Dies from the section bytes.
+  ///
+  /// The data must outlive this object. Without it, or if the debug sections
+  /// are compressed, the cursors fall back to libdwarf. If DecodeValues is
+  /// set, the attribute values of the Dies the cursors walk are decoded from
+  /// the bytes too (see isDecodingValues()).
+  void setFileData(const char *FileData, size_t FileSize,
+                   bool DecodeValues = false);
+
+  /// \brief Return true if the attribute values of the Dies walked by a
+  /// DwarfDieCursor are decoded from the section bytes rather than by
+  /// libdwarf.
+  ///
+  /// This needs the relocations of the debug sections in an object file to
+  /// be applied, which is only done for the RELA relocations of x86, x86-64
+  /// and AArch64. Forms the decoder doesn't read are still left to libdwarf.
+  bool isDecodingValues() const { return DecodingValues; }
+
+  /// \brief Get the bytes of .debug_info, or .debug_types if IsInfo is false.
+  const DwarfSectionData &getInfoSection(bool IsInfo) const {
+    return IsInfo ? InfoSection : TypesSection;
+  }
+  /// \brief Get the bytes of .debug_abbrev.
+  const DwarfSectionData &getAbbrevSection() const { return AbbrevSection; }
+  /// \brief Get the bytes of .debug_str.
+  const DwarfSectionData &getStrSection() const { return StrSection; }
+  /// \brief Get the bytes of .debug_line.
+  const DwarfSectionData &getLineSection() const { return LineSection; }
+  /// \brief Get the bytes of .debug_str_offsets.
+  const DwarfSectionData &getStrOffsetsSection() const {
+    return StrOffsetsSection;
+  }
+
+  /// \brief Get the compiled abbreviation table of the unit with Header, or
+  /// nullptr if it can't be compiled.
+  ///
+  /// Each table is compiled once and shared by the units that use it.
+  const DwarfAbbrevTable *getAbbrevTable(const DwarfUnitHeader &Header) const;
+
+  /// \brief Get what is needed to decode the attribute values of the Dies of
+  /// the unit with Header, whose unit Die is at UnitOffset with UnitAbbrev.
+  ///
+  /// Each context is created once and lives as long as this object.
+  const DwarfUnitContext *getUnitContext(const DwarfUnitHeader &Header,
+                                         bool IsInfo, Dwarf_Off UnitOffset,
+                                         const DwarfAbbrev &UnitAbbrev) const;
 
   /// \brief Return a copy of a libdwarf c string and then free the libdwarf
   /// memory.
   std::string copyAndFreeDwarfString(char *DwarfStr) const;
 
 private:
+  // Read the unit headers of one section, adding each unit to CompileUnits or
+  // TypeUnits depending on its unit type. Either may be null to skip those
+  // units, and the compile units Select (if any) returns false for are
+  // skipped too.
+  void readUnits(bool IsInfo, std::vector<DwarfCompileUnit> *CompileUnits,
+                 std::vector<DwarfTypeUnit> *TypeUnits,
+                 const CompileUnitFilter &Select = nullptr) const;
+
   // Free Dbg and set it to nullptr.
   void freeDbg();
 
   Dwarf_Debug Dbg;
+
+  DwarfSectionData InfoSection;
+  DwarfSectionData TypesSection;
+  DwarfSectionData AbbrevSection;
+  DwarfSectionData StrSection;
+  DwarfSectionData StrOffsetsSection;
+  DwarfSectionData LineSection;
+  bool DecodingValues = false;
+
+  // The relocated copies of sections in object files, which the section data
+  // above points to instead of the file.
+  std::vector<std::vector<uint8_t>> RelocatedSections;
+
+  // The compiled abbreviation tables, by offset and then the address size,
+  // offset size and whether the version is 2, which change the form sizes.
+  // Tables that can't be compiled are kept as nullptr.
+  mutable std::map<std::tuple<Dwarf_Off, Dwarf_Half, Dwarf_Half, bool>,
+                   std::unique_ptr<DwarfAbbrevTable>>
+      AbbrevTables;
+
+  // The unit contexts, by section and header offset.
+  mutable std::map<std::pair<bool, Dwarf_Off>,
+                   std::unique_ptr<DwarfUnitContext>>
+      UnitContexts;
 };
 
 /// \brief Wrapper around a Dwarf_Die with resource management.
@@ -118,8 +323,26 @@ class DwarfDie {
 public:
   friend class DwarfDieChildIterator;
 
-  explicit DwarfDie(const DwarfDebugData &DbgData, Dwarf_Die RawDie)
-      : DebugData(DbgData), Die(RawDie) {}
+  /// \brief Create an empty DwarfDie.
+  DwarfDie()
+      : DebugData(nullptr), Die(nullptr), Abbrev(nullptr), Unit(nullptr),
+        Offset(0U) {}
+  /// \brief Wrap RawDie. If the Die's abbreviation is given, it is used to
+  /// answer for the tag and the attributes the Die doesn't have.
+  explicit DwarfDie(const DwarfDebugData &DbgData, Dwarf_Die RawDie,
+                    const DwarfAbbrev *DieAbbrev = nullptr)
+      : DebugData(&DbgData), Die(RawDie), Abbrev(DieAbbrev), Unit(nullptr),
+        Offset(0U) {}
+  /// \brief Refer to the Die at DieOffset in the unit with UnitContext,
+  /// decoding its attribute values from the section bytes.
+  ///
+  /// The libdwarf Die is only created if something the decoder doesn't
+  /// support is asked for, such as a form it doesn't read or the children.
+  explicit DwarfDie(const DwarfDebugData &DbgData,
+                    const DwarfUnitContext &UnitContext, Dwarf_Off DieOffset,
+                    const DwarfAbbrev &DieAbbrev)
+      : DebugData(&DbgData), Die(nullptr), Abbrev(&DieAbbrev),
+        Unit(&UnitContext), Offset(DieOffset) {}
   DwarfDie(DwarfDie &&Other);
   ~DwarfDie() { freeDie(); }
 
@@ -129,14 +352,21 @@ public:
   DwarfDie &operator=(const DwarfDie &) = delete;
 
   /// \brief get the wrapped Dwarf_Die instance.
-  Dwarf_Die get() const { return Die; }
+  Dwarf_Die get() const {
+    if (!Die && Unit)
+      createDie();
+    return Die;
+  }
   /// \brief get the wrapped Dwarf_Die instance.
-  Dwarf_Die operator*() const { return Die; }
+  Dwarf_Die operator*() const { return get(); }
 
   DwarfDieChildIterator childrenBegin() const;
   static DwarfDieChildIterator childrenEnd();
 
   Dwarf_Off getGlobalOffset() const;
+  /// \brief Return true if the Die is in .debug_info rather than
+  /// .debug_types.
+  bool isInfo() const;
   std::string getName() const;
   Dwarf_Half getTag() const;
   std::string getTagName() const;
@@ -145,30 +375,93 @@ public:
   bool hasAttr(Dwarf_Half Attr) const;
   DwarfAttrValue getAttr(Dwarf_Half Attr) const;
 
+  /// \brief Get the DW_AT_low_pc of the Die. Returns false if it has none.
+  bool getLowPC(Dwarf_Addr &LowPC) const;
+
+  /// \brief Get the code covered by the Die, from DW_AT_low_pc and
+  /// DW_AT_high_pc or from DW_AT_ranges. BaseAddress is the base of the
+  /// DW_AT_ranges entries, the DW_AT_low_pc of the compile unit.
+  std::vector<DwarfAddressRange> getAddressRanges(Dwarf_Addr BaseAddress) const;
+
   /// \brief get the line table. Only valid for compile units.
   DwarfLineTable getLineTable() const;
 
+  /// \brief Replace Rows with the rows of the line table. Only valid for
+  /// compile units.
+  ///
+  /// With DwarfDebugData::isDecodingValues() the rows are decoded from
+  /// .debug_line in one pass, otherwise they are read from a DwarfLineTable.
+  void getLineRows(std::vector<DwarfLineRow> &Rows) const;
+
 private:
+  // Create the libdwarf Die of a Die decoded from the section bytes.
+  void createDie() const;
   // Free Die and set it to nullptr.
   void freeDie();
 
-  const DwarfDebugData &DebugData;
-  Dwarf_Die Die;
+  // Get the DW_AT_high_pc of a Die with LowPC. Returns false if it has none.
+  bool getHighPC(Dwarf_Addr LowPC, Dwarf_Addr &HighPC) const;
+
+  // Decode the value of AbbrevAttr from the section bytes. Returns false if
+  // it has to be read by libdwarf.
+  bool decodeAttr(const DwarfAbbrevAttr &AbbrevAttr,
+                  DwarfAttrValue &Result) const;
+
+  const DwarfDebugData *DebugData;
+  mutable Dwarf_Die Die;
+  const DwarfAbbrev *Abbrev;
+
+  // Where a Die decoded from the section bytes is.
+  const DwarfUnitContext *Unit;
+  Dwarf_Off Offset;
+};
+
+/// \brief The fields of a unit header needed to decode the unit's Dies.
+struct DwarfUnitHeader {
+  Dwarf_Off HeaderOffset = 0U;
+  Dwarf_Off NextHeaderOffset = 0U;
+  /// The offset of the unit's abbreviation table in .debug_abbrev.
+  Dwarf_Off AbbrevOffset = 0U;
+  Dwarf_Half Version = 0U;
+  Dwarf_Half AddressSize = 0U;
+  /// 4 for 32-bit DWARF, 8 for 64-bit DWARF.
+  Dwarf_Half OffsetSize = 0U;
+};
+
+/// \brief What is needed to decode the attribute values of a unit's Dies from
+/// the section bytes.
+struct DwarfUnitContext {
+  DwarfUnitHeader Header;
+  bool IsInfo = true;
+  /// The unit's DW_AT_str_offsets_base, or 0 if it has none.
+  Dwarf_Off StrOffsetsBase = 0U;
 };
 
 /// \brief Container for the CU Die and its metadata.
-struct DwarfCompileUnit {
+struct DwarfCompileUnit : DwarfUnitHeader {
   DwarfCompileUnit(DwarfDie &&CompileUnitDie)
-      : CUDie(std::move(CompileUnitDie)), HeaderOffset(0), NextHeaderOffset(0) {
-  }
+      : CUDie(std::move(CompileUnitDie)) {}
   DwarfDie CUDie;
-  Dwarf_Off HeaderOffset;
-  Dwarf_Off NextHeaderOffset;
+};
+
+/// \brief Container for a type unit Die and its metadata.
+///
+/// Global offsets of Dies in .debug_types overlap with those in .debug_info,
+/// so type units must be identified by Signature rather than by offset.
+struct DwarfTypeUnit : DwarfUnitHeader {
+  DwarfTypeUnit(DwarfDie &&TypeUnitDie)
+      : TUDie(std::move(TypeUnitDie)), Signature(0), TypeOffset(0) {}
+  DwarfDie TUDie;
+  /// The 8 byte type signature, read as a little endian number.
+  Dwarf_Unsigned Signature;
+  /// The global offset of the Die for the type this unit defines.
+  Dwarf_Off TypeOffset;
 };
 
 /// \brief Access all a DIE's children in sequence.
 ///
-/// Typical usage:
+/// The iterator holds the current child itself, so it can be moved but not
+/// copied. Typical usage:
 /// \code
 ///   for (auto IT = Die.childrenBegin(), End = Die.childrenEnd();
 ///        IT != End; ++IT) {
@@ -181,12 +474,15 @@ public:
   DwarfDieChildIterator() = default;
   DwarfDieChildIterator(const DwarfDie &Parent);
 
-  const DwarfDie &operator*() const { return *Child; }
-  const DwarfDie *operator->() const { return Child.get(); }
+  DwarfDieChildIterator(DwarfDieChildIterator &&) = default;
+  DwarfDieChildIterator &operator=(DwarfDieChildIterator &&) = default;
+
+  const DwarfDie &operator*() const { return Child; }
+  const DwarfDie *operator->() const { return &Child; }
 
   friend bool operator==(const DwarfDieChildIterator &a,
                          const DwarfDieChildIterator &b) {
-    return a.Child == b.Child;
+    return a.Child.get() == b.Child.get();
   }
   friend bool operator!=(const DwarfDieChildIterator &a,
                          const DwarfDieChildIterator &b) {
@@ -196,10 +492,160 @@ public:
   DwarfDieChildIterator &operator++();
   void operator++(int) { ++(*this); }
 
-  bool atEnd() const { return Child == nullptr; }
+  bool atEnd() const { return Child.get() == nullptr; }
 
 private:
-  std::shared_ptr<DwarfDie> Child;
+  DwarfDie Child;
+};
+
+/// \brief A lightweight reference to a Die, for walking the Dies without
+/// allocating.
+///
+/// A handle is the Die's offset, its section and its abbreviation, so it can
+/// be copied freely and kept on the stack. The tag and which attributes the
+/// Die has are answered from the abbreviation. The libdwarf Die, which has to
+/// be allocated, is only created by getDie(), for reading attribute values or
+/// keeping the Die beyond the walk. Handles without an abbreviation (from a
+/// DwarfDieCursor falling back to libdwarf) create the Die for everything.
+/// Handles with a unit context give Dies that decode their attribute values
+/// from the section bytes instead.
+class DwarfDieHandle {
+public:
+  DwarfDieHandle() = default;
+  DwarfDieHandle(const DwarfDebugData &DbgData, Dwarf_Off DieOffset,
+                 bool InfoSection, const DwarfAbbrev *DieAbbrev,
+                 const DwarfUnitContext *UnitContext = nullptr)
+      : DebugData(&DbgData), Offset(DieOffset), IsInfo(InfoSection),
+        Abbrev(DieAbbrev), Unit(UnitContext) {}
+
+  bool empty() const { return DebugData == nullptr; }
+
+  /// \brief The global offset of the Die.
+  Dwarf_Off getOffset() const { return Offset; }
+  /// \brief The abbreviation of the Die, if known.
+  const DwarfAbbrev *getAbbrev() const { return Abbrev; }
+
+  Dwarf_Half getTag() const;
+  bool hasAttr(Dwarf_Half Attr) const;
+
+  /// \brief Get the Die, creating the libdwarf Die unless it has a unit
+  /// context.
+  DwarfDie getDie() const;
+
+private:
+  const DwarfDebugData *DebugData = nullptr;
+  Dwarf_Off Offset = 0U;
+  bool IsInfo = true;
+  const DwarfAbbrev *Abbrev = nullptr;
+  const DwarfUnitContext *Unit = nullptr;
+};
+
+/// \brief Walks the Dies of a unit in a single pass.
+///
+/// Moving to the next sibling of a Die with children but no DW_AT_sibling
+/// makes libdwarf decode all the Die's descendants again, so walking a tree
+/// with DwarfDieChildIterator decodes each Die once for every level above it.
+/// The cursor instead decodes the section bytes itself, in order, and each
+/// child is read from where the previous child's subtree ended. The children
+/// of a Die that are not visited are skipped using DW_AT_sibling when there
+/// is one.
+///
+/// Typical usage, where visit() only uses the cursor this way:
+/// \code
+///   void visit(DwarfDieCursor &Cursor) {
+///     DwarfDie Die = Cursor.getDie();
+///     // ...
+///     unsigned Depth = Cursor.getDepth();
+///     while (Cursor.nextChild(Depth))
+///       visit(Cursor);
+///   }
+/// \endcode
+///
+/// The entries are decoded with the unit's compiled DwarfAbbrevTable. Without
+/// the section bytes, or if the table can't be compiled, the cursor uses
+/// libdwarf to move between the Dies. When the debug data is decoding values,
+/// the Dies the cursor gives decode their attribute values too.
+class DwarfDieCursor {
+public:
+  /// \brief Create a cursor positioned on UnitDie, at depth 1.
+  DwarfDieCursor(const DwarfDebugData &DbgData, const DwarfDie &UnitDie,
+                 const DwarfUnitHeader &Header);
+
+  /// \brief Move to the next child of the Die at ParentDepth that encloses
+  /// the cursor, skipping what is left of the current Die's subtree. Returns
+  /// false, leaving the cursor after the last child, if there are no more.
+  bool nextChild(unsigned ParentDepth);
+
+  /// \brief The depth of the current Die, 1 for the unit Die.
+  unsigned getDepth() const { return Depth; }
+
+  /// \brief The global offset of the current Die.
+  Dwarf_Off getOffset() const { return Offset; }
+
+  /// \brief The tag of the current Die.
+  Dwarf_Half getTag() const {
+    return Data ? CurrentAbbrev->Tag : Path.back().getTag();
+  }
+
+  /// \brief Get a handle to the current Die, which doesn't allocate.
+  DwarfDieHandle getHandle() const;
+
+  /// \brief Get the current Die, along with its abbreviation.
+  DwarfDie getDie() const { return getHandle().getDie(); }
+
+  /// \brief The number of bytes of the unit decoded by the cursor so far.
+  ///
+  /// A walk of the whole unit decodes each byte once, so it ends with the
+  /// size of the unit's Dies. Always 0 when falling back to libdwarf.
+  uint64_t getBytesDecoded() const { return BytesDecoded; }
+
+  /// \brief Return true if the cursor is decoding the section bytes, rather
+  /// than falling back to libdwarf.
+  bool isDecoding() const { return Data != nullptr; }
+
+  /// \brief Return true if the cursor stopped at an entry it couldn't decode,
+  /// so the rest of the unit was not visited.
+  bool hasFailed() const { return Failed; }
+
+private:
+  // Decode the entry at Pos and move past it. Returns false for a null entry
+  // or the end of the unit, and sets Failed for an entry that can't be
+  // decoded.
+  bool readEntry();
+
+  // Get the reference value of Form at ValuePos as a global offset.
+  Dwarf_Off readReference(Dwarf_Half Form, Dwarf_Off ValuePos) const;
+
+  // Move to the next child in the libdwarf fallback.
+  bool nextChildFromLibDwarf(unsigned ParentDepth);
+
+  const DwarfDebugData &DebugData;
+  bool IsInfo;
+  DwarfUnitHeader Header;
+
+  // The current Die.
+  Dwarf_Off Offset;
+  unsigned Depth;
+  const DwarfAbbrev *CurrentAbbrev;
+
+  // Decoding state: the unit's abbreviations, its context if the values are
+  // decoded too, the bytes of the unit's section, the position of the next
+  // entry and its depth, and where the current Die's next sibling is if it
+  // has a DW_AT_sibling (otherwise 0).
+  const DwarfAbbrevTable *Abbrevs;
+  const DwarfUnitContext *Unit;
+  const uint8_t *Data;
+  Dwarf_Off Pos;
+  Dwarf_Off End;
+  unsigned NextDepth;
+  Dwarf_Off SiblingPos;
+  uint64_t BytesDecoded;
+  bool Failed;
+
+  // Fallback state: the Dies from the unit down to the current one, and true
+  // if the children of the last of them have all been visited.
+  std::vector<DwarfDie> Path;
+  bool PathAtEnd;
 };
 
 /// \brief the kind of an attribute value.
@@ -214,6 +660,7 @@ enum class DwarfAttrValueKind {
   Bytes,
   Exprloc,
   String,
+  Signature,
 };
 
 /// \brief Discriminated union for the values of DWARF attributes.
@@ -246,6 +693,7 @@ public:
   const std::vector<uint8_t> &getBytes() const;
   const std::vector<uint8_t> &getExprloc() const;
   const std::string &getString() const;
+  Dwarf_Unsigned getSignature() const;
 
 private:
   friend class DwarfDie;
@@ -255,7 +703,7 @@ private:
   explicit DwarfAttrValue(Dwarf_Signed Val, Dwarf_Half Form);
   explicit DwarfAttrValue(std::string &&Val, Dwarf_Half Form);
 
-  // Reference, Address and Unsigned have the same underlying type.
+  // Reference, Address, Unsigned and Signature have the same underlying type.
   explicit DwarfAttrValue(Dwarf_Unsigned Val, DwarfAttrValueKind ValKind,
                           Dwarf_Half Form);
 
@@ -274,6 +722,7 @@ private:
     std::vector<uint8_t> Bytes;
     std::vector<uint8_t> Exprloc;
     std::string String;
+    Dwarf_Unsigned Signature;
 
     ValueUnion() {}
     ~ValueUnion() {}
@@ -298,6 +747,25 @@ struct DwarfLineEntry {
   Dwarf_Unsigned Discriminator;
 };
 
+/// \brief A row of a line table, packed so that whole tables are decoded into
+/// an array.
+struct DwarfLineRow {
+  /// The flags of a row.
+  enum : uint8_t {
+    IsBeginStatement = 1U << 0,
+    IsEndSequence = 1U << 1,
+    IsBeginBlock = 1U << 2,
+    IsPrologEnd = 1U << 3,
+    IsEpilogueBegin = 1U << 4,
+  };
+
+  Dwarf_Addr LineAddr;
+  uint32_t LineNo;
+  uint32_t SrcFileID;
+  uint32_t Discriminator;
+  uint8_t Flags;
+};
+
 /// Wrapper around a line table with memory management.
 class DwarfLineTable {
 public:
@@ -324,6 +792,18 @@ public:
     return getLine(LineIndex);
   }
 
+  /// \brief Append the rows of the table to Rows.
+  void getRows(std::vector<DwarfLineRow> &Rows) const;
+
+  /// \brief Run the line number program at Offset in Section, the bytes of
+  /// .debug_line, replacing Rows with the rows it makes. Returns false and
+  /// leaves Rows empty if the program can't be decoded.
+  ///
+  /// Versions 2 to 5 are decoded, with any number of sequences. Only Rows
+  /// is allocated, so reusing it between tables keeps its capacity.
+  static bool decodeRows(const DwarfSectionData &Section, Dwarf_Off Offset,
+                         std::vector<DwarfLineRow> &Rows);
+
 private:
   // Free lines and reset values to null/zero.
   void freeLines();
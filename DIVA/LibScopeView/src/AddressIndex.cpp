@@ -0,0 +1,215 @@
+//===-- LibScopeView/AddressIndex.cpp ---------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Index from code addresses to the scopes and lines of a scope tree.
+///
+//===----------------------------------------------------------------------===//
+
+#include "AddressIndex.h"
+#include "Line.h"
+#include "Scope.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace LibScopeView;
+
+namespace {
+
+// An address range of a scope and its depth below the compile unit.
+struct Interval {
+  Dwarf_Addr Low;
+  Dwarf_Addr High;
+  size_t Depth;
+  const Scope *Owner;
+};
+
+void collectIntervals(const Scope *Scp, size_t Depth,
+                      std::vector<Interval> &Intervals,
+                      std::vector<const Line *> &Lines) {
+  for (const AddressRange &Range : Scp->getAddressRanges())
+    if (Range.Low < Range.High)
+      Intervals.push_back({Range.Low, Range.High, Depth, Scp});
+  for (const Line *Ln : Scp->getLines())
+    if (Ln->getIsLineRecord())
+      Lines.push_back(Ln);
+  for (const Scope *Child : Scp->getScopes())
+    collectIntervals(Child, Depth + 1, Intervals, Lines);
+}
+
+} // namespace
+
+AddressIndex::AddressIndex(const Scope *Root) {
+  if (!Root)
+    return;
+
+  // Collect each compile unit on its own thread.
+  const ChildSpan<Scope> Units(Root->getScopes());
+  std::vector<std::vector<Segment>> UnitSegments(Units.size());
+  UnitRows.resize(Units.size());
+  parallelFor(Units.size(), [&](size_t Index) {
+    collect(Units[Index], static_cast<uint32_t>(Index), UnitSegments[Index],
+            UnitRows[Index]);
+  });
+
+  // Merge the units. Their ranges only overlap in relocatable objects, where
+  // the code of each section starts at 0, and the unit whose range starts
+  // first keeps the overlapping addresses.
+  std::vector<Segment> All;
+  for (const std::vector<Segment> &Segs : UnitSegments)
+    All.insert(All.end(), Segs.begin(), Segs.end());
+  std::stable_sort(All.begin(), All.end(),
+                   [](const Segment &A, const Segment &B) {
+                     return A.Low < B.Low;
+                   });
+  Segments.reserve(All.size());
+  for (Segment Seg : All) {
+    if (!Segments.empty() && Seg.Low < Segments.back().High)
+      Seg.Low = Segments.back().High;
+    if (Seg.Low < Seg.High)
+      Segments.push_back(Seg);
+  }
+}
+
+void AddressIndex::collect(const Scope *Unit, uint32_t UnitIndex,
+                           std::vector<Segment> &UnitSegments,
+                           std::vector<Row> &Rows) {
+  std::vector<Interval> Intervals;
+  std::vector<const Line *> Lines;
+  collectIntervals(Unit, 0, Intervals, Lines);
+
+  // Outer scopes come before the scopes nested in them.
+  std::sort(Intervals.begin(), Intervals.end(),
+            [](const Interval &A, const Interval &B) {
+              if (A.Low != B.Low)
+                return A.Low < B.Low;
+              if (A.Depth != B.Depth)
+                return A.Depth < B.Depth;
+              return A.High > B.High;
+            });
+
+  // Adds [Low, High) owned by Owner, extending the last segment if possible.
+  auto Emit = [&](Dwarf_Addr Low, Dwarf_Addr High, const Scope *Owner) {
+    if (Low >= High)
+      return;
+    if (!UnitSegments.empty() && UnitSegments.back().High == Low &&
+        UnitSegments.back().Innermost == Owner)
+      UnitSegments.back().High = High;
+    else
+      UnitSegments.push_back({Low, High, Owner, UnitIndex});
+  };
+
+  // Sweep the intervals keeping the stack of the scopes covering the current
+  // address. A nested range is clipped to the range enclosing it, so the
+  // addresses in the stack never decrease from its top to its bottom.
+  std::vector<Interval> Open;
+  Dwarf_Addr Cursor = 0;
+  for (const Interval &Next : Intervals) {
+    while (!Open.empty() && Open.back().High <= Next.Low) {
+      Emit(Cursor, Open.back().High, Open.back().Owner);
+      Cursor = Open.back().High;
+      Open.pop_back();
+    }
+    Dwarf_Addr High = Next.High;
+    if (!Open.empty()) {
+      Emit(Cursor, Next.Low, Open.back().Owner);
+      High = std::min(High, Open.back().High);
+    }
+    Cursor = Next.Low;
+    Open.push_back({Next.Low, High, Next.Depth, Next.Owner});
+  }
+  while (!Open.empty()) {
+    Emit(Cursor, Open.back().High, Open.back().Owner);
+    Cursor = Open.back().High;
+    Open.pop_back();
+  }
+
+  // An end of sequence comes before a row starting a new sequence at the same
+  // address, so the new sequence covers it.
+  Rows.reserve(Lines.size());
+  for (const Line *Ln : Lines)
+    Rows.push_back({Ln->getAddress(), Ln});
+  std::stable_sort(Rows.begin(), Rows.end(), [](const Row &A, const Row &B) {
+    if (A.Address != B.Address)
+      return A.Address < B.Address;
+    return A.Ln->getIsLineEndSequence() && !B.Ln->getIsLineEndSequence();
+  });
+}
+
+AddressIndex::Location AddressIndex::getLocation(const Segment *Seg,
+                                                 Dwarf_Addr Address) const {
+  Location Loc;
+  if (!Seg || Address < Seg->Low || Address >= Seg->High)
+    return Loc;
+  Loc.Innermost = Seg->Innermost;
+
+  // The row covering the address is the last one at or before it.
+  const std::vector<Row> &Rows = UnitRows[Seg->Unit];
+  auto Next = std::upper_bound(
+      Rows.begin(), Rows.end(), Address,
+      [](Dwarf_Addr Addr, const Row &R) { return Addr < R.Address; });
+  if (Next != Rows.begin() && !std::prev(Next)->Ln->getIsLineEndSequence())
+    Loc.Row = std::prev(Next)->Ln;
+  return Loc;
+}
+
+AddressIndex::Location AddressIndex::find(Dwarf_Addr Address) const {
+  auto Next = std::upper_bound(
+      Segments.begin(), Segments.end(), Address,
+      [](Dwarf_Addr Addr, const Segment &Seg) { return Addr < Seg.Low; });
+  if (Next == Segments.begin())
+    return Location();
+  return getLocation(&*std::prev(Next), Address);
+}
+
+std::vector<AddressIndex::Location>
+AddressIndex::find(const std::vector<Dwarf_Addr> &Addresses) const {
+  std::vector<Location> Locations(Addresses.size());
+  std::vector<size_t> Order(Addresses.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  std::sort(Order.begin(), Order.end(), [&](size_t A, size_t B) {
+    return Addresses[A] < Addresses[B];
+  });
+
+  const size_t ChunkSize = 4096;
+  size_t ChunkCount = (Order.size() + ChunkSize - 1) / ChunkSize;
+  parallelFor(ChunkCount, [&](size_t Chunk) {
+    size_t Begin = Chunk * ChunkSize;
+    size_t End = std::min(Order.size(), Begin + ChunkSize);
+    // Search for the first address of the chunk, then walk forward.
+    auto Next = std::upper_bound(
+        Segments.begin(), Segments.end(), Addresses[Order[Begin]],
+        [](Dwarf_Addr Addr, const Segment &Seg) { return Addr < Seg.Low; });
+    for (size_t I = Begin; I < End; ++I) {
+      Dwarf_Addr Address = Addresses[Order[I]];
+      while (Next != Segments.end() && Next->Low <= Address)
+        ++Next;
+      if (Next != Segments.begin())
+        Locations[Order[I]] = getLocation(&*std::prev(Next), Address);
+    }
+  });
+  return Locations;
+}
@@ -0,0 +1,105 @@
+//===-- LibScopeView/AddressIndex.h -----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Index from code addresses to the scopes and lines of a scope tree.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ADDRESSINDEX_H
+#define ADDRESSINDEX_H
+
+#include "libdwarf.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LibScopeView {
+
+class Line;
+class Scope;
+
+/// \brief Index from the code addresses of a scope tree to the innermost scope
+/// and the line covering each address.
+///
+/// The address ranges of the scopes are flattened into sorted segments that
+/// do not overlap, each owned by the innermost scope covering it, so an
+/// address is found with a single binary search. The segments and lines of
+/// each compile unit are collected on their own thread.
+class AddressIndex {
+public:
+  /// \brief The scope and line covering an address.
+  struct Location {
+    // Innermost scope, e.g. an inlined function or a block. Its parents give
+    // the rest of the inlining chain. Null if the address is not covered.
+    const Scope *Innermost = nullptr;
+    // Line table row covering the address, if any.
+    const Line *Row = nullptr;
+  };
+
+  /// \brief Index the address ranges and lines of the tree under Root.
+  explicit AddressIndex(const Scope *Root);
+
+  /// \brief Returns the location of a single address.
+  Location find(Dwarf_Addr Address) const;
+
+  /// \brief Returns the locations of the given addresses, in the same order.
+  /// The addresses are sorted and looked up in chunks on their own threads,
+  /// walking the segments instead of searching them for each address.
+  std::vector<Location> find(const std::vector<Dwarf_Addr> &Addresses) const;
+
+  /// \brief Number of address segments in the index.
+  size_t size() const { return Segments.size(); }
+
+private:
+  struct Segment {
+    Dwarf_Addr Low;
+    Dwarf_Addr High;
+    const Scope *Innermost;
+    // Index of the compile unit in UnitRows.
+    uint32_t Unit;
+  };
+  struct Row {
+    Dwarf_Addr Address;
+    const Line *Ln;
+  };
+
+  // Collects the segments and the line table rows of a compile unit.
+  static void collect(const Scope *Unit, uint32_t UnitIndex,
+                      std::vector<Segment> &UnitSegments,
+                      std::vector<Row> &Rows);
+
+  // Location of an address within the segment Seg, which may be null.
+  Location getLocation(const Segment *Seg, Dwarf_Addr Address) const;
+
+  // Sorted segments of all the compile units.
+  std::vector<Segment> Segments;
+  // Line table rows of each compile unit, sorted by address.
+  std::vector<std::vector<Row>> UnitRows;
+};
+
+} // namespace LibScopeView
+
+#endif // ADDRESSINDEX_H
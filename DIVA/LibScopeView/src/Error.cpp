@@ -77,6 +77,9 @@ const ErrorEntry ErrorTable[] = {
     {"ERR_FILE_NOT_FOUND", "Unable to open file '%s'."},
     {"ERR_INVALID_FILE",
      "Invalid input file '%s', please provide a file in a supported format."},
+
+    // Server Error.
+    {"ERR_SERVE_SOCKET", "Unable to serve requests on socket '%s'."},
 };
 static_assert(sizeof(ErrorTable) / sizeof(ErrorEntry) ==
                   static_cast<size_t>(ErrorCode::ERR_LAST_CODE),
@@ -64,6 +64,9 @@ enum class ErrorCode {
   ERR_FILE_NOT_FOUND,
   ERR_INVALID_FILE,
 
+  // Server Error.
+  ERR_SERVE_SOCKET,
+
   // Last Error.
   ERR_LAST_CODE
 };
@@ -46,10 +46,13 @@
 #define NOMINMAX
 #include <Windows.h>
 #include <io.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 #elif defined(PLATFORM_LINUX)
 #include <errno.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -86,6 +89,16 @@ bool getBytesFromFile(std::vector<char> &Bytes, const std::string FileLocation,
   return true;
 }
 
+// Read an unsigned ELF value of the given size and byte order.
+uint64_t readElfValue(const char *Data, size_t Size, bool BigEndian) {
+  uint64_t Value = 0;
+  for (size_t I = 0; I < Size; ++I) {
+    size_t Byte = BigEndian ? I : Size - 1 - I;
+    Value = (Value << 8) | static_cast<unsigned char>(Data[Byte]);
+  }
+  return Value;
+}
+
 } // End anonymous namespace.
 
 std::string LibScopeView::unifyFilePath(const std::string &Path) {
@@ -286,6 +299,121 @@ bool LibScopeView::isFileFormatElf(const std::string &FileLocation) {
   return std::equal(Bytes.begin(), Bytes.end(), ElfMagic.begin());
 }
 
+bool LibScopeView::getElfBuildID(const std::string &FileLocation,
+                                 std::string &BuildID) {
+  // ELF constants, as there are no elf.h headers on all platforms.
+  const size_t Elf32HeaderSize = 52;
+  const size_t Elf64HeaderSize = 64;
+  const uint64_t SHT_NOTE = 7;
+  const uint64_t NT_GNU_BUILD_ID = 3;
+  // Notes are small, anything bigger than this is not a build-id section.
+  const uint64_t MaxNoteSectionSize = 1 << 16;
+
+  std::ifstream FIn(nativeFilePath(FileLocation), std::ios::binary);
+  char Header[Elf64HeaderSize];
+  if (!FIn.read(Header, Elf32HeaderSize) ||
+      !std::equal(Header, Header + 4, "\x7f" "ELF"))
+    return false;
+
+  const bool Is64 = Header[4] == 2;
+  const bool BigEndian = Header[5] == 2;
+  if (Is64 && !FIn.read(Header + Elf32HeaderSize,
+                        Elf64HeaderSize - Elf32HeaderSize))
+    return false;
+  auto read = [BigEndian](const char *Data, size_t Size) {
+    return readElfValue(Data, Size, BigEndian);
+  };
+
+  const size_t AddrSize = Is64 ? 8 : 4;
+  const uint64_t SectionsOffset = read(Header + (Is64 ? 0x28 : 0x20), AddrSize);
+  const uint64_t SectionSize = read(Header + (Is64 ? 0x3A : 0x2E), 2);
+  const uint64_t SectionCount = read(Header + (Is64 ? 0x3C : 0x30), 2);
+  if (SectionSize < (Is64 ? 0x28u : 0x18u))
+    return false;
+
+  std::vector<char> Section(static_cast<size_t>(SectionSize));
+  std::vector<char> Notes;
+  for (uint64_t Index = 0; Index < SectionCount; ++Index) {
+    FIn.seekg(static_cast<std::streamoff>(SectionsOffset +
+                                          Index * SectionSize));
+    if (!FIn.read(Section.data(), static_cast<std::streamsize>(SectionSize)))
+      return false;
+    if (read(&Section[4], 4) != SHT_NOTE)
+      continue;
+
+    const uint64_t NotesOffset = read(&Section[Is64 ? 0x18 : 0x10], AddrSize);
+    const uint64_t NotesSize = read(&Section[Is64 ? 0x20 : 0x14], AddrSize);
+    if (NotesSize > MaxNoteSectionSize)
+      continue;
+    Notes.resize(static_cast<size_t>(NotesSize));
+    FIn.seekg(static_cast<std::streamoff>(NotesOffset));
+    if (!FIn.read(Notes.data(), static_cast<std::streamsize>(NotesSize)))
+      return false;
+
+    // Each note is a name size, descriptor size and type followed by the
+    // name and descriptor, both padded to 4 bytes.
+    auto align4 = [](uint64_t Size) { return (Size + 3) & ~uint64_t(3); };
+    uint64_t Pos = 0;
+    while (Pos + 12 <= NotesSize) {
+      const uint64_t NameSize = read(&Notes[Pos], 4);
+      const uint64_t DescSize = read(&Notes[Pos + 4], 4);
+      const uint64_t NoteType = read(&Notes[Pos + 8], 4);
+      const uint64_t NamePos = Pos + 12;
+      const uint64_t DescPos = NamePos + align4(NameSize);
+      if (DescPos + DescSize > NotesSize)
+        break;
+      if (NoteType == NT_GNU_BUILD_ID && NameSize == 4 &&
+          std::equal(&Notes[NamePos], &Notes[NamePos] + 4, "GNU") &&
+          DescSize != 0) {
+        static const char HexDigits[] = "0123456789abcdef";
+        BuildID.clear();
+        for (uint64_t I = 0; I < DescSize; ++I) {
+          unsigned char Byte = static_cast<unsigned char>(Notes[DescPos + I]);
+          BuildID += HexDigits[Byte >> 4];
+          BuildID += HexDigits[Byte & 0xF];
+        }
+        return true;
+      }
+      Pos = DescPos + align4(DescSize);
+    }
+  }
+  return false;
+}
+
+bool LibScopeView::getFileSizeAndTime(const std::string &FileLocation,
+                                      uint64_t &Size, int64_t &ModifiedTime) {
+#ifdef PLATFORM_WIN
+  struct _stat64 SB;
+  if (_stat64(nativeFilePath(FileLocation).c_str(), &SB) != 0)
+    return false;
+#else
+  struct stat SB;
+  if (stat(FileLocation.c_str(), &SB) != 0)
+    return false;
+#endif
+  Size = static_cast<uint64_t>(SB.st_size);
+  ModifiedTime = static_cast<int64_t>(SB.st_mtime);
+  return true;
+}
+
+bool LibScopeView::getFileContentHash(const std::string &FileLocation,
+                                      uint64_t &Hash) {
+  std::ifstream FIn(nativeFilePath(FileLocation), std::ios::binary);
+  if (!FIn)
+    return false;
+
+  Hash = 14695981039346656037ULL;
+  std::vector<char> Buffer(1 << 16);
+  do {
+    FIn.read(Buffer.data(), static_cast<std::streamsize>(Buffer.size()));
+    for (std::streamsize I = 0; I < FIn.gcount(); ++I) {
+      Hash ^= static_cast<unsigned char>(Buffer[static_cast<size_t>(I)]);
+      Hash *= 1099511628211ULL;
+    }
+  } while (FIn);
+  return FIn.eof();
+}
+
 FileDescriptor::FileDescriptor(const std::string &UnifiedPath) {
 #ifdef PLATFORM_WIN
   _sopen_s(&FD, nativeFilePath(UnifiedPath).c_str(), _O_BINARY | _O_RDONLY,
@@ -317,3 +445,57 @@ FileDescriptor &FileDescriptor::operator=(FileDescriptor &&Other) {
   swap(*this, Tmp);
   return *this;
 }
+
+bool MappedFile::open(const std::string &UnifiedPath) {
+  close();
+#ifdef PLATFORM_WIN
+  HANDLE File = CreateFileA(nativeFilePath(UnifiedPath).c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (File == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER FileSize;
+  HANDLE Mapping = nullptr;
+  if (GetFileSizeEx(File, &FileSize) && FileSize.QuadPart > 0 &&
+      static_cast<uint64_t>(FileSize.QuadPart) <= SIZE_MAX)
+    Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (Mapping) {
+    Data = static_cast<const char *>(
+        MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+    // The view keeps the file mapped after the handles are closed.
+    CloseHandle(Mapping);
+  }
+  CloseHandle(File);
+  if (!Data)
+    return false;
+  Size = static_cast<size_t>(FileSize.QuadPart);
+#else
+  int FD = ::open(UnifiedPath.c_str(), O_RDONLY);
+  if (FD < 0)
+    return false;
+  struct stat SB;
+  void *Mapped = MAP_FAILED;
+  if (fstat(FD, &SB) == 0 && SB.st_size > 0)
+    Mapped = mmap(nullptr, static_cast<size_t>(SB.st_size), PROT_READ,
+                  MAP_PRIVATE, FD, 0);
+  // The mapping stays valid after the descriptor is closed.
+  ::close(FD);
+  if (Mapped == MAP_FAILED)
+    return false;
+  Data = static_cast<const char *>(Mapped);
+  Size = static_cast<size_t>(SB.st_size);
+#endif
+  return true;
+}
+
+void MappedFile::close() {
+  if (!Data)
+    return;
+#ifdef PLATFORM_WIN
+  UnmapViewOfFile(Data);
+#else
+  munmap(const_cast<char *>(Data), Size);
+#endif
+  Data = nullptr;
+  Size = 0;
+}
@@ -31,6 +31,7 @@
 #ifndef FILE_UTILITIES_H
 #define FILE_UTILITIES_H
 
+#include <cstdint>
 #include <string>
 
 namespace LibScopeView {
@@ -75,6 +76,22 @@ bool doesFileExist(const std::string &FileLocation);
 /// \brief Return true if the file is an elf.
 bool isFileFormatElf(const std::string &FileLocation);
 
+/// \brief Get the GNU build-id note of an elf file as a hex string.
+///
+/// Returns false if the file is not an elf or it does not have a build-id.
+bool getElfBuildID(const std::string &FileLocation, std::string &BuildID);
+
+/// \brief Get the size of the file and the time it was last modified.
+///
+/// Returns false if the file does not exist.
+bool getFileSizeAndTime(const std::string &FileLocation, uint64_t &Size,
+                        int64_t &ModifiedTime);
+
+/// \brief Get a 64 bit FNV-1a hash of the file contents.
+///
+/// Returns false if the file can not be read.
+bool getFileContentHash(const std::string &FileLocation, uint64_t &Hash);
+
 /// \brief RAII warpper around an int file descriptor.
 class FileDescriptor {
 public:
@@ -99,6 +116,29 @@ private:
   int FD;
 };
 
+/// \brief RAII wrapper around a read-only memory mapping of a whole file.
+class MappedFile {
+public:
+  MappedFile() : Data(nullptr), Size(0) {}
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile &Other) = delete;
+  MappedFile &operator=(const MappedFile &Other) = delete;
+
+  /// \brief Map the file, returns false if it can not be mapped.
+  ///
+  /// Empty files can not be mapped.
+  bool open(const std::string &UnifiedPath);
+  void close();
+
+  const char *data() const { return Data; }
+  size_t size() const { return Size; }
+
+private:
+  const char *Data;
+  size_t Size;
+};
+
 } // namespace LibScopeView
 
 #endif // FILE_UTILITIES_H
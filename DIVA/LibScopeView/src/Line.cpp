@@ -50,12 +50,14 @@ Line::Line() : Element(), Discriminator(0) {
 
 Line::~Line() {}
 
-uint32_t Line::LinesAllocated = 0;
+std::atomic<uint32_t> Line::LinesAllocated(0);
 
 void Line::setTag() {
-  ++Line::LinesAllocated;
+  uint32_t Count = ++Line::LinesAllocated;
 #ifndef NDEBUG
-  Tag = Line::LinesAllocated;
+  Tag = Count;
+#else
+  (void)Count;
 #endif
 }
 
@@ -77,14 +79,19 @@ const char *Line::KindNewStatement = "NewStatement";
 const char *Line::KindPrologueEnd = "PrologueEnd";
 const char *Line::KindUndefined = "Undefined";
 
-const char *Line::getKindAsString() const {
-  const char *Kind = KindUndefined;
-  if (getIsLineRecord()) {
-    Kind = KindLine;
-  }
-  return Kind;
+const Object::KindEntry &Line::getKindEntry() const {
+  static const KindEntry CodeLine = {&KindLine, ObjectKind::CodeLine};
+  static const KindEntry Undefined = {&KindUndefined, ObjectKind::Other};
+
+  if (getIsLineRecord())
+    return CodeLine;
+  return Undefined;
 }
 
+const char *Line::getKindAsString() const { return *getKindEntry().Label; }
+
+ObjectKind Line::getKind() const { return getKindEntry().Kind; }
+
 std::string Line::getLineNumberAsStringStripped() {
   std::string number = getLineNumberAsString();
   return trim(number);
@@ -93,7 +100,7 @@ std::string Line::getLineNumberAsStringStripped() {
 void Line::dump(const PrintSettings &Settings) {
   if (Settings.printObject(*this)) {
     // Object Summary Table.
-    getReader()->incrementPrinted(this);
+    getReader()->incrementPrinted(getKind());
 
     // Common Object Data.
     Element::dump(Settings);
@@ -71,6 +71,9 @@ private:
   };
   std::bitset<LineAttributesSize> LineAttributesFlags;
 
+  // Saves and restores the flags when caching the tree.
+  friend class ScopeTreeSerializer;
+
 private:
   // Discriminator value (DW_LNE_set_discriminator). The DWARF standard
   // defines the discriminator as an unsigned LEB128 integer. In our case,
@@ -80,6 +83,11 @@ private:
 public:
   // Gets the line kind as a string (eg, "LINE").
   const char *getKindAsString() const override;
+  ObjectKind getKind() const final;
+
+private:
+  // The kind of this line, which getKindAsString and getKind are taken from.
+  const KindEntry &getKindEntry() const;
 
 public:
   /// \brief Flags associated with the line.
@@ -149,7 +157,7 @@ public:
   std::string getAsYAML() const override;
 
 private:
-  static uint32_t LinesAllocated;
+  static std::atomic<uint32_t> LinesAllocated;
 
 public:
   static uint32_t getInstanceCount() { return LinesAllocated; }
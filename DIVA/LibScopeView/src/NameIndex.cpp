@@ -0,0 +1,136 @@
+//===-- LibScopeView/NameIndex.cpp ------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Index from qualified names to the objects of a scope tree.
+///
+//===----------------------------------------------------------------------===//
+
+#include "NameIndex.h"
+#include "Line.h"
+#include "QualifiedNamePool.h"
+#include "Scope.h"
+#include "StringPool.h"
+#include "Utilities.h"
+
+#include <utility>
+
+using namespace LibScopeView;
+
+NameIndex::NameIndex(const Scope *Root) {
+  if (!Root)
+    return;
+
+  // Collect the objects under each child of the root on its own thread. The
+  // root itself is not a named object of the program.
+  std::vector<Object *> Subtrees(Root->getChildren().begin(),
+                                 Root->getChildren().end());
+  Subtrees.insert(Subtrees.end(), Root->getLines().begin(),
+                  Root->getLines().end());
+  std::vector<std::vector<Entry>> Entries(Subtrees.size());
+  parallelFor(Subtrees.size(),
+              [&](size_t Index) { collect(Subtrees[Index], Entries[Index]); });
+
+  // Fill each shard on its own thread, taking the subtrees in order so the
+  // objects of each name stay in tree order.
+  parallelFor(ShardCount, [&](size_t ShardIndex) {
+    Shard &TheShard = Shards[ShardIndex];
+    for (const std::vector<Entry> &SubtreeEntries : Entries)
+      for (const Entry &E : SubtreeEntries)
+        if (E.first == ShardIndex)
+          TheShard[getKey(E.second)].push_back(E.second);
+  });
+}
+
+NameIndex::Key NameIndex::getKey(const Object *Obj) {
+  return {Obj->getQualifiedNameIndex(), Obj->getNameIndex()};
+}
+
+void NameIndex::collect(Object *Obj, std::vector<Entry> &Entries) {
+  if (Obj->isNamed())
+    Entries.emplace_back(KeyHash()(getKey(Obj)) % ShardCount, Obj);
+  if (!Obj->getIsScope())
+    return;
+  const Scope *Scp = static_cast<const Scope *>(Obj);
+  for (Object *Child : Scp->getChildren())
+    collect(Child, Entries);
+  for (Line *Ln : Scp->getLines())
+    collect(Ln, Entries);
+}
+
+const std::vector<Object *> &
+NameIndex::find(const std::string &QualifiedName) const {
+  static const std::vector<Object *> NoObjects;
+
+  // Only names already in the pools can be found.
+  std::string Qualifiers, Name;
+  splitQualifiedName(QualifiedName, Qualifiers, Name);
+  bool Found = false;
+  Key K;
+  K.QualifiedIndex = QualifiedNamePool::lookupQualifiedIndex(Qualifiers, Found);
+  if (!Found)
+    return NoObjects;
+  K.NameIndex = StringPool::lookupStringIndex(Name, Found);
+  if (!Found || K.NameIndex == 0)
+    return NoObjects;
+
+  const Shard &TheShard = Shards[KeyHash()(K) % ShardCount];
+  auto Objects = TheShard.find(K);
+  return Objects == TheShard.end() ? NoObjects : Objects->second;
+}
+
+size_t NameIndex::size() const {
+  size_t Size = 0;
+  for (const Shard &TheShard : Shards)
+    Size += TheShard.size();
+  return Size;
+}
+
+void NameIndex::splitQualifiedName(const std::string &QualifiedName,
+                                   std::string &Qualifiers,
+                                   std::string &Name) {
+  // Find the last "::" outside of any template arguments or parameters.
+  size_t Split = std::string::npos;
+  int Depth = 0;
+  for (size_t I = 0; I < QualifiedName.size(); ++I) {
+    char C = QualifiedName[I];
+    if (C == '<' || C == '(')
+      ++Depth;
+    else if ((C == '>' || C == ')') && Depth > 0)
+      --Depth;
+    else if (C == ':' && Depth == 0 && I + 1 < QualifiedName.size() &&
+             QualifiedName[I + 1] == ':') {
+      Split = I;
+      ++I;
+    }
+  }
+
+  if (Split == std::string::npos) {
+    Qualifiers.clear();
+    Name = QualifiedName;
+  } else {
+    Qualifiers = QualifiedName.substr(0, Split + 2);
+    Name = QualifiedName.substr(Split + 2);
+  }
+}
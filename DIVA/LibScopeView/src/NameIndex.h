@@ -0,0 +1,98 @@
+//===-- LibScopeView/NameIndex.h --------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Index from qualified names to the objects of a scope tree.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace LibScopeView {
+
+class Object;
+class Scope;
+
+/// \brief Index from the qualified names of the objects of a scope tree to the
+/// objects, so they are found without visiting the tree.
+///
+/// An object is indexed under the Qualified Name Pool index of its qualifiers
+/// and the String Pool index of its name, so looking up "ns::Class::method"
+/// only hashes two integers once the names are found in the pools. The names
+/// are collected from the subtree of each child of the root on its own thread,
+/// and the index is split in shards that are also filled on their own threads.
+class NameIndex {
+public:
+  /// \brief Index the named objects of the tree under Root.
+  explicit NameIndex(const Scope *Root);
+
+  /// \brief Returns the objects with the given qualified name, in tree order.
+  const std::vector<Object *> &find(const std::string &QualifiedName) const;
+
+  /// \brief Number of different names in the index.
+  size_t size() const;
+
+  /// \brief Split a qualified name in its qualifiers, ending with "::", and
+  /// its name, e.g. "ns::Class<a::b>::method" in "ns::Class<a::b>::" and
+  /// "method".
+  static void splitQualifiedName(const std::string &QualifiedName,
+                                 std::string &Qualifiers, std::string &Name);
+
+private:
+  struct Key {
+    size_t QualifiedIndex;
+    size_t NameIndex;
+    bool operator==(const Key &Other) const {
+      return QualifiedIndex == Other.QualifiedIndex &&
+             NameIndex == Other.NameIndex;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &K) const {
+      return std::hash<size_t>()(K.QualifiedIndex * 31 + K.NameIndex);
+    }
+  };
+  typedef std::unordered_map<Key, std::vector<Object *>, KeyHash> Shard;
+
+  // A named object and the shard it is indexed in.
+  typedef std::pair<size_t, Object *> Entry;
+
+  static Key getKey(const Object *Obj);
+  // Collects the named objects of a subtree, in tree order.
+  static void collect(Object *Obj, std::vector<Entry> &Entries);
+
+  static const size_t ShardCount = 16;
+  Shard Shards[ShardCount];
+};
+
+} // namespace LibScopeView
+
+#endif // NAMEINDEX_H
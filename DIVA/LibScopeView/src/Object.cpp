@@ -30,6 +30,7 @@
 #include "FileUtilities.h"
 #include "Line.h"
 #include "PrintContext.h"
+#include "QualifiedNamePool.h"
 #include "Reader.h"
 #include "StringPool.h"
 #include "Symbol.h"
@@ -118,7 +119,7 @@ namespace {
 const char *OffsetAsString(Dwarf_Off Offset) {
   // [0x00000000]
   const unsigned MaxLineSize = 16;
-  static char Buffer[MaxLineSize];
+  thread_local char Buffer[MaxLineSize];
   int Res = snprintf(Buffer, MaxLineSize, "[0x%08" DW_PR_DUx "]", Offset);
   assert((Res >= 0) && (static_cast<unsigned>(Res) < MaxLineSize) &&
          "string overflow");
@@ -156,7 +157,7 @@ const char *Object::getNoLineString() const {
 
 const char *Object::getLineAsString(uint64_t LnNumber) const {
   const unsigned MaxLineSize = 16;
-  static char Buffer[MaxLineSize];
+  thread_local char Buffer[MaxLineSize];
   const char *Str = Buffer;
   if (LnNumber) {
     int Res;
@@ -179,7 +180,7 @@ const char *Object::getReferenceAsString(uint64_t LnNumber, bool Spaces) const {
   const char *Str = "";
   if (LnNumber) {
     const unsigned MaxLineSize = 16;
-    static char Buffer[MaxLineSize];
+    thread_local char Buffer[MaxLineSize];
     int Res = snprintf(Buffer, MaxLineSize, "@%s%s",
                        std::to_string(LnNumber).c_str(), Spaces ? " " : "");
     assert((Res >= 0) && (static_cast<unsigned>(Res) < MaxLineSize) &&
@@ -194,26 +195,30 @@ const char *Object::getTypeAsString(const PrintSettings &Settings) const {
   return getHasType() ? (getTypeName()) : (Settings.ShowVoid ? "void" : "");
 }
 
-void Object::resolveQualifiedName(const Scope *ExplicitParent) {
-  std::string QualifiedName;
+namespace {
+// Index of the qualifiers made of the names of Parent and of its parents, up to
+// the Compile Unit or the scope root.
+size_t getQualifiers(const Object *Parent) {
+  if (!Parent || Parent->getIsCompileUnit() ||
+      (Parent->getIsScope() && static_cast<const Scope *>(Parent)->getIsRoot()))
+    return 0;
+  size_t Qualifiers = getQualifiers(Parent->getParent());
+  if (Parent->isNamed())
+    Qualifiers = QualifiedNamePool::getQualifiedIndex(Qualifiers,
+                                                      Parent->getNameIndex());
+  return Qualifiers;
+}
+} // namespace
 
+void Object::resolveQualifiedName(const Scope *ExplicitParent) {
   // Get the qualified name, excluding the Compile Unit, Functions, and the
-  // scope root.
-  const Object *ObjParent = ExplicitParent;
-  while (ObjParent && !ObjParent->getIsCompileUnit() &&
-         !ExplicitParent->getIsFunction() &&
-         !(ObjParent->getIsScope() &&
-           static_cast<const Scope *>(ObjParent)->getIsRoot())) {
-
-    if (strlen(ObjParent->getName()) != 0) {
-      QualifiedName.insert(0, "::");
-      QualifiedName.insert(0, ObjParent->getName());
-    }
-    ObjParent = ObjParent->getParent();
-  }
-
-  if (!QualifiedName.empty()) {
-    setQualifiedName(QualifiedName.c_str());
+  // scope root. The parents share the qualifiers they have in common, so no
+  // text is built here.
+  if (ExplicitParent && ExplicitParent->getIsFunction())
+    return;
+  size_t Qualifiers = getQualifiers(ExplicitParent);
+  if (Qualifiers != 0) {
+    setQualifiedNameIndex(Qualifiers);
     setHasQualifiedName();
   }
 }
@@ -402,21 +407,31 @@ std::string getTagString(const Dwarf_Half DWTag, const bool IsLine) {
 } // namespace
 
 // Number of characters written by PrintAttributes.
-size_t Object::IndentationSize = 0;
+thread_local size_t Object::IndentationSize = 0;
 
 std::string Object::getAttributesAsText(const PrintSettings &Settings) {
-  static bool CalculateIndentation = true;
   // Record the required space for the offsets (object and parent) and
   // DWARF tag. These fields are not required for the {InputFile} object.
-  static size_t OffsetWidth = 0;
-  static size_t ParentWidth = 0;
-  static size_t TagWidth = 0;
+  // Like all the printing state, they are kept per thread.
+  thread_local size_t OffsetWidth = 0;
+  thread_local size_t ParentWidth = 0;
+  thread_local size_t TagWidth = 0;
 
   // Calculate the indentation size, so we can use that value when printing
   // additional attributes to DIVA objects. This value is calculated just for
-  // the first object.
-  if (CalculateIndentation) {
+  // the first object printed with the given attributes.
+  thread_local std::bitset<5> ShownAttributes;
+  thread_local bool CalculateIndentation = true;
+  std::bitset<5> Shown;
+  Shown[0] = Settings.ShowDWARFOffset;
+  Shown[1] = Settings.ShowDWARFParent;
+  Shown[2] = Settings.ShowLevel;
+  Shown[3] = Settings.ShowIsGlobal;
+  Shown[4] = Settings.ShowDWARFTag;
+  if (CalculateIndentation || Shown != ShownAttributes) {
     CalculateIndentation = false;
+    ShownAttributes = Shown;
+    IndentationSize = 0;
     if (Settings.ShowDWARFOffset) {
       OffsetWidth = static_cast<size_t>(
           snprintf(nullptr, 0, "[0x%08" DW_PR_DUx "]", getDieOffset()));
@@ -448,7 +463,7 @@ std::string Object::getAttributesAsText(const PrintSettings &Settings) {
   // the largest value (DWARF tag).
   const unsigned MaxSize = 64;
   int Res;
-  static char Literal[MaxSize];
+  thread_local char Literal[MaxSize];
   Literal[0] = 0;
 
   std::string Attributes;
@@ -519,7 +534,7 @@ void Object::printAttributes(const PrintSettings &Settings) {
 
 // Record the last seen filename index. It is reset after the object that
 // represents the Compile Unit is printed.
-size_t Object::LastFilenameIndex = 0;
+thread_local size_t Object::LastFilenameIndex = 0;
 
 void Object::printFileIndex() {
   // Check if there is a change in the File ID sequence.
@@ -569,7 +584,7 @@ Object::getAttributeInfoAsText(const std::string &AttributeText,
   // for those. Then we want to indent the space where the line number would be.
   // Then We want to indent the attribute info 4 columns to the right of the
   // object.
-  static const std::string ConstantIndent(
+  thread_local const std::string ConstantIndent(
       std::string(IndentationSize, ' ') + std::string(3, ' ') +
       getNoLineString() + std::string(4, ' '));
 
@@ -577,13 +592,10 @@ Object::getAttributeInfoAsText(const std::string &AttributeText,
   return ConstantIndent + getIndentString(Settings) + "- " + AttributeText;
 }
 
-std::string Object::getCommonYAML() const {
-  std::stringstream YAML;
-
-  // Kind.
-  YAML << "object: \"" << getKindAsString() << "\"\n";
-
-  // Name.
+std::string Object::getPrintedName() const {
+  // Base types are printed with their name as the type.
+  if (getIsType() && static_cast<const Type *>(this)->getIsBaseType())
+    return "";
   std::string Name;
   if (getHasQualifiedName())
     Name += getQualifiedName();
@@ -592,7 +604,39 @@ std::string Object::getCommonYAML() const {
     Name += "...";
   else
     Name += getName();
+  return Name;
+}
 
+bool Object::getPrintedTypeName(std::string &TypeName) const {
+  TypeName.clear();
+  if (getIsType() && static_cast<const Type *>(this)->getIsBaseType()) {
+    TypeName = getName();
+    return true;
+  }
+  // Template's types are printed in attributes.
+  if (getType() &&
+      !(getIsType() && static_cast<const Type *>(this)->getIsTemplateParam())) {
+    if (getType()->getHasQualifiedName())
+      TypeName += getType()->getQualifiedName();
+    TypeName += getType()->getName();
+    return true;
+  }
+  // Functions must have types.
+  if (getIsScope() && static_cast<const Scope *>(this)->getIsFunction()) {
+    TypeName = "void";
+    return true;
+  }
+  return false;
+}
+
+std::string Object::getCommonYAML() const {
+  std::stringstream YAML;
+
+  // Kind.
+  YAML << "object: \"" << getKindAsString() << "\"\n";
+
+  // Name.
+  std::string Name(getPrintedName());
   YAML << "name: ";
   if (!Name.empty())
     YAML << "\"" << Name << "\"\n";
@@ -600,18 +644,10 @@ std::string Object::getCommonYAML() const {
     YAML << "null\n";
 
   // Type.
+  std::string TypeName;
   YAML << "type: ";
-  if (getType() &&
-      // Template's types are printed in attributes.
-      !(getIsType() && static_cast<const Type *>(this)->getIsTemplateParam())) {
-    std::string TypeName;
-    if (getType()->getHasQualifiedName())
-      TypeName += getType()->getQualifiedName();
-    TypeName += getType()->getName();
+  if (getPrintedTypeName(TypeName))
     YAML << "\"" << TypeName << "\"\n";
-    // Functions must have types.
-  } else if (getIsScope() && static_cast<const Scope *>(this)->getIsFunction())
-    YAML << "\"void\"\n";
   else
     YAML << "null\n";
 
@@ -675,11 +711,11 @@ void Element::setNameIndex(size_t name_index) { NameIndex = name_index; }
 size_t Element::getNameIndex() const { return NameIndex; }
 
 void Element::setQualifiedName(const char *QualName) {
-  QualifiedIndex = StringPool::getStringIndex(QualName);
+  QualifiedIndex = QualifiedNamePool::getQualifiedIndex(QualName);
 }
 
 const char *Element::getQualifiedName() const {
-  return StringPool::getStringValue(QualifiedIndex);
+  return QualifiedNamePool::getQualifiedText(QualifiedIndex);
 }
 
 const char *Element::getTypeName() const {
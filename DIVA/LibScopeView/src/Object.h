@@ -43,6 +43,7 @@
 #pragma clang diagnostic pop
 #endif
 
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 
@@ -51,6 +52,7 @@ namespace LibScopeView {
 class Object;
 class PrintSettings;
 class Scope;
+class ScopeTreeSerializer;
 class Type;
 
 void printAllocationInfo();
@@ -64,6 +66,29 @@ typedef bool (Object::*ObjGetFunction)() const;
 /// \brief Enum to represent C++ access specifiers.
 enum class AccessSpecifier { Unspecified, Private, Protected, Public };
 
+/// \brief The kinds of object counted by the summary table, in the order of
+/// its rows. Each is named as getKindAsString names its objects.
+enum class ObjectKind : uint8_t {
+  Alias,
+  Block,
+  Class,
+  CodeLine,
+  CompileUnit,
+  Enum,
+  Function,
+  Member,
+  Namespace,
+  Parameter,
+  PrimitiveType,
+  Struct,
+  TemplateParameter,
+  Union,
+  Using,
+  Variable,
+  // The objects of any other kind, which are not counted.
+  Other
+};
+
 /// \brief Class to represent the basic information for a DIVA object.
 class Object {
 public:
@@ -92,15 +117,31 @@ private:
     HasReference,
     HasQualifiedName,
     HasPattern,
+    IsNameResolved,
+    IsReferenceResolved,
     ObjectAttributesSize
   };
   // Flags specifying various properties of the Object.
   std::bitset<ObjectAttributesSize> ObjectAttributesFlags;
 
+  // Saves and restores the flags when caching the tree.
+  friend class ScopeTreeSerializer;
+
 public:
   /// \brief Get the object kind as a string.
   virtual const char *getKindAsString() const = 0;
 
+  /// \brief Get the kind of the object counted by the summary table.
+  virtual ObjectKind getKind() const = 0;
+
+protected:
+  // The label and summary table kind of a kind of object, so that both are
+  // given by a single classification of the object.
+  struct KindEntry {
+    const char *const *Label;
+    ObjectKind Kind;
+  };
+
 public:
   /// \brief The Object is a line.
   bool getIsLine() const { return ObjectAttributesFlags[IsLine]; }
@@ -132,6 +173,20 @@ public:
   bool getIsResolved() const { return ObjectAttributesFlags[IsResolved]; }
   void setIsResolved() { ObjectAttributesFlags.set(IsResolved); }
 
+  /// \brief The full name of the Object has been resolved.
+  bool getIsNameResolved() const {
+    return ObjectAttributesFlags[IsNameResolved];
+  }
+  void setIsNameResolved() { ObjectAttributesFlags.set(IsNameResolved); }
+
+  /// \brief The Object has the attributes of the Object it references.
+  bool getIsReferenceResolved() const {
+    return ObjectAttributesFlags[IsReferenceResolved];
+  }
+  void setIsReferenceResolved() {
+    ObjectAttributesFlags.set(IsReferenceResolved);
+  }
+
   /// \brief The Object has been inlined.
   bool getIsInlined() const { return ObjectAttributesFlags[IsInlined]; }
   void setIsInlined() { ObjectAttributesFlags.set(IsInlined); }
@@ -158,15 +213,16 @@ public:
   bool getHasPattern() const { return ObjectAttributesFlags[HasPattern]; }
   void setHasPattern() { ObjectAttributesFlags.set(HasPattern); }
 
+  /// \brief Print the source file of the next printed object.
+  static void resetFileIndex() { LastFilenameIndex = 0; }
+
 private:
-  // Track source file changes while printing.
-  static size_t LastFilenameIndex;
-  // Filler gap for the attributes.
-  static size_t IndentationSize;
+  // Track source file changes while printing, in each thread.
+  static thread_local size_t LastFilenameIndex;
+  // Filler gap for the attributes, in each thread.
+  static thread_local size_t IndentationSize;
 
 protected:
-  static void resetFileIndex() { LastFilenameIndex = 0; }
-
   // Scope level for this object.
   LevelType Level;
 
@@ -216,6 +272,10 @@ public:
   virtual const char *getQualifiedName() const = 0;
   virtual void setQualifiedName(const char *Name) = 0;
 
+  /// \brief QualifiedNamePool index of the Object's qualified name.
+  virtual size_t getQualifiedNameIndex() const = 0;
+  virtual void setQualifiedNameIndex(size_t QualifiedIndex) = 0;
+
   /// \brief The Object's type name (if any).
   virtual const char *getTypeName() const = 0;
 
@@ -327,6 +387,12 @@ public:
   /// \brief Returns a YAML representation of this DIVA Object.
   virtual std::string getAsYAML() const = 0;
 
+  /// \brief The name and type name as given in the YAML representation.
+  std::string getPrintedName() const;
+  /// \brief Returns false if no type is printed, which is not the same as a
+  /// type with an empty name.
+  bool getPrintedTypeName(std::string &TypeName) const;
+
 protected:
   /// \brief Returns a text representation of attribute information.
   std::string getAttributeInfoAsText(const std::string &AttributeText,
@@ -354,7 +420,8 @@ private:
   void CommonConstructor();
 
 protected:
-  // The name, type name, qualified name and filename in String Pool.
+  // The name and filename in String Pool, and the qualified name in the
+  // Qualified Name Pool.
   size_t NameIndex;
   size_t QualifiedIndex;
   size_t FilenameIndex;
@@ -391,6 +458,10 @@ public:
   const char *getQualifiedName() const override;
   void setQualifiedName(const char *Name) override;
 
+  /// \brief The QualifiedNamePool index of the Object's qualified name.
+  size_t getQualifiedNameIndex() const override { return QualifiedIndex; }
+  void setQualifiedNameIndex(size_t Index) override { QualifiedIndex = Index; }
+
   /// \brief The Object's type name (if any).
   const char *getTypeName() const override;
 
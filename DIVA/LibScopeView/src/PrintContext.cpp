@@ -35,7 +35,7 @@
 
 using namespace LibScopeView;
 
-std::unique_ptr<PrintContext> LibScopeView::GlobalPrintContext;
+thread_local std::unique_ptr<PrintContext> LibScopeView::GlobalPrintContext;
 
 PrintContext::PrintContext()
     : File(nullptr), FileSave(nullptr), TheLocation(""), LocationDone(false) {}
@@ -63,8 +63,9 @@ private:
   bool LocationDone;
 };
 
-// Instance to handle the print context.
-extern std::unique_ptr<PrintContext> GlobalPrintContext;
+// Instance to handle the print context. Each thread has its own instance, and
+// only the one of the thread calling initialize() is created on stdout.
+extern thread_local std::unique_ptr<PrintContext> GlobalPrintContext;
 
 } // namespace LibScopeView
 
@@ -157,3 +157,7 @@ bool PrintSettings::matchesWithChildrenFilterPattern(
     const std::string &Name) const {
   return matchPattern(Name, WithChildrenFilters, WithChildrenFilterAnys);
 }
+
+bool PrintSettings::matchesCompileUnitPattern(const std::string &Name) const {
+  return matchPattern(Name, CompileUnitFilters, CompileUnitFilterAnys);
+}
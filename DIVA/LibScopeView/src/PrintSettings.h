@@ -32,6 +32,7 @@
 
 #include "Sort.h"
 
+#include <cstdint>
 #include <regex>
 #include <set>
 #include <vector>
@@ -57,19 +58,53 @@ public:
   /// \brief Check if the name matches a --tree pattern.
   bool matchesWithChildrenFilterPattern(const std::string &Name) const;
 
+  /// \brief Check if the name, or the compilation directory, of a compile
+  /// unit matches a --cu pattern.
+  bool matchesCompileUnitPattern(const std::string &Name) const;
+
   bool QuietMode = false;
   bool ShowSummary = false;
 
+  // Only print the summary table, counting the objects without creating the
+  // tree.
+  bool SummaryOnly = false;
+
   bool SplitOutput = false;
   std::string OutputDirectory;
 
   SortingKey SortKey = SortingKey::LINE;
 
+  // Share identical types between compile units instead of reading each copy.
+  bool DedupTypes = false;
+
+  // Decode the attribute values of the Dies from the section bytes instead of
+  // through libdwarf where possible. The scope tree is the same either way.
+  bool NativeDwarf = false;
+
+  // Create the children of each compile unit only when they are first
+  // requested, keeping the debug data until then.
+  bool LazyScopes = false;
+
+  // Directory where the scope trees are cached between runs.
+  std::string CacheDirectory;
+
   std::vector<std::regex> Filters;
   std::vector<std::string> FilterAnys;
   std::vector<std::regex> WithChildrenFilters;
   std::vector<std::string> WithChildrenFilterAnys;
 
+  // The compile units read, by name or compilation directory. All of them
+  // are read if both are empty.
+  std::vector<std::regex> CompileUnitFilters;
+  std::vector<std::string> CompileUnitFilterAnys;
+
+  // Qualified names of the objects printed instead of the tree.
+  std::vector<std::string> Finds;
+
+  // Code addresses whose scopes and lines are printed instead of the tree.
+  bool LookupAddresses = false;
+  std::vector<uint64_t> Addresses;
+
   // The defaults for these values are set by showBrief.
   bool ShowAlias;
   bool ShowBlock;
@@ -0,0 +1,169 @@
+//===-- QualifiedNamePool.cpp -----------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the QualifiedNamePool class.
+///
+//===----------------------------------------------------------------------===//
+
+#include "QualifiedNamePool.h"
+#include "StringPool.h"
+
+#include <assert.h>
+#include <stdexcept>
+
+using namespace LibScopeView;
+
+namespace {
+// Current instance to handle the qualified names.
+QualifiedNamePool *GlobalQualifiedNamePool = nullptr;
+} // namespace
+
+void QualifiedNamePool::create() {
+  if (!GlobalQualifiedNamePool)
+    GlobalQualifiedNamePool = new QualifiedNamePool();
+}
+
+void QualifiedNamePool::destroy() {
+  delete GlobalQualifiedNamePool;
+  GlobalQualifiedNamePool = nullptr;
+}
+
+size_t QualifiedNamePool::getQualifiedIndex(size_t Parent, size_t NameIndex) {
+  assert(GlobalQualifiedNamePool);
+  return GlobalQualifiedNamePool->getIndex(Parent, NameIndex);
+}
+
+size_t QualifiedNamePool::getQualifiedIndex(const std::string &Text) {
+  size_t Index = 0;
+  for (const std::string &Name : splitQualifiers(Text))
+    Index = getQualifiedIndex(Index, StringPool::getStringIndex(Name));
+  return Index;
+}
+
+size_t QualifiedNamePool::lookupQualifiedIndex(const std::string &Text,
+                                               bool &Found) {
+  assert(GlobalQualifiedNamePool);
+  size_t Index = 0;
+  Found = true;
+  for (const std::string &Name : splitQualifiers(Text)) {
+    size_t NameIndex = StringPool::lookupStringIndex(Name, Found);
+    if (!Found)
+      return 0;
+    Index = GlobalQualifiedNamePool->lookup(Index, NameIndex, Found);
+    if (!Found)
+      return 0;
+  }
+  return Index;
+}
+
+const char *QualifiedNamePool::getQualifiedText(size_t Index) {
+  assert(GlobalQualifiedNamePool);
+  return GlobalQualifiedNamePool->getText(Index);
+}
+
+std::vector<std::string>
+QualifiedNamePool::splitQualifiers(const std::string &Text) {
+  std::vector<std::string> Names;
+  size_t Start = 0;
+  int Depth = 0;
+  for (size_t I = 0; I < Text.size(); ++I) {
+    char C = Text[I];
+    if (C == '<' || C == '(')
+      ++Depth;
+    else if ((C == '>' || C == ')') && Depth > 0)
+      --Depth;
+    else if (Depth == 0 && C == ':' && I + 1 < Text.size() &&
+             Text[I + 1] == ':') {
+      if (I > Start)
+        Names.push_back(Text.substr(Start, I - Start));
+      Start = I + 2;
+      ++I;
+    }
+  }
+  if (Start < Text.size())
+    Names.push_back(Text.substr(Start));
+  return Names;
+}
+
+QualifiedNamePool::QualifiedNamePool() : EntryCount(0) {
+  // The empty qualifiers are at index 0.
+  Chunks[0].reset(new Entry[ChunkSize]);
+  Entry &Empty = getEntry(EntryCount++);
+  Empty.Parent = 0;
+  Empty.NameIndex = 0;
+  Empty.TextIndex = 0;
+}
+
+QualifiedNamePool::~QualifiedNamePool() {}
+
+size_t QualifiedNamePool::getIndex(size_t Parent, size_t NameIndex) {
+  const Key K = {Parent, NameIndex};
+  const size_t Shard = KeyHash()(K) % ShardCount;
+  std::lock_guard<std::mutex> Lock(ShardLocks[Shard]);
+  auto Found = Shards[Shard].find(K);
+  if (Found != Shards[Shard].end())
+    return Found->second;
+
+  size_t Index;
+  {
+    std::lock_guard<std::mutex> StorageLock(StorageMutex);
+    Index = EntryCount++;
+    if ((Index >> ChunkBits) >= MaxChunks)
+      throw std::length_error("Qualified Name Pool is full.\n");
+    if ((Index & (ChunkSize - 1)) == 0)
+      Chunks[Index >> ChunkBits].reset(new Entry[ChunkSize]);
+  }
+  Entry &NewEntry = getEntry(Index);
+  NewEntry.Parent = Parent;
+  NewEntry.NameIndex = NameIndex;
+  NewEntry.TextIndex = NoText;
+  Shards[Shard].emplace(K, Index);
+  return Index;
+}
+
+size_t QualifiedNamePool::lookup(size_t Parent, size_t NameIndex,
+                                 bool &Found) {
+  const Key K = {Parent, NameIndex};
+  const size_t Shard = KeyHash()(K) % ShardCount;
+  std::lock_guard<std::mutex> Lock(ShardLocks[Shard]);
+  auto Entry = Shards[Shard].find(K);
+  Found = Entry != Shards[Shard].end();
+  return Found ? Entry->second : 0;
+}
+
+const char *QualifiedNamePool::getText(size_t Index) {
+  Entry &TheEntry = getEntry(Index);
+  size_t TextIndex = TheEntry.TextIndex;
+  if (TextIndex == NoText) {
+    // Build the text from the text of the parent. Several threads may build
+    // the same text, and then they all get the same String Pool index.
+    std::string Text(getText(TheEntry.Parent));
+    Text += StringPool::getStringValue(TheEntry.NameIndex);
+    Text += "::";
+    TextIndex = StringPool::getStringIndex(Text);
+    TheEntry.TextIndex = TextIndex;
+  }
+  return StringPool::getStringValue(TextIndex);
+}
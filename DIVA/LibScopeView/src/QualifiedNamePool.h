@@ -0,0 +1,127 @@
+//===-- QualifiedNamePool.h -------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Definition of the QualifiedNamePool class.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUALIFIEDNAMEPOOL_H_
+#define QUALIFIEDNAMEPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LibScopeView {
+
+/// \brief This class implements a pool of the qualifiers of the object names,
+/// such as "ns::Class::".
+///
+/// Qualifiers are stored as a tree: each one is its parent qualifiers followed
+/// by a single name, given by its String Pool index, so the qualifiers of
+/// nested scopes share their common prefix. Index 0 is the empty qualifiers.
+/// The text of some qualifiers is only built when it is first asked for, and
+/// then kept in the String Pool. Qualifiers can be added and read by several
+/// threads at once.
+class QualifiedNamePool {
+public:
+  QualifiedNamePool(QualifiedNamePool const &) = delete;
+  QualifiedNamePool &operator=(QualifiedNamePool const &) = delete;
+
+  /// \brief Index of the qualifiers at Parent followed by the name with the
+  /// given String Pool index, adding them if required.
+  static size_t getQualifiedIndex(size_t Parent, size_t NameIndex);
+
+  /// \brief Index of the qualifiers with the given text, e.g. "ns::Class::",
+  /// adding them if required.
+  static size_t getQualifiedIndex(const std::string &Text);
+
+  /// \brief Looks for the qualifiers with the given text without adding them.
+  static size_t lookupQualifiedIndex(const std::string &Text, bool &Found);
+
+  /// \brief Text of the qualifiers, ending with "::" unless it is empty.
+  static const char *getQualifiedText(size_t Index);
+
+  static void create();
+  static void destroy();
+
+  /// \brief Split the text of qualifiers in its names, ignoring the "::"
+  /// inside template arguments or function parameters.
+  static std::vector<std::string> splitQualifiers(const std::string &Text);
+
+private:
+  QualifiedNamePool();
+  ~QualifiedNamePool();
+
+  size_t getIndex(size_t Parent, size_t NameIndex);
+  size_t lookup(size_t Parent, size_t NameIndex, bool &Found);
+  const char *getText(size_t Index);
+
+  struct Entry {
+    size_t Parent;
+    size_t NameIndex;
+    // String Pool index of the text once it has been built, NoText before.
+    std::atomic<size_t> TextIndex;
+  };
+  static const size_t NoText = static_cast<size_t>(-1);
+
+  Entry &getEntry(size_t Index) {
+    return Chunks[Index >> ChunkBits][Index & (ChunkSize - 1)];
+  }
+
+  // The entries are stored in chunks that never move, so an entry can be read
+  // while others are added.
+  static const size_t ChunkBits = 12;
+  static const size_t ChunkSize = size_t(1) << ChunkBits;
+  static const size_t MaxChunks = size_t(1) << 16;
+  std::unique_ptr<Entry[]> Chunks[MaxChunks];
+  size_t EntryCount;
+  std::mutex StorageMutex;
+
+  // Index of each (parent, name) pair, in shards each with its own lock.
+  struct Key {
+    size_t Parent;
+    size_t NameIndex;
+    bool operator==(const Key &Other) const {
+      return Parent == Other.Parent && NameIndex == Other.NameIndex;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &K) const {
+      return std::hash<size_t>()(K.Parent * 31 + K.NameIndex);
+    }
+  };
+  static const size_t ShardCount = 64;
+  std::unordered_map<Key, size_t, KeyHash> Shards[ShardCount];
+  std::mutex ShardLocks[ShardCount];
+};
+
+} // namespace LibScopeView
+
+#endif // QUALIFIEDNAMEPOOL_H_
@@ -28,23 +28,30 @@
 //===----------------------------------------------------------------------===//
 
 #include "Reader.h"
+#include "Error.h"
+#include "FileUtilities.h"
 #include "Line.h"
 #include "PrintContext.h"
-#include "ScopeVisitor.h"
+#include "ScopeTreeSerializer.h"
 #include "Symbol.h"
 #include "Type.h"
 #include "Utilities.h"
 
 #include <algorithm>
 #include <assert.h>
-#include <iostream>
+#include <iomanip>
 #include <sstream>
+#include <unordered_map>
 #include <unordered_set>
 
 using namespace LibScopeView;
 
 namespace {
-Reader *GlobalReader = nullptr;
+// Each thread prints the tree of its own reader.
+thread_local Reader *GlobalReader = nullptr;
+
+// The reader creating the children of a lazy compile unit on this thread.
+thread_local Reader *MaterializingReader = nullptr;
 }
 
 Reader *LibScopeView::getReader() { return GlobalReader; }
@@ -55,17 +62,31 @@ void Reader::printSummary(const PrintSettings &Settings) {
   if (!PrintedHeader) {
     getScopesRoot()->dump(Settings);
   }
-  TheSummaryTable.getPrintedSummaryTable(std::cout);
+  std::ostringstream Summary;
+  TheSummaryTable.getPrintedSummaryTable(Summary);
+  GlobalPrintContext->print("%s", Summary.str().c_str());
 }
 
 void Reader::print(const PrintSettings &Settings) {
-  // If doing any search (--filter), do not do any scope tree printing.
-  if (!Settings.Filters.empty() || !Settings.FilterAnys.empty()) {
+  // The output of each file doesn't depend on the files printed before it.
+  Object::resetFileIndex();
+
+  // If doing any search (--lookup-address, --find, --filter), do not do any
+  // scope tree printing.
+  if (Settings.SummaryOnly) {
+    // There is no tree, only the counts of its objects.
+    PrintedHeader = true;
+    printSummary(Settings);
+  } else if (Settings.LookupAddresses) {
+    printAddresses(Settings);
+  } else if (!Settings.Finds.empty()) {
+    printFoundObjects(Settings);
+  } else if (!Settings.Filters.empty() || !Settings.FilterAnys.empty()) {
     printObjects(Settings);
   } else {
     printScopes(Settings);
   }
-  std::cout << "\n";
+  GlobalPrintContext->print("\n");
 }
 
 void Reader::printObjects(const PrintSettings &Settings) {
@@ -87,6 +108,71 @@ void Reader::printObjects(const PrintSettings &Settings) {
     printSummary(Settings);
 }
 
+void Reader::printFoundObjects(const PrintSettings &Settings) {
+  MatchedObjects Found;
+  std::unordered_set<std::string> Names;
+  for (const std::string &Name : Settings.Finds)
+    if (Names.insert(Name).second) {
+      const std::vector<Object *> &Objects = findObjects(Name);
+      Found.insert(Found.end(), Objects.begin(), Objects.end());
+    }
+
+  if (getPrintObjects() && Found.size()) {
+    // Get the sorting callback function.
+    SortFunction SortFunc = getSortFunction(Settings.SortKey);
+    if (SortFunc) {
+      std::stable_sort(Found.begin(), Found.end(), SortFunc);
+    }
+
+    getScopesRoot()->dump(Settings);
+    PrintedHeader = true;
+
+    for (Object *Obj : Found)
+      Obj->dump(Settings);
+  }
+
+  if (Settings.ShowSummary)
+    printSummary(Settings);
+}
+
+void Reader::printAddresses(const PrintSettings &Settings) {
+  std::vector<Dwarf_Addr> Addresses(Settings.Addresses.begin(),
+                                    Settings.Addresses.end());
+  std::vector<AddressIndex::Location> Locations =
+      getAddressIndex().find(Addresses);
+
+  getScopesRoot()->dump(Settings);
+  PrintedHeader = true;
+
+  for (size_t Index = 0; Index < Addresses.size(); ++Index) {
+    GlobalPrintContext->print("\n{Address} 0x%016" DW_PR_DUx "\n",
+                              Addresses[Index]);
+    const AddressIndex::Location &Loc = Locations[Index];
+    if (!Loc.Innermost) {
+      GlobalPrintContext->print("  - Not found\n");
+      continue;
+    }
+    if (Loc.Row)
+      GlobalPrintContext->print(
+          "  {%s} %llu \"%s\"\n", Loc.Row->getKindAsString(),
+          static_cast<unsigned long long>(Loc.Row->getLineNumber()),
+          Loc.Row->getFileName(/*NameOnly=*/true).c_str());
+
+    // The inlining chain, from the innermost scope out to its compile unit.
+    for (const Scope *Scp = Loc.Innermost; Scp && Scp != getScopesRoot();
+         Scp = Scp->getParent()) {
+      std::string Text(Scp->getAsText(Settings));
+      Text.resize(std::min(Text.size(), Text.find('\n')));
+      GlobalPrintContext->print("  %s\n", Text.c_str());
+      if (Scp->getIsInlined())
+        GlobalPrintContext->print("    - Inlined\n");
+    }
+  }
+
+  if (Settings.ShowSummary)
+    printSummary(Settings);
+}
+
 void Reader::printScopes(const PrintSettings &Settings) {
   bool DoPrint = getPrintObjects();
   if (DoPrint) {
@@ -120,6 +206,59 @@ void Reader::printScopes(const PrintSettings &Settings) {
     printSummary(Settings);
 }
 
+namespace {
+
+// Key identifying the scope tree created from FileName with the given
+// settings. Empty if the file can not be identified, or if the tree is only of
+// the compile units selected by --cu.
+std::string getCacheKey(const std::string &FileName,
+                        const PrintSettings &Settings) {
+  if (!Settings.CompileUnitFilters.empty() ||
+      !Settings.CompileUnitFilterAnys.empty())
+    return "";
+
+  std::string Key;
+  std::string BuildID;
+  uint64_t Hash;
+  uint64_t Size;
+  int64_t ModifiedTime;
+  if (getElfBuildID(FileName, BuildID) &&
+      getFileSizeAndTime(FileName, Size, ModifiedTime)) {
+    // Stripping a file, or keeping only its debug information, keeps the
+    // build-id, so the file itself is told apart by its size and time.
+    std::stringstream Stream;
+    Stream << "buildid-" << BuildID << "-" << std::hex << Size << "-"
+           << ModifiedTime;
+    Key = Stream.str();
+  } else if (getFileContentHash(FileName, Hash)) {
+    std::stringstream Stream;
+    Stream << "content-" << std::hex << std::setw(16) << std::setfill('0')
+           << Hash;
+    Key = Stream.str();
+  } else {
+    return "";
+  }
+
+  // Options that change the tree created by the readers.
+  if (Settings.DedupTypes)
+    Key += "-dedup";
+  return Key;
+}
+
+// Return true if the options need every object of the tree once it is loaded,
+// so the children of the compile units are not created lazily: the filters
+// are matched and the global and local objects are found while loading, and
+// --dedup-types shares types in the order of the compile units.
+bool needsWholeTree(const PrintSettings &Settings) {
+  return !Settings.Filters.empty() || !Settings.FilterAnys.empty() ||
+         !Settings.WithChildrenFilters.empty() ||
+         !Settings.WithChildrenFilterAnys.empty() ||
+         Settings.ShowOnlyGlobals != Settings.ShowOnlyLocals ||
+         Settings.DedupTypes;
+}
+
+} // namespace
+
 bool Reader::loadFile(const std::string &FileName,
                       const PrintSettings &Settings) {
   destroyScopes();
@@ -129,137 +268,390 @@ bool Reader::loadFile(const std::string &FileName,
   // to access it.
   setReader(this);
 
-  // Delegate the scope tree creation to the respective reader.
-  if (!createScopes())
-    return false;
+  // Only the summary table is printed, which doesn't need the tree.
+  if (Settings.SummaryOnly) {
+    PassTimes.clear();
+    auto StartTime = getCurrentTime();
+    if (!countObjects(Settings))
+      return false;
+    addPassTime("count", StartTime);
+    return true;
+  }
+
+  // Keep the settings to create the children of the compile units lazily. A
+  // tree read lazily is not complete, so it is not cached.
+  if (Settings.LazyScopes && !needsWholeTree(Settings))
+    LazySettings = std::make_unique<PrintSettings>(Settings);
+
+  // Reuse the tree cached by a previous run if the file has not changed. The
+  // cached tree is the one created by the reader, before any of the option
+  // dependent post-creation actions.
+  std::string CacheKey;
+  std::string CacheFile;
+  if (!Settings.CacheDirectory.empty() && !getReadsLazily()) {
+    CacheKey = getCacheKey(FileName, Settings);
+    if (!CacheKey.empty()) {
+      CacheFile = unifyFilePath(Settings.CacheDirectory) + "/" + CacheKey +
+                  ".divatree";
+      Scopes = ScopeTreeSerializer::readFile(CacheFile, CacheKey);
+    }
+  }
+
+  PassTimes.clear();
+  auto StartTime = getCurrentTime();
+  if (Scopes) {
+    Scopes->setName(FileName.c_str());
+    addPassTime("read cache", StartTime);
+  } else {
+    // Delegate the scope tree creation to the respective reader.
+    if (!createScopes(Settings))
+      return false;
+    Scopes->compactChildren();
+    Scopes->propagateHasFlags();
+    addPassTime("create", StartTime);
+
+    // A tree without units, e.g. of a stripped file, is quick to read again.
+    if (!CacheFile.empty() && !Scopes->getChildren().empty() &&
+        (!recursiveMakeDir(unifyFilePath(Settings.CacheDirectory)) ||
+         !ScopeTreeSerializer::writeFile(*Scopes, CacheKey, CacheFile)))
+      LibScopeError::warning("Unable to write the cache file '" + CacheFile +
+                             "'.");
+  }
 
   postCreationActions(Settings);
+
+  // The lazy compile units have been resolved and sorted on their own, so
+  // their children can now be created.
+  for (Scope *Unit : LazyUnits)
+    Unit->setLazyChildren(this, Unit->getLazyChildCount());
+  if (LazyUnits.empty())
+    LazySettings.reset();
+  LazyUnits.clear();
   return true;
 }
 
-// Visitors for post-creation actions.
+void Reader::addLazyUnit(Scope *Unit, uint32_t DieChildCount) {
+  Unit->setLazyChildren(nullptr, DieChildCount);
+  LazyUnits.push_back(Unit);
+}
+
+// Post-creation actions.
 namespace {
 
-// Visitor that creates all the full type names once the CU tree has been
-// created.
-class NameResolver : public ScopeVisitor {
+// Resolves the objects once the tree has been created: the full names of the
+// types, the attributes that objects take from those they reference, the
+// global references and the objects matching the filters. Each object is
+// resolved in a single visit of the tree, with the objects it depends on
+// resolved first, on demand.
+//
+// The units under the root (compile and type units) are resolved in parallel.
+// An object that depends on an object of another unit is put aside while that
+// unit may still be changing; such objects are resolved in further parallel
+// rounds, once the units they depend on are complete.
+class TreeResolver {
 public:
-  NameResolver(const PrintSettings &PrintingSettings)
-      : Settings(PrintingSettings) {}
+  TreeResolver(Scope *Root, const PrintSettings &Settings)
+      : Root(Root), Settings(Settings) {}
 
-private:
-  void visitImpl(Object *Obj) override {
-    resolve(Obj);
-    visitChildren(Obj);
-  }
+  void resolve(std::vector<Object *> &MatchedObjects,
+               std::vector<Scope *> &MatchedScopes);
 
-  void resolve(Object *Obj) {
-    if (AlreadyResolved.count(Obj))
-      return;
-    AlreadyResolved.insert(Obj);
+  // Resolves the objects of a unit created after the others were resolved.
+  void resolveUnit(Scope *Unit, std::vector<Object *> &MatchedObjects,
+                   std::vector<Scope *> &MatchedScopes);
 
-    // Resolve type names.
-    if (auto Ty = dynamic_cast<Type *>(Obj)) {
-      resolveTypeName(Ty);
-      return;
-    }
+private:
+  // Objects matching a filter, flagged as pending if their names were not
+  // resolved when they were visited.
+  typedef std::vector<std::pair<Object *, bool>> MatchList;
+
+  // The resolution of the objects of a unit.
+  struct UnitState {
+    // The unit, or null once any object can be resolved.
+    const Object *Unit = nullptr;
+    // Objects that depend on other units, not resolved yet.
+    std::vector<Object *> Deferred;
+    MatchList ObjectMatches;
+    MatchList ScopeMatches;
+    // Objects being resolved, to stop at cycles.
+    std::vector<const Object *> NameStack;
+    std::vector<const Object *> ReferenceStack;
+  };
+
+  void visit(Object *Obj, UnitState &State);
+  void visitObject(Object *Obj, UnitState &State);
+  bool resolveObject(Object *Obj, UnitState &State);
+  bool canResolve(const Object *Obj, const UnitState &State) const;
+
+  bool resolveName(Object *Obj, UnitState &State);
+  bool resolveFunctionPointerName(ScopeFunction *Func, UnitState &State);
+  bool resolveTypeName(Type *Ty, UnitState &State);
+  bool resolveArrayName(ScopeArray *Array, UnitState &State);
+  bool resolveReference(Object *Obj, UnitState &State);
+
+  void collectMatches(const MatchList &Matches, bool Tree,
+                      std::vector<Object *> &Objects) const;
+  bool matches(const Object *Obj, bool Tree) const;
+
+  Scope *Root;
+  const PrintSettings &Settings;
 
-    if (auto ObjScope = dynamic_cast<Scope *>(Obj)) {
-      // Resolve function pointer names.
-      if (ObjScope->getIsSubroutineType()) {
-        resolveFunctionPointerName(dynamic_cast<ScopeFunction *>(Obj));
-        return;
-      }
+  // Index of each unit, and whether it was complete at the start of the
+  // current round.
+  std::unordered_map<const Object *, size_t> UnitIndexes;
+  std::vector<char> CompleteUnits;
+};
 
-      // Resolve array names.
-      if (ObjScope->getIsArrayType()) {
-        resolveArrayName(dynamic_cast<ScopeArray *>(Obj));
-        return;
-      }
-    }
+void TreeResolver::resolve(std::vector<Object *> &MatchedObjects,
+                           std::vector<Scope *> &MatchedScopes) {
+  // The root has nothing to resolve, but can match the filters.
+  UnitState RootState;
+  visitObject(Root, RootState);
+
+  const std::vector<Object *> Units(Root->getChildren().begin(),
+                                    Root->getChildren().end());
+  std::vector<UnitState> States(Units.size());
+  for (size_t Index = 0; Index < Units.size(); ++Index) {
+    UnitIndexes.emplace(Units[Index], Index);
+    States[Index].Unit = Units[Index];
   }
-
-  void resolveFunctionPointerName(ScopeFunction *Func) {
-    // Make sure the return type is resolved first.
-    if (Func->getType())
-      resolve(Func->getType());
-
-    std::stringstream ResolvedName;
-    ResolvedName << Func->getTypeAsString(Settings) << " (*)(";
-
-    // Add the parameters.
-    bool First = true;
-    for (auto *Sym : Func->getSymbols()) {
-      if (Sym->getIsParameter()) {
-        // Make sure the parameters are resolved.
-        if (Sym->getType())
-          resolve(Sym->getType());
-        ResolvedName << (First ? "" : ",") << Sym->getTypeName();
-        First = false;
+  CompleteUnits.assign(Units.size(), false);
+  parallelFor(Units.size(),
+              [&](size_t Index) { visit(Units[Index], States[Index]); });
+  UnitState LineState;
+  for (Object *Ln : Root->getLines())
+    visit(Ln, LineState);
+
+  // Retry the deferred objects, while some get resolved.
+  size_t Deferred = 0;
+  for (const UnitState &State : States)
+    Deferred += State.Deferred.size();
+  while (Deferred) {
+    for (size_t Index = 0; Index < Units.size(); ++Index)
+      CompleteUnits[Index] = States[Index].Deferred.empty();
+    parallelFor(Units.size(), [&](size_t Index) {
+      std::vector<Object *> &Objects = States[Index].Deferred;
+      Objects.erase(std::remove_if(Objects.begin(), Objects.end(),
+                                   [&](Object *Obj) {
+                                     return resolveObject(Obj, States[Index]);
+                                   }),
+                    Objects.end());
+    });
+
+    size_t StillDeferred = 0;
+    for (const UnitState &State : States)
+      StillDeferred += State.Deferred.size();
+    if (StillDeferred == Deferred) {
+      // The units depend on each other, so resolve the rest on this thread.
+      for (UnitState &State : States) {
+        State.Unit = nullptr;
+        for (Object *Obj : State.Deferred)
+          resolveObject(Obj, State);
       }
+      break;
     }
+    Deferred = StillDeferred;
+  }
 
-    ResolvedName << ")";
-    Func->setName(ResolvedName.str().c_str());
+  // Keep the matches in the order of the tree.
+  std::vector<Object *> Scopes;
+  collectMatches(RootState.ObjectMatches, false, MatchedObjects);
+  collectMatches(RootState.ScopeMatches, true, Scopes);
+  for (const UnitState &State : States) {
+    collectMatches(State.ObjectMatches, false, MatchedObjects);
+    collectMatches(State.ScopeMatches, true, Scopes);
   }
+  collectMatches(LineState.ObjectMatches, false, MatchedObjects);
+  for (Object *Scp : Scopes)
+    MatchedScopes.push_back(static_cast<Scope *>(Scp));
+}
+
+void TreeResolver::resolveUnit(Scope *Unit,
+                               std::vector<Object *> &MatchedObjects,
+                               std::vector<Scope *> &MatchedScopes) {
+  // The objects of the other units no longer change, so with no unit set in
+  // the state any object can be resolved.
+  UnitState State;
+  visit(Unit, State);
+  assert(State.Deferred.empty() && "Objects of a unit were not resolved");
+
+  std::vector<Object *> Scopes;
+  collectMatches(State.ObjectMatches, false, MatchedObjects);
+  collectMatches(State.ScopeMatches, true, Scopes);
+  for (Object *Scp : Scopes)
+    MatchedScopes.push_back(static_cast<Scope *>(Scp));
+}
+
+void TreeResolver::visit(Object *Obj, UnitState &State) {
+  visitObject(Obj, State);
+
+  if (!Obj->getIsScope())
+    return;
+  auto Scp = static_cast<Scope *>(Obj);
+  for (Object *Child : Scp->getChildren())
+    visit(Child, State);
+  for (Object *Ln : Scp->getLines())
+    visit(Ln, State);
+}
+
+void TreeResolver::visitObject(Object *Obj, UnitState &State) {
+  const bool Resolved = resolveObject(Obj, State);
+  if (!Resolved)
+    State.Deferred.push_back(Obj);
+
+  // Resolve any filters, or check them once the object is resolved.
+  // TODO: Filters should be evaluated while printing.
+  if (!Resolved || matches(Obj, false))
+    State.ObjectMatches.emplace_back(Obj, !Resolved);
+  if (Obj->getIsScope() && (!Resolved || matches(Obj, true)))
+    State.ScopeMatches.emplace_back(Obj, !Resolved);
+
+  // If the parent is global then mark this as global.
+  if (Obj->getParent() && Obj->getParent()->getIsGlobalReference())
+    Obj->setIsGlobalReference();
+}
+
+bool TreeResolver::resolveObject(Object *Obj, UnitState &State) {
+  if (!resolveName(Obj, State) || !resolveReference(Obj, State))
+    return false;
+  Obj->setIsResolved();
+  return true;
+}
 
-  void resolveTypeName(Type *Ty) {
-    // Make sure Ty's type is resolved first.
-    if (Ty->getType())
-      resolve(Ty->getType());
+bool TreeResolver::canResolve(const Object *Obj,
+                              const UnitState &State) const {
+  if (!State.Unit)
+    return true;
+
+  // Find the unit of the object.
+  const Object *Unit = Obj;
+  while (Unit->getParent() && Unit->getParent() != Root)
+    Unit = Unit->getParent();
+  if (Unit == State.Unit)
+    return true;
+
+  // The objects of another unit can only be used once that unit no longer
+  // changes.
+  auto Found = UnitIndexes.find(Unit);
+  return Found != UnitIndexes.end() && CompleteUnits[Found->second];
+}
 
-    bool Ret = Ty->setFullName(Settings);
-    // setFullName keys off DWARF tags and will return false if it doesn't
-    // recognise the tag.
-    assert(Ret && "Unrecognised DWARF Tag in Object::setFullName");
-    (void)Ret;
+bool TreeResolver::resolveName(Object *Obj, UnitState &State) {
+  // The flags of the objects of another unit can only be read once that unit
+  // no longer changes.
+  if (!canResolve(Obj, State))
+    return false;
+  if (Obj->getIsNameResolved())
+    return true;
+  if (std::find(State.NameStack.begin(), State.NameStack.end(), Obj) !=
+      State.NameStack.end())
+    return true;
+
+  State.NameStack.push_back(Obj);
+  bool Resolved = true;
+  if (auto Ty = dynamic_cast<Type *>(Obj)) {
+    // Resolve type names.
+    Resolved = resolveTypeName(Ty, State);
+  } else if (auto ObjScope = dynamic_cast<Scope *>(Obj)) {
+    if (ObjScope->getIsSubroutineType())
+      // Resolve function pointer names.
+      Resolved =
+          resolveFunctionPointerName(dynamic_cast<ScopeFunction *>(Obj), State);
+    else if (ObjScope->getIsArrayType())
+      // Resolve array names.
+      Resolved = resolveArrayName(dynamic_cast<ScopeArray *>(Obj), State);
   }
+  State.NameStack.pop_back();
 
-  void resolveArrayName(ScopeArray *Array) {
-    // Make sure Array's type is resolved first.
-    Object *ArrayType = Array->getType();
-    if (ArrayType)
-      resolve(ArrayType);
+  if (Resolved)
+    Obj->setIsNameResolved();
+  return Resolved;
+}
 
-    std::string ResolvedName(
-        ArrayType && ArrayType->getName() ? ArrayType->getName() : "?");
-    ResolvedName += " ";
+bool TreeResolver::resolveFunctionPointerName(ScopeFunction *Func,
+                                              UnitState &State) {
+  // Make sure the return type is resolved first.
+  if (Func->getType() && !resolveName(Func->getType(), State))
+    return false;
 
-    for (const auto *Ty : Array->getTypes()) {
-      if (Ty->getIsSubrangeType())
-        ResolvedName += Ty->getName();
+  std::stringstream ResolvedName;
+  ResolvedName << Func->getTypeAsString(Settings) << " (*)(";
+
+  // Add the parameters.
+  bool First = true;
+  for (auto *Sym : Func->getSymbols()) {
+    if (Sym->getIsParameter()) {
+      // Make sure the parameters are resolved.
+      if (Sym->getType() && !resolveName(Sym->getType(), State))
+        return false;
+      ResolvedName << (First ? "" : ",") << Sym->getTypeName();
+      First = false;
     }
-    Array->setName(ResolvedName.c_str());
   }
 
-  const PrintSettings &Settings;
-  std::unordered_set<Object *> AlreadyResolved;
-};
+  ResolvedName << ")";
+  Func->setName(ResolvedName.str().c_str());
+  return true;
+}
 
-// Visitor that sets the attributes of objects to those they reference.
-class ReferenceAttributeResolver : public ScopeVisitor {
-private:
-  void visitImpl(Object *Obj) override {
-    resolveReference(Obj);
-    visitChildren(Obj);
-  }
+bool TreeResolver::resolveTypeName(Type *Ty, UnitState &State) {
+  // Make sure Ty's type is resolved first.
+  if (Ty->getType() && !resolveName(Ty->getType(), State))
+    return false;
+
+  bool Ret = Ty->setFullName(Settings);
+  // setFullName keys off DWARF tags and will return false if it doesn't
+  // recognise the tag.
+  assert(Ret && "Unrecognised DWARF Tag in Object::setFullName");
+  (void)Ret;
+  return true;
+}
+
+bool TreeResolver::resolveArrayName(ScopeArray *Array, UnitState &State) {
+  // Make sure Array's type is resolved first.
+  Object *ArrayType = Array->getType();
+  if (ArrayType && !resolveName(ArrayType, State))
+    return false;
 
-  // Get an Object's referenced Object, handling any type specifics.
-  static Object *getObjectReference(Object *Obj) {
-    if (auto Scp = dynamic_cast<Scope *>(Obj))
-      return Scp->getReference();
-    if (auto Sym = dynamic_cast<Symbol *>(Obj))
-      return Sym->getReference();
-    return nullptr;
+  std::string ResolvedName(
+      ArrayType && ArrayType->getName() ? ArrayType->getName() : "?");
+  ResolvedName += " ";
+
+  for (const auto *Ty : Array->getTypes()) {
+    if (Ty->getIsSubrangeType())
+      ResolvedName += Ty->getName();
   }
+  Array->setName(ResolvedName.c_str());
+  return true;
+}
 
-  static void resolveReference(Object *Obj) {
-    auto *Reference = getObjectReference(Obj);
-    if (!Reference)
-      return;
+// Get an Object's referenced Object, handling any type specifics.
+Object *getObjectReference(Object *Obj) {
+  if (auto Scp = dynamic_cast<Scope *>(Obj))
+    return Scp->getReference();
+  if (auto Sym = dynamic_cast<Symbol *>(Obj))
+    return Sym->getReference();
+  return nullptr;
+}
+
+// Sets the attributes of an object to those of the object it references.
+bool TreeResolver::resolveReference(Object *Obj, UnitState &State) {
+  if (Obj->getIsReferenceResolved())
+    return true;
+  auto *Reference = getObjectReference(Obj);
+  if (Reference) {
+    if (!canResolve(Reference, State))
+      return false;
+    if (std::find(State.ReferenceStack.begin(), State.ReferenceStack.end(),
+                  Obj) != State.ReferenceStack.end())
+      return true;
 
     // Resolve the reference first.
-    resolveReference(Reference);
+    State.ReferenceStack.push_back(Obj);
+    const bool Resolved = resolveReference(Reference, State);
+    State.ReferenceStack.pop_back();
+    if (!Resolved)
+      return false;
 
     // Set common attribute values.
     Obj->setNameIndex(Reference->getNameIndex());
@@ -284,47 +676,93 @@ private:
     if (Obj->getIsSymbol() && Reference->getIsSymbol())
       Obj->resolveQualifiedName(Reference->getParent());
   }
-};
+  Obj->setIsReferenceResolved();
+  return true;
+}
 
-// Visitor that does any modifications to the CU tree that need to be done after
-// it has been created and the type names and references have been resolved.
-class TreeResolver : public ScopeVisitor {
-public:
-  TreeResolver(Reader &Reader, const PrintSettings &PrintingSettings)
-      : ReaderInstance(Reader), Settings(PrintingSettings) {}
+bool TreeResolver::matches(const Object *Obj, bool Tree) const {
+  if (!Obj->isNamed())
+    return false;
+  return Tree ? Settings.matchesWithChildrenFilterPattern(Obj->getName())
+              : Settings.matchesFilterPattern(Obj->getName());
+}
 
-private:
-  void visitImpl(Object *Obj) override {
-    if (Obj->getIsResolved())
-      return;
-    Obj->setIsResolved();
-
-    // Resolve any filters.
-    // TODO: Filters should be evaluated while printing.
-    ReaderInstance.resolveFilterPatternMatch(Obj, Settings);
-    if (auto Scp = dynamic_cast<Scope *>(Obj))
-      ReaderInstance.resolveTreePatternMatch(Scp, Settings);
-
-    // If the parent is global then mark this as global.
-    if (Obj->getParent() && Obj->getParent()->getIsGlobalReference())
-      Obj->setIsGlobalReference();
-
-    visitChildren(Obj);
-  }
+void TreeResolver::collectMatches(const MatchList &Matches, bool Tree,
+                                  std::vector<Object *> &Objects) const {
+  for (const std::pair<Object *, bool> &Match : Matches)
+    if (!Match.second || matches(Match.first, Tree))
+      Objects.push_back(Match.first);
+}
 
-  Reader &ReaderInstance;
-  const PrintSettings &Settings;
-};
 } // namespace
 
 void Reader::postCreationActions(const PrintSettings &Settings) {
   assert(Scopes);
 
-  NameResolver(Settings).visit(Scopes);
-  ReferenceAttributeResolver().visit(Scopes);
-  TreeResolver(*this, Settings).visit(Scopes);
+  auto StartTime = getCurrentTime();
+  TreeResolver(Scopes, Settings).resolve(ViewMatchedObjects, ViewMatchedScopes);
+  addPassTime("resolve", StartTime);
 
+  StartTime = getCurrentTime();
   Scopes->sortScopes(Settings.SortKey);
+  addPassTime("sort", StartTime);
+}
+
+void Reader::materializeChildren(Scope &Scp) {
+  // The unit being created by this thread is read as it is.
+  if (MaterializingReader == this)
+    return;
+  std::lock_guard<std::mutex> Lock(LazyMutex);
+  if (!Scp.getHasLazyChildren())
+    return;
+
+  // The objects are counted by the reader of the tree, whichever thread asks
+  // for them.
+  Reader *SavedReader = getReader();
+  setReader(this);
+  MaterializingReader = this;
+
+  createLazyChildren(Scp);
+  Scp.compactChildren();
+  // Other threads read the flags of the unit and the root without the lock,
+  // so they keep those set at load time and only the new scopes are set. The
+  // Has* flags are only used by options that read the whole tree anyway.
+  Scp.propagateChildHasFlags();
+
+  // The other units are complete, so the post-creation actions only need to
+  // visit this one.
+  TreeResolver(Scopes, *LazySettings)
+      .resolveUnit(&Scp, ViewMatchedObjects, ViewMatchedScopes);
+  Scp.sortScopes(LazySettings->SortKey);
+
+  MaterializingReader = nullptr;
+  setReader(SavedReader);
+  Scp.setLazyChildren(nullptr, 0U);
+}
+
+void Reader::addPassTime(
+    const char *Pass, const std::chrono::steady_clock::time_point &StartTime) {
+  typedef std::chrono::duration<double, std::ratio<1>> Seconds;
+  PassTimes.emplace_back(
+      Pass, std::chrono::duration_cast<Seconds>(getCurrentTime() - StartTime)
+                .count());
+}
+
+const std::vector<Object *> &
+Reader::findObjects(const std::string &QualifiedName) {
+  {
+    std::lock_guard<std::mutex> Lock(NameIndexMutex);
+    if (!TheNameIndex)
+      TheNameIndex = std::make_unique<NameIndex>(Scopes);
+  }
+  return TheNameIndex->find(QualifiedName);
+}
+
+const AddressIndex &Reader::getAddressIndex() {
+  std::lock_guard<std::mutex> Lock(AddressIndexMutex);
+  if (!TheAddressIndex)
+    TheAddressIndex = std::make_unique<AddressIndex>(Scopes);
+  return *TheAddressIndex;
 }
 
 void Reader::propagatePatternMatch() {
@@ -30,38 +30,82 @@
 #ifndef READER_H
 #define READER_H
 
+#include "AddressIndex.h"
+#include "NameIndex.h"
 #include "PrintSettings.h"
 #include "Scope.h"
 #include "SummaryTable.h"
 
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 namespace LibScopeView {
 
 class Scope;
 
 /// \brief Representation for a generic reader.
-class Reader {
+class Reader : public ScopeMaterializer {
 public:
   Reader() : Scopes(nullptr), PrintedHeader(false) {}
 
   bool loadFile(const std::string &FileName, const PrintSettings &Settings);
   void print(const PrintSettings &Settings);
 
+  /// \brief Name and time taken in seconds of each pass of the last loadFile:
+  /// the creation of the tree (or the reading of its cache), the resolution
+  /// of its objects and its sorting.
+  typedef std::vector<std::pair<const char *, double>> PassTimeList;
+  const PassTimeList &getPassTimes() const { return PassTimes; }
+
   virtual ~Reader() { delete Scopes; }
 
+  /// \brief Create the children of a compile unit read lazily
+  /// (--lazy-scopes), and then run the post-creation actions on them. Can be
+  /// called from any thread.
+  void materializeChildren(Scope &Scp) override;
+
 private:
   // TODO: Make pure virtual but all the tests currently have to instantiate a
   // Reader to not crash, so that needs to be fixed first.
   /// \brief Implements the creation of the tree from a file.
-  virtual bool createScopes() { return false; }
+  virtual bool createScopes(const PrintSettings &) { return false; }
+
+  /// \brief Implements the counting of the objects of a file for the summary
+  /// table (--summary-only). Readers that can count them without creating the
+  /// tree override it.
+  virtual bool countObjects(const PrintSettings &Settings) {
+    return createScopes(Settings);
+  }
+
+  /// \brief Implements the creation of the children and lines of a compile
+  /// unit added by addLazyUnit.
+  virtual void createLazyChildren(Scope & /*Unit*/) {}
 
   void postCreationActions(const PrintSettings &Settings);
 
   void destroyScopes() {
+    LazySettings.reset();
+    LazyUnits.clear();
+    TheNameIndex.reset();
+    TheAddressIndex.reset();
     delete Scopes;
     Scopes = nullptr;
   }
 
 protected:
+  /// \brief Return true if the children of the compile units of the file
+  /// being loaded can be created lazily (--lazy-scopes).
+  bool getReadsLazily() const { return LazySettings != nullptr; }
+
+  /// \brief Leave the children of a compile unit created without them to be
+  /// created by createLazyChildren when they are first requested, once the
+  /// file is loaded. DieChildCount is the number of Dies directly under the
+  /// unit's Die.
+  void addLazyUnit(Scope *Unit, uint32_t DieChildCount);
+
   Scope *Scopes;
 
   // A header has been printed.
@@ -70,22 +114,42 @@ protected:
 private:
   std::string InputFile;
 
+  // Time taken by each pass of loadFile.
+  PassTimeList PassTimes;
+  void addPassTime(const char *Pass,
+                   const std::chrono::steady_clock::time_point &StartTime);
+
   // Summary table member used with --show-summary.
   SummaryTable TheSummaryTable;
 
+  // Index of the object names, built by the first findObjects.
+  std::unique_ptr<NameIndex> TheNameIndex;
+  std::mutex NameIndexMutex;
+
+  // The settings of the last loadFile, kept while some compile units may
+  // still create their children lazily.
+  std::unique_ptr<PrintSettings> LazySettings;
+  std::mutex LazyMutex;
+  // The compile units added by addLazyUnit during the last loadFile.
+  std::vector<Scope *> LazyUnits;
+
+  // Index of the code addresses, built by the first getAddressIndex.
+  std::unique_ptr<AddressIndex> TheAddressIndex;
+  std::mutex AddressIndexMutex;
+
 public:
-  void incrementFound(const Object *Obj) {
-    TheSummaryTable.incrementFound(Obj);
+  void incrementFound(ObjectKind Kind) { TheSummaryTable.incrementFound(Kind); }
+  void incrementAdded(ObjectKind Kind) { TheSummaryTable.incrementAdded(Kind); }
+  void incrementPrinted(ObjectKind Kind) {
+    TheSummaryTable.incrementPrinted(Kind);
   }
-  void incrementAdded(const Object *Obj) {
-    TheSummaryTable.incrementAdded(Obj);
+  void incrementMissing(ObjectKind Kind) {
+    TheSummaryTable.incrementMissing(Kind);
   }
-  void incrementPrinted(const Object *Obj) {
-    TheSummaryTable.incrementPrinted(Obj);
-  }
-  void incrementMissing(const Object *Obj) {
-    TheSummaryTable.incrementMissing(Obj);
+  void addFound(ObjectKind Kind, uint32_t Count) {
+    TheSummaryTable.addFound(Kind, Count);
   }
+  const SummaryTable &getSummaryTable() const { return TheSummaryTable; }
 
 protected:
   // Scopes that match a pattern.
@@ -100,6 +164,8 @@ protected:
   virtual void printObjects(const PrintSettings &Settings);
   virtual void printScopes(const PrintSettings &Settings);
   virtual void printSummary(const PrintSettings &Settings);
+  virtual void printFoundObjects(const PrintSettings &Settings);
+  virtual void printAddresses(const PrintSettings &Settings);
 
 public:
   void propagatePatternMatch();
@@ -107,6 +173,16 @@ public:
   void resolveFilterPatternMatch(Object *object, const PrintSettings &Settings);
   void resolveFilterPatternMatch(Line *line, const PrintSettings &Settings);
 
+public:
+  /// \brief Returns the objects with the given qualified name, e.g.
+  /// "ns::Class::method", in tree order. The name index is built on the first
+  /// call, after which the objects are found without visiting the tree.
+  const std::vector<Object *> &findObjects(const std::string &QualifiedName);
+
+  /// \brief Returns the index from code addresses to the innermost scopes and
+  /// lines covering them, building it on the first call.
+  const AddressIndex &getAddressIndex();
+
 public:
   std::string getInputFile() const { return InputFile; }
 
@@ -35,6 +35,7 @@
 #include "Reader.h"
 #include "Symbol.h"
 #include "Type.h"
+#include "Utilities.h"
 
 #include <algorithm>
 #include <sstream>
@@ -54,22 +55,32 @@ Scope::Scope() : Element() {
 }
 
 Scope::~Scope() {
-  for (Type *Ty : TheTypes)
-    delete (Ty);
-  for (Symbol *Sym : TheSymbols)
-    delete (Sym);
-  for (Scope *Scp : TheScopes)
-    delete (Scp);
+  // Lazy children are not created just to be deleted.
+  for (int Run = 0; Run < ChildRunCount; ++Run) {
+    size_t Size;
+    Object **Children = getChildRunData(static_cast<ChildRun>(Run), Size);
+    for (size_t Index = 0; Index < Size; ++Index)
+      delete (Children[Index]);
+  }
   for (Line *Ln : TheLines)
     delete (Ln);
 }
 
-uint32_t Scope::ScopesAllocated = 0;
+void Scope::createLazyChildren() const {
+  // Checked again, as the children may have been created since.
+  if (ScopeMaterializer *Creator =
+          Materializer.load(std::memory_order_acquire))
+    Creator->materializeChildren(const_cast<Scope &>(*this));
+}
+
+std::atomic<uint32_t> Scope::ScopesAllocated(0);
 
 void Scope::setTag() {
-  ++Scope::ScopesAllocated;
+  uint32_t Count = ++Scope::ScopesAllocated;
 #ifndef NDEBUG
-  Tag = Scope::ScopesAllocated;
+  Tag = Count;
+#else
+  (void)Count;
 #endif
 }
 
@@ -105,37 +116,59 @@ const char *Scope::KindTryBlock = "TryBlock";
 const char *Scope::KindUndefined = "Undefined";
 const char *Scope::KindUnion = "Union";
 
-const char *Scope::getKindAsString() const {
-  const char *Kind = KindUndefined;
+const Object::KindEntry &Scope::getKindEntry() const {
+  static const KindEntry Array = {&KindArray, ObjectKind::Other};
+  static const KindEntry Block = {&KindBlock, ObjectKind::Block};
+  static const KindEntry Class = {&KindClass, ObjectKind::Class};
+  static const KindEntry CompileUnit = {&KindCompileUnit,
+                                        ObjectKind::CompileUnit};
+  static const KindEntry Enumeration = {&KindEnumeration, ObjectKind::Enum};
+  static const KindEntry File = {&KindFile, ObjectKind::Other};
+  static const KindEntry Function = {&KindFunction, ObjectKind::Function};
+  static const KindEntry InlinedFunction = {&KindInlinedFunction,
+                                            ObjectKind::Function};
+  static const KindEntry Namespace = {&KindNamespace, ObjectKind::Namespace};
+  static const KindEntry Struct = {&KindStruct, ObjectKind::Struct};
+  static const KindEntry TemplateAlias = {&KindTemplateAlias,
+                                          ObjectKind::Alias};
+  static const KindEntry TemplatePack = {&KindTemplatePack,
+                                         ObjectKind::TemplateParameter};
+  static const KindEntry Undefined = {&KindUndefined, ObjectKind::Other};
+  static const KindEntry Union = {&KindUnion, ObjectKind::Union};
+
   if (getIsArrayType())
-    Kind = KindArray;
-  else if (getIsBlock())
-    Kind = KindBlock;
-  else if (getIsCompileUnit())
-    Kind = KindCompileUnit;
-  else if (getIsEnumerationType())
-    Kind = KindEnumeration;
-  else if (getIsInlinedSubroutine())
-    Kind = KindInlinedFunction;
-  else if (getIsNamespace())
-    Kind = KindNamespace;
-  else if (getIsTemplatePack())
-    Kind = KindTemplatePack;
-  else if (getIsRoot())
-    Kind = KindFile;
-  else if (getIsTemplateAlias())
-    Kind = KindTemplateAlias;
-  else if (getIsClassType())
-    Kind = KindClass;
-  else if (getIsFunction())
-    Kind = KindFunction;
-  else if (getIsStructType())
-    Kind = KindStruct;
-  else if (getIsUnionType())
-    Kind = KindUnion;
-  return Kind;
+    return Array;
+  if (getIsBlock())
+    return Block;
+  if (getIsCompileUnit())
+    return CompileUnit;
+  if (getIsEnumerationType())
+    return Enumeration;
+  if (getIsInlinedSubroutine())
+    return InlinedFunction;
+  if (getIsNamespace())
+    return Namespace;
+  if (getIsTemplatePack())
+    return TemplatePack;
+  if (getIsRoot())
+    return File;
+  if (getIsTemplateAlias())
+    return TemplateAlias;
+  if (getIsClassType())
+    return Class;
+  if (getIsFunction())
+    return Function;
+  if (getIsStructType())
+    return Struct;
+  if (getIsUnionType())
+    return Union;
+  return Undefined;
 }
 
+const char *Scope::getKindAsString() const { return *getKindEntry().Label; }
+
+ObjectKind Scope::getKind() const { return getKindEntry().Kind; }
+
 void Scope::addObject(Line *Ln) {
   if (getCanHaveLines()) {
     // Add it to parent.
@@ -143,14 +176,15 @@ void Scope::addObject(Line *Ln) {
     Ln->setParent(this);
 
     // Update Object Summary Table.
-    getReader()->incrementFound(Ln);
+    getReader()->incrementFound(Ln->getKind());
 
     // Do not add the line records to the children, as they represent the
     // logical view for the text section. Preserve the original sequence.
     // m_children->push_back(line);
 
-    // Indicate that this tree branch has lines.
-    traverse(&Scope::getHasLines, &Scope::setHasLines, /*down=*/false);
+    // Indicate that this tree branch has lines. The parents are updated by
+    // propagateHasFlags.
+    setHasLines();
   } else {
     throw std::logic_error("Cannot set line records on a scope that's not a "
                            "function or module.\n");
@@ -159,68 +193,147 @@ void Scope::addObject(Line *Ln) {
 
 void Scope::addObject(Scope *Scp) {
   // Add it to parent.
-  TheScopes.push_back(Scp);
-  Children.push_back(Scp);
+  addChild(Scp, ScopeChildren);
   Scp->setParent(this);
 
   // Object Summary Table.
-  getReader()->incrementFound(Scp);
+  getReader()->incrementFound(Scp->getKind());
 
   // If the object is a global reference, mark its parent as having global
   // references; that information is used, to print only those branches
   // with global references.
+  // The parents are updated by propagateHasFlags.
   if (Scp->getIsGlobalReference()) {
-    traverse(&Scope::getHasGlobals, &Scope::setHasGlobals, /*down=*/false);
+    setHasGlobals();
   } else {
-    traverse(&Scope::getHasLocals, &Scope::setHasLocals, /*down=*/false);
+    setHasLocals();
   }
 
   // Indicate that this tree branch has scopes.
-  traverse(&Scope::getHasScopes, &Scope::setHasScopes, /*down=*/false);
+  setHasScopes();
 }
 
 void Scope::addObject(Symbol *Sym) {
   // Add it to parent.
-  TheSymbols.push_back(Sym);
-  Children.push_back(Sym);
+  addChild(Sym, SymbolChildren);
   Sym->setParent(this);
 
   // Object Summary Table.
-  getReader()->incrementFound(Sym);
+  getReader()->incrementFound(Sym->getKind());
 
   // If the object is a global reference, mark its parent as having global
   // references; that information is used, to print only those branches
   // with global references.
+  // The parents are updated by propagateHasFlags.
   if (Sym->getIsGlobalReference()) {
-    traverse(&Scope::getHasGlobals, &Scope::setHasGlobals, /*down=*/false);
+    setHasGlobals();
   } else {
-    traverse(&Scope::getHasLocals, &Scope::setHasLocals, /*down=*/false);
+    setHasLocals();
   }
 
   // Indicate that this tree branch has symbols.
-  traverse(&Scope::getHasSymbols, &Scope::setHasSymbols, /*down=*/false);
+  setHasSymbols();
 }
 
 void Scope::addObject(Type *Ty) {
   // Add it to parent.
-  TheTypes.push_back(Ty);
-  Children.push_back(Ty);
+  addChild(Ty, TypeChildren);
   Ty->setParent(this);
 
   // Object Summary Table.
-  getReader()->incrementFound(Ty);
+  getReader()->incrementFound(Ty->getKind());
 
   // If the object is a global reference, mark its parent as having global
   // references; that information is used, to print only those branches
   // with global references.
+  // The parents are updated by propagateHasFlags.
   if (Ty->getIsGlobalReference()) {
-    traverse(&Scope::getHasGlobals, &Scope::setHasGlobals, /*down=*/false);
+    setHasGlobals();
   } else {
-    traverse(&Scope::getHasLocals, &Scope::setHasLocals, /*down=*/false);
+    setHasLocals();
   }
 
   // Indicate that this tree branch has types.
-  traverse(&Scope::getHasTypes, &Scope::setHasTypes, /*down=*/false);
+  setHasTypes();
+}
+
+void Scope::addChild(Object *Child, ChildRun Kind) {
+  // Move the children of a compacted scope back out of its array.
+  if (!NewChildren) {
+    std::unique_ptr<NewChildRuns> Runs(new NewChildRuns);
+    for (int Run = 0; Run < ChildRunCount; ++Run) {
+      size_t Size;
+      Object **Data = getChildRunData(static_cast<ChildRun>(Run), Size);
+      Runs->Runs[Run].assign(Data, Data + Size);
+    }
+    const uint8_t *Kinds = getChildKinds();
+    Runs->Kinds.assign(Kinds, Kinds + (getChildRunsSize() + 3) / 4);
+    ChildArray.reset();
+    NewChildren = std::move(Runs);
+  }
+  const size_t Pos = getChildRunsSize();
+  if (Pos % 4 == 0)
+    NewChildren->Kinds.push_back(0);
+  NewChildren->Kinds.back() |= static_cast<uint8_t>(Kind << (Pos % 4 * 2));
+  NewChildren->Runs[Kind].push_back(Child);
+}
+
+void Scope::compactChildren() {
+  if (NewChildren) {
+    // The tags take the space of as many pointers as they need after the
+    // children, so the scope has a single allocation.
+    const std::vector<uint8_t> &Kinds = NewChildren->Kinds;
+    const size_t Size = getChildRunsSize();
+    const size_t KindSlots =
+        (Kinds.size() + sizeof(Object *) - 1) / sizeof(Object *);
+    ChildArray.reset(Size ? new Object *[Size + KindSlots] : nullptr);
+    Object **Next = ChildArray.get();
+    for (int Run = 0; Run < ChildRunCount; ++Run) {
+      const std::vector<Object *> &Children = NewChildren->Runs[Run];
+      ChildRunSizes[Run] = static_cast<uint32_t>(Children.size());
+      Next = std::copy(Children.begin(), Children.end(), Next);
+    }
+    std::copy(Kinds.begin(), Kinds.end(), reinterpret_cast<uint8_t *>(Next));
+    NewChildren.reset();
+  }
+
+  // The subtrees of the scopes are independent, so each one is compacted on
+  // its own thread.
+  const ChildSpan<Scope> Scopes(getScopes());
+  if (getIsRoot())
+    parallelFor(Scopes.size(),
+                [&](size_t Index) { Scopes[Index]->compactChildren(); });
+  else
+    for (Scope *Scp : Scopes)
+      Scp->compactChildren();
+}
+
+void Scope::propagateHasFlags() {
+  propagateChildHasFlags();
+  mergeChildHasFlags();
+}
+
+void Scope::propagateChildHasFlags() {
+  // The subtrees of the scopes are independent, so each one is visited on its
+  // own thread.
+  const ChildSpan<Scope> Scopes(getScopes());
+  parallelFor(Scopes.size(),
+              [&](size_t Index) { Scopes[Index]->propagateSubtreeHasFlags(); });
+}
+
+void Scope::propagateSubtreeHasFlags() {
+  for (Scope *Scp : getScopes())
+    Scp->propagateSubtreeHasFlags();
+  mergeChildHasFlags();
+}
+
+void Scope::mergeChildHasFlags() {
+  decltype(ScopeAttributesFlags) HasFlags;
+  for (ScopeAttributes Flag :
+       {HasGlobals, HasLocals, HasLines, HasScopes, HasSymbols, HasTypes})
+    HasFlags.set(Flag);
+  for (const Scope *Scp : getScopes())
+    ScopeAttributesFlags |= Scp->ScopeAttributesFlags & HasFlags;
 }
 
 void Scope::getQualifiedName(std::string &qualified_name) const {
@@ -240,32 +353,107 @@ void Scope::getQualifiedName(std::string &qualified_name) const {
 
 void Scope::sortScopes(const SortingKey &SortKey) {
   // Get the sorting callback function.
-  SortFunction SortFunc = getSortFunction(SortKey);
-  if (SortFunc) {
-    sortScopes(SortFunc);
-  }
-}
+  SortKeyFunction SortFunc = getSortKeyFunction(SortKey);
+  if (!SortFunc)
+    return;
 
-void Scope::sortScopes(SortFunction SortFunc) {
-  // Sort the contained objects, using the associated line.
-  std::sort(TheTypes.begin(), TheTypes.end(), SortFunc);
-  std::sort(TheSymbols.begin(), TheSymbols.end(), SortFunc);
-  std::sort(TheScopes.begin(), TheScopes.end(), SortFunc);
+  const SortKeyBuilder Keys(this);
+  sortChildren(Keys, SortFunc);
 
-  // Sort the contained objects, using the associated line.
-  std::sort(Children.begin(), Children.end(), SortFunc);
+  // The subtrees of the scopes are independent, so each one is sorted on its
+  // own thread.
+  const ChildSpan<Scope> Scopes(getScopes());
+  parallelFor(Scopes.size(),
+              [&](size_t Index) { Scopes[Index]->sortScopes(Keys, SortFunc); });
+}
+
+void Scope::sortScopes(const SortKeyBuilder &Keys, SortKeyFunction SortFunc) {
+  sortChildren(Keys, SortFunc);
 
   // Scopes.
-  for (Scope *Scp : TheScopes)
-    Scp->sortScopes(SortFunc);
+  for (Scope *Scp : getScopes())
+    Scp->sortScopes(Keys, SortFunc);
+}
+
+namespace {
+// Sort the objects comparing their keys, read once for each object, and
+// return the keys in SortedKeys.
+void sortObjects(Object **Objects, size_t Size, const SortKeyBuilder &Keys,
+                 SortKeyFunction SortFunc,
+                 std::vector<ObjectSortKey> &SortedKeys) {
+  typedef std::pair<ObjectSortKey, Object *> Entry;
+  thread_local std::vector<Entry> Entries;
+  Entries.clear();
+  for (size_t Index = 0; Index < Size; ++Index)
+    Entries.emplace_back(Keys.getKey(Objects[Index]), Objects[Index]);
+
+  std::sort(Entries.begin(), Entries.end(),
+            [SortFunc](const Entry &LHS, const Entry &RHS) {
+              return SortFunc(LHS.first, RHS.first);
+            });
+  SortedKeys.clear();
+  for (size_t Index = 0; Index < Entries.size(); ++Index) {
+    Objects[Index] = Entries[Index].second;
+    SortedKeys.push_back(Entries[Index].first);
+  }
+}
+} // namespace
+
+template <typename LessFunction>
+void Scope::mergeChildRuns(LessFunction Less) {
+  size_t Sizes[ChildRunCount];
+  for (int Run = 0; Run < ChildRunCount; ++Run)
+    getChildRunData(static_cast<ChildRun>(Run), Sizes[Run]);
+  size_t Next[ChildRunCount] = {};
+  uint8_t *Kinds = getChildKinds();
+  const size_t Size = getChildRunsSize();
+  for (size_t Pos = 0; Pos < Size; ++Pos) {
+    // The first run with children left whose next child is not after that
+    // of any other run.
+    int Taken = ChildRunCount;
+    for (int Run = 0; Run < ChildRunCount; ++Run)
+      if (Next[Run] < Sizes[Run] &&
+          (Taken == ChildRunCount ||
+           Less(Run, Next[Run], Taken, Next[Taken])))
+        Taken = Run;
+    ++Next[Taken];
+
+    uint8_t &Byte = Kinds[Pos / 4];
+    const int Shift = Pos % 4 * 2;
+    Byte = static_cast<uint8_t>((Byte & ~(3 << Shift)) | (Taken << Shift));
+  }
+}
+
+void Scope::sortChildren(const SortKeyBuilder &Keys, SortKeyFunction SortFunc) {
+  // Sort the children of each kind using their keys, and then merge the
+  // sorted runs into the printing order.
+  thread_local std::vector<ObjectSortKey> RunKeys[ChildRunCount];
+  for (int Run = 0; Run < ChildRunCount; ++Run) {
+    size_t Size;
+    Object **Children = getChildRunData(static_cast<ChildRun>(Run), Size);
+    sortObjects(Children, Size, Keys, SortFunc, RunKeys[Run]);
+  }
+  mergeChildRuns([SortFunc](int Run, size_t Index, int Other,
+                            size_t OtherIndex) {
+    return SortFunc(RunKeys[Run][Index], RunKeys[Other][OtherIndex]);
+  });
 }
 
 void Scope::sortCompileUnits(const SortingKey &SortKey) {
   // Sort the contained objects, using the sort criteria.
   SortFunction SortFunc = getSortFunction(SortKey);
   if (SortFunc) {
-    std::sort(TheScopes.begin(), TheScopes.end(), SortFunc);
-    std::sort(Children.begin(), Children.end(), SortFunc);
+    Object **Runs[ChildRunCount];
+    for (int Run = 0; Run < ChildRunCount; ++Run) {
+      size_t Size;
+      Runs[Run] = getChildRunData(static_cast<ChildRun>(Run), Size);
+      if (Run == ScopeChildren)
+        std::sort(Runs[Run], Runs[Run] + Size, SortFunc);
+    }
+    mergeChildRuns([&Runs, SortFunc](int Run, size_t Index, int Other,
+                                     size_t OtherIndex) {
+      return SortFunc(Runs[Run][Index], Runs[Other][OtherIndex]);
+    });
   }
 }
 
@@ -309,11 +497,11 @@ void Scope::traverse(ObjGetFunction GetFunc, ObjSetFunction SetFunc) {
   (this->*SetFunc)();
 
   // Types.
-  for (Type *Ty : TheTypes)
+  for (Type *Ty : getTypes())
     (Ty->*SetFunc)();
 
   // Symbols.
-  for (Symbol *Sym : TheSymbols)
+  for (Symbol *Sym : getSymbols())
     (Sym->*SetFunc)();
 
   // Line records.
@@ -321,7 +509,7 @@ void Scope::traverse(ObjGetFunction GetFunc, ObjSetFunction SetFunc) {
     (Ln->*SetFunc)();
 
   // Scopes.
-  for (Scope *Scp : TheScopes)
+  for (Scope *Scp : getScopes())
     Scp->traverse(GetFunc, SetFunc);
 }
 
@@ -384,7 +572,7 @@ void Scope::print(bool SplitCU, bool Match, bool IsNull,
     // Dump the object itself.
     dump(Settings);
     // Dump the children.
-    for (Object *Obj : Children) {
+    for (Object *Obj : getChildren()) {
       if (Match && !Obj->getHasPattern())
         continue;
       Obj->print(SplitCU, Match, IsNull, Settings);
@@ -420,7 +608,7 @@ void Scope::dump(const PrintSettings &Settings) {
   // Check if the object needs to be printed.
   if (dumpAllowed() || Settings.printObject(*this)) {
     // Object Summary Table.
-    getReader()->incrementPrinted(this);
+    getReader()->incrementPrinted(getKind());
 
     // Common Object Data.
     Element::dump(Settings);
@@ -515,7 +703,7 @@ std::string ScopeAggregate::getAsYAML() const {
   Result << "\n  inherits_from:";
 
   bool hasInheritance = false;
-  for (auto type : TheTypes) {
+  for (auto type : getTypes()) {
     if (type->getIsInheritance()) {
       hasInheritance = true;
       Result << "\n" << static_cast<TypeImport *>(type)->getAsYAML();
@@ -32,13 +32,179 @@
 
 #include "Object.h"
 #include "Sort.h"
-
+#include "Symbol.h"
+#include "Type.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 
 namespace LibScopeView {
 
 class Line;
-class Symbol;
+
+/// \brief A range of code addresses, from Low up to but not including High.
+struct AddressRange {
+  Dwarf_Addr Low;
+  Dwarf_Addr High;
+};
+
+/// \brief A view of consecutive children of a scope, each seen as a T.
+template <typename T> class ChildSpan {
+public:
+  class iterator {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T *value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T *const *pointer;
+    typedef T *reference;
+
+    iterator() : Pos(nullptr) {}
+    explicit iterator(Object *const *Pos) : Pos(Pos) {}
+
+    T *operator*() const { return static_cast<T *>(*Pos); }
+    T *operator[](difference_type N) const { return static_cast<T *>(Pos[N]); }
+
+    iterator &operator++() {
+      ++Pos;
+      return *this;
+    }
+    iterator operator++(int) { return iterator(Pos++); }
+    iterator &operator--() {
+      --Pos;
+      return *this;
+    }
+    iterator operator--(int) { return iterator(Pos--); }
+    iterator &operator+=(difference_type N) {
+      Pos += N;
+      return *this;
+    }
+    iterator &operator-=(difference_type N) {
+      Pos -= N;
+      return *this;
+    }
+    iterator operator+(difference_type N) const { return iterator(Pos + N); }
+    iterator operator-(difference_type N) const { return iterator(Pos - N); }
+    difference_type operator-(const iterator &Other) const {
+      return Pos - Other.Pos;
+    }
+
+    bool operator==(const iterator &Other) const { return Pos == Other.Pos; }
+    bool operator!=(const iterator &Other) const { return Pos != Other.Pos; }
+    bool operator<(const iterator &Other) const { return Pos < Other.Pos; }
+    bool operator>(const iterator &Other) const { return Pos > Other.Pos; }
+    bool operator<=(const iterator &Other) const { return Pos <= Other.Pos; }
+    bool operator>=(const iterator &Other) const { return Pos >= Other.Pos; }
+
+  private:
+    Object *const *Pos;
+  };
+  typedef iterator const_iterator;
+
+  ChildSpan(Object *const *Data, size_t Size) : Data(Data), Size(Size) {}
+
+  iterator begin() const { return iterator(Data); }
+  iterator end() const { return iterator(Data + Size); }
+  iterator cbegin() const { return begin(); }
+  iterator cend() const { return end(); }
+
+  size_t size() const { return Size; }
+  bool empty() const { return Size == 0; }
+
+  T *operator[](size_t Index) const { return static_cast<T *>(Data[Index]); }
+  T *at(size_t Index) const {
+    if (Index >= Size)
+      throw std::out_of_range("ChildSpan::at");
+    return (*this)[Index];
+  }
+  T *front() const { return (*this)[0]; }
+  T *back() const { return (*this)[Size - 1]; }
+
+private:
+  Object *const *Data;
+  size_t Size;
+};
+
+/// \brief A view of all the children of a scope, in printing order. The
+/// children are stored once, in a run for each kind, and a 2-bit tag for each
+/// child gives the run it is taken from next.
+class ChildList {
+public:
+  class iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Object *value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Object *const *pointer;
+    typedef Object *reference;
+
+    iterator() : Next(), Kinds(nullptr), Pos(0) {}
+    iterator(Object *const *const *Runs, const uint8_t *Kinds, size_t Pos)
+        : Next{Runs[0], Runs[1], Runs[2]}, Kinds(Kinds), Pos(Pos) {}
+
+    Object *operator*() const { return *Next[getKind(Kinds, Pos)]; }
+
+    iterator &operator++() {
+      ++Next[getKind(Kinds, Pos)];
+      ++Pos;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator Old(*this);
+      ++*this;
+      return Old;
+    }
+
+    bool operator==(const iterator &Other) const { return Pos == Other.Pos; }
+    bool operator!=(const iterator &Other) const { return Pos != Other.Pos; }
+
+  private:
+    Object *const *Next[3];
+    const uint8_t *Kinds;
+    size_t Pos;
+  };
+  typedef iterator const_iterator;
+
+  /// \brief The kind tag of the child at Pos, packed four to a byte.
+  static unsigned getKind(const uint8_t *Kinds, size_t Pos) {
+    return (Kinds[Pos / 4] >> (Pos % 4 * 2)) & 3U;
+  }
+
+  ChildList(Object *const *TypeRun, Object *const *SymbolRun,
+            Object *const *ScopeRun, const uint8_t *Kinds, size_t Size)
+      : Runs{TypeRun, SymbolRun, ScopeRun}, Kinds(Kinds), Size(Size) {}
+
+  iterator begin() const { return iterator(Runs, Kinds, 0); }
+  iterator end() const { return iterator(Runs, Kinds, Size); }
+  iterator cbegin() const { return begin(); }
+  iterator cend() const { return end(); }
+
+  size_t size() const { return Size; }
+  bool empty() const { return Size == 0; }
+
+  Object *front() const { return *begin(); }
+
+private:
+  Object *const *Runs[3];
+  const uint8_t *Kinds;
+  size_t Size;
+};
+
+/// \brief Creates the children of the scopes whose children are created
+/// lazily (see Scope::setLazyChildren).
+class ScopeMaterializer {
+public:
+  virtual ~ScopeMaterializer() = default;
+
+  /// \brief Create the children and lines of Scp, and then mark them as
+  /// created.
+  virtual void materializeChildren(Scope &Scp) = 0;
+};
 
 /// \brief Class to represent a DWARF Scope object.
 class Scope : public Element {
@@ -122,6 +288,11 @@ public:
 public:
   /// \brief Get the object kind as a string.
   const char *getKindAsString() const override;
+  ObjectKind getKind() const final;
+
+private:
+  // The kind of this scope, which getKindAsString and getKind are taken from.
+  const KindEntry &getKindEntry() const;
 
 public:
   // Flags associated with the scope.
@@ -295,23 +466,47 @@ public:
   void addObject(Scope *Scp);
   void addObject(Line *Ln);
 
+  /// \brief Move the children of this scope and of the scopes under it into
+  /// arrays of their exact size. Objects can still be added later, which
+  /// moves the children of that scope out of its array again.
+  void compactChildren();
+
 public:
   /// \brief Gets the child symbol at the specified index.
-  Symbol *getSymbolAt(size_t Index) const { return TheSymbols.at(Index); }
+  Symbol *getSymbolAt(size_t Index) const { return getSymbols().at(Index); }
 
   /// \brief Gets the child scope at the specified index.
-  Scope *getScopeAt(size_t Index) const { return TheScopes.at(Index); }
-
-public:
-  const std::vector<Object *> &getChildren() const { return Children; }
-  std::vector<Object *> &getChildren() { return Children; }
+  Scope *getScopeAt(size_t Index) const { return getScopes().at(Index); }
+
+public:
+  /// \brief All the children (types, symbols and scopes), in printing order.
+  ChildList getChildren() const {
+    materializeChildren();
+    size_t TypeCount, SymbolCount, ScopeCount;
+    Object *const *Types = getChildRunData(TypeChildren, TypeCount);
+    Object *const *Symbols = getChildRunData(SymbolChildren, SymbolCount);
+    Object *const *Scopes = getChildRunData(ScopeChildren, ScopeCount);
+    return ChildList(Types, Symbols, Scopes, getChildKinds(),
+                     TypeCount + SymbolCount + ScopeCount);
+  }
 
-  const std::vector<Line *> &getLines() const { return TheLines; }
-  std::vector<Line *> &getLines() { return TheLines; }
+  const std::vector<Line *> &getLines() const {
+    materializeChildren();
+    return TheLines;
+  }
+  std::vector<Line *> &getLines() {
+    materializeChildren();
+    return TheLines;
+  }
 
-  const std::vector<Scope *> &getScopes() const { return TheScopes; }
-  const std::vector<Symbol *> &getSymbols() const { return TheSymbols; }
-  const std::vector<Type *> &getTypes() const { return TheTypes; }
+  /// \brief The children of each kind, in printing order.
+  ChildSpan<Scope> getScopes() const {
+    return getChildRun<Scope>(ScopeChildren);
+  }
+  ChildSpan<Symbol> getSymbols() const {
+    return getChildRun<Symbol>(SymbolChildren);
+  }
+  ChildSpan<Type> getTypes() const { return getChildRun<Type>(TypeChildren); }
 
   /// \brief Get the number of children.
   size_t getChildrenCount() const { return getChildren().size(); }
@@ -328,6 +523,33 @@ public:
   /// \brief Get the number of types.
   size_t getTypeCount() const { return getTypes().size(); }
 
+  /// \brief The code covered by the scope (DW_AT_low_pc and DW_AT_high_pc or
+  /// DW_AT_ranges). Empty if the scope has no code.
+  const std::vector<AddressRange> &getAddressRanges() const {
+    return TheAddressRanges;
+  }
+  void addAddressRange(Dwarf_Addr Low, Dwarf_Addr High) {
+    TheAddressRanges.push_back({Low, High});
+  }
+
+  /// \brief Leave the children and lines of this scope to be created by
+  /// Creator when any of them are first requested. DieChildCount is the
+  /// number of Dies directly under the scope's Die. A null Creator marks the
+  /// children as created.
+  void setLazyChildren(ScopeMaterializer *Creator, uint32_t DieChildCount) {
+    LazyChildCount = DieChildCount;
+    Materializer.store(Creator, std::memory_order_release);
+  }
+
+  /// \brief Return true if the children have not been created yet.
+  bool getHasLazyChildren() const {
+    return Materializer.load(std::memory_order_acquire) != nullptr;
+  }
+
+  /// \brief The number of Dies directly under the Die of a scope whose
+  /// children have not been created yet.
+  uint32_t getLazyChildCount() const { return LazyChildCount; }
+
 private:
   // Traverse the scopes tree calling given get/set functions.
   void traverse(ObjGetFunction GetFunc, ObjSetFunction SetFunc);
@@ -346,29 +568,114 @@ public:
   void sortScopes(const SortingKey &SortKey);
   void sortCompileUnits(const SortingKey &SortKey);
 
+  /// \brief Set the HasGlobals, HasLocals, HasLines, HasScopes, HasSymbols
+  /// and HasTypes flags of the scopes under this one from their children.
+  /// Adding an object only sets the flags of the scope it is added to, so
+  /// this is called once the tree is created.
+  void propagateHasFlags();
+
+  /// \brief Set the flags of the scopes under this one, as propagateHasFlags
+  /// does, but leave those of this scope as they are.
+  void propagateChildHasFlags();
+
+  /// \brief Add the HasGlobals, HasLocals, HasLines, HasScopes, HasSymbols
+  /// and HasTypes flags of the child scopes to the flags of this scope.
+  void mergeChildHasFlags();
+
   // bring parent method getQualifiedName into scope.
   using Element::getQualifiedName;
   /// \brief Return the chain of parents as a string.
   void getQualifiedName(std::string &QualifiedName) const;
 
 protected:
-  void sortScopes(SortFunction SortFunc);
+  void propagateSubtreeHasFlags();
+
+  void sortScopes(const SortKeyBuilder &Keys, SortKeyFunction SortFunc);
+  void sortChildren(const SortKeyBuilder &Keys, SortKeyFunction SortFunc);
 
 protected:
-  // All the types in this scope.
-  std::vector<Type *> TheTypes;
+  // The runs of children of each kind. The value of each kind is the tag
+  // ChildList reads.
+  enum ChildRun { TypeChildren, SymbolChildren, ScopeChildren, ChildRunCount };
+
+  // Adds an object to the children, without updating any flags.
+  void addChild(Object *Child, ChildRun Kind);
+
+  // Start and size of a run of children.
+  Object **getChildRunData(ChildRun Run, size_t &Size) const {
+    if (NewChildren) {
+      std::vector<Object *> &Children = NewChildren->Runs[Run];
+      Size = Children.size();
+      return Children.data();
+    }
+    size_t Start = 0;
+    for (int Before = 0; Before < Run; ++Before)
+      Start += ChildRunSizes[Before];
+    Size = ChildRunSizes[Run];
+    return ChildArray.get() + Start;
+  }
+  template <typename T> ChildSpan<T> getChildRun(ChildRun Run) const {
+    materializeChildren();
+    size_t Size;
+    Object *const *Data = getChildRunData(Run, Size);
+    return ChildSpan<T>(Data, Size);
+  }
+  size_t getChildRunsSize() const {
+    if (NewChildren)
+      return NewChildren->Runs[TypeChildren].size() +
+             NewChildren->Runs[SymbolChildren].size() +
+             NewChildren->Runs[ScopeChildren].size();
+    return ChildRunSizes[TypeChildren] + ChildRunSizes[SymbolChildren] +
+           ChildRunSizes[ScopeChildren];
+  }
 
-  // All the symbols in this scope.
-  std::vector<Symbol *> TheSymbols;
+  // The kind tags of the children in printing order, packed four to a byte.
+  uint8_t *getChildKinds() const {
+    if (NewChildren)
+      return NewChildren->Kinds.data();
+    return reinterpret_cast<uint8_t *>(ChildArray.get() + getChildRunsSize());
+  }
 
-  // All the child scopes underneath this one.
-  std::vector<Scope *> TheScopes;
+  // Sets the printing order of the children by merging their sorted runs,
+  // comparing them with Less(Run, Index, OtherRun, OtherIndex). Children that
+  // compare equal keep the order of their runs.
+  template <typename LessFunction> void mergeChildRuns(LessFunction Less);
+
+protected:
+  // The children split by kind into types, symbols and scopes, each run in
+  // printing order, followed by the tags of the children in printing order.
+  std::unique_ptr<Object *[]> ChildArray;
+  uint32_t ChildRunSizes[ChildRunCount] = {};
+
+  // The runs of children and their tags while objects are being added, until
+  // they are moved into ChildArray by compactChildren.
+  struct NewChildRuns {
+    std::vector<Object *> Runs[ChildRunCount];
+    std::vector<uint8_t> Kinds;
+  };
+  std::unique_ptr<NewChildRuns> NewChildren;
 
   // All the line information for this scope.
   std::vector<Line *> TheLines;
 
-  // Vector of objects (types, scopes, symbols, lines).
-  std::vector<Object *> Children;
+  // The code addresses covered by this scope.
+  std::vector<AddressRange> TheAddressRanges;
+
+  // Creates the children of a scope whose children have not been created,
+  // before they are first read.
+  void materializeChildren() const {
+    if (Materializer.load(std::memory_order_acquire))
+      createLazyChildren();
+  }
+  void createLazyChildren() const;
+
+  // The creator of the children while they have not been created, and the
+  // number of Dies under the scope's Die until then.
+  std::atomic<ScopeMaterializer *> Materializer{nullptr};
+  uint32_t LazyChildCount = 0;
+
+  // Rebuilds the children vectors when loading a cached tree.
+  friend class ScopeTreeSerializer;
 
 public:
   /// \brief Decide if the object will be printed.
@@ -387,7 +694,7 @@ public:
   std::string getAsYAML() const override;
 
 private:
-  static uint32_t ScopesAllocated;
+  static std::atomic<uint32_t> ScopesAllocated;
 
 public:
   static uint32_t getInstanceCount() { return ScopesAllocated; }
@@ -0,0 +1,59 @@
+//===-- LibScopeView/ScopeBinaryPrinter.cpp ---------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the definitions of ScopeBinaryPrinter's methods.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ScopeBinaryPrinter.h"
+#include "Scope.h"
+#include "ScopeTreeSerializer.h"
+
+#include <assert.h>
+#include <ostream>
+#include <vector>
+
+using namespace LibScopeView;
+
+ScopeBinaryPrinter::ScopeBinaryPrinter(std::string InputFile)
+    : InputFile(InputFile) {}
+
+const std::string &ScopeBinaryPrinter::getFileExtension() {
+  static std::string BinaryExtension = "divatree";
+  return BinaryExtension;
+}
+
+void ScopeBinaryPrinter::printImpl(const Object *Obj,
+                                   std::ostream &OutputStream) {
+  // The whole tree is written at once, so the children are not visited.
+  assert(Obj->getIsScope() && "Only scopes can be printed as binary");
+  std::vector<char> Data;
+  bool Written = ScopeTreeSerializer::write(*static_cast<const Scope *>(Obj),
+                                            InputFile, Data,
+                                            /*DropExternalReferences=*/true);
+  assert(Written && "External references are dropped");
+  static_cast<void>(Written);
+  OutputStream.write(Data.data(), static_cast<std::streamsize>(Data.size()));
+}
@@ -0,0 +1,56 @@
+//===-- LibScopeView/ScopeBinaryPrinter.h -----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the ScopeBinaryPrinter class.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPEVIEW_SCOPEBINARYPRINTER_H
+#define SCOPEVIEW_SCOPEBINARYPRINTER_H
+
+#include "ScopePrinter.h"
+
+namespace LibScopeView {
+
+/// \brief A Scope printer that outputs DIVA's binary scope tree format.
+///
+/// Each printed scope is written with all the objects under it, and can be
+/// read in place with a ScopeTreeView. References to objects outside the
+/// printed scope are left out.
+class ScopeBinaryPrinter : public ScopePrinter {
+public:
+  explicit ScopeBinaryPrinter(std::string InputFile);
+
+private:
+  const std::string &getFileExtension() override;
+  bool getIsBinary() const override { return true; }
+  void printImpl(const Object *Obj, std::ostream &OutputStream) override;
+
+  std::string InputFile;
+};
+
+} // end namespace LibScopeView
+
+#endif // SCOPEVIEW_SCOPEBINARYPRINTER_H
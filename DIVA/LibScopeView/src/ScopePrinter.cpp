@@ -72,7 +72,10 @@ void ScopePrinter::print(const ScopeRoot *Root, const std::string &OutputDir) {
       OutputPath += ".";
       OutputPath += getFileExtension();
 
-      std::ofstream SplitOutputFile(nativeFilePath(OutputPath));
+      std::ofstream SplitOutputFile(nativeFilePath(OutputPath),
+                                    getIsBinary()
+                                        ? std::ios::out | std::ios::binary
+                                        : std::ios::out);
       if (SplitOutputFile.fail())
         fatalError(LibScopeError::ErrorCode::ERR_SPLIT_UNABLE_TO_OPEN_FILE,
                    OutputPath);
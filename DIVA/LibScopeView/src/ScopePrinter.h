@@ -81,6 +81,9 @@ private:
   /// \brief get the file extension to use when splitting output (e.g. "txt").
   virtual const std::string &getFileExtension() = 0;
 
+  /// \brief Whether split output files should be opened in binary mode.
+  virtual bool getIsBinary() const { return false; }
+
   /// \brief get header text to be added to the start of the output, or at the
   /// top of each split file.
   virtual const std::string &getHeader();
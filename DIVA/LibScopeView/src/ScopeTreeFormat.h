@@ -0,0 +1,182 @@
+//===-- LibScopeView/ScopeTreeFormat.h --------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Layout of DIVA's binary scope tree format.
+///
+/// A serialized tree is a header followed by four tables: one fixed size
+/// record per object in pre-order (the root is record 0), an array of record
+/// indexes listing the children of every scope, the code address ranges of the
+/// scopes, and a string table. All values
+/// are little endian and all references between objects are record indexes,
+/// so the data can be used in place without any pointer fixups.
+///
+/// The string data is the last table, so a tree ends at StringDataOffset +
+/// StringDataSize and several trees can be stored one after the other.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPETREEFORMAT_H
+#define SCOPETREEFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace LibScopeView {
+namespace ScopeTreeFormat {
+
+/// \brief Identifies the data as a DIVA scope tree.
+const char Magic[8] = {'D', 'I', 'V', 'A', 'T', 'R', 'E', 'E'};
+
+/// \brief Bumped whenever the layout or the meaning of a field changes.
+const uint32_t Version = 3;
+
+/// \brief Record index used for a missing parent, type or reference.
+const uint32_t NoIndex = 0xFFFFFFFF;
+
+/// \brief The concrete class of a serialized object.
+enum class ObjectClass : uint8_t {
+  Line,
+  Scope,
+  ScopeAggregate,
+  ScopeAlias,
+  ScopeArray,
+  ScopeCompileUnit,
+  ScopeEnumeration,
+  ScopeFunction,
+  ScopeFunctionInlined,
+  ScopeNamespace,
+  ScopeRoot,
+  ScopeTemplatePack,
+  Symbol,
+  Type,
+  TypeDefinition,
+  TypeEnumerator,
+  TypeImport,
+  TypeParam,
+  TypeSubrange,
+  Last = TypeSubrange
+};
+
+/// \brief Byte offsets of the header fields.
+enum HeaderField : size_t {
+  HeaderMagic = 0,                // char[8]
+  HeaderVersion = 8,              // uint32_t
+  HeaderRecordSize = 12,          // uint32_t
+  HeaderObjectCount = 16,         // uint32_t
+  HeaderChildIndexCount = 20,     // uint32_t
+  HeaderStringCount = 24,         // uint32_t
+  HeaderKey = 28,                 // uint32_t, string index.
+  HeaderObjectsOffset = 32,       // uint64_t
+  HeaderChildIndexOffset = 40,    // uint64_t
+  HeaderStringOffsetsOffset = 48, // uint64_t
+  HeaderStringDataOffset = 56,    // uint64_t
+  HeaderStringDataSize = 64,      // uint64_t
+  HeaderRangeCount = 72,          // uint32_t
+  HeaderReserved = 76,            // uint32_t
+  HeaderRangesOffset = 80,        // uint64_t
+  HeaderSize = 88
+};
+
+/// \brief Byte offsets of the fields in an object record.
+///
+/// Strings are indexes into the string table, where index 0 is the empty
+/// string. The children of a scope are ChildCount entries of the child index
+/// array starting at FirstChild, in the order of Scope::getChildren(),
+/// followed by LineCount entries for Scope::getLines(). Its code address
+/// ranges are RangeCount entries of the range table starting at FirstRange,
+/// each a uint64_t low address followed by a uint64_t end address.
+///
+/// The flag fields hold DIVA's internal attribute bits and are only meant to
+/// be read back by DIVA itself. Other tools should use the Kind, FullName and
+/// TypeName strings, which match the "object", "name" and "type" values of
+/// the YAML output.
+enum RecordField : size_t {
+  RecordClass = 0,           // uint8_t, ObjectClass.
+  RecordAccess = 1,          // uint8_t, AccessSpecifier.
+  RecordLevel = 2,           // uint16_t
+  RecordDieTag = 4,          // uint16_t
+  RecordDiscriminator = 6,   // uint16_t
+  RecordObjectFlags = 8,     // uint32_t
+  RecordKindFlags = 12,      // uint32_t, scope/type/symbol/line flags.
+  RecordExtraFlags = 16,     // uint32_t, see ExtraFlag.
+  RecordByteSize = 20,       // uint32_t
+  RecordName = 24,           // uint32_t
+  RecordQualifiedName = 28,  // uint32_t
+  RecordFileName = 32,       // uint32_t, file index if ExtraInvalidFileName.
+  RecordValue = 36,          // uint32_t
+  RecordLineNumber = 40,     // uint64_t
+  RecordDieOffset = 48,      // uint64_t, the address for lines.
+  RecordCallLineNumber = 56, // uint64_t
+  RecordParent = 64,         // uint32_t
+  RecordType = 68,           // uint32_t
+  RecordReference = 72,      // uint32_t
+  RecordFirstChild = 76,     // uint32_t
+  RecordChildCount = 80,     // uint32_t
+  RecordLineCount = 84,      // uint32_t
+  RecordKind = 88,           // uint32_t
+  RecordFullName = 92,       // uint32_t
+  RecordTypeName = 96,       // uint32_t
+  RecordFirstRange = 100,    // uint32_t
+  RecordRangeCount = 104,    // uint32_t
+  RecordReserved = 108,      // uint32_t
+  RecordSize = 112
+};
+
+/// \brief Size of an entry in the range table.
+const uint32_t RangeSize = 16;
+
+/// \brief Class specific boolean properties stored in RecordExtraFlags.
+enum ExtraFlag : uint32_t {
+  ExtraIsStatic = 1 << 0,
+  ExtraIsDeclaredInline = 1 << 1,
+  ExtraIsDeclaration = 1 << 2,
+  ExtraIsEnumClass = 1 << 3,
+  ExtraIsPrintedAsObject = 1 << 4,
+  ExtraInvalidFileName = 1 << 5
+};
+
+/// \brief Read a little endian value of type T from Data.
+template <typename T> T readLE(const char *Data) {
+  unsigned char Bytes[sizeof(T)];
+  std::memcpy(Bytes, Data, sizeof(T));
+  T Value = 0;
+  for (size_t I = sizeof(T); I > 0; --I)
+    Value = static_cast<T>((Value << 8) | Bytes[I - 1]);
+  return Value;
+}
+
+/// \brief Write Value to Data as a little endian value of type T.
+template <typename T> void writeLE(char *Data, T Value) {
+  for (size_t I = 0; I < sizeof(T); ++I) {
+    Data[I] = static_cast<char>(Value & 0xFF);
+    Value = static_cast<T>(Value >> 8);
+  }
+}
+
+} // namespace ScopeTreeFormat
+} // namespace LibScopeView
+
+#endif // SCOPETREEFORMAT_H
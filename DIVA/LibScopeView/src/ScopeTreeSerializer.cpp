@@ -0,0 +1,523 @@
+//===-- LibScopeView/ScopeTreeSerializer.cpp --------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Conversion between a scope tree and DIVA's binary scope tree format.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ScopeTreeSerializer.h"
+#include "FileUtilities.h"
+#include "Line.h"
+#include "Reader.h"
+#include "Scope.h"
+#include "ScopeTreeFormat.h"
+#include "ScopeTreeView.h"
+#include "StringPool.h"
+#include "Symbol.h"
+#include "Type.h"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+using namespace LibScopeView;
+using namespace LibScopeView::ScopeTreeFormat;
+
+namespace {
+
+ObjectClass getObjectClass(const Object &Obj) {
+  if (Obj.getIsLine())
+    return ObjectClass::Line;
+  if (Obj.getIsSymbol())
+    return ObjectClass::Symbol;
+  if (Obj.getIsType()) {
+    if (dynamic_cast<const TypeDefinition *>(&Obj))
+      return ObjectClass::TypeDefinition;
+    if (dynamic_cast<const TypeEnumerator *>(&Obj))
+      return ObjectClass::TypeEnumerator;
+    if (dynamic_cast<const TypeImport *>(&Obj))
+      return ObjectClass::TypeImport;
+    if (dynamic_cast<const TypeParam *>(&Obj))
+      return ObjectClass::TypeParam;
+    if (dynamic_cast<const TypeSubrange *>(&Obj))
+      return ObjectClass::TypeSubrange;
+    return ObjectClass::Type;
+  }
+  if (dynamic_cast<const ScopeAggregate *>(&Obj))
+    return ObjectClass::ScopeAggregate;
+  if (dynamic_cast<const ScopeAlias *>(&Obj))
+    return ObjectClass::ScopeAlias;
+  if (dynamic_cast<const ScopeArray *>(&Obj))
+    return ObjectClass::ScopeArray;
+  if (dynamic_cast<const ScopeCompileUnit *>(&Obj))
+    return ObjectClass::ScopeCompileUnit;
+  if (dynamic_cast<const ScopeEnumeration *>(&Obj))
+    return ObjectClass::ScopeEnumeration;
+  // Check the derived class before its base.
+  if (dynamic_cast<const ScopeFunctionInlined *>(&Obj))
+    return ObjectClass::ScopeFunctionInlined;
+  if (dynamic_cast<const ScopeFunction *>(&Obj))
+    return ObjectClass::ScopeFunction;
+  if (dynamic_cast<const ScopeNamespace *>(&Obj))
+    return ObjectClass::ScopeNamespace;
+  if (dynamic_cast<const ScopeRoot *>(&Obj))
+    return ObjectClass::ScopeRoot;
+  if (dynamic_cast<const ScopeTemplatePack *>(&Obj))
+    return ObjectClass::ScopeTemplatePack;
+  return ObjectClass::Scope;
+}
+
+Object *createObject(ObjectClass Class, LevelType Level) {
+  switch (Class) {
+  case ObjectClass::Line:
+    return new Line(Level);
+  case ObjectClass::Scope:
+    return new Scope(Level);
+  case ObjectClass::ScopeAggregate:
+    return new ScopeAggregate(Level);
+  case ObjectClass::ScopeAlias:
+    return new ScopeAlias(Level);
+  case ObjectClass::ScopeArray:
+    return new ScopeArray(Level);
+  case ObjectClass::ScopeCompileUnit:
+    return new ScopeCompileUnit(Level);
+  case ObjectClass::ScopeEnumeration:
+    return new ScopeEnumeration(Level);
+  case ObjectClass::ScopeFunction:
+    return new ScopeFunction(Level);
+  case ObjectClass::ScopeFunctionInlined:
+    return new ScopeFunctionInlined(Level);
+  case ObjectClass::ScopeNamespace:
+    return new ScopeNamespace(Level);
+  case ObjectClass::ScopeRoot:
+    return new ScopeRoot(Level);
+  case ObjectClass::ScopeTemplatePack:
+    return new ScopeTemplatePack(Level);
+  case ObjectClass::Symbol:
+    return new Symbol(Level);
+  case ObjectClass::Type:
+    return new Type(Level);
+  case ObjectClass::TypeDefinition:
+    return new TypeDefinition(Level);
+  case ObjectClass::TypeEnumerator:
+    return new TypeEnumerator(Level);
+  case ObjectClass::TypeImport:
+    return new TypeImport(Level);
+  case ObjectClass::TypeParam:
+    return new TypeParam(Level);
+  case ObjectClass::TypeSubrange:
+    return new TypeSubrange(Level);
+  }
+  return nullptr;
+}
+
+// Deduplicated strings for the string table, index 0 is the empty string.
+class StringTableBuilder {
+public:
+  StringTableBuilder() : Strings(1) { Indexes.emplace("", 0); }
+
+  uint32_t add(const char *Str) {
+    if (!Str || !Str[0])
+      return 0;
+    auto Inserted =
+        Indexes.emplace(Str, static_cast<uint32_t>(Strings.size()));
+    if (Inserted.second)
+      Strings.emplace_back(Str);
+    return Inserted.first->second;
+  }
+
+  const std::vector<std::string> &getStrings() const { return Strings; }
+
+private:
+  std::vector<std::string> Strings;
+  std::unordered_map<std::string, uint32_t> Indexes;
+};
+
+// Collect the objects in the tree in pre-order, children before lines.
+void collectObjects(const Object *Obj, std::vector<const Object *> &Objects) {
+  Objects.push_back(Obj);
+  if (const auto *Scp = dynamic_cast<const Scope *>(Obj)) {
+    for (const Object *Child : Scp->getChildren())
+      collectObjects(Child, Objects);
+    for (const Line *Ln : Scp->getLines())
+      collectObjects(Ln, Objects);
+  }
+}
+
+} // namespace
+
+bool ScopeTreeSerializer::write(const Scope &Root, const std::string &Key,
+                                std::vector<char> &Data,
+                                bool DropExternalReferences) {
+  std::vector<const Object *> Objects;
+  collectObjects(&Root, Objects);
+
+  std::unordered_map<const Object *, uint32_t> Indexes;
+  Indexes.reserve(Objects.size());
+  for (const Object *Obj : Objects)
+    Indexes.emplace(Obj, static_cast<uint32_t>(Indexes.size()));
+
+  bool Valid = true;
+  auto getIndex = [&](const Object *Obj) -> uint32_t {
+    if (!Obj)
+      return NoIndex;
+    auto It = Indexes.find(Obj);
+    if (It == Indexes.end()) {
+      Valid = Valid && DropExternalReferences;
+      return NoIndex;
+    }
+    return It->second;
+  };
+
+  StringTableBuilder StringTable;
+  uint32_t KeyIndex = StringTable.add(Key.c_str());
+
+  std::vector<char> Records(Objects.size() * RecordSize, 0);
+  std::vector<uint32_t> ChildIndexes;
+  std::vector<AddressRange> Ranges;
+  for (size_t I = 0; I < Objects.size(); ++I) {
+    const Object &Obj = *Objects[I];
+    char *Record = &Records[I * RecordSize];
+    ObjectClass Class = getObjectClass(Obj);
+    uint32_t KindFlags = 0;
+    uint32_t ExtraFlags = 0;
+    uint32_t ByteSize = 0;
+    uint32_t Value = 0;
+    AccessSpecifier Access = AccessSpecifier::Unspecified;
+    const Object *Reference = nullptr;
+
+    if (const auto *Scp = dynamic_cast<const Scope *>(&Obj)) {
+      KindFlags = static_cast<uint32_t>(Scp->ScopeAttributesFlags.to_ulong());
+      Reference = Scp->getReference();
+      if (const auto *Fn = dynamic_cast<const ScopeFunction *>(Scp)) {
+        if (Fn->getIsStatic())
+          ExtraFlags |= ExtraIsStatic;
+        if (Fn->getIsDeclaredInline())
+          ExtraFlags |= ExtraIsDeclaredInline;
+        if (Fn->getIsDeclaration())
+          ExtraFlags |= ExtraIsDeclaration;
+      }
+      if (const auto *Enum = dynamic_cast<const ScopeEnumeration *>(Scp))
+        if (Enum->getIsClass())
+          ExtraFlags |= ExtraIsEnumClass;
+
+      writeLE<uint32_t>(Record + RecordFirstChild,
+                        static_cast<uint32_t>(ChildIndexes.size()));
+      writeLE<uint32_t>(Record + RecordChildCount,
+                        static_cast<uint32_t>(Scp->getChildrenCount()));
+      writeLE<uint32_t>(Record + RecordLineCount,
+                        static_cast<uint32_t>(Scp->getLineCount()));
+      for (const Object *Child : Scp->getChildren())
+        ChildIndexes.push_back(getIndex(Child));
+      for (const Line *Ln : Scp->getLines())
+        ChildIndexes.push_back(getIndex(Ln));
+
+      writeLE<uint32_t>(Record + RecordFirstRange,
+                        static_cast<uint32_t>(Ranges.size()));
+      writeLE<uint32_t>(Record + RecordRangeCount,
+                        static_cast<uint32_t>(Scp->getAddressRanges().size()));
+      Ranges.insert(Ranges.end(), Scp->getAddressRanges().begin(),
+                    Scp->getAddressRanges().end());
+    } else if (const auto *Ty = dynamic_cast<const Type *>(&Obj)) {
+      KindFlags = static_cast<uint32_t>(Ty->TypeAttributesFlags.to_ulong());
+      ByteSize = Ty->ByteSize;
+      if (Ty->getValueIndex())
+        Value = StringTable.add(Ty->getValue());
+      if (const auto *Import = dynamic_cast<const TypeImport *>(Ty))
+        if (Import->getIsInheritance())
+          Access = Import->getInheritanceAccess();
+    } else if (const auto *Sym = dynamic_cast<const Symbol *>(&Obj)) {
+      KindFlags = static_cast<uint32_t>(Sym->SymbolAttributesFlags.to_ulong());
+      Reference = Sym->getReference();
+      if (Sym->getIsStatic())
+        ExtraFlags |= ExtraIsStatic;
+      if (Sym->getIsMember())
+        Access = Sym->getAccessSpecifier();
+    } else if (const auto *Ln = dynamic_cast<const Line *>(&Obj)) {
+      KindFlags = static_cast<uint32_t>(Ln->LineAttributesFlags.to_ulong());
+    }
+
+    if (Obj.getIsPrintedAsObject())
+      ExtraFlags |= ExtraIsPrintedAsObject;
+
+    // An invalid filename holds the raw DWARF file index, not a string.
+    uint32_t FileName = 0;
+    if (Obj.getInvalidFileName()) {
+      ExtraFlags |= ExtraInvalidFileName;
+      FileName = static_cast<uint32_t>(Obj.getFileNameIndex());
+    } else {
+      FileName =
+          StringTable.add(StringPool::getStringValue(Obj.getFileNameIndex()));
+    }
+
+    writeLE<uint8_t>(Record + RecordClass, static_cast<uint8_t>(Class));
+    writeLE<uint8_t>(Record + RecordAccess, static_cast<uint8_t>(Access));
+    writeLE<uint16_t>(Record + RecordLevel, Obj.getLevel());
+    writeLE<uint16_t>(Record + RecordDieTag, Obj.getDieTag());
+    writeLE<uint16_t>(Record + RecordDiscriminator, Obj.getDiscriminator());
+    writeLE<uint32_t>(
+        Record + RecordObjectFlags,
+        static_cast<uint32_t>(Obj.ObjectAttributesFlags.to_ulong()));
+    writeLE<uint32_t>(Record + RecordKindFlags, KindFlags);
+    writeLE<uint32_t>(Record + RecordExtraFlags, ExtraFlags);
+    writeLE<uint32_t>(Record + RecordByteSize, ByteSize);
+    writeLE<uint32_t>(Record + RecordName, StringTable.add(Obj.getName()));
+    writeLE<uint32_t>(Record + RecordQualifiedName,
+                      StringTable.add(Obj.getQualifiedName()));
+    writeLE<uint32_t>(Record + RecordFileName, FileName);
+    writeLE<uint32_t>(Record + RecordValue, Value);
+    writeLE<uint64_t>(Record + RecordLineNumber, Obj.getLineNumber());
+    writeLE<uint64_t>(Record + RecordDieOffset, Obj.getDieOffset());
+    writeLE<uint64_t>(Record + RecordCallLineNumber, Obj.getCallLineNumber());
+    writeLE<uint32_t>(Record + RecordParent,
+                      I == 0 ? NoIndex : getIndex(Obj.getParent()));
+    writeLE<uint32_t>(Record + RecordType, getIndex(Obj.getType()));
+    writeLE<uint32_t>(Record + RecordReference, getIndex(Reference));
+    writeLE<uint32_t>(Record + RecordKind,
+                      StringTable.add(Obj.getKindAsString()));
+    writeLE<uint32_t>(Record + RecordFullName,
+                      StringTable.add(Obj.getPrintedName().c_str()));
+    std::string TypeName;
+    Obj.getPrintedTypeName(TypeName);
+    writeLE<uint32_t>(Record + RecordTypeName,
+                      StringTable.add(TypeName.c_str()));
+  }
+  if (!Valid)
+    return false;
+
+  // Lay out the string table.
+  const std::vector<std::string> &Strings = StringTable.getStrings();
+  std::vector<char> StringData;
+  std::vector<uint32_t> StringOffsets;
+  StringOffsets.reserve(Strings.size());
+  for (const std::string &Str : Strings) {
+    StringOffsets.push_back(static_cast<uint32_t>(StringData.size()));
+    StringData.insert(StringData.end(), Str.begin(), Str.end());
+    StringData.push_back('\0');
+  }
+
+  const uint64_t ObjectsOffset = HeaderSize;
+  const uint64_t ChildIndexOffset = ObjectsOffset + Records.size();
+  const uint64_t RangesOffset =
+      ChildIndexOffset + ChildIndexes.size() * sizeof(uint32_t);
+  const uint64_t StringOffsetsOffset = RangesOffset + Ranges.size() * RangeSize;
+  const uint64_t StringDataOffset =
+      StringOffsetsOffset + StringOffsets.size() * sizeof(uint32_t);
+
+  Data.assign(static_cast<size_t>(StringDataOffset + StringData.size()), 0);
+  char *Header = Data.data();
+  std::memcpy(Header + HeaderMagic, Magic, sizeof(Magic));
+  writeLE<uint32_t>(Header + HeaderVersion, Version);
+  writeLE<uint32_t>(Header + HeaderRecordSize, RecordSize);
+  writeLE<uint32_t>(Header + HeaderObjectCount,
+                    static_cast<uint32_t>(Objects.size()));
+  writeLE<uint32_t>(Header + HeaderChildIndexCount,
+                    static_cast<uint32_t>(ChildIndexes.size()));
+  writeLE<uint32_t>(Header + HeaderStringCount,
+                    static_cast<uint32_t>(Strings.size()));
+  writeLE<uint32_t>(Header + HeaderKey, KeyIndex);
+  writeLE<uint64_t>(Header + HeaderObjectsOffset, ObjectsOffset);
+  writeLE<uint64_t>(Header + HeaderChildIndexOffset, ChildIndexOffset);
+  writeLE<uint64_t>(Header + HeaderStringOffsetsOffset, StringOffsetsOffset);
+  writeLE<uint64_t>(Header + HeaderStringDataOffset, StringDataOffset);
+  writeLE<uint64_t>(Header + HeaderStringDataSize, StringData.size());
+  writeLE<uint32_t>(Header + HeaderRangeCount,
+                    static_cast<uint32_t>(Ranges.size()));
+  writeLE<uint64_t>(Header + HeaderRangesOffset, RangesOffset);
+
+  std::copy(Records.begin(), Records.end(), Data.begin() + ObjectsOffset);
+  for (size_t I = 0; I < ChildIndexes.size(); ++I)
+    writeLE<uint32_t>(&Data[ChildIndexOffset + I * sizeof(uint32_t)],
+                      ChildIndexes[I]);
+  for (size_t I = 0; I < Ranges.size(); ++I) {
+    writeLE<uint64_t>(&Data[RangesOffset + I * RangeSize], Ranges[I].Low);
+    writeLE<uint64_t>(&Data[RangesOffset + I * RangeSize + 8], Ranges[I].High);
+  }
+  for (size_t I = 0; I < StringOffsets.size(); ++I)
+    writeLE<uint32_t>(&Data[StringOffsetsOffset + I * sizeof(uint32_t)],
+                      StringOffsets[I]);
+  std::copy(StringData.begin(), StringData.end(),
+            Data.begin() + StringDataOffset);
+  return true;
+}
+
+Scope *ScopeTreeSerializer::read(const char *Data, size_t Size,
+                                 const std::string &Key) {
+  ScopeTreeView View;
+  if (!View.open(Data, Size) || Key != View.getKey())
+    return nullptr;
+
+  // Create the objects and their plain attributes.
+  const uint32_t ObjectCount = View.getObjectCount();
+  std::vector<Object *> Objects(ObjectCount);
+  for (uint32_t I = 0; I < ObjectCount; ++I) {
+    ScopeTreeView::ObjectView Record = View.getObject(I);
+    Object *Obj = createObject(Record.getClass(), Record.getLevel());
+    Objects[I] = Obj;
+
+    Obj->setDieTag(Record.getDieTag());
+    Obj->setDieOffset(Record.getDieOffset());
+    Obj->setLineNumber(Record.getLineNumber());
+    Obj->setCallLineNumber(Record.getCallLineNumber());
+    Obj->setDiscriminator(Record.getDiscriminator());
+    Obj->setNameIndex(StringPool::getStringIndex(Record.getName()));
+    Obj->setQualifiedName(Record.getQualifiedName());
+
+    uint32_t ExtraFlags = Record.getField<uint32_t>(RecordExtraFlags);
+    Obj->setFileNameIndex(
+        (ExtraFlags & ExtraInvalidFileName)
+            ? Record.getField<uint32_t>(RecordFileName)
+            : StringPool::getStringIndex(Record.getFileName()));
+
+    if (auto *Fn = dynamic_cast<ScopeFunction *>(Obj)) {
+      if (ExtraFlags & ExtraIsStatic)
+        Fn->setIsStatic();
+      if (ExtraFlags & ExtraIsDeclaredInline)
+        Fn->setIsDeclaredInline();
+      if (ExtraFlags & ExtraIsDeclaration)
+        Fn->setIsDeclaration();
+    } else if (auto *Enum = dynamic_cast<ScopeEnumeration *>(Obj)) {
+      if (ExtraFlags & ExtraIsEnumClass)
+        Enum->setIsClass();
+    } else if (auto *Sym = dynamic_cast<Symbol *>(Obj)) {
+      if (ExtraFlags & ExtraIsStatic)
+        Sym->setIsStatic();
+    } else if (auto *Ty = dynamic_cast<Type *>(Obj)) {
+      Ty->setByteSize(Record.getByteSize());
+      if (Record.getValue()[0])
+        Ty->setValue(Record.getValue());
+    }
+  }
+
+  // Link the objects, keeping the original order of the children.
+  for (uint32_t I = 0; I < ObjectCount; ++I) {
+    ScopeTreeView::ObjectView Record = View.getObject(I);
+    Object *Obj = Objects[I];
+
+    if (Record.hasType())
+      Obj->setType(Objects[Record.getType().getIndex()]);
+    if (Record.hasReference()) {
+      Object *Reference = Objects[Record.getReference().getIndex()];
+      if (auto *Sym = dynamic_cast<Symbol *>(Obj))
+        Sym->setReference(static_cast<Symbol *>(Reference));
+      else
+        static_cast<Scope *>(Obj)->setReference(
+            static_cast<Scope *>(Reference));
+    }
+
+    auto *Scp = dynamic_cast<Scope *>(Obj);
+    if (!Scp)
+      continue;
+    // The children are added directly rather than using addObject, as the
+    // flags that it propagates are restored as they were when written.
+    for (uint32_t C = 0; C < Record.getChildCount(); ++C) {
+      Object *Child = Objects[Record.getChild(C).getIndex()];
+      Child->setParent(Scp);
+      if (dynamic_cast<Type *>(Child))
+        Scp->addChild(Child, Scope::TypeChildren);
+      else if (dynamic_cast<Symbol *>(Child))
+        Scp->addChild(Child, Scope::SymbolChildren);
+      else
+        Scp->addChild(Child, Scope::ScopeChildren);
+    }
+    Scp->compactChildren();
+    for (uint32_t L = 0; L < Record.getLineCount(); ++L) {
+      auto *Ln = static_cast<Line *>(Objects[Record.getLine(L).getIndex()]);
+      Ln->setParent(Scp);
+      Scp->TheLines.push_back(Ln);
+    }
+    for (uint32_t R = 0; R < Record.getRangeCount(); ++R)
+      Scp->addAddressRange(Record.getRangeLow(R), Record.getRangeHigh(R));
+  }
+
+  // Restore the flags last, as some of the setters above also set flags.
+  for (uint32_t I = 0; I < ObjectCount; ++I) {
+    ScopeTreeView::ObjectView Record = View.getObject(I);
+    Object *Obj = Objects[I];
+    uint32_t KindFlags = Record.getField<uint32_t>(RecordKindFlags);
+    auto Access =
+        static_cast<AccessSpecifier>(Record.getField<uint8_t>(RecordAccess));
+
+    Obj->ObjectAttributesFlags = decltype(Obj->ObjectAttributesFlags)(
+        Record.getField<uint32_t>(RecordObjectFlags));
+    if (auto *Scp = dynamic_cast<Scope *>(Obj)) {
+      Scp->ScopeAttributesFlags =
+          decltype(Scp->ScopeAttributesFlags)(KindFlags);
+    } else if (auto *Ty = dynamic_cast<Type *>(Obj)) {
+      Ty->TypeAttributesFlags = decltype(Ty->TypeAttributesFlags)(KindFlags);
+      if (auto *Import = dynamic_cast<TypeImport *>(Ty))
+        if (Import->getIsInheritance())
+          Import->setInheritanceAccess(Access);
+    } else if (auto *Sym = dynamic_cast<Symbol *>(Obj)) {
+      Sym->SymbolAttributesFlags =
+          decltype(Sym->SymbolAttributesFlags)(KindFlags);
+      if (Sym->getIsMember())
+        Sym->setAccessSpecifier(Access);
+    } else if (auto *Ln = dynamic_cast<Line *>(Obj)) {
+      Ln->LineAttributesFlags = decltype(Ln->LineAttributesFlags)(KindFlags);
+    }
+
+    // The summary table uses the flags to classify the objects.
+    if (I != 0 && getReader())
+      getReader()->incrementFound(Obj->getKind());
+  }
+
+  return static_cast<Scope *>(Objects[0]);
+}
+
+bool ScopeTreeSerializer::writeFile(const Scope &Root, const std::string &Key,
+                                    const std::string &UnifiedPath) {
+  std::vector<char> Data;
+  if (!write(Root, Key, Data))
+    return false;
+
+  // Write to a temporary file first, so a concurrent reader never sees a
+  // partially written tree. The name is unique to the thread, as several
+  // threads can write the same tree.
+  const std::string TempPath =
+      UnifiedPath + "." +
+      std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+      ".tmp";
+  {
+    std::ofstream Out(nativeFilePath(TempPath),
+                      std::ios::binary | std::ios::trunc);
+    Out.write(Data.data(), static_cast<std::streamsize>(Data.size()));
+    if (!Out)
+      return false;
+  }
+  std::remove(nativeFilePath(UnifiedPath).c_str());
+  return std::rename(nativeFilePath(TempPath).c_str(),
+                     nativeFilePath(UnifiedPath).c_str()) == 0;
+}
+
+Scope *ScopeTreeSerializer::readFile(const std::string &UnifiedPath,
+                                     const std::string &Key) {
+  MappedFile File;
+  if (!File.open(UnifiedPath))
+    return nullptr;
+  return read(File.data(), File.size(), Key);
+}
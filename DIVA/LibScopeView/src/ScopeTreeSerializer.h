@@ -0,0 +1,77 @@
+//===-- LibScopeView/ScopeTreeSerializer.h ----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Conversion between a scope tree and DIVA's binary scope tree format.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPETREESERIALIZER_H
+#define SCOPETREESERIALIZER_H
+
+#include <string>
+#include <vector>
+
+namespace LibScopeView {
+
+class Scope;
+
+/// \brief Writes and rebuilds scope trees using the layout described in
+/// ScopeTreeFormat.h. Use ScopeTreeView to access the data in place.
+///
+/// The rebuilt tree is an exact copy of the written one, including every
+/// attribute flag, so it can go through the same post-creation actions as a
+/// tree freshly created by a reader.
+class ScopeTreeSerializer {
+public:
+  /// \brief Serialize the tree under Root, tagged with the given Key.
+  ///
+  /// Returns false if any object references an object outside the tree,
+  /// unless DropExternalReferences is set. Such references are then left out,
+  /// their names are still available in the type names of the records.
+  static bool write(const Scope &Root, const std::string &Key,
+                    std::vector<char> &Data,
+                    bool DropExternalReferences = false);
+
+  /// \brief Rebuild the tree stored in Data.
+  ///
+  /// Returns nullptr if the data is not a valid tree tagged with Key. The
+  /// objects are counted in the current Reader summary table.
+  static Scope *read(const char *Data, size_t Size, const std::string &Key);
+
+  /// \brief Serialize the tree under Root into the file at UnifiedPath.
+  static bool writeFile(const Scope &Root, const std::string &Key,
+                        const std::string &UnifiedPath);
+
+  /// \brief Rebuild the tree stored in the file at UnifiedPath.
+  ///
+  /// Returns nullptr if the file does not exist or is not a valid tree tagged
+  /// with Key.
+  static Scope *readFile(const std::string &UnifiedPath,
+                         const std::string &Key);
+};
+
+} // namespace LibScopeView
+
+#endif // SCOPETREESERIALIZER_H
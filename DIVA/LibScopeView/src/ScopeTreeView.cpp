@@ -0,0 +1,351 @@
+//===-- LibScopeView/ScopeTreeView.cpp --------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Read-only access to a tree in DIVA's binary scope tree format.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ScopeTreeView.h"
+
+#include <assert.h>
+#include <vector>
+
+using namespace LibScopeView;
+using namespace LibScopeView::ScopeTreeFormat;
+
+namespace {
+
+bool isScopeClass(ObjectClass Class) {
+  return Class >= ObjectClass::Scope && Class <= ObjectClass::ScopeTemplatePack;
+}
+
+// True if Count elements of ElementSize bytes starting at Offset fit in Size.
+bool fits(size_t Size, uint64_t Offset, uint64_t Count, uint64_t ElementSize) {
+  if (Offset > Size)
+    return false;
+  return ElementSize == 0 || Count <= (Size - Offset) / ElementSize;
+}
+
+} // namespace
+
+ScopeTreeView::ScopeTreeView()
+    : Data(nullptr), Size(0), ObjectCount(0), StringCount(0),
+      Objects(nullptr), ChildIndexes(nullptr), Ranges(nullptr),
+      StringOffsets(nullptr), StringData(nullptr) {}
+
+bool ScopeTreeView::open(const char *TreeData, size_t TreeSize) {
+  *this = ScopeTreeView();
+  if (!fits(TreeSize, 0, 1, HeaderSize) ||
+      std::memcmp(TreeData + HeaderMagic, Magic, sizeof(Magic)) != 0 ||
+      readLE<uint32_t>(TreeData + HeaderVersion) != Version ||
+      readLE<uint32_t>(TreeData + HeaderRecordSize) != RecordSize)
+    return false;
+
+  const uint32_t Count = readLE<uint32_t>(TreeData + HeaderObjectCount);
+  const uint32_t ChildIndexCount =
+      readLE<uint32_t>(TreeData + HeaderChildIndexCount);
+  const uint32_t Strings = readLE<uint32_t>(TreeData + HeaderStringCount);
+  const uint64_t ObjectsOffset =
+      readLE<uint64_t>(TreeData + HeaderObjectsOffset);
+  const uint64_t ChildIndexOffset =
+      readLE<uint64_t>(TreeData + HeaderChildIndexOffset);
+  const uint64_t StringOffsetsOffset =
+      readLE<uint64_t>(TreeData + HeaderStringOffsetsOffset);
+  const uint64_t StringDataOffset =
+      readLE<uint64_t>(TreeData + HeaderStringDataOffset);
+  const uint64_t StringDataSize =
+      readLE<uint64_t>(TreeData + HeaderStringDataSize);
+  const uint32_t RangeCount = readLE<uint32_t>(TreeData + HeaderRangeCount);
+  const uint64_t RangesOffset = readLE<uint64_t>(TreeData + HeaderRangesOffset);
+  if (Count == 0 || Strings == 0 || StringDataSize == 0 ||
+      !fits(TreeSize, ObjectsOffset, Count, RecordSize) ||
+      !fits(TreeSize, ChildIndexOffset, ChildIndexCount, sizeof(uint32_t)) ||
+      !fits(TreeSize, RangesOffset, RangeCount, RangeSize) ||
+      !fits(TreeSize, StringOffsetsOffset, Strings, sizeof(uint32_t)) ||
+      !fits(TreeSize, StringDataOffset, StringDataSize, 1) ||
+      TreeData[StringDataOffset + StringDataSize - 1] != '\0')
+    return false;
+
+  // Every string must start inside the string data, which is terminated.
+  for (uint32_t I = 0; I < Strings; ++I)
+    if (readLE<uint32_t>(TreeData + StringOffsetsOffset +
+                         I * sizeof(uint32_t)) >= StringDataSize)
+      return false;
+  if (readLE<uint32_t>(TreeData + HeaderKey) >= Strings)
+    return false;
+
+  auto getRecord = [&](uint32_t Index) {
+    return TreeData + ObjectsOffset + uint64_t(Index) * RecordSize;
+  };
+  auto getClass = [&](uint32_t Index) {
+    return static_cast<ObjectClass>(readLE<uint8_t>(getRecord(Index)));
+  };
+  auto isString = [&](const char *Record, RecordField Field) {
+    return readLE<uint32_t>(Record + Field) < Strings;
+  };
+
+  // Each object other than the root must be owned by exactly one scope,
+  // appear after it and point back to it, so the tree has no cycles.
+  std::vector<bool> Owned(Count, false);
+  for (uint32_t I = 0; I < Count; ++I) {
+    const char *Record = getRecord(I);
+    ObjectClass Class = getClass(I);
+    if (Class > ObjectClass::Last)
+      return false;
+    for (RecordField Field : {RecordName, RecordQualifiedName, RecordValue,
+                              RecordKind, RecordFullName, RecordTypeName})
+      if (!isString(Record, Field))
+        return false;
+    if (!(readLE<uint32_t>(Record + RecordExtraFlags) & ExtraInvalidFileName) &&
+        !isString(Record, RecordFileName))
+      return false;
+
+    uint32_t TypeIndex = readLE<uint32_t>(Record + RecordType);
+    if (TypeIndex != NoIndex && TypeIndex >= Count)
+      return false;
+    uint32_t ReferenceIndex = readLE<uint32_t>(Record + RecordReference);
+    if (ReferenceIndex != NoIndex) {
+      if (ReferenceIndex >= Count)
+        return false;
+      // Scopes refer to scopes and symbols to symbols.
+      ObjectClass ReferenceClass = getClass(ReferenceIndex);
+      if (isScopeClass(Class) ? !isScopeClass(ReferenceClass)
+                              : (Class != ObjectClass::Symbol ||
+                                 ReferenceClass != ObjectClass::Symbol))
+        return false;
+    }
+
+    uint64_t FirstChild = readLE<uint32_t>(Record + RecordFirstChild);
+    uint64_t ChildCount = readLE<uint32_t>(Record + RecordChildCount);
+    uint64_t LineCount = readLE<uint32_t>(Record + RecordLineCount);
+    if (!isScopeClass(Class) && (ChildCount || LineCount))
+      return false;
+    if (FirstChild + ChildCount + LineCount > ChildIndexCount)
+      return false;
+    uint64_t FirstRange = readLE<uint32_t>(Record + RecordFirstRange);
+    uint64_t ScopeRangeCount = readLE<uint32_t>(Record + RecordRangeCount);
+    if ((!isScopeClass(Class) && ScopeRangeCount) ||
+        FirstRange + ScopeRangeCount > RangeCount)
+      return false;
+    for (uint64_t C = 0; C < ChildCount + LineCount; ++C) {
+      uint32_t Child = readLE<uint32_t>(TreeData + ChildIndexOffset +
+                                        (FirstChild + C) * sizeof(uint32_t));
+      if (Child >= Count || Child <= I || Owned[Child] ||
+          readLE<uint32_t>(getRecord(Child) + RecordParent) != I ||
+          (getClass(Child) == ObjectClass::Line) != (C >= ChildCount))
+        return false;
+      Owned[Child] = true;
+    }
+  }
+  if (readLE<uint32_t>(getRecord(0) + RecordParent) != NoIndex ||
+      !isScopeClass(getClass(0)))
+    return false;
+  for (uint32_t I = 1; I < Count; ++I)
+    if (!Owned[I])
+      return false;
+
+  Data = TreeData;
+  Size = TreeSize;
+  ObjectCount = Count;
+  StringCount = Strings;
+  Objects = TreeData + ObjectsOffset;
+  ChildIndexes = TreeData + ChildIndexOffset;
+  Ranges = TreeData + RangesOffset;
+  StringOffsets = TreeData + StringOffsetsOffset;
+  StringData = TreeData + StringDataOffset;
+  return true;
+}
+
+uint64_t ScopeTreeView::getSize() const {
+  if (!Data)
+    return 0;
+  return readLE<uint64_t>(Data + HeaderStringDataOffset) +
+         readLE<uint64_t>(Data + HeaderStringDataSize);
+}
+
+const char *ScopeTreeView::getKey() const {
+  return getString(readLE<uint32_t>(Data + HeaderKey));
+}
+
+ScopeTreeView::ObjectView ScopeTreeView::getObject(uint32_t Index) const {
+  assert(Index < ObjectCount && "Invalid object index");
+  return ObjectView(*this, Index);
+}
+
+ScopeTreeView::ObjectView ScopeTreeView::getRoot() const {
+  return getObject(0);
+}
+
+const char *ScopeTreeView::getString(uint32_t Index) const {
+  assert(Index < StringCount && "Invalid string index");
+  return StringData +
+         readLE<uint32_t>(StringOffsets + uint64_t(Index) * sizeof(uint32_t));
+}
+
+ScopeTreeView::ObjectView::ObjectView(const ScopeTreeView &View,
+                                      uint32_t Index)
+    : View(&View), Index(Index),
+      Record(View.Objects + uint64_t(Index) * RecordSize) {}
+
+ObjectClass ScopeTreeView::ObjectView::getClass() const {
+  return static_cast<ObjectClass>(getField<uint8_t>(RecordClass));
+}
+
+bool ScopeTreeView::ObjectView::isScope() const {
+  return isScopeClass(getClass());
+}
+
+bool ScopeTreeView::ObjectView::isLine() const {
+  return getClass() == ObjectClass::Line;
+}
+
+const char *ScopeTreeView::ObjectView::getKind() const {
+  return View->getString(getField<uint32_t>(RecordKind));
+}
+
+const char *ScopeTreeView::ObjectView::getFullName() const {
+  return View->getString(getField<uint32_t>(RecordFullName));
+}
+
+const char *ScopeTreeView::ObjectView::getTypeName() const {
+  return View->getString(getField<uint32_t>(RecordTypeName));
+}
+
+bool ScopeTreeView::ObjectView::isPrintedAsObject() const {
+  return getField<uint32_t>(RecordExtraFlags) & ExtraIsPrintedAsObject;
+}
+
+const char *ScopeTreeView::ObjectView::getName() const {
+  return View->getString(getField<uint32_t>(RecordName));
+}
+
+const char *ScopeTreeView::ObjectView::getQualifiedName() const {
+  return View->getString(getField<uint32_t>(RecordQualifiedName));
+}
+
+const char *ScopeTreeView::ObjectView::getFileName() const {
+  if (getField<uint32_t>(RecordExtraFlags) & ExtraInvalidFileName)
+    return "?";
+  return View->getString(getField<uint32_t>(RecordFileName));
+}
+
+const char *ScopeTreeView::ObjectView::getValue() const {
+  return View->getString(getField<uint32_t>(RecordValue));
+}
+
+uint16_t ScopeTreeView::ObjectView::getLevel() const {
+  return getField<uint16_t>(RecordLevel);
+}
+
+uint64_t ScopeTreeView::ObjectView::getLineNumber() const {
+  return getField<uint64_t>(RecordLineNumber);
+}
+
+uint64_t ScopeTreeView::ObjectView::getCallLineNumber() const {
+  return getField<uint64_t>(RecordCallLineNumber);
+}
+
+uint16_t ScopeTreeView::ObjectView::getDiscriminator() const {
+  return getField<uint16_t>(RecordDiscriminator);
+}
+
+uint32_t ScopeTreeView::ObjectView::getByteSize() const {
+  return getField<uint32_t>(RecordByteSize);
+}
+
+uint16_t ScopeTreeView::ObjectView::getDieTag() const {
+  return getField<uint16_t>(RecordDieTag);
+}
+
+uint64_t ScopeTreeView::ObjectView::getDieOffset() const {
+  return getField<uint64_t>(RecordDieOffset);
+}
+
+bool ScopeTreeView::ObjectView::hasParent() const {
+  return getField<uint32_t>(RecordParent) != NoIndex;
+}
+
+ScopeTreeView::ObjectView ScopeTreeView::ObjectView::getParent() const {
+  return View->getObject(getField<uint32_t>(RecordParent));
+}
+
+bool ScopeTreeView::ObjectView::hasType() const {
+  return getField<uint32_t>(RecordType) != NoIndex;
+}
+
+ScopeTreeView::ObjectView ScopeTreeView::ObjectView::getType() const {
+  return View->getObject(getField<uint32_t>(RecordType));
+}
+
+bool ScopeTreeView::ObjectView::hasReference() const {
+  return getField<uint32_t>(RecordReference) != NoIndex;
+}
+
+ScopeTreeView::ObjectView ScopeTreeView::ObjectView::getReference() const {
+  return View->getObject(getField<uint32_t>(RecordReference));
+}
+
+uint32_t ScopeTreeView::ObjectView::getChildCount() const {
+  return getField<uint32_t>(RecordChildCount);
+}
+
+ScopeTreeView::ObjectView
+ScopeTreeView::ObjectView::getChild(uint32_t ChildIndex) const {
+  assert(ChildIndex < getChildCount() && "Invalid child index");
+  return getChildEntry(ChildIndex);
+}
+
+uint32_t ScopeTreeView::ObjectView::getLineCount() const {
+  return getField<uint32_t>(RecordLineCount);
+}
+
+ScopeTreeView::ObjectView
+ScopeTreeView::ObjectView::getLine(uint32_t LineIndex) const {
+  assert(LineIndex < getLineCount() && "Invalid line index");
+  return getChildEntry(getChildCount() + LineIndex);
+}
+
+ScopeTreeView::ObjectView
+ScopeTreeView::ObjectView::getChildEntry(uint64_t Entry) const {
+  uint64_t Position = getField<uint32_t>(RecordFirstChild) + Entry;
+  return View->getObject(
+      readLE<uint32_t>(View->ChildIndexes + Position * sizeof(uint32_t)));
+}
+
+uint32_t ScopeTreeView::ObjectView::getRangeCount() const {
+  return getField<uint32_t>(RecordRangeCount);
+}
+
+uint64_t ScopeTreeView::ObjectView::getRangeLow(uint32_t RangeIndex) const {
+  assert(RangeIndex < getRangeCount() && "Invalid range index");
+  uint64_t Position = getField<uint32_t>(RecordFirstRange) + RangeIndex;
+  return readLE<uint64_t>(View->Ranges + Position * RangeSize);
+}
+
+uint64_t ScopeTreeView::ObjectView::getRangeHigh(uint32_t RangeIndex) const {
+  assert(RangeIndex < getRangeCount() && "Invalid range index");
+  uint64_t Position = getField<uint32_t>(RecordFirstRange) + RangeIndex;
+  return readLE<uint64_t>(View->Ranges + Position * RangeSize + 8);
+}
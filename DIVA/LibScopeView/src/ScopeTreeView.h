@@ -0,0 +1,166 @@
+//===-- LibScopeView/ScopeTreeView.h ----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Read-only access to a tree in DIVA's binary scope tree format.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPETREEVIEW_H
+#define SCOPETREEVIEW_H
+
+#include "ScopeTreeFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace LibScopeView {
+
+/// \brief Read-only access to a serialized scope tree, used in place.
+///
+/// The view does not copy or convert the data, so it can be used directly on
+/// a memory mapped file. The whole structure is checked when the view is
+/// opened, after that every access is a plain read of the record fields.
+///
+/// Typical usage:
+/// \code
+///   MappedFile File;
+///   ScopeTreeView View;
+///   if (File.open(Path) && View.open(File.data(), File.size()))
+///     for (uint32_t I = 0; I < View.getRoot().getChildCount(); ++I)
+///       std::cout << View.getRoot().getChild(I).getFullName() << '\n';
+/// \endcode
+class ScopeTreeView {
+public:
+  class ObjectView;
+
+  ScopeTreeView();
+
+  /// \brief Open a view on the tree at the start of Data.
+  ///
+  /// Returns false if Data does not start with a valid tree. Data must
+  /// outlive the view.
+  bool open(const char *Data, size_t Size);
+
+  /// \brief The number of bytes used by the tree.
+  uint64_t getSize() const;
+
+  /// \brief The key stored when the tree was written.
+  const char *getKey() const;
+
+  uint32_t getObjectCount() const { return ObjectCount; }
+  ObjectView getObject(uint32_t Index) const;
+  ObjectView getRoot() const;
+
+  uint32_t getStringCount() const { return StringCount; }
+  const char *getString(uint32_t Index) const;
+
+private:
+  const char *Data;
+  size_t Size;
+  uint32_t ObjectCount;
+  uint32_t StringCount;
+  const char *Objects;
+  const char *ChildIndexes;
+  const char *Ranges;
+  const char *StringOffsets;
+  const char *StringData;
+};
+
+/// \brief A lightweight handle to an object record in a ScopeTreeView.
+///
+/// Handles are cheap to copy and stay valid while the underlying data does.
+class ScopeTreeView::ObjectView {
+public:
+  /// \brief The record index of the object, the root has index 0.
+  uint32_t getIndex() const { return Index; }
+
+  ScopeTreeFormat::ObjectClass getClass() const;
+  bool isScope() const;
+  bool isLine() const;
+
+  /// \brief Values matching the YAML "object", "name" and "type" fields.
+  const char *getKind() const;
+  const char *getFullName() const;
+  const char *getTypeName() const;
+
+  /// \brief Whether the text and YAML outputs print it as an object.
+  bool isPrintedAsObject() const;
+
+  const char *getName() const;
+  const char *getQualifiedName() const;
+  const char *getFileName() const;
+  const char *getValue() const;
+  uint16_t getLevel() const;
+  uint64_t getLineNumber() const;
+  uint64_t getCallLineNumber() const;
+  uint16_t getDiscriminator() const;
+  uint32_t getByteSize() const;
+  uint16_t getDieTag() const;
+  uint64_t getDieOffset() const;
+  /// \brief The address of a line.
+  uint64_t getAddress() const { return getDieOffset(); }
+
+  /// \brief Links to other objects, check with the has* functions first.
+  bool hasParent() const;
+  ObjectView getParent() const;
+  bool hasType() const;
+  ObjectView getType() const;
+  bool hasReference() const;
+  ObjectView getReference() const;
+
+  /// \brief Children in the order of Scope::getChildren(), without lines.
+  uint32_t getChildCount() const;
+  ObjectView getChild(uint32_t ChildIndex) const;
+
+  /// \brief Line records of the scope.
+  uint32_t getLineCount() const;
+  ObjectView getLine(uint32_t LineIndex) const;
+
+  /// \brief Code address ranges of the scope, each from its low address up
+  /// to but not including its high address.
+  uint32_t getRangeCount() const;
+  uint64_t getRangeLow(uint32_t RangeIndex) const;
+  uint64_t getRangeHigh(uint32_t RangeIndex) const;
+
+  /// \brief Raw record fields, see ScopeTreeFormat::RecordField.
+  template <typename T> T getField(ScopeTreeFormat::RecordField Field) const {
+    return ScopeTreeFormat::readLE<T>(Record + Field);
+  }
+
+private:
+  friend class ScopeTreeView;
+  ObjectView(const ScopeTreeView &View, uint32_t Index);
+
+  // Entry in the children of the scope, the lines follow the other children.
+  ObjectView getChildEntry(uint64_t Entry) const;
+
+  const ScopeTreeView *View;
+  uint32_t Index;
+  const char *Record;
+};
+
+} // namespace LibScopeView
+
+#endif // SCOPETREEVIEW_H
@@ -30,6 +30,12 @@
 #include "Reader.h"
 
 #include "Sort.h"
+#include "StringPool.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
 
 using namespace LibScopeView;
 
@@ -37,11 +43,33 @@ namespace {
 template <typename T> int compare(const T &LHS, const T &RHS) {
   return (LHS < RHS) ? -1 : ((LHS > RHS) ? 1 : 0);
 }
+
+int compareStrings(const char *LHS, const char *RHS) {
+  return compare(std::strcmp(LHS, RHS), 0);
+}
+
+// Collects the name indexes and the kinds of the children of a scope.
+void collectChildren(const Scope *Scp, std::vector<size_t> &Names,
+                     std::vector<const char *> &Kinds) {
+  for (const Object *Child : Scp->getChildren()) {
+    Names.push_back(Child->getNameIndex());
+    const char *Kind = Child->getKindAsString();
+    if (std::find(Kinds.begin(), Kinds.end(), Kind) == Kinds.end())
+      Kinds.push_back(Kind);
+  }
+}
+
+// Collects the name indexes and the kinds of the objects under a scope.
+void collectSubtree(const Scope *Scp, std::vector<size_t> &Names,
+                    std::vector<const char *> &Kinds) {
+  collectChildren(Scp, Names, Kinds);
+  for (const Scope *Child : Scp->getScopes())
+    collectSubtree(Child, Names, Kinds);
+}
 } // namespace
 
 int LibScopeView::compareKind(const Object *LHS, const Object *RHS) {
-  return compare(std::string(LHS->getKindAsString()),
-                 std::string(RHS->getKindAsString()));
+  return compareStrings(LHS->getKindAsString(), RHS->getKindAsString());
 }
 
 int LibScopeView::compareLine(const Object *LHS, const Object *RHS) {
@@ -49,7 +77,7 @@ int LibScopeView::compareLine(const Object *LHS, const Object *RHS) {
 }
 
 int LibScopeView::compareName(const Object *LHS, const Object *RHS) {
-  return compare(std::string(LHS->getName()), std::string(RHS->getName()));
+  return compareStrings(LHS->getName(), RHS->getName());
 }
 
 int LibScopeView::compareOffset(const Object *LHS, const Object *RHS) {
@@ -105,3 +133,122 @@ SortFunction LibScopeView::getSortFunction(const SortingKey &SortKey) {
   }
   return nullptr;
 }
+
+bool LibScopeView::sortKeysByLine(const ObjectSortKey &LHS,
+                                  const ObjectSortKey &RHS) {
+  // The same keys as sortByLine.
+  if (LHS.Line != RHS.Line)
+    return LHS.Line < RHS.Line;
+  if (LHS.NameRank != RHS.NameRank)
+    return LHS.NameRank < RHS.NameRank;
+  if (LHS.KindRank != RHS.KindRank)
+    return LHS.KindRank < RHS.KindRank;
+  return LHS.Offset < RHS.Offset;
+}
+
+bool LibScopeView::sortKeysByName(const ObjectSortKey &LHS,
+                                  const ObjectSortKey &RHS) {
+  // The same keys as sortByName.
+  if (LHS.NameRank != RHS.NameRank)
+    return LHS.NameRank < RHS.NameRank;
+  if (LHS.Line != RHS.Line)
+    return LHS.Line < RHS.Line;
+  if (LHS.KindRank != RHS.KindRank)
+    return LHS.KindRank < RHS.KindRank;
+  return LHS.Offset < RHS.Offset;
+}
+
+bool LibScopeView::sortKeysByOffset(const ObjectSortKey &LHS,
+                                    const ObjectSortKey &RHS) {
+  return LHS.Offset < RHS.Offset;
+}
+
+SortKeyFunction LibScopeView::getSortKeyFunction(const SortingKey &SortKey) {
+  switch (SortKey) {
+  case SortingKey::LINE:
+    return sortKeysByLine;
+  case SortingKey::OFFSET:
+    return sortKeysByOffset;
+  case SortingKey::NAME:
+    return sortKeysByName;
+  }
+  return nullptr;
+}
+
+SortKeyBuilder::SortKeyBuilder(const Scope *Root) {
+  if (!Root)
+    return;
+
+  // Collect the subtree of each child scope of the root on its own thread,
+  // and the children of the root itself last.
+  const ChildSpan<Scope> Subtrees(Root->getScopes());
+  std::vector<std::vector<size_t>> Names(Subtrees.size() + 1);
+  std::vector<std::vector<const char *>> Kinds(Subtrees.size() + 1);
+  parallelFor(Subtrees.size(), [&](size_t Index) {
+    collectSubtree(Subtrees[Index], Names[Index], Kinds[Index]);
+  });
+  collectChildren(Root, Names.back(), Kinds.back());
+
+  // The String Pool holds each name once, so different indexes are different
+  // names and get different ranks.
+  std::vector<size_t> AllNames;
+  for (const std::vector<size_t> &SubtreeNames : Names)
+    AllNames.insert(AllNames.end(), SubtreeNames.begin(), SubtreeNames.end());
+  std::sort(AllNames.begin(), AllNames.end());
+  AllNames.erase(std::unique(AllNames.begin(), AllNames.end()),
+                 AllNames.end());
+  std::sort(AllNames.begin(), AllNames.end(), [](size_t LHS, size_t RHS) {
+    return std::strcmp(StringPool::getStringValue(LHS),
+                       StringPool::getStringValue(RHS)) < 0;
+  });
+  NameRanks.reserve(AllNames.size());
+  for (size_t Rank = 0; Rank < AllNames.size(); ++Rank)
+    NameRanks.emplace_back(AllNames[Rank], static_cast<uint32_t>(Rank));
+  std::sort(NameRanks.begin(), NameRanks.end());
+
+  // Several kinds have the same string, e.g. functions and inlined functions,
+  // and those get the same rank.
+  std::vector<const char *> AllKinds;
+  for (const std::vector<const char *> &SubtreeKinds : Kinds)
+    for (const char *Kind : SubtreeKinds)
+      if (std::find(AllKinds.begin(), AllKinds.end(), Kind) == AllKinds.end())
+        AllKinds.push_back(Kind);
+  std::sort(AllKinds.begin(), AllKinds.end(),
+            [](const char *LHS, const char *RHS) {
+              return std::strcmp(LHS, RHS) < 0;
+            });
+  uint32_t Rank = 0;
+  for (size_t Index = 0; Index < AllKinds.size(); ++Index) {
+    if (Index && std::strcmp(AllKinds[Index - 1], AllKinds[Index]) != 0)
+      ++Rank;
+    KindRanks.emplace_back(AllKinds[Index], Rank);
+  }
+}
+
+uint32_t SortKeyBuilder::getNameRank(size_t NameIndex) const {
+  auto Found = std::lower_bound(
+      NameRanks.begin(), NameRanks.end(), NameIndex,
+      [](const std::pair<size_t, uint32_t> &NameRank, size_t Index) {
+        return NameRank.first < Index;
+      });
+  assert(Found != NameRanks.end() && Found->first == NameIndex &&
+         "Name not in the tree");
+  return Found->second;
+}
+
+uint32_t SortKeyBuilder::getKindRank(const char *Kind) const {
+  for (const std::pair<const char *, uint32_t> &KindRank : KindRanks)
+    if (KindRank.first == Kind)
+      return KindRank.second;
+  assert(false && "Kind not found in the tree");
+  return 0;
+}
+
+ObjectSortKey SortKeyBuilder::getKey(const Object *Obj) const {
+  ObjectSortKey Key;
+  Key.Line = Obj->getLineNumber();
+  Key.NameRank = getNameRank(Obj->getNameIndex());
+  Key.KindRank = getKindRank(Obj->getKindAsString());
+  Key.Offset = Obj->getDieOffset();
+  return Key;
+}
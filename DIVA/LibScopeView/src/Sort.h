@@ -30,9 +30,15 @@
 #ifndef SORT_H
 #define SORT_H
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 namespace LibScopeView {
 
 class Object;
+class Scope;
 
 enum class SortingKey { LINE, OFFSET, NAME };
 
@@ -48,6 +54,50 @@ bool sortByLine(const Object *LHS, const Object *RHS);
 bool sortByName(const Object *LHS, const Object *RHS);
 bool sortByOffset(const Object *LHS, const Object *RHS);
 
+/// \brief The values an object is sorted by, read once from the object so that
+/// comparing two keys neither calls into the objects nor allocates.
+struct ObjectSortKey {
+  uint64_t Line;
+  // Position of the name in the sorted names of the tree.
+  uint32_t NameRank;
+  // Position of the kind in the sorted kinds of the tree.
+  uint32_t KindRank;
+  uint64_t Offset;
+};
+
+typedef bool (*SortKeyFunction)(const ObjectSortKey &LHS,
+                                const ObjectSortKey &RHS);
+
+// Callback functions to sort object keys, in the same order as the
+// callback functions to sort objects.
+SortKeyFunction getSortKeyFunction(const SortingKey &SortKey);
+bool sortKeysByLine(const ObjectSortKey &LHS, const ObjectSortKey &RHS);
+bool sortKeysByName(const ObjectSortKey &LHS, const ObjectSortKey &RHS);
+bool sortKeysByOffset(const ObjectSortKey &LHS, const ObjectSortKey &RHS);
+
+/// \brief Computes the sort keys of the objects of a tree.
+///
+/// The names and kinds are replaced by their rank among the names and kinds
+/// in the tree, so the integer comparisons of the ranks give the same order as
+/// comparing the strings.
+class SortKeyBuilder {
+public:
+  /// \brief Rank the names and kinds of the objects under Root.
+  explicit SortKeyBuilder(const Scope *Root);
+
+  ObjectSortKey getKey(const Object *Obj) const;
+
+private:
+  uint32_t getNameRank(size_t NameIndex) const;
+  uint32_t getKindRank(const char *Kind) const;
+
+  // Rank of each String Pool index used as a name in the tree, sorted by
+  // index.
+  std::vector<std::pair<size_t, uint32_t>> NameRanks;
+  // Rank of each kind string. The same kind may be several strings.
+  std::vector<std::pair<const char *, uint32_t>> KindRanks;
+};
+
 } // namespace LibScopeView
 
 #endif // SORT_H
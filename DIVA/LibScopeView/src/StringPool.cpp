@@ -85,11 +85,22 @@ const char *StringPool::getStringValue(size_t Index) {
   return GlobalStringPool->getString(Index);
 }
 
+size_t StringPool::lookupStringIndex(const std::string &Str, bool &Found) {
+  assert(GlobalStringPool);
+  // The empty string is always at index 0.
+  if (Str.empty()) {
+    Found = true;
+    return 0;
+  }
+  return GlobalStringPool->lookup(Str.c_str(), Found);
+}
+
 StringPool::StringPool() {
   Hits = 0;
   Misses = 0;
 
-  TheStrings.push_back('\0');
+  StorageEnd = 0;
+  store("", 0);
 }
 
 StringPool::~StringPool() {}
@@ -103,6 +114,7 @@ size_t StringPool::getIndex(const char *Str) {
     // Any other string is hashed and looked up.
     uint32_t Hash = strHash(Str);
     size_t bucket = Hash % HASHTABLE_NUM_BUCKETS;
+    std::lock_guard<std::mutex> Lock(BucketLocks[bucket % LockCount]);
 
     // Lookup.
     bool Found = false;
@@ -121,6 +133,7 @@ size_t StringPool::lookup(const char *Str, bool &Found) {
   // Any other string is hashed and looked up.
   uint32_t Hash = strHash(Str);
   size_t Bucket = Hash % HASHTABLE_NUM_BUCKETS;
+  std::lock_guard<std::mutex> Lock(BucketLocks[Bucket % LockCount]);
 
   // Lookup.
   return lookup(Str, Bucket, Found);
@@ -129,7 +142,7 @@ size_t StringPool::lookup(const char *Str, bool &Found) {
 size_t StringPool::lookup(const char *Str, size_t Bucket, bool &Found) {
   // Index to string.
   for (auto Index : HashTable[Bucket]) {
-    const char *stored_str = &(TheStrings[Index]);
+    const char *stored_str = getString(Index);
     if (strcmp(Str, stored_str) == 0) {
       Hits++;
       Found = true;
@@ -142,11 +155,7 @@ size_t StringPool::lookup(const char *Str, size_t Bucket, bool &Found) {
 }
 
 size_t StringPool::insert(const char *Str, size_t Bucket) {
-  size_t Index = TheStrings.size();
-  while (*Str) {
-    TheStrings.push_back(*Str++);
-  }
-  TheStrings.push_back('\0');
+  size_t Index = store(Str, strlen(Str));
 
   HashTable[Bucket].push_back(Index);
   Misses++;
@@ -154,11 +163,33 @@ size_t StringPool::insert(const char *Str, size_t Bucket) {
   return Index;
 }
 
+size_t StringPool::store(const char *Str, size_t Length) {
+  std::lock_guard<std::mutex> Lock(StorageMutex);
+  size_t Size = Length + 1;
+  size_t Index = StorageEnd;
+  size_t Offset = Index & (ChunkSize - 1);
+
+  // Start a new chunk if the string does not fit in the current one.
+  size_t ChunkCount = 1;
+  if (Offset == 0 || Offset + Size > ChunkSize) {
+    Index = (Index + ChunkSize - 1) & ~(ChunkSize - 1);
+    ChunkCount = (Size + ChunkSize - 1) >> ChunkBits;
+    if ((Index >> ChunkBits) + ChunkCount > MaxChunks)
+      throw std::length_error("String Pool is full.\n");
+    Chunks[Index >> ChunkBits].reset(new char[ChunkCount * ChunkSize]);
+  }
+
+  memcpy(Chunks[Index >> ChunkBits].get() + (Index & (ChunkSize - 1)), Str,
+         Size);
+  StorageEnd = ChunkCount > 1 ? Index + ChunkCount * ChunkSize : Index + Size;
+  return Index;
+}
+
 const char *StringPool::getString(size_t Index) {
-  if (Index > TheStrings.size()) {
+  if (Index >= StorageEnd) {
     throw std::logic_error("Invalid string index in String Pool.\n");
   }
-  return &(TheStrings[Index]);
+  return Chunks[Index >> ChunkBits].get() + (Index & (ChunkSize - 1));
 }
 
 void StringPool::info(const char *Title) {
@@ -179,15 +210,18 @@ void StringPool::info(const char *Title) {
 
   GlobalPrintContext->print("\n%s\n", Title);
   GlobalPrintContext->print("Number of buckets:           %d\n", HASHTABLE_NUM_BUCKETS);
-  GlobalPrintContext->print("Pool misses (total strings): %d\n", Misses);
-  GlobalPrintContext->print("Pool hits:                   %d\n", Hits);
+  GlobalPrintContext->print("Pool misses (total strings): %d\n",
+                            Misses.load());
+  GlobalPrintContext->print("Pool hits:                   %d\n",
+                            Hits.load());
   GlobalPrintContext->print("Pool efficiency:             %f\n",
          (static_cast<double>(Hits) / static_cast<double>(Misses)));
   GlobalPrintContext->print("Min entries per bucket:      %d\n", MinEntries);
   GlobalPrintContext->print("Max entries per bucket:      %d\n", MaxEntries);
   GlobalPrintContext->print("Average entries per bucket:  %f\n", Average);
   GlobalPrintContext->print("Standard deviation:          %f\n", sqrt(Variance));
-  GlobalPrintContext->print("Size of string table:        %d\n", TheStrings.size());
+  GlobalPrintContext->print("Size of string table:        %d\n",
+                            StorageEnd.load());
 }
 
 uint32_t StringPool::strHash(const char *Str) {
@@ -211,7 +245,7 @@ void StringPool::dump(const char *Title) {
   GlobalPrintContext->print("\n%s\n", Title);
   for (size_t Bucket = 0; Bucket < HASHTABLE_NUM_BUCKETS; ++Bucket) {
     for (auto Index : HashTable[Bucket]) {
-      const char *Str = &(TheStrings[Index]);
+      const char *Str = getString(Index);
       GlobalPrintContext->print("Bucket=%08x,index=%08x,str='%s'\n", Bucket,
                                 Index, Str);
     }
@@ -30,8 +30,11 @@
 #ifndef STRINGPOOL_H_
 #define STRINGPOOL_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -41,8 +44,9 @@ namespace LibScopeView {
 
 /// \brief This class implements a String Pool for deduplicating strings.
 ///
-/// The deduplicated strings are stored in one contiguous bit of memory, and a
-/// hash table is then used to index them.
+/// The deduplicated strings are stored in large chunks of memory, and a hash
+/// table is then used to index them. A stored string never moves, so strings
+/// can be added and read by several threads at once.
 class StringPool {
 public:
   StringPool(StringPool const &) = delete;
@@ -52,6 +56,8 @@ public:
   static size_t getStringIndex(const char *Str);
   static size_t getStringIndex(const std::string &Str);
   static const char *getStringValue(size_t Index);
+  /// \brief Looks for a string without adding it to the String Pool.
+  static size_t lookupStringIndex(const std::string &Str, bool &Found);
 
   static void create();
   static void destroy();
@@ -96,16 +102,32 @@ private:
   // Creates a specific string in this String Pool and returns it's index.
   size_t insert(const char *Str, size_t Bucket);
 
+  // Copies a string of the given length into the chunks and returns its index.
+  size_t store(const char *Str, size_t Length);
+
 private:
-  // All the strings in the pool, as null-terminated char sequences.
-  std::vector<char> TheStrings;
+  // The index of a string is its position in the sequence of chunks. A string
+  // never spans two chunks, unless it is longer than a chunk and then it gets
+  // its own chunks.
+  static const size_t ChunkBits = 20;
+  static const size_t ChunkSize = size_t(1) << ChunkBits;
+  static const size_t MaxChunks = size_t(1) << 16;
 
-  // The hash table indexing the strings in the pool.
+  // All the strings in the pool, as null-terminated char sequences.
+  std::unique_ptr<char[]> Chunks[MaxChunks];
+  // Index of the next string stored.
+  std::atomic<size_t> StorageEnd;
+  std::mutex StorageMutex;
+
+  // The hash table indexing the strings in the pool, with each lock guarding
+  // every LockCount-th bucket.
+  static const size_t LockCount = 64;
   std::vector<size_t> HashTable[HASHTABLE_NUM_BUCKETS];
+  std::mutex BucketLocks[LockCount];
 
   // Track hits and misses.
-  size_t Hits;
-  size_t Misses;
+  std::atomic<size_t> Hits;
+  std::atomic<size_t> Misses;
 };
 
 } // namespace LibScopeView
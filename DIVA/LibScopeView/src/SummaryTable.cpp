@@ -28,41 +28,35 @@
 //===----------------------------------------------------------------------===//
 
 #include "SummaryTable.h"
-#include "Object.h"
 
 #include <iomanip>
 #include <ostream>
-#include <vector>
+#include <string>
 
 using namespace LibScopeView;
 
-SummaryTable::SummaryTable()
-    : TotalFound(0), TotalPrinted(0), TotalMissing(0), TotalAdded(0) {
-  // Create a list of row labels for each DIVA Object.
-  static const std::vector<std::string> RowLabels = {"Alias",
-                                                     "Block",
-                                                     "Class",
-                                                     "CodeLine",
-                                                     "CompileUnit",
-                                                     "Enum",
-                                                     "Function",
-                                                     "Member",
-                                                     "Namespace",
-                                                     "Parameter",
-                                                     "PrimitiveType",
-                                                     "Struct",
-                                                     "TemplateParameter",
-                                                     "Union",
-                                                     "Using",
-                                                     "Variable"};
-
-  // Add a row to the table for each DIVA object.
-  for (auto Label : RowLabels) {
-    Rows.emplace(Label, SummaryTableRow());
-  }
-}
-
-void SummaryTable::getPrintedSummaryTable(std::ostream &Out) {
+// Row labels for each DIVA Object, in the order of ObjectKind.
+const char *const SummaryTable::RowLabels[RowCount] = {
+    "Alias",
+    "Block",
+    "Class",
+    "CodeLine",
+    "CompileUnit",
+    "Enum",
+    "Function",
+    "Member",
+    "Namespace",
+    "Parameter",
+    "PrimitiveType",
+    "Struct",
+    "TemplateParameter",
+    "Union",
+    "Using",
+    "Variable"};
+
+SummaryTable::SummaryTable() {}
+
+void SummaryTable::getPrintedSummaryTable(std::ostream &Out) const {
   // Calculate and create indent and divider strings.
   const uint32_t NumberOfColumns = 2;
   const uint32_t DividerLength = (LabelWidth + (ColumnWidth * NumberOfColumns));
@@ -85,12 +79,15 @@ void SummaryTable::getPrintedSummaryTable(std::ostream &Out) {
       << Indent << Divider << "\n";
 
   // Output each row.
-  for (auto Row : Rows) {
-    auto RowLabel = Row.first;
-    auto RowData = Row.second;
-    Out << Indent << std::left << std::setw(LabelWidth) << RowLabel
+  unsigned int TotalFound = 0;
+  unsigned int TotalPrinted = 0;
+  for (uint32_t Index = 0; Index < RowCount; ++Index) {
+    const SummaryTableRow &RowData = Rows[Index];
+    Out << Indent << std::left << std::setw(LabelWidth) << RowLabels[Index]
         << std::right << std::setw(ColumnWidth) << RowData.ObjectsFound
         << std::setw(ColumnWidth) << RowData.ObjectsPrinted << "\n";
+    TotalFound += RowData.ObjectsFound;
+    TotalPrinted += RowData.ObjectsPrinted;
   }
 
   // Output the footer.
@@ -100,54 +97,3 @@ void SummaryTable::getPrintedSummaryTable(std::ostream &Out) {
       << std::setw(ColumnWidth) << TotalPrinted << "\n"
       << "\n";
 }
-
-void SummaryTable::incrementFound(const Object *Obj) {
-  if (!Obj)
-    return;
-
-  auto Row = Rows.find(Obj->getKindAsString());
-
-  if (Row == Rows.end())
-    return;
-
-  ++(Row->second.ObjectsFound);
-  ++TotalFound;
-}
-
-void SummaryTable::incrementPrinted(const Object *Obj) {
-  if (!Obj)
-    return;
-
-  auto Row = Rows.find(Obj->getKindAsString());
-
-  if (Row == Rows.end())
-    return;
-
-  ++(Row->second.ObjectsPrinted);
-  ++TotalPrinted;
-}
-
-void SummaryTable::incrementMissing(const Object *Obj) {
-  if (!Obj)
-    return;
-
-  auto Row = Rows.find(Obj->getKindAsString());
-
-  if (Row == Rows.end())
-    return;
-
-  ++(Row->second.ObjectsMissing);
-  ++TotalMissing;
-}
-
-void SummaryTable::incrementAdded(const Object *Obj) {
-  if (!Obj)
-    return;
-
-  auto Row = Rows.find(Obj->getKindAsString());
-  if (Row == Rows.end())
-    return;
-
-  ++(Row->second.ObjectsAdded);
-  ++TotalAdded;
-}
@@ -30,27 +30,39 @@
 #ifndef SUMMARY_TABLE_H
 #define SUMMARY_TABLE_H
 
-#include <map>
-#include <string>
+#include "Object.h"
 
-namespace LibScopeView {
+#include <cstdint>
+#include <ostream>
 
-class Object;
+namespace LibScopeView {
 
 class SummaryTable {
 public:
   SummaryTable();
 
   /// \brief Outut the standard summary table for a single file.
-  void getPrintedSummaryTable(std::ostream &out);
+  void getPrintedSummaryTable(std::ostream &out) const;
+
+  /// \brief Increment a specific column in the row of the objects of Kind.
+  void incrementFound(ObjectKind Kind) { ++getRow(Kind).ObjectsFound; }
+  void incrementPrinted(ObjectKind Kind) { ++getRow(Kind).ObjectsPrinted; }
+  void incrementMissing(ObjectKind Kind) { ++getRow(Kind).ObjectsMissing; }
+  void incrementAdded(ObjectKind Kind) { ++getRow(Kind).ObjectsAdded; }
 
-  /// \brief Increment a specific column in Obj's row.
-  void incrementFound(const Object *obj);
-  void incrementPrinted(const Object *obj);
-  void incrementMissing(const Object *obj);
-  void incrementAdded(const Object *obj);
+  /// \brief Add Count to the found column of the row of the objects of Kind,
+  /// without needing the objects.
+  void addFound(ObjectKind Kind, uint32_t Count) {
+    getRow(Kind).ObjectsFound += Count;
+  }
 
 private:
+  // The number of rows printed, one for each ObjectKind but Other.
+  static const uint32_t RowCount = static_cast<uint32_t>(ObjectKind::Other);
+
+  // Label of each row.
+  static const char *const RowLabels[RowCount];
+
   struct SummaryTableRow {
     SummaryTableRow()
         : ObjectsFound(0), ObjectsPrinted(0), ObjectsMissing(0),
@@ -62,14 +74,12 @@ private:
     uint32_t ObjectsAdded;
   };
 
-  // Map of the rows, indexed via the ObjectsClassID.
-  std::map<std::string, SummaryTableRow> Rows;
-
-  // Totals for all four columns of the summary table.
-  unsigned int TotalFound;
-  unsigned int TotalPrinted;
-  unsigned int TotalMissing;
-  unsigned int TotalAdded;
+  // The rows, indexed by their ObjectKind. The extra row counts the objects of
+  // the other kinds, so that incrementing needs no check.
+  SummaryTableRow Rows[RowCount + 1];
+  SummaryTableRow &getRow(ObjectKind Kind) {
+    return Rows[static_cast<uint32_t>(Kind)];
+  }
 
   // Column width values.
   const static uint32_t LabelWidth = 19;
@@ -54,13 +54,15 @@ Symbol::Symbol()
 
 Symbol::~Symbol() {}
 
-uint32_t Symbol::SymbolsAllocated = 0;
+std::atomic<uint32_t> Symbol::SymbolsAllocated(0);
 
 // Set Unique Object identifier, for debug purposes
 void Symbol::setTag() {
-  ++Symbol::SymbolsAllocated;
+  uint32_t Count = ++Symbol::SymbolsAllocated;
 #ifndef NDEBUG
-  Tag = Symbol::SymbolsAllocated;
+  Tag = Count;
+#else
+  (void)Count;
 #endif
 }
 
@@ -79,19 +81,29 @@ const char *Symbol::KindUndefined = "Undefined";
 const char *Symbol::KindUnspecified = "Parameter";
 const char *Symbol::KindVariable = "Variable";
 
-const char *Symbol::getKindAsString() const {
-  const char *Kind = KindUndefined;
+const Object::KindEntry &Symbol::getKindEntry() const {
+  static const KindEntry Member = {&KindMember, ObjectKind::Member};
+  static const KindEntry Parameter = {&KindParameter, ObjectKind::Parameter};
+  static const KindEntry Undefined = {&KindUndefined, ObjectKind::Other};
+  static const KindEntry Unspecified = {&KindUnspecified,
+                                        ObjectKind::Parameter};
+  static const KindEntry Variable = {&KindVariable, ObjectKind::Variable};
+
   if (getIsMember())
-    Kind = KindMember;
-  else if (getIsParameter())
-    Kind = KindParameter;
-  else if (getIsUnspecifiedParameter())
-    Kind = KindUnspecified;
-  else if (getIsVariable())
-    Kind = KindVariable;
-  return Kind;
+    return Member;
+  if (getIsParameter())
+    return Parameter;
+  if (getIsUnspecifiedParameter())
+    return Unspecified;
+  if (getIsVariable())
+    return Variable;
+  return Undefined;
 }
 
+const char *Symbol::getKindAsString() const { return *getKindEntry().Label; }
+
+ObjectKind Symbol::getKind() const { return getKindEntry().Kind; }
+
 AccessSpecifier Symbol::getAccessSpecifier() const {
   assert(getIsMember() && "getAccessSpecifier only valid for members");
   return TheAccessSpecifier;
@@ -118,7 +130,7 @@ const char *Symbol::resolveName() {
 void Symbol::dump(const PrintSettings &Settings) {
   if (Settings.printObject(*this)) {
     // Object Summary Table.
-    getReader()->incrementPrinted(this);
+    getReader()->incrementPrinted(getKind());
 
     // Common Object Data.
     Element::dump(Settings);
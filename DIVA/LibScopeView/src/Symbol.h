@@ -63,9 +63,17 @@ private:
   };
   std::bitset<SymbolAttributesSize> SymbolAttributesFlags;
 
+  // Saves and restores the flags when caching the tree.
+  friend class ScopeTreeSerializer;
+
 public:
   /// \brief Gets the object kind as a string.
   const char *getKindAsString() const override;
+  ObjectKind getKind() const final;
+
+private:
+  // The kind of this symbol, which getKindAsString and getKind are taken from.
+  const KindEntry &getKindEntry() const;
 
 public:
   bool getIsMember() const { return SymbolAttributesFlags[IsMember]; }
@@ -124,7 +132,7 @@ public:
   std::string getAsYAML() const override;
 
 private:
-  static uint32_t SymbolsAllocated;
+  static std::atomic<uint32_t> SymbolsAllocated;
 
 public:
   static uint32_t getInstanceCount() { return SymbolsAllocated; }
@@ -52,12 +52,14 @@ Type::Type() : ByteSize(0) {
 
 Type::~Type() {}
 
-uint32_t Type::TypesAllocated = 0;
+std::atomic<uint32_t> Type::TypesAllocated(0);
 
 void Type::setTag() {
-  ++Type::TypesAllocated;
+  uint32_t Count = ++Type::TypesAllocated;
 #ifndef NDEBUG
-  Tag = Type::TypesAllocated;
+  Tag = Count;
+#else
+  (void)Count;
 #endif
 }
 
@@ -91,45 +93,72 @@ const char *Type::KindUndefined = "Undefined";
 const char *Type::KindUnspecified = "Unspecified";
 const char *Type::KindVolatile = "Volatile";
 
-const char *Type::getKindAsString() const {
-  const char *kind = KindUndefined;
+const Object::KindEntry &Type::getKindEntry() const {
+  static const KindEntry Base = {&KindBase, ObjectKind::PrimitiveType};
+  static const KindEntry Const = {&KindConst, ObjectKind::Other};
+  static const KindEntry Enumerator = {&KindEnumerator, ObjectKind::Other};
+  static const KindEntry Import = {&KindImport, ObjectKind::Using};
+  static const KindEntry Inherits = {&KindInherits, ObjectKind::Other};
+  static const KindEntry Pointer = {&KindPointer, ObjectKind::Other};
+  static const KindEntry PointerMember = {&KindPointerMember,
+                                          ObjectKind::Other};
+  static const KindEntry Reference = {&KindReference, ObjectKind::Other};
+  static const KindEntry Restrict = {&KindRestrict, ObjectKind::Other};
+  static const KindEntry RvalueReference = {&KindRvalueReference,
+                                            ObjectKind::Other};
+  static const KindEntry Subrange = {&KindSubrange, ObjectKind::Other};
+  static const KindEntry TemplateTemplate = {&KindTemplateTemplate,
+                                             ObjectKind::TemplateParameter};
+  static const KindEntry TemplateType = {&KindTemplateType,
+                                         ObjectKind::TemplateParameter};
+  static const KindEntry TemplateValue = {&KindTemplateValue,
+                                          ObjectKind::TemplateParameter};
+  static const KindEntry Typedef = {&KindTypedef, ObjectKind::Alias};
+  static const KindEntry Undefined = {&KindUndefined, ObjectKind::Other};
+  static const KindEntry Unspecified = {&KindUnspecified, ObjectKind::Other};
+  static const KindEntry Volatile = {&KindVolatile, ObjectKind::Other};
+
   if (getIsBaseType())
-    kind = KindBase;
-  else if (getIsConstType())
-    kind = KindConst;
-  else if (getIsEnumerator())
-    kind = KindEnumerator;
-  else if (getIsImported())
-    kind = KindImport;
-  else if (getIsInheritance())
-    kind = KindInherits;
-  else if (getIsPointerMemberType())
-    kind = KindPointerMember;
-  else if (getIsPointerType())
-    kind = KindPointer;
-  else if (getIsReferenceType())
-    kind = KindReference;
-  else if (getIsRestrictType())
-    kind = KindRestrict;
-  else if (getIsRvalueReferenceType())
-    kind = KindRvalueReference;
-  else if (getIsSubrangeType())
-    kind = KindSubrange;
-  else if (getIsTemplateType())
-    kind = KindTemplateType;
-  else if (getIsTemplateValue())
-    kind = KindTemplateValue;
-  else if (getIsTemplateTemplate())
-    kind = KindTemplateTemplate;
-  else if (getIsTypedef())
-    kind = KindTypedef;
-  else if (getIsUnspecifiedType())
-    kind = KindUnspecified;
-  else if (getIsVolatileType())
-    kind = KindVolatile;
-  return kind;
+    return Base;
+  if (getIsConstType())
+    return Const;
+  if (getIsEnumerator())
+    return Enumerator;
+  if (getIsImported())
+    return Import;
+  if (getIsInheritance())
+    return Inherits;
+  if (getIsPointerMemberType())
+    return PointerMember;
+  if (getIsPointerType())
+    return Pointer;
+  if (getIsReferenceType())
+    return Reference;
+  if (getIsRestrictType())
+    return Restrict;
+  if (getIsRvalueReferenceType())
+    return RvalueReference;
+  if (getIsSubrangeType())
+    return Subrange;
+  if (getIsTemplateType())
+    return TemplateType;
+  if (getIsTemplateValue())
+    return TemplateValue;
+  if (getIsTemplateTemplate())
+    return TemplateTemplate;
+  if (getIsTypedef())
+    return Typedef;
+  if (getIsUnspecifiedType())
+    return Unspecified;
+  if (getIsVolatileType())
+    return Volatile;
+  return Undefined;
 }
 
+const char *Type::getKindAsString() const { return *getKindEntry().Label; }
+
+ObjectKind Type::getKind() const { return getKindEntry().Kind; }
+
 const char *Type::resolveName() { return getName(); }
 
 bool Type::setFullName(const PrintSettings &Settings) {
@@ -157,7 +186,7 @@ bool Type::setFullName(const PrintSettings &Settings) {
 void Type::dump(const PrintSettings &Settings) {
   if (Settings.printObject(*this)) {
     // Object Summary Table.
-    getReader()->incrementPrinted(this);
+    getReader()->incrementPrinted(getKind());
 
     // Common Object Data.
     Element::dump(Settings);
@@ -94,9 +94,17 @@ private:
   };
   std::bitset<TypeAttributesSize> TypeAttributesFlags;
 
+  // Saves and restores the flags when caching the tree.
+  friend class ScopeTreeSerializer;
+
 public:
   /// \brief Gets the Type kind as a string (eg, "ARRAY").
   const char *getKindAsString() const override;
+  ObjectKind getKind() const final;
+
+private:
+  // The kind of this type, which getKindAsString and getKind are taken from.
+  const KindEntry &getKindEntry() const;
 
 public:
   bool getIsBaseType() const { return TypeAttributesFlags[IsBaseType]; }
@@ -219,7 +227,7 @@ public:
   std::string getAsYAML() const override;
 
 private:
-  static uint32_t TypesAllocated;
+  static std::atomic<uint32_t> TypesAllocated;
 
 public:
   static uint32_t getInstanceCount() { return TypesAllocated; }
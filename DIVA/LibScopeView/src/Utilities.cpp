@@ -30,11 +30,16 @@
 #include "Utilities.h"
 #include "Platform.h"
 #include "PrintContext.h"
+#include "QualifiedNamePool.h"
 #include "StringPool.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #ifdef PLATFORM_WIN
 #include <Windows.h>
@@ -54,6 +59,7 @@ void LibScopeView::initialize() {
 
   // Create the String Pool, to be used for all readers.
   StringPool::create();
+  QualifiedNamePool::create();
 
   // Default print context.
   PrintContext::create(stdout);
@@ -61,6 +67,7 @@ void LibScopeView::initialize() {
 
 void LibScopeView::terminate() {
   // Delete the String Pool.
+  QualifiedNamePool::destroy();
   StringPool::destroy();
 }
 
@@ -141,3 +148,27 @@ std::string LibScopeView::trim(const std::string &text) {
   }
   return text.substr(first, (last - first + 1));
 }
+
+void LibScopeView::parallelFor(size_t Count,
+                               const std::function<void(size_t)> &Func) {
+  size_t ThreadCount = std::min<size_t>(
+      Count, std::max(1U, std::thread::hardware_concurrency()));
+  if (ThreadCount <= 1) {
+    for (size_t Index = 0; Index < Count; ++Index)
+      Func(Index);
+    return;
+  }
+
+  // Each thread takes the next index until there are none left.
+  std::atomic<size_t> Next(0);
+  auto Work = [&]() {
+    for (size_t Index = Next++; Index < Count; Index = Next++)
+      Func(Index);
+  };
+  std::vector<std::thread> Threads;
+  for (size_t Thread = 1; Thread < ThreadCount; ++Thread)
+    Threads.emplace_back(Work);
+  Work();
+  for (std::thread &Thread : Threads)
+    Thread.join();
+}
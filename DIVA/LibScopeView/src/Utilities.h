@@ -31,6 +31,7 @@
 #define UTILITIES_H
 
 #include <chrono>
+#include <functional>
 #include <string>
 
 namespace LibScopeView {
@@ -59,6 +60,10 @@ void printTimeTaken(const std::chrono::steady_clock::time_point &StartTime,
 /// \brief Remove leading and trailing spaces.
 std::string trim(const std::string &Text);
 
+/// \brief Call Func(0) to Func(Count - 1) from one thread per hardware thread
+/// and return once they have all returned.
+void parallelFor(size_t Count, const std::function<void(size_t)> &Func);
+
 } // namespace LibScopeView
 
 #endif // UTILITIES_H
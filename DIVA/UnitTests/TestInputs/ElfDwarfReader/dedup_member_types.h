@@ -0,0 +1,4 @@
+struct S {
+  MEMBER_TYPE *A;
+  MEMBER_TYPE B;
+};
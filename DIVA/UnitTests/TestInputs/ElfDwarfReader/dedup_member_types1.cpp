@@ -0,0 +1,3 @@
+#define MEMBER_TYPE int
+#include "dedup_member_types.h"
+S Var1;
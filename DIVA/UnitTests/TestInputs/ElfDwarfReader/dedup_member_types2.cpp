@@ -0,0 +1,3 @@
+#define MEMBER_TYPE unsigned
+#include "dedup_member_types.h"
+S Var2;
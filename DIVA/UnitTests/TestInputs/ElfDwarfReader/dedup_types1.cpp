@@ -0,0 +1,3 @@
+#include "dedup_types.h"
+int S::get() const { return A; }
+S Var1;
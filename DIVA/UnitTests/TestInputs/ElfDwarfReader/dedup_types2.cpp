@@ -0,0 +1,3 @@
+#include "dedup_types.h"
+S Var2;
+int use() { return Var2.get(); }
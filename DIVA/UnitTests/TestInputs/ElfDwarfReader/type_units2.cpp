@@ -0,0 +1,5 @@
+struct S {
+  int A;
+  char B;
+};
+S Var2;
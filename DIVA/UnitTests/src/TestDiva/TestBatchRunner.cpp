@@ -0,0 +1,100 @@
+//===-- UnitTests/TestDiva/TestBatchRunner.cpp ------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for processing input files in a batch.
+///
+//===----------------------------------------------------------------------===//
+
+#include "BatchRunner.h"
+#include "ElfDwarfReader.h"
+#include "FileUtilities.h"
+#include "PrintContext.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace LibScopeView;
+
+namespace {
+
+const std::vector<std::string> TestFiles = {
+    "ElfDwarfReader/structure.elf", "ElfDwarfReader/dedup_types.elf",
+    "ElfDwarfReader/structure.elf"};
+
+// Prints the name of each input file through the print context and through
+// the stream.
+std::string runBatch(BatchRunner &Runner) {
+  std::vector<std::string> InputFiles;
+  for (const std::string &TestFile : TestFiles)
+    InputFiles.push_back(getTestInputFilePath(TestFile));
+
+  PrintSettings Settings;
+  std::ostringstream Output;
+  Runner.run(InputFiles,
+             [&](const std::string &InputFile) {
+               auto TheReader = std::make_unique<ElfDwarfReader::DwarfReader>();
+               EXPECT_TRUE(TheReader->loadFile(InputFile, Settings));
+               return TheReader;
+             },
+             [](Reader &TheReader, std::ostream &Output) {
+               std::string Name(getFileName(TheReader.getInputFile()));
+               GlobalPrintContext->print("text %s\n", Name.c_str());
+               Output << "stream " << Name << "\n";
+             },
+             Output);
+  return Output.str();
+}
+
+} // namespace
+
+TEST(BatchRunner, OutputInInputOrder) {
+  const std::string Expected("text structure.elf\n"
+                             "stream structure.elf\n"
+                             "text dedup_types.elf\n"
+                             "stream dedup_types.elf\n"
+                             "text structure.elf\n"
+                             "stream structure.elf\n");
+  for (unsigned Jobs : {1U, 2U, 8U}) {
+    BatchRunner Runner(Jobs, /*MemoryLimit*/ 0);
+    EXPECT_EQ(runBatch(Runner), Expected);
+  }
+}
+
+TEST(BatchRunner, MemoryLimit) {
+  // A limit under the size of any file processes one file at a time.
+  BatchRunner Limited(4, /*MemoryLimit*/ 1);
+  runBatch(Limited);
+  size_t LargestFile = 0;
+  for (const std::string &TestFile : TestFiles) {
+    std::ifstream File(getTestInputFilePath(TestFile),
+                       std::ios::binary | std::ios::ate);
+    LargestFile = std::max(LargestFile, static_cast<size_t>(File.tellg()));
+  }
+  EXPECT_EQ(Limited.getPeakMemory(), LargestFile);
+}
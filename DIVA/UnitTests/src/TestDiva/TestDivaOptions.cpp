@@ -54,10 +54,18 @@ TEST(DivaOptions, Defaults) {
 
   EXPECT_EQ(PSet.SortKey, LibScopeView::SortingKey::LINE);
 
+  EXPECT_FALSE(PSet.DedupTypes);
+  EXPECT_TRUE(PSet.CacheDirectory.empty());
+
   EXPECT_TRUE(PSet.Filters.empty());
   EXPECT_TRUE(PSet.FilterAnys.empty());
   EXPECT_TRUE(PSet.WithChildrenFilters.empty());
   EXPECT_TRUE(PSet.WithChildrenFilterAnys.empty());
+  EXPECT_TRUE(PSet.CompileUnitFilters.empty());
+  EXPECT_TRUE(PSet.CompileUnitFilterAnys.empty());
+  EXPECT_TRUE(PSet.Finds.empty());
+  EXPECT_FALSE(PSet.LookupAddresses);
+  EXPECT_TRUE(PSet.Addresses.empty());
 
   EXPECT_TRUE(PSet.ShowAlias);
   EXPECT_TRUE(PSet.ShowBlock);
@@ -97,6 +105,16 @@ TEST(DivaOptions, Defaults) {
   EXPECT_FALSE(DOpt.ShowScopeAllocation);
   EXPECT_FALSE(DOpt.ShowStringPoolInfo);
   EXPECT_FALSE(DOpt.DumpStringPool);
+
+  EXPECT_FALSE(DOpt.Serve);
+  EXPECT_TRUE(DOpt.ServeSocket.empty());
+
+  EXPECT_FALSE(DOpt.Batch);
+  EXPECT_TRUE(DOpt.BatchManifest.empty());
+  EXPECT_EQ(DOpt.BatchJobs, 0U);
+  EXPECT_EQ(DOpt.BatchMemory, 0U);
+
+  EXPECT_TRUE(DOpt.AddressFile.empty());
 }
 
 TEST(DivaOptions, InputFiles) {
@@ -132,6 +150,53 @@ TEST(DivaOptions, OutputDir) {
   }
 }
 
+TEST(DivaOptions, CacheDirectory) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--cache-dir=test/cache"}, Output, Output, Output);
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_EQ(DOpt.PrintingSettings.CacheDirectory, "test/cache");
+}
+
+TEST(DivaOptions, Serve) {
+  std::stringstream Output;
+
+  {
+    DivaOptions DOpt({"--serve"}, Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_TRUE(DOpt.Serve);
+    EXPECT_TRUE(DOpt.ServeSocket.empty());
+  }
+
+  {
+    DivaOptions DOpt({"--serve=diva.sock"}, Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_TRUE(DOpt.Serve);
+    EXPECT_EQ(DOpt.ServeSocket, "diva.sock");
+  }
+}
+
+TEST(DivaOptions, Batch) {
+  std::stringstream Output;
+
+  {
+    DivaOptions DOpt({"--batch", "input.o"}, Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_TRUE(DOpt.Batch);
+    EXPECT_TRUE(DOpt.BatchManifest.empty());
+    EXPECT_EQ(DOpt.InputFiles, std::vector<std::string>({"input.o"}));
+  }
+
+  {
+    DivaOptions DOpt({"--batch=inputs.txt", "--jobs=12", "--batch-memory=512"},
+                     Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_TRUE(DOpt.Batch);
+    EXPECT_EQ(DOpt.BatchManifest, "inputs.txt");
+    EXPECT_EQ(DOpt.BatchJobs, 12U);
+    EXPECT_EQ(DOpt.BatchMemory, 512U);
+  }
+}
+
 TEST(DivaOptions, EarlyExitArgs) {
   std::stringstream Output;
   // Version.
@@ -181,6 +246,13 @@ TEST(DivaOptions, OutputFormat) {
     EXPECT_EQ(DOpt.OutputFormats,
               std::set<OutputFormat>({OutputFormat::TEXT, OutputFormat::YAML}));
   }
+
+  {
+    DivaOptions DOpt({"--output=binary"}, Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_EQ(DOpt.OutputFormats,
+              std::set<OutputFormat>({OutputFormat::BINARY}));
+  }
 }
 
 TEST(DivaOptions, Sorting) {
@@ -203,11 +275,29 @@ TEST(DivaOptions, Sorting) {
   }
 }
 
+TEST(DivaOptions, Finds) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--find=ns::Class::method", "--find=f1,f2"}, Output,
+                   Output, Output);
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_EQ(DOpt.PrintingSettings.Finds,
+            std::vector<std::string>({"ns::Class::method", "f1", "f2"}));
+}
+
+TEST(DivaOptions, LookupAddress) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--lookup-address=crash/pcs.txt"}, Output, Output,
+                   Output);
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_EQ(DOpt.AddressFile, "crash/pcs.txt");
+}
+
 TEST(DivaOptions, Filters) {
   std::stringstream Output;
   DivaOptions DOpt({"--filter=f1", "--filter=f2,f3", "--filter-any=fa1",
                     "--filter-any=fa2,fa3", "--tree=t1", "--tree=t2,t3",
-                    "--tree-any=ta1", "--tree-any=ta2,ta3"},
+                    "--tree-any=ta1", "--tree-any=ta2,ta3", "--cu=c1",
+                    "--cu=c2,c3", "--cu-any=ca1", "--cu-any=ca2,ca3"},
                    Output, Output, Output);
   EXPECT_EQ(Output.str(), "");
   EXPECT_EQ(DOpt.PrintingSettings.FilterAnys,
@@ -227,6 +317,16 @@ TEST(DivaOptions, Filters) {
       "t2", DOpt.PrintingSettings.WithChildrenFilters[1]));
   EXPECT_TRUE(std::regex_match(
       "t3", DOpt.PrintingSettings.WithChildrenFilters[2]));
+
+  EXPECT_EQ(DOpt.PrintingSettings.CompileUnitFilterAnys,
+            std::vector<std::string>({"ca1", "ca2", "ca3"}));
+  ASSERT_EQ(DOpt.PrintingSettings.CompileUnitFilters.size(), 3U);
+  EXPECT_TRUE(
+      std::regex_match("c1", DOpt.PrintingSettings.CompileUnitFilters[0]));
+  EXPECT_TRUE(
+      std::regex_match("c2", DOpt.PrintingSettings.CompileUnitFilters[1]));
+  EXPECT_TRUE(
+      std::regex_match("c3", DOpt.PrintingSettings.CompileUnitFilters[2]));
 }
 
 TEST(DivaOptions, ShowNone) {
@@ -312,6 +412,10 @@ TEST(DivaOptions, FlagArguments) {
 
   CHECK_FLAG("quiet", PrintingSettings.QuietMode);
   CHECK_FLAG("show-summary", PrintingSettings.ShowSummary);
+  CHECK_FLAG("summary-only", PrintingSettings.SummaryOnly);
+  CHECK_FLAG("dedup-types", PrintingSettings.DedupTypes);
+  CHECK_FLAG("native-dwarf", PrintingSettings.NativeDwarf);
+  CHECK_FLAG("lazy-scopes", PrintingSettings.LazyScopes);
 
   CHECK_FLAG("show-alias", PrintingSettings.ShowAlias);
   CHECK_FLAG("show-block", PrintingSettings.ShowBlock);
@@ -396,4 +500,15 @@ TEST(DivaOptions, Errors) {
       ExitedWithCode(1),
       "ERR_CMD_INVALID_VALUE: Argument '--output' was given the invalid value "
       "'bad'.");
+
+  // Invalid count.
+  EXPECT_EXIT(
+      { DivaOptions DOpt1({"--jobs=-2"}, Output, Output, std::cerr); },
+      ExitedWithCode(1),
+      "ERR_CMD_INVALID_VALUE: Argument '--jobs' was given the invalid value "
+      "'-2'.");
+  EXPECT_EXIT(
+      { DivaOptions DOpt1({"--batch-memory"}, Output, Output, std::cerr); },
+      ExitedWithCode(1),
+      "ERR_CMD_MISSING_VALUE: Argument '--batch-memory' requires a value.");
 }
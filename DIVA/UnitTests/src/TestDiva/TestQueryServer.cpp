@@ -0,0 +1,285 @@
+//===-- UnitTests/TestDiva/TestQueryServer.cpp ------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the Diva query server.
+///
+//===----------------------------------------------------------------------===//
+
+#include "QueryServer.h"
+#include "ElfDwarfReader.h"
+#include "Platform.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#ifndef PLATFORM_WIN
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+class TestQueryServer : public ::testing::Test {
+protected:
+  void SetUp() override {
+    for (const char *TestFile :
+         {"ElfDwarfReader/structure.elf", "ElfDwarfReader/dedup_types.elf"}) {
+      Readers.push_back(std::make_unique<ElfDwarfReader::DwarfReader>());
+      ASSERT_TRUE(
+          Readers.back()->loadFile(getTestInputFilePath(TestFile), Settings));
+      ServedReaders.push_back(Readers.back().get());
+    }
+    Server = std::make_unique<QueryServer>(ServedReaders, Settings);
+  }
+
+  std::string request(const std::string &Request) {
+    return Server->handleRequest(Request, State);
+  }
+
+  LibScopeView::PrintSettings Settings;
+  std::vector<std::unique_ptr<LibScopeView::Reader>> Readers;
+  std::vector<LibScopeView::Reader *> ServedReaders;
+  std::unique_ptr<QueryServer> Server;
+  QueryServer::Session State;
+};
+
+// Removes the status line of a successful response.
+std::string getOutput(const std::string &Response) {
+  size_t End = Response.find('\n');
+  EXPECT_EQ(Response.substr(0, 3), "ok ");
+  EXPECT_EQ(Response.substr(3, End - 3),
+            std::to_string(Response.size() - End - 1));
+  return Response.substr(End + 1);
+}
+
+} // namespace
+
+TEST_F(TestQueryServer, Files) {
+  EXPECT_EQ(getOutput(request("files")),
+            "0 " + getTestInputFilePath("ElfDwarfReader/structure.elf") +
+                "\n1 " +
+                getTestInputFilePath("ElfDwarfReader/dedup_types.elf") + "\n");
+}
+
+TEST_F(TestQueryServer, Tree) {
+  std::string Output(getOutput(request("tree 0")));
+  EXPECT_NE(Output.find("{CompileUnit} \"structure2.cpp\""), std::string::npos);
+  EXPECT_NE(Output.find("{Class} \"Class\""), std::string::npos);
+  EXPECT_EQ(Output.find("dedup_types1.cpp"), std::string::npos);
+
+  // The file can also be given by name and the output doesn't depend on the
+  // previous requests.
+  const std::string File(getTestInputFilePath("ElfDwarfReader/structure.elf"));
+  EXPECT_EQ(getOutput(request("tree " + File)), Output);
+
+  EXPECT_EQ(request("format yaml"), "ok 0\n");
+  std::string YAML(getOutput(request("tree 0")));
+  EXPECT_EQ(YAML.find("input_file: "), 0U);
+  EXPECT_NE(YAML.find("  - object: \"CompileUnit\"\n"
+                      "    name: \"structure2.cpp\""),
+            std::string::npos);
+}
+
+TEST_F(TestQueryServer, PrintScope) {
+  std::string Output(getOutput(request("print-scope 0 Class::method")));
+  EXPECT_NE(Output.find("{Source} \"structure2.cpp\""), std::string::npos);
+  EXPECT_NE(Output.find("{Function} \"Class::method\" -> \"void\""),
+            std::string::npos);
+  EXPECT_NE(Output.find("{Parameter} -> \"Class *\""), std::string::npos);
+  EXPECT_EQ(Output.find("{Class}"), std::string::npos);
+
+  request("format yaml");
+  std::string YAML(getOutput(request("print-scope 0 Class")));
+  EXPECT_NE(YAML.find("objects:\n"
+                      "  - object: \"Class\"\n"
+                      "    name: \"Class\"\n"),
+            std::string::npos);
+  EXPECT_NE(YAML.find("name: \"Class::method\""), std::string::npos);
+
+  EXPECT_EQ(request("print-scope 0 Missing"),
+            "error no scope named 'Missing'\n");
+}
+
+TEST_F(TestQueryServer, Filter) {
+  std::string Output(getOutput(request("filter 0 m.*")));
+  EXPECT_NE(Output.find("{Function} \"main\" -> \"int\""), std::string::npos);
+  EXPECT_NE(Output.find("{Function} \"Class::method\" -> \"void\""),
+            std::string::npos);
+  // Only the matching objects are printed, not their children.
+  EXPECT_EQ(Output.find("{Parameter}"), std::string::npos);
+  EXPECT_EQ(Output.find("global"), std::string::npos);
+
+  EXPECT_EQ(getOutput(request("filter 0 nothing")), "");
+  EXPECT_EQ(request("filter 0 (("), "error invalid regular expression '(('\n");
+}
+
+TEST_F(TestQueryServer, Compare) {
+  EXPECT_EQ(getOutput(request("compare 0 0")), "");
+
+  std::string Output(getOutput(request("compare 0 1")));
+  EXPECT_NE(Output.find("- {Class} \"Class\"\n"), std::string::npos);
+  EXPECT_NE(Output.find("- {Variable} \"global\" -> \"int\"\n"),
+            std::string::npos);
+  EXPECT_NE(Output.find("+ {CompileUnit} \"dedup_types1.cpp\"\n"),
+            std::string::npos);
+  // Objects found in both files are not listed.
+  EXPECT_EQ(Output.find("{PrimitiveType} \"\" -> \"int\""), std::string::npos);
+}
+
+TEST_F(TestQueryServer, Errors) {
+  EXPECT_EQ(request("unknown"), "error unknown command 'unknown'\n");
+  EXPECT_EQ(request("tree 2"), "error unknown file '2'\n");
+  EXPECT_EQ(request("compare 0 missing.o"),
+            "error unknown file 'missing.o'\n");
+  EXPECT_EQ(request("format html"), "error unknown format 'html'\n");
+  EXPECT_FALSE(State.Quit);
+}
+
+TEST_F(TestQueryServer, Serve) {
+  std::istringstream Input("files\r\nquit\nfiles\n");
+  std::ostringstream Output;
+  Server->serve(Input, Output);
+
+  // The requests after 'quit' are not answered.
+  QueryServer::Session NewState;
+  EXPECT_EQ(Output.str(),
+            Server->handleRequest("files", NewState) + "ok 0\n");
+}
+
+TEST_F(TestQueryServer, ConcurrentRequests) {
+  const std::vector<std::string> Requests = {
+      "tree 0", "tree 1", "print-scope 0 Class", "filter 1 .*", "compare 0 1"};
+
+  // Answer each request once in text and once in YAML.
+  std::vector<std::string> Expected;
+  for (bool YAML : {false, true}) {
+    QueryServer::Session Session;
+    Session.YAMLOutput = YAML;
+    for (const std::string &Request : Requests)
+      Expected.push_back(Server->handleRequest(Request, Session));
+  }
+
+  std::vector<std::vector<std::string>> Responses(8);
+  std::vector<std::thread> Threads;
+  for (std::vector<std::string> &ThreadResponses : Responses)
+    Threads.emplace_back([&]() {
+      for (bool YAML : {false, true}) {
+        QueryServer::Session Session;
+        Session.YAMLOutput = YAML;
+        for (const std::string &Request : Requests)
+          ThreadResponses.push_back(Server->handleRequest(Request, Session));
+      }
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  for (const std::vector<std::string> &ThreadResponses : Responses)
+    EXPECT_EQ(ThreadResponses, Expected);
+}
+
+#ifndef PLATFORM_WIN
+// Connects to the server listening at Path, once it is listening.
+int connectToServer(const std::string &Path) {
+  sockaddr_un Address = {};
+  Address.sun_family = AF_UNIX;
+  Path.copy(Address.sun_path, sizeof(Address.sun_path) - 1);
+  int Client = -1;
+  for (int Attempt = 0; Attempt < 500 && Client == -1; ++Attempt) {
+    Client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(Client, reinterpret_cast<sockaddr *>(&Address),
+                sizeof(Address)) != 0) {
+      close(Client);
+      Client = -1;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  return Client;
+}
+
+// Sends the Requests and returns the responses, reading until Size bytes have
+// been received or the server ends the session.
+std::string sendRequests(int Client, const std::string &Requests,
+                         size_t Size = std::string::npos) {
+  EXPECT_EQ(send(Client, Requests.data(), Requests.size(), 0),
+            static_cast<ssize_t>(Requests.size()));
+  std::string Responses;
+  char Data[256];
+  ssize_t Count;
+  while (Responses.size() < Size &&
+         (Count = recv(Client, Data, sizeof(Data), 0)) > 0)
+    Responses.append(Data, static_cast<size_t>(Count));
+  return Responses;
+}
+
+TEST_F(TestQueryServer, ServeSocket) {
+  const std::string Path = getTestOutputFilePath("diva.sock");
+  bool Served = false;
+  std::thread ServerThread([&]() { Served = Server->serveSocket(Path); });
+
+  int Client = connectToServer(Path);
+  ASSERT_NE(Client, -1);
+  std::string Responses(sendRequests(Client, "files\nshutdown\n"));
+  close(Client);
+  ServerThread.join();
+
+  QueryServer::Session NewState;
+  EXPECT_TRUE(Served);
+  EXPECT_EQ(Responses, Server->handleRequest("files", NewState) + "ok 0\n");
+}
+
+TEST_F(TestQueryServer, ServeSocketSessions) {
+  const std::string Path = getTestOutputFilePath("diva_sessions.sock");
+  bool Served = false;
+  std::thread ServerThread([&]() { Served = Server->serveSocket(Path); });
+  const std::string Files(request("files"));
+
+  // The server keeps answering new clients as earlier sessions end.
+  for (int Session = 0; Session < 16; ++Session) {
+    int Client = connectToServer(Path);
+    ASSERT_NE(Client, -1);
+    EXPECT_EQ(sendRequests(Client, "files\nquit\n"), Files + "ok 0\n");
+    close(Client);
+  }
+
+  // A session still running when the server is shut down is answered until
+  // it ends.
+  int Open = connectToServer(Path);
+  ASSERT_NE(Open, -1);
+  EXPECT_EQ(sendRequests(Open, "files\n", Files.size()), Files);
+  int Closing = connectToServer(Path);
+  ASSERT_NE(Closing, -1);
+  EXPECT_EQ(sendRequests(Closing, "shutdown\n"), "ok 0\n");
+  close(Closing);
+  EXPECT_EQ(sendRequests(Open, "files\nquit\n"), Files + "ok 0\n");
+  close(Open);
+  ServerThread.join();
+  EXPECT_TRUE(Served);
+}
+#endif
@@ -0,0 +1,98 @@
+//===-- UnitTests/TestDiva/TestWorkStealingPool.cpp -------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the work-stealing thread pool.
+///
+//===----------------------------------------------------------------------===//
+
+#include "WorkStealingPool.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+TEST(WorkStealingPool, RunsEachTaskOnce) {
+  for (unsigned Threads : {1U, 3U, 8U}) {
+    WorkStealingPool Pool(Threads);
+    EXPECT_EQ(Pool.getThreadCount(), Threads);
+
+    std::vector<std::atomic<int>> Runs(100);
+    Pool.run(Runs.size(), [&](size_t Index) { ++Runs[Index]; });
+    for (std::atomic<int> &Count : Runs)
+      EXPECT_EQ(Count, 1);
+  }
+
+  // Running no task returns at once.
+  WorkStealingPool Pool(4);
+  Pool.run(0, [](size_t) { FAIL(); });
+}
+
+TEST(WorkStealingPool, DefaultThreadCount) {
+  EXPECT_GE(WorkStealingPool(0).getThreadCount(), 1U);
+}
+
+TEST(WorkStealingPool, SingleThreadRunsInOrder) {
+  WorkStealingPool Pool(1);
+  std::vector<size_t> Order;
+  Pool.run(10, [&](size_t Index) { Order.push_back(Index); });
+  EXPECT_EQ(Order, std::vector<size_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(WorkStealingPool, CanStart) {
+  // Only start a task once all the tasks two before it have ended, and never
+  // run more than two tasks at once.
+  WorkStealingPool Pool(4);
+  std::mutex Mutex;
+  std::vector<bool> Ended(50, false);
+  size_t Running = 0;
+  size_t MaxRunning = 0;
+  bool InOrder = true;
+  Pool.run(Ended.size(),
+           [&](size_t Index) {
+             {
+               std::lock_guard<std::mutex> Lock(Mutex);
+               InOrder &= Index < 2 || Ended[Index - 2];
+             }
+             std::this_thread::sleep_for(std::chrono::microseconds(100));
+             std::lock_guard<std::mutex> Lock(Mutex);
+             Ended[Index] = true;
+             --Running;
+           },
+           [&](size_t Index) {
+             std::lock_guard<std::mutex> Lock(Mutex);
+             if (Running == 2 || (Index >= 2 && !Ended[Index - 2]))
+               return false;
+             MaxRunning = std::max(MaxRunning, ++Running);
+             return true;
+           });
+
+  EXPECT_TRUE(InOrder);
+  EXPECT_EQ(MaxRunning, 2U);
+  EXPECT_EQ(std::count(Ended.begin(), Ended.end(), true), 50);
+}
@@ -0,0 +1,105 @@
+//===-- UnitTests/TestDivaGenDwarf/TestDwarfGenerator.cpp -------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+///
+/// \file
+/// Tests for the synthetic DWARF generator.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfGenerator.h"
+#include "ElfDwarfReader.h"
+#include "Line.h"
+#include "Scope.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+std::string readFile(const std::string &Path) {
+  std::ifstream Stream(Path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(Stream),
+                     std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+TEST(DwarfGenerator, Shape) {
+  GeneratorOptions Options;
+  Options.CompileUnits = 3;
+  Options.Depth = 1;
+  Options.FanOut = 2;
+  Options.Templates = 2;
+  Options.LinesPerFunction = 3;
+  Options.StringSize = 0;
+  const std::string Path(getTestOutputFilePath("generated.o"));
+  DwarfGenerator Generator(Options);
+  std::string Error;
+  ASSERT_TRUE(Generator.generate(Path, Error)) << Error;
+  EXPECT_EQ(Generator.getOutputSize(), readFile(Path).size());
+
+  ElfDwarfReader::DwarfReader Reader;
+  LibScopeView::PrintSettings Settings;
+  Settings.SortKey = LibScopeView::SortingKey::OFFSET;
+  ASSERT_TRUE(Reader.loadFile(Path, Settings));
+  const LibScopeView::Scope *Root = Reader.getScopesRoot();
+  ASSERT_EQ(Root->getScopeCount(), 3U);
+
+  const LibScopeView::Scope *CU = Root->getScopes()[1];
+  EXPECT_STREQ(CU->getName(), "unit1.cpp");
+  // The two classes and the two namespaces.
+  ASSERT_EQ(CU->getScopeCount(), 4U);
+  EXPECT_STREQ(CU->getScopes()[0]->getName(), "Container<int, 0>");
+  EXPECT_STREQ(CU->getScopes()[1]->getName(), "Container<int, 1>");
+  const LibScopeView::Scope *Namespace = CU->getScopes()[3];
+  EXPECT_STREQ(Namespace->getName(), "ns_1_1");
+  ASSERT_EQ(Namespace->getScopeCount(), 2U);
+  const LibScopeView::Scope *Function = Namespace->getScopes()[1];
+  EXPECT_STREQ(Function->getName(), "function_1_1_1");
+  EXPECT_EQ(Function->getLineNumber(), 16U);
+  ASSERT_EQ(Function->getScopeCount(), 1U);
+  EXPECT_EQ(Function->getScopes()[0]->getSymbolCount(), 1U);
+
+  // The rows of the four functions and the end of the sequence.
+  ASSERT_EQ(CU->getLines().size(), 13U);
+  EXPECT_EQ(CU->getLines()[11]->getLineNumber(), 18U);
+  EXPECT_TRUE(CU->getLines()[12]->getIsLineEndSequence());
+
+  // The same options give the same output.
+  std::string Output(readFile(Path));
+  ASSERT_TRUE(Generator.generate(Path, Error)) << Error;
+  EXPECT_EQ(readFile(Path), Output);
+}
+
+TEST(DwarfGenerator, UnwritableOutput) {
+  DwarfGenerator Generator((GeneratorOptions()));
+  std::string Error;
+  EXPECT_FALSE(Generator.generate(getTestOutputFilePath("missing/out.o"),
+                                  Error));
+  EXPECT_NE(Error.find("missing/out.o"), std::string::npos);
+}
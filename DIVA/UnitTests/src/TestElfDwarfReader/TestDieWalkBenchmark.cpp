@@ -0,0 +1,155 @@
+//===-- UnitTests/TestElfDwarfReader/TestDieWalkBenchmark.cpp ---*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Measures how many Dies per second the ways of walking a compile unit get
+/// through. The benchmark is disabled by default, run it with:
+///
+///   unittests --gtest_also_run_disabled_tests --gtest_filter=DieWalk*
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfGenerator.h"
+#include "FileUtilities.h"
+#include "LibDwarfHelpers.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// Visit every Die below Die with DwarfDieChildIterator, which creates a
+// libdwarf Die for each one.
+void walkWithIterator(const DwarfDie &Die, uint64_t &Count, uint64_t &Tags) {
+  for (auto IT = Die.childrenBegin(), End = Die.childrenEnd(); IT != End;
+       ++IT) {
+    ++Count;
+    Tags += IT->getTag();
+    walkWithIterator(*IT, Count, Tags);
+  }
+}
+
+// Visit every Die below the cursor with handles, which doesn't allocate.
+void walkWithHandles(DwarfDieCursor &Cursor, uint64_t &Count,
+                     uint64_t &Tags) {
+  unsigned Depth = Cursor.getDepth();
+  while (Cursor.nextChild(Depth)) {
+    ++Count;
+    Tags += Cursor.getHandle().getTag();
+    walkWithHandles(Cursor, Count, Tags);
+  }
+}
+
+// Visit every Die below the cursor, creating the libdwarf Die for each one
+// as DwarfReader does.
+void walkWithDies(DwarfDieCursor &Cursor, uint64_t &Count, uint64_t &Tags) {
+  unsigned Depth = Cursor.getDepth();
+  while (Cursor.nextChild(Depth)) {
+    ++Count;
+    Tags += Cursor.getDie().getTag();
+    walkWithDies(Cursor, Count, Tags);
+  }
+}
+
+// Run Walk, printing the Dies per second, and return the Dies visited.
+uint64_t measure(const std::string &Name,
+                 const std::function<void(uint64_t &, uint64_t &)> &Walk,
+                 uint64_t &Tags) {
+  uint64_t Count = 0U;
+  Tags = 0U;
+  auto Start = std::chrono::steady_clock::now();
+  Walk(Count, Tags);
+  std::chrono::duration<double> Seconds =
+      std::chrono::steady_clock::now() - Start;
+  std::cout << Name << ": " << Count << " Dies in " << Seconds.count()
+            << "s, " << static_cast<uint64_t>(Count / Seconds.count())
+            << " Dies/second\n";
+  return Count;
+}
+
+} // namespace
+
+TEST(DieWalkBenchmark, DISABLED_DiesPerSecond) {
+  // One compile unit with 250047 functions of 4 Dies each.
+  GeneratorOptions Options;
+  Options.CompileUnits = 1;
+  Options.Depth = 2;
+  Options.FanOut = 63;
+  Options.Templates = 0;
+  Options.LinesPerFunction = 0;
+  Options.StringSize = 0;
+  const std::string Path(getTestOutputFilePath("benchmark.o"));
+  DwarfGenerator Generator(Options);
+  std::string Error;
+  ASSERT_TRUE(Generator.generate(Path, Error)) << Error;
+
+  LibScopeView::FileDescriptor FD(Path);
+  LibScopeView::MappedFile File;
+  ASSERT_TRUE(File.open(Path));
+  DwarfDebugData DebugData(*FD);
+  DebugData.setFileData(File.data(), File.size());
+  auto CompileUnits = DebugData.getCompileUnits();
+  ASSERT_EQ(CompileUnits.size(), 1U);
+  const DwarfCompileUnit &CU = CompileUnits[0];
+
+  uint64_t IteratorTags, HandleTags, DieTags;
+  uint64_t IteratorCount = measure(
+      "DwarfDieChildIterator",
+      [&](uint64_t &Count, uint64_t &Tags) {
+        walkWithIterator(CU.CUDie, Count, Tags);
+      },
+      IteratorTags);
+  EXPECT_GE(IteratorCount, 1000000U);
+
+  DwarfDieCursor HandleCursor(DebugData, CU.CUDie, CU);
+  ASSERT_TRUE(HandleCursor.isDecoding());
+  uint64_t HandleCount = measure(
+      "DwarfDieCursor handles",
+      [&](uint64_t &Count, uint64_t &Tags) {
+        walkWithHandles(HandleCursor, Count, Tags);
+      },
+      HandleTags);
+  EXPECT_EQ(HandleCount, IteratorCount);
+  EXPECT_EQ(HandleTags, IteratorTags);
+
+  DwarfDieCursor DieCursor(DebugData, CU.CUDie, CU);
+  uint64_t DieCount = measure(
+      "DwarfDieCursor Dies",
+      [&](uint64_t &Count, uint64_t &Tags) {
+        walkWithDies(DieCursor, Count, Tags);
+      },
+      DieTags);
+  EXPECT_EQ(DieCount, IteratorCount);
+  EXPECT_EQ(DieTags, IteratorTags);
+
+  // The generated object is tens of megabytes, so don't leave it behind.
+  File.close();
+  clearTestOutputFile("benchmark.o");
+}
@@ -30,6 +30,9 @@
 #include "ElfDwarfReader.h"
 #include "FileUtilities.h"
 #include "Line.h"
+#include "ScopeBinaryPrinter.h"
+#include "ScopeTreeView.h"
+#include "ScopeYAMLPrinter.h"
 #include "Symbol.h"
 #include "Type.h"
 #include "UtilsForTesting.h"
@@ -37,7 +40,12 @@
 #include "dwarf.h"
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
+#include <sstream>
 
 using namespace ElfDwarfReader;
 
@@ -88,6 +96,34 @@ std::string getSourceFileName(LibScopeView::Element *E, bool Format = true) {
   return E->getFileName(Format);
 }
 
+// Collect the objects in the tree under Obj as text.
+void getTreeAsText(LibScopeView::Object *Obj,
+                   const LibScopeView::PrintSettings &TextSettings,
+                   std::vector<std::string> &Text) {
+  Text.push_back(Obj->getAsText(TextSettings));
+  if (auto *Scp = dynamic_cast<LibScopeView::Scope *>(Obj)) {
+    for (LibScopeView::Object *Child : Scp->getChildren())
+      getTreeAsText(Child, TextSettings, Text);
+    for (LibScopeView::Line *Ln : Scp->getLines())
+      getTreeAsText(Ln, TextSettings, Text);
+  }
+}
+
+// Write a copy of TestFile to the test outputs with the byte at Offset of its
+// .debug_info section set to 0x7f, and return the path of the copy.
+std::string writeCorruptedTestFile(const std::string &TestFile,
+                                   size_t DebugInfoOffset, size_t Offset,
+                                   const std::string &OutputFile) {
+  std::ifstream In(getTestInputFilePath(TestFile), std::ios::binary);
+  std::string Data((std::istreambuf_iterator<char>(In)),
+                   std::istreambuf_iterator<char>());
+  EXPECT_LT(DebugInfoOffset + Offset, Data.size());
+  Data[DebugInfoOffset + Offset] = '\x7f';
+  std::string Path(getTestOutputFilePath(OutputFile));
+  std::ofstream(Path, std::ios::binary) << Data;
+  return Path;
+}
+
 // Test fixture providing helpers to load a Scope tree using the DwarfReader.
 class TestElfDwarfReader : public ::testing::Test {
 public:
@@ -973,3 +1009,591 @@ TEST_F(TestElfDwarfReader, ReadTypes) {
   EXPECT_STREQ(Volatile->getName(), "volatile int");
   EXPECT_EQ(Volatile->getType(), Base);
 }
+
+TEST_F(TestElfDwarfReader, ReadTypeUnits) {
+  // type_units.elf was built with -fdebug-types-section, so both CUs refer to
+  // struct S in a single .debug_types unit using DW_FORM_ref_sig8.
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile("ElfDwarfReader/type_units.elf", &Root));
+  ASSERT_TRUE(checkChildCount(Root, 3, 0, 0));
+
+  // Sorted by offset, the type unit (0x17 in .debug_types) is between the CUs.
+  auto CU1 = Root->getScopeAt(0);
+  auto TU = Root->getScopeAt(1);
+  auto CU2 = Root->getScopeAt(2);
+
+  EXPECT_EQ(CU1->getDieTag(), DW_TAG_compile_unit);
+  EXPECT_EQ(CU2->getDieTag(), DW_TAG_compile_unit);
+
+  // The type unit is read once, as a compile unit named after its signature.
+  EXPECT_TRUE(TU->getIsCompileUnit());
+  EXPECT_EQ(TU->getDieTag(), DW_TAG_type_unit);
+  EXPECT_EQ(TU->getDieOffset(), 0x17U);
+  EXPECT_STREQ(TU->getName(), "type_unit_0xd80743045e7f4103");
+  EXPECT_EQ(TU->getLineCount(), 0U);
+  ASSERT_EQ(TU->getScopeCount(), 1U);
+
+  auto Struct = TU->getScopeAt(0);
+  EXPECT_TRUE(Struct->getIsStructType());
+  EXPECT_EQ(Struct->getDieOffset(), 0x25U);
+  EXPECT_STREQ(Struct->getName(), "S");
+  EXPECT_EQ(getSourceFileName(Struct), "type_units1.cpp");
+  EXPECT_TRUE(Struct->getIsGlobalReference());
+
+  // Both CUs share the type from the type unit.
+  ASSERT_TRUE(checkChildCount(CU1, 0, 2, 1));
+  ASSERT_TRUE(checkChildCount(CU2, 0, 2, 1));
+  EXPECT_STREQ(CU1->getSymbolAt(0)->getName(), "Var1");
+  EXPECT_EQ(CU1->getSymbolAt(0)->getType(), Struct);
+  EXPECT_STREQ(CU2->getSymbolAt(0)->getName(), "Var2");
+  EXPECT_EQ(CU2->getSymbolAt(0)->getType(), Struct);
+}
+
+TEST_F(TestElfDwarfReader, ReadDedupTypes) {
+  // Both CUs in dedup_types.elf contain an identical definition of struct S.
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile("ElfDwarfReader/dedup_types.elf", &Root));
+  ASSERT_TRUE(checkChildCount(Root, 2, 0, 0));
+  EXPECT_EQ(Root->getScopeAt(0)->getScopeCount(), 2U);
+  EXPECT_EQ(Root->getScopeAt(1)->getScopeCount(), 2U);
+
+  // With --dedup-types the second CU uses the struct from the first.
+  LibScopeView::PrintSettings Settings;
+  Settings.DedupTypes = true;
+  ASSERT_TRUE(
+      loadRootFromTestFile("ElfDwarfReader/dedup_types.elf", &Root, Settings));
+  ASSERT_TRUE(checkChildCount(Root, 2, 0, 0));
+
+  auto CU1 = Root->getScopeAt(0);
+  auto CU2 = Root->getScopeAt(1);
+  ASSERT_EQ(CU1->getScopeCount(), 2U);
+  auto Struct = CU1->getScopeAt(0);
+  EXPECT_TRUE(Struct->getIsStructType());
+  EXPECT_STREQ(Struct->getName(), "S");
+  EXPECT_TRUE(Struct->getIsGlobalReference());
+  ASSERT_EQ(Struct->getScopeCount(), 1U);
+  auto Method = Struct->getScopeAt(0);
+
+  // Only the function is left in the second CU.
+  ASSERT_EQ(CU2->getScopeCount(), 1U);
+  EXPECT_TRUE(CU2->getScopeAt(0)->getIsFunction());
+  ASSERT_EQ(CU2->getSymbolCount(), 1U);
+  EXPECT_STREQ(CU2->getSymbolAt(0)->getName(), "Var2");
+  EXPECT_EQ(CU2->getSymbolAt(0)->getType(), Struct);
+
+  // The definition of S::get in the first CU still refers to its declaration.
+  auto Definition = dynamic_cast<LibScopeView::ScopeFunction *>(
+      CU1->getScopeAt(1));
+  ASSERT_NE(Definition, nullptr);
+  EXPECT_EQ(Definition->getReference(), Method);
+}
+
+TEST_F(TestElfDwarfReader, ReadDedupTypesMemberTypes) {
+  // Both CUs in dedup_member_types.elf define struct S at the same place, but
+  // its members are int in one and unsigned int in the other.
+  LibScopeView::PrintSettings Settings;
+  Settings.DedupTypes = true;
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile("ElfDwarfReader/dedup_member_types.elf",
+                                   &Root, Settings));
+  ASSERT_TRUE(checkChildCount(Root, 2, 0, 0));
+
+  // So each CU keeps its own S.
+  for (size_t i = 0; i < 2U; ++i) {
+    auto CU = Root->getScopeAt(i);
+    ASSERT_EQ(CU->getScopeCount(), 1U);
+    auto Struct = CU->getScopeAt(0);
+    EXPECT_STREQ(Struct->getName(), "S");
+    EXPECT_FALSE(Struct->getIsGlobalReference());
+    ASSERT_EQ(CU->getSymbolCount(), 1U);
+    EXPECT_EQ(CU->getSymbolAt(0)->getType(), Struct);
+  }
+  auto Member = Root->getScopeAt(1)->getScopeAt(0)->getSymbolAt(0);
+  EXPECT_STREQ(Member->getTypeName(), "unsigned int *");
+}
+
+TEST_F(TestElfDwarfReader, ReadInvalidDwarf) {
+  // Byte 0x3f of .debug_info in dedup_types.elf (at 0x188 in the file) is in
+  // the DW_AT_type of member S::A, which then refers past the end of the unit.
+  const std::string Path = writeCorruptedTestFile(
+      "ElfDwarfReader/dedup_types.elf", 0x188, 0x3f, "invalid_ref.elf");
+  for (bool Native : {false, true}) {
+    for (bool Lazy : {false, true}) {
+      LibScopeView::PrintSettings Settings;
+      Settings.NativeDwarf = Native;
+      Settings.LazyScopes = Lazy;
+      EXPECT_EXIT(
+          {
+            DwarfReader TheReader;
+            if (TheReader.loadFile(Path, Settings))
+              TheReader.getScopesRoot()->getScopeAt(0)->getChildren();
+          },
+          ::testing::ExitedWithCode(1), "ERR_INVALID_DWARF");
+    }
+  }
+  clearTestOutputFile("invalid_ref.elf");
+}
+
+TEST_F(TestElfDwarfReader, ReadMalformedUnit) {
+  // Byte 0x43 of .debug_info in dedup_types.elf is the abbreviation code of
+  // member S::B, which then has no abbreviation.
+  const std::string Path = writeCorruptedTestFile(
+      "ElfDwarfReader/dedup_types.elf", 0x188, 0x43, "malformed_unit.elf");
+  for (bool Native : {false, true}) {
+    for (bool Lazy : {false, true}) {
+      for (bool SummaryOnly : {false, true}) {
+        LibScopeView::PrintSettings Settings;
+        Settings.NativeDwarf = Native;
+        Settings.LazyScopes = Lazy;
+        Settings.SummaryOnly = SummaryOnly;
+        EXPECT_EXIT(
+            {
+              DwarfReader TheReader;
+              if (TheReader.loadFile(Path, Settings) && !SummaryOnly)
+                TheReader.getScopesRoot()->getScopeAt(0)->getChildren();
+            },
+            ::testing::ExitedWithCode(1), "ERR_INVALID_DWARF");
+      }
+    }
+  }
+  clearTestOutputFile("malformed_unit.elf");
+}
+
+// Get the cache file of an input with a build-id.
+std::string getBuildIDCacheFile(const std::string &CacheDir,
+                                const std::string &TestFile) {
+  std::string BuildID;
+  uint64_t Size = 0U;
+  int64_t ModifiedTime = 0;
+  EXPECT_TRUE(
+      LibScopeView::getElfBuildID(getTestInputFilePath(TestFile), BuildID));
+  EXPECT_TRUE(LibScopeView::getFileSizeAndTime(getTestInputFilePath(TestFile),
+                                               Size, ModifiedTime));
+  std::stringstream Stream;
+  Stream << CacheDir << "/buildid-" << BuildID << "-" << std::hex << Size
+         << "-" << ModifiedTime << ".divatree";
+  return Stream.str();
+}
+
+TEST_F(TestElfDwarfReader, ReadFromCache) {
+  const std::string CacheDir = getTestOutputFilePath("ScopeTreeCache");
+  const std::string TestFile = "ElfDwarfReader/structure.elf";
+  const std::string CacheFile = getBuildIDCacheFile(CacheDir, TestFile);
+  std::remove(CacheFile.c_str());
+
+  LibScopeView::PrintSettings TextSettings;
+  TextSettings.showAll();
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root));
+  std::vector<std::string> Expected;
+  getTreeAsText(Root, TextSettings, Expected);
+
+  // The first load creates the cache file, the second one reads it.
+  LibScopeView::PrintSettings Settings;
+  Settings.CacheDirectory = CacheDir;
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, Settings));
+  ASSERT_TRUE(LibScopeView::doesFileExist(CacheFile));
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, Settings));
+  std::vector<std::string> Cached;
+  getTreeAsText(Root, TextSettings, Cached);
+  EXPECT_EQ(Cached, Expected);
+  EXPECT_EQ(Root->getName(), getTestInputFilePath(TestFile));
+}
+
+TEST_F(TestElfDwarfReader, ReadFromCacheStripped) {
+  // structure_stripped.elf is structure.elf after strip -g, which keeps the
+  // build-id.
+  const std::string CacheDir = getTestOutputFilePath("ScopeTreeCacheStripped");
+  const std::string FullFile = "ElfDwarfReader/structure.elf";
+  const std::string StrippedFile = "ElfDwarfReader/structure_stripped.elf";
+  const std::string FullCache = getBuildIDCacheFile(CacheDir, FullFile);
+  const std::string StrippedCache = getBuildIDCacheFile(CacheDir, StrippedFile);
+  EXPECT_NE(FullCache, StrippedCache);
+  std::remove(FullCache.c_str());
+
+  // The tree of the stripped file has no units, so it isn't cached, and
+  // neither file is read from the cache of the other.
+  LibScopeView::PrintSettings Settings;
+  Settings.CacheDirectory = CacheDir;
+  LibScopeView::Scope *Root = nullptr;
+  for (int Pass = 0; Pass < 2; ++Pass) {
+    ASSERT_TRUE(loadRootFromTestFile(StrippedFile, &Root, Settings));
+    EXPECT_EQ(Root->getScopeCount(), 0U);
+    EXPECT_FALSE(LibScopeView::doesFileExist(StrippedCache));
+    ASSERT_TRUE(loadRootFromTestFile(FullFile, &Root, Settings));
+    EXPECT_GT(Root->getScopeCount(), 0U);
+    EXPECT_TRUE(LibScopeView::doesFileExist(FullCache));
+  }
+}
+
+TEST_F(TestElfDwarfReader, NativeDwarfMatchesLibDwarf) {
+  // Every input of the examples and system tests, except corrupted.o and
+  // not_an_elf.elf which stop DIVA before any Dies are read.
+  static const char *const TestFiles[] = {
+      "Examples/broken.o",
+      "Examples/example_01.o",
+      "Examples/example_02.o",
+      "Examples/example_03.o",
+      "Examples/example_04.o",
+      "Examples/example_05.o",
+      "Examples/example_06.o",
+      "Examples/example_07.o",
+      "Examples/example_08.o",
+      "Examples/example_09.o",
+      "Examples/example_10.elf",
+      "Examples/example_11.o",
+      "Examples/example_12.o",
+      "Examples/example_13.o",
+      "Examples/example_14.o",
+      "Examples/example_15.o",
+      "Examples/example_16.elf",
+      "Examples/example_16_lto.elf",
+      "Examples/fixed.o",
+      "Examples/good.o",
+      "Examples/helloworld.o",
+      "Examples/helloworld_O0.o",
+      "Examples/helloworld_O2.o",
+      "Examples/scopes_mod.o",
+      "Examples/scopes_org.o",
+      "SystemTests/FeatureTests/all_objects.o",
+      "SystemTests/FeatureTests/simple.o",
+      "SystemTests/FeatureTests/unknown_tag.o",
+      "SystemTests/RegressionTests/input.o",
+      "SystemTests/RegressionTests/repro17.o",
+      "SystemTests/RegressionTests/repro7.o",
+      "SystemTests/RegressionTests/repro8.o",
+      "SystemTests/SpecTests/alias.o",
+      "SystemTests/SpecTests/block.o",
+      "SystemTests/SpecTests/class.o",
+      "SystemTests/SpecTests/codeline.o",
+      "SystemTests/SpecTests/compile_unit.o",
+      "SystemTests/SpecTests/enum.o",
+      "SystemTests/SpecTests/function.o",
+      "SystemTests/SpecTests/member.o",
+      "SystemTests/SpecTests/namespace.o",
+      "SystemTests/SpecTests/parameter.o",
+      "SystemTests/SpecTests/primitive_type.o",
+      "SystemTests/SpecTests/struct.o",
+      "SystemTests/SpecTests/template.o",
+      "SystemTests/SpecTests/template_parameter.o",
+      "SystemTests/SpecTests/union.o",
+      "SystemTests/SpecTests/using.o",
+      "SystemTests/SpecTests/variable.o",
+      "SystemTests/StabilityTests/Hello World.o",
+      "SystemTests/StabilityTests/Hello!+$987World.o",
+      "SystemTests/StabilityTests/HelloWorld.o",
+      "SystemTests/StabilityTests/nodebug.o",
+  };
+
+  LibScopeView::PrintSettings TextSettings;
+  TextSettings.showAll();
+  TextSettings.ShowDWARFOffset = true;
+  TextSettings.ShowDWARFParent = true;
+  TextSettings.ShowDWARFTag = true;
+  LibScopeView::PrintSettings NativeSettings;
+  NativeSettings.NativeDwarf = true;
+  for (const char *TestFile : TestFiles) {
+    SCOPED_TRACE(TestFile);
+    // The inputs are relative to the DIVA directory.
+    const std::string Path = std::string("../../") + TestFile;
+    LibScopeView::Scope *Root = nullptr;
+    ASSERT_TRUE(loadRootFromTestFile(Path, &Root));
+    std::vector<std::string> Expected;
+    getTreeAsText(Root, TextSettings, Expected);
+
+    ASSERT_TRUE(loadRootFromTestFile(Path, &Root, NativeSettings));
+    std::vector<std::string> Native;
+    getTreeAsText(Root, TextSettings, Native);
+    EXPECT_EQ(Native, Expected);
+  }
+}
+
+TEST_F(TestElfDwarfReader, SummaryOnlyMatchesTree) {
+  static const char *const TestFiles[] = {
+      "ElfDwarfReader/aggregate.o",
+      "ElfDwarfReader/block.o",
+      "ElfDwarfReader/dedup_types.elf",
+      "ElfDwarfReader/function_static_inline.o",
+      "ElfDwarfReader/import.o",
+      "ElfDwarfReader/lines.o",
+      "ElfDwarfReader/lto_cross_cu.elf",
+      "ElfDwarfReader/structure.elf",
+      "ElfDwarfReader/template.o",
+      "ElfDwarfReader/type_units.elf",
+      "../../Examples/example_16_lto.elf",
+      "../../SystemTests/FeatureTests/all_objects.o",
+      "../../SystemTests/FeatureTests/unknown_tag.o",
+  };
+
+  LibScopeView::PrintSettings CountSettings;
+  CountSettings.SummaryOnly = true;
+  for (const char *TestFile : TestFiles) {
+    SCOPED_TRACE(TestFile);
+    LibScopeView::Scope *Root = nullptr;
+    ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root));
+    std::ostringstream Expected;
+    getReader().getSummaryTable().getPrintedSummaryTable(Expected);
+
+    // Only the root is created.
+    ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, CountSettings));
+    EXPECT_TRUE(Root->getChildren().empty());
+    EXPECT_EQ(Root->getName(), getTestInputFilePath(TestFile));
+    std::ostringstream Counted;
+    getReader().getSummaryTable().getPrintedSummaryTable(Counted);
+    EXPECT_EQ(Counted.str(), Expected.str());
+  }
+}
+
+TEST_F(TestElfDwarfReader, SelectedCompileUnits) {
+  // structure.elf has 3 compile units, structure1.cpp to structure3.cpp.
+  const std::string TestFile = "ElfDwarfReader/structure.elf";
+  LibScopeView::PrintSettings TextSettings;
+  TextSettings.showAll();
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root));
+  ASSERT_EQ(Root->getScopeCount(), 3U);
+  std::vector<std::vector<std::string>> Expected(3U);
+  for (size_t Index = 0U; Index < 3U; ++Index)
+    getTreeAsText(Root->getScopeAt(Index), TextSettings, Expected[Index]);
+
+  // The units are the same as when all of them are read.
+  LibScopeView::PrintSettings Settings;
+  Settings.CompileUnitFilterAnys = {"structure2"};
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, Settings));
+  ASSERT_EQ(Root->getScopeCount(), 1U);
+  std::vector<std::string> Text;
+  getTreeAsText(Root->getScopeAt(0), TextSettings, Text);
+  EXPECT_EQ(Text, Expected[1]);
+
+  Settings.CompileUnitFilterAnys.clear();
+  Settings.CompileUnitFilters = {std::regex("structure[13]\\.cpp")};
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, Settings));
+  ASSERT_EQ(Root->getScopeCount(), 2U);
+  Text.clear();
+  getTreeAsText(Root->getScopeAt(0), TextSettings, Text);
+  EXPECT_EQ(Text, Expected[0]);
+  Text.clear();
+  getTreeAsText(Root->getScopeAt(1), TextSettings, Text);
+  EXPECT_EQ(Text, Expected[2]);
+
+  // The regular expressions must match the whole name.
+  Settings.CompileUnitFilters = {std::regex("structure")};
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, Settings));
+  EXPECT_EQ(Root->getScopeCount(), 0U);
+}
+
+TEST_F(TestElfDwarfReader, LazyScopes) {
+  // structure.elf has 3 compile units, structure1.cpp to structure3.cpp.
+  const std::string TestFile = "ElfDwarfReader/structure.elf";
+  LibScopeView::PrintSettings TextSettings;
+  TextSettings.showAll();
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root));
+  std::vector<std::string> Expected;
+  getTreeAsText(Root, TextSettings, Expected);
+
+  // Only the unit Dies are read until the children are requested.
+  LibScopeView::PrintSettings Settings;
+  Settings.LazyScopes = true;
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, Settings));
+  ASSERT_EQ(Root->getScopeCount(), 3U);
+  for (LibScopeView::Scope *CU : Root->getScopes())
+    EXPECT_TRUE(CU->getHasLazyChildren());
+  // int and main.
+  EXPECT_EQ(Root->getScopeAt(0)->getLazyChildCount(), 2U);
+  EXPECT_EQ(Root->getScopeAt(0)->getName(), std::string("structure1.cpp"));
+
+  LibScopeView::Scope *CU2 = Root->getScopeAt(1);
+  EXPECT_EQ(CU2->getScopeCount(), 1U);
+  EXPECT_FALSE(CU2->getHasLazyChildren());
+  EXPECT_EQ(CU2->getLazyChildCount(), 0U);
+  EXPECT_TRUE(Root->getScopeAt(0)->getHasLazyChildren());
+  EXPECT_TRUE(Root->getScopeAt(2)->getHasLazyChildren());
+
+  // The tree is the same as when all of it is read at once.
+  std::vector<std::string> Text;
+  getTreeAsText(Root, TextSettings, Text);
+  EXPECT_EQ(Text, Expected);
+  for (LibScopeView::Scope *CU : Root->getScopes())
+    EXPECT_FALSE(CU->getHasLazyChildren());
+
+  // The filters need the whole tree.
+  Settings.FilterAnys = {"main"};
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root, Settings));
+  for (LibScopeView::Scope *CU : Root->getScopes())
+    EXPECT_FALSE(CU->getHasLazyChildren());
+
+  // The compile units of LTO refer to each other (DW_FORM_ref_addr).
+  Settings.FilterAnys.clear();
+  ASSERT_TRUE(
+      loadRootFromTestFile("ElfDwarfReader/lto_cross_cu.elf", &Root, Settings));
+  ASSERT_FALSE(Root->getScopes().empty());
+  for (LibScopeView::Scope *CU : Root->getScopes())
+    EXPECT_FALSE(CU->getHasLazyChildren());
+}
+
+TEST_F(TestElfDwarfReader, BinaryOutputMatchesYAML) {
+  const std::string TestFile = "ElfDwarfReader/structure.elf";
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root));
+  auto *TheRoot = static_cast<LibScopeView::ScopeRoot *>(Root);
+
+  // The common part of each object in the YAML output.
+  std::ostringstream YAML;
+  LibScopeView::ScopeYAMLPrinter("input", "0.1").print(TheRoot, YAML);
+  std::vector<std::string> Expected;
+  std::istringstream YAMLLines(YAML.str());
+  for (std::string Line; std::getline(YAMLLines, Line);) {
+    size_t Start = Line.find("- object: ");
+    if (Start == std::string::npos)
+      continue;
+    std::string Common = Line.substr(Start + 2) + '\n';
+    for (int I = 0; I < 8 && std::getline(YAMLLines, Line); ++I)
+      Common += Line.substr(Start + 2) + '\n';
+    Expected.push_back(Common);
+  }
+  ASSERT_FALSE(Expected.empty());
+
+  // The same fields read from the binary output.
+  std::ostringstream Binary;
+  LibScopeView::ScopeBinaryPrinter("input").print(TheRoot, Binary);
+  const std::string Data = Binary.str();
+  LibScopeView::ScopeTreeView View;
+  ASSERT_TRUE(View.open(Data.data(), Data.size()));
+  EXPECT_STREQ(View.getKey(), "input");
+
+  auto quoted = [](const std::string &Str) {
+    return Str.empty() ? std::string("null") : '"' + Str + '"';
+  };
+  std::vector<std::string> Actual;
+  for (uint32_t I = 0; I < View.getObjectCount(); ++I) {
+    LibScopeView::ScopeTreeView::ObjectView Obj = View.getObject(I);
+    if (!Obj.isPrintedAsObject())
+      continue;
+    std::ostringstream Common;
+    Common << "object: \"" << Obj.getKind() << "\"\n"
+           << "name: " << quoted(Obj.getFullName()) << '\n'
+           << "type: " << quoted(Obj.getTypeName()) << '\n' << "source:\n"
+           << "  line: ";
+    if (Obj.getLineNumber() != 0)
+      Common << Obj.getLineNumber() << '\n';
+    else
+      Common << "null\n";
+    Common << "  file: "
+           << quoted(LibScopeView::getFileName(Obj.getFileName())) << '\n'
+           << "dwarf:\n"
+           << "  offset: 0x" << std::hex << Obj.getDieOffset() << '\n'
+           << "  tag: ";
+    const char *TagName = nullptr;
+    if (Obj.getDieTag() != 0 &&
+        dwarf_get_TAG_name(Obj.getDieTag(), &TagName) == DW_DLV_OK)
+      Common << '"' << TagName << "\"\n";
+    else
+      Common << "null\n";
+    Actual.push_back(Common.str());
+  }
+  EXPECT_EQ(Actual, Expected);
+}
+
+TEST_F(TestElfDwarfReader, ReadAddressRanges) {
+  typedef std::vector<std::pair<Dwarf_Addr, Dwarf_Addr>> RangeList;
+  auto ExpectRanges = [](const LibScopeView::Scope *Scp, RangeList Ranges) {
+    RangeList Read;
+    for (const LibScopeView::AddressRange &Range : Scp->getAddressRanges())
+      Read.emplace_back(Range.Low, Range.High);
+    EXPECT_EQ(Read, Ranges) << Scp->getName();
+  };
+
+  // DW_AT_low_pc with a DW_AT_high_pc offset.
+  LibScopeView::Scope *CU = nullptr;
+  ASSERT_TRUE(
+      loadSingleCUFromTestFile("ElfDwarfReader/function_static_inline.o", &CU));
+  ExpectRanges(CU, {{0x0, 0x38}});
+  auto *Other = CU->getScopeAt(4);
+  ASSERT_STREQ(Other->getName(), "other");
+  ExpectRanges(Other, {{0x18, 0x38}});
+  auto *Block = Other->getScopeAt(0);
+  ExpectRanges(Block, {{0x23, 0x36}});
+  auto *Inlined = Block->getScopeAt(0);
+  ASSERT_TRUE(Inlined->getIsInlined());
+  ExpectRanges(Inlined, {{0x23, 0x26}});
+  // Only the scopes with code have ranges.
+  ExpectRanges(CU->getScopeAt(0), {});
+
+  const LibScopeView::AddressIndex &Index = getReader().getAddressIndex();
+  LibScopeView::AddressIndex::Location Loc = Index.find(0x24);
+  EXPECT_EQ(Loc.Innermost, Inlined);
+  ASSERT_NE(Loc.Row, nullptr);
+  EXPECT_EQ(Loc.Row->getLineNumber(), 5U);
+  EXPECT_EQ(Index.find(0x2a).Innermost, Block);
+  EXPECT_EQ(Index.find(0x38).Innermost, nullptr);
+
+  // DW_AT_ranges.
+  ASSERT_TRUE(loadSingleCUFromTestFile("ElfDwarfReader/members.o", &CU));
+  ExpectRanges(CU, {{0x0, 0x1a}, {0x0, 0x29}});
+}
+
+TEST_F(TestElfDwarfReader, FindObjects) {
+  for (const char *TestFile :
+       {"ElfDwarfReader/structure.elf", "ElfDwarfReader/dedup_types.elf",
+        "ElfDwarfReader/qualified_name.o"}) {
+    LibScopeView::Scope *Root = nullptr;
+    ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root));
+
+    // The objects of each qualified name, in tree order.
+    std::map<std::string, std::vector<LibScopeView::Object *>> Expected;
+    std::function<void(LibScopeView::Object *)> Collect =
+        [&](LibScopeView::Object *Obj) {
+          if (Obj->isNamed())
+            Expected[std::string(Obj->getQualifiedName()) + Obj->getName()]
+                .push_back(Obj);
+          if (!Obj->getIsScope())
+            return;
+          auto *Scp = static_cast<LibScopeView::Scope *>(Obj);
+          for (LibScopeView::Object *Child : Scp->getChildren())
+            Collect(Child);
+          for (LibScopeView::Object *Ln : Scp->getLines())
+            Collect(Ln);
+        };
+    for (LibScopeView::Object *Child : Root->getChildren())
+      Collect(Child);
+    ASSERT_FALSE(Expected.empty());
+
+    for (const auto &Objects : Expected)
+      EXPECT_EQ(getReader().findObjects(Objects.first), Objects.second)
+          << TestFile << ": " << Objects.first;
+    EXPECT_TRUE(getReader().findObjects("no::such::name").empty());
+  }
+}
+
+TEST_F(TestElfDwarfReader, ResolveAcrossUnits) {
+  // The objects of these files refer to objects in other units, so they are
+  // resolved after those units.
+  for (const char *TestFile :
+       {"ElfDwarfReader/lto_cross_cu.elf", "ElfDwarfReader/type_units.elf"}) {
+    LibScopeView::Scope *Root = nullptr;
+    ASSERT_TRUE(loadRootFromTestFile(TestFile, &Root));
+
+    std::function<void(LibScopeView::Object *)> Check =
+        [&](LibScopeView::Object *Obj) {
+          EXPECT_TRUE(Obj->getIsResolved() && Obj->getIsNameResolved() &&
+                      Obj->getIsReferenceResolved())
+              << TestFile << ": " << std::hex << Obj->getDieOffset();
+          if (!Obj->getIsScope())
+            return;
+          auto *Scp = static_cast<LibScopeView::Scope *>(Obj);
+          for (LibScopeView::Object *Child : Scp->getChildren())
+            Check(Child);
+          for (LibScopeView::Object *Ln : Scp->getLines())
+            Check(Ln);
+        };
+    Check(Root);
+
+    std::vector<std::string> Passes;
+    for (const auto &PassTime : getReader().getPassTimes()) {
+      Passes.push_back(PassTime.first);
+      EXPECT_GE(PassTime.second, 0.0);
+    }
+    EXPECT_EQ(Passes, std::vector<std::string>({"create", "resolve", "sort"}));
+  }
+}
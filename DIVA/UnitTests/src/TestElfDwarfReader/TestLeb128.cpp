@@ -0,0 +1,281 @@
+//===-- UnitTests/TestElfDwarfReader/TestLeb128.cpp -------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the LEB128 functions, and a benchmark of them over the
+/// abbreviation tables of the test inputs, which are all LEB128 numbers. The
+/// benchmark is disabled by default, run it with:
+///
+///   unittests --gtest_also_run_disabled_tests --gtest_filter=Leb128*
+///
+//===----------------------------------------------------------------------===//
+
+#include "FileUtilities.h"
+#include "Leb128.h"
+#include "LibDwarfHelpers.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+std::vector<uint8_t> encodeULEB128(uint64_t Value) {
+  std::vector<uint8_t> Bytes;
+  do {
+    uint8_t Byte = Value & 0x7fU;
+    Value >>= 7U;
+    Bytes.push_back(Value != 0U ? Byte | 0x80U : Byte);
+  } while (Value != 0U);
+  return Bytes;
+}
+
+std::vector<uint8_t> encodeSLEB128(int64_t Value) {
+  std::vector<uint8_t> Bytes;
+  for (;;) {
+    uint8_t Byte = Value & 0x7f;
+    // Shifting a negative number is implementation defined, so divide.
+    Value = (Value - (Value & 0x7f)) / 128;
+    bool Done = (Value == 0 && (Byte & 0x40) == 0) ||
+                (Value == -1 && (Byte & 0x40) != 0);
+    Bytes.push_back(Done ? Byte : Byte | 0x80U);
+    if (Done)
+      return Bytes;
+  }
+}
+
+// Numbers around the boundaries of each encoded length.
+std::vector<uint64_t> getUnsignedValues() {
+  std::vector<uint64_t> Values;
+  for (unsigned Bits = 0U; Bits <= 63U; Bits += 7U) {
+    uint64_t Boundary = static_cast<uint64_t>(1U) << Bits;
+    Values.push_back(Boundary - 1U);
+    Values.push_back(Boundary);
+    Values.push_back(Boundary + 1U);
+  }
+  Values.push_back(std::numeric_limits<uint64_t>::max());
+  return Values;
+}
+
+std::vector<int64_t> getSignedValues() {
+  std::vector<int64_t> Values;
+  for (unsigned Bits = 6U; Bits <= 62U; Bits += 7U) {
+    int64_t Boundary = static_cast<int64_t>(1) << Bits;
+    for (int64_t Value : {Boundary - 1, Boundary, -Boundary, -Boundary - 1})
+      Values.push_back(Value);
+  }
+  Values.push_back(0);
+  Values.push_back(std::numeric_limits<int64_t>::max());
+  Values.push_back(std::numeric_limits<int64_t>::min());
+  return Values;
+}
+
+// Concatenate the encodings of Values, and record where each one ends.
+std::vector<uint8_t> encodeAll(const std::vector<uint64_t> &Values,
+                               std::vector<size_t> &Ends) {
+  std::vector<uint8_t> Bytes;
+  for (uint64_t Value : Values) {
+    std::vector<uint8_t> Encoded = encodeULEB128(Value);
+    Bytes.insert(Bytes.end(), Encoded.begin(), Encoded.end());
+    Ends.push_back(Bytes.size());
+  }
+  return Bytes;
+}
+
+// Run Decode over Bytes, printing the numbers per second, and return the
+// numbers decoded.
+uint64_t measure(const std::string &Name, const std::vector<uint8_t> &Bytes,
+                 const std::function<uint64_t(const uint8_t *,
+                                              const uint8_t *)> &Decode) {
+  auto Start = std::chrono::steady_clock::now();
+  uint64_t Count = Decode(Bytes.data(), Bytes.data() + Bytes.size());
+  std::chrono::duration<double> Seconds =
+      std::chrono::steady_clock::now() - Start;
+  std::cout << Name << ": " << Count << " numbers in " << Seconds.count()
+            << "s, " << static_cast<uint64_t>(Count / Seconds.count())
+            << " numbers/second\n";
+  return Count;
+}
+
+} // namespace
+
+TEST(Leb128, ReadULEB128) {
+  for (uint64_t Expected : getUnsignedValues()) {
+    std::vector<uint8_t> Bytes = encodeULEB128(Expected);
+    // Read it both at the end of the data and with bytes after it, which
+    // take different paths.
+    for (size_t Padding : {0U, 1U, 8U}) {
+      std::vector<uint8_t> Data(Bytes);
+      Data.resize(Bytes.size() + Padding, 0xffU);
+      const uint8_t *Pos = Data.data();
+      uint64_t Value = 0U;
+      EXPECT_TRUE(readULEB128(Pos, Data.data() + Data.size(), Value));
+      EXPECT_EQ(Value, Expected);
+      EXPECT_EQ(Pos, Data.data() + Bytes.size());
+    }
+  }
+}
+
+TEST(Leb128, ReadSLEB128) {
+  for (int64_t Expected : getSignedValues()) {
+    std::vector<uint8_t> Bytes = encodeSLEB128(Expected);
+    for (size_t Padding : {0U, 1U, 8U}) {
+      std::vector<uint8_t> Data(Bytes);
+      Data.resize(Bytes.size() + Padding, 0xffU);
+      const uint8_t *Pos = Data.data();
+      Dwarf_Signed Value = 0;
+      EXPECT_TRUE(readSLEB128(Pos, Data.data() + Data.size(), Value));
+      EXPECT_EQ(Value, Expected);
+      EXPECT_EQ(Pos, Data.data() + Bytes.size());
+    }
+  }
+}
+
+TEST(Leb128, Truncated) {
+  // Numbers that don't end before the end of the data.
+  const uint8_t Data[] = {0x80U, 0x81U, 0xffU, 0x80U, 0x80U, 0x80U,
+                          0x80U, 0x80U, 0x80U, 0x80U, 0x80U};
+  for (size_t Size = 0U; Size <= sizeof(Data); ++Size) {
+    const uint8_t *Pos = Data;
+    uint64_t Unsigned;
+    EXPECT_FALSE(readULEB128(Pos, Data + Size, Unsigned));
+    Pos = Data;
+    Dwarf_Signed Signed;
+    EXPECT_FALSE(readSLEB128(Pos, Data + Size, Signed));
+    Pos = Data;
+    EXPECT_FALSE(skipLEB128(Pos, Data + Size));
+    Pos = Data;
+    EXPECT_FALSE(skipLEB128s(Pos, Data + Size, 1U));
+  }
+}
+
+TEST(Leb128, SkipLEB128) {
+  std::vector<size_t> Ends;
+  std::vector<uint8_t> Bytes = encodeAll(getUnsignedValues(), Ends);
+  const uint8_t *End = Bytes.data() + Bytes.size();
+
+  // Skip each number from the start.
+  const uint8_t *Pos = Bytes.data();
+  for (size_t NumberEnd : Ends) {
+    EXPECT_TRUE(skipLEB128(Pos, End));
+    EXPECT_EQ(Pos, Bytes.data() + NumberEnd);
+  }
+  EXPECT_FALSE(skipLEB128(Pos, End));
+
+  // Skip every number of numbers from every number.
+  for (size_t First = 0U; First <= Ends.size(); ++First) {
+    const uint8_t *Start = Bytes.data() + (First ? Ends[First - 1U] : 0U);
+    for (size_t Count = 0U; First + Count <= Ends.size(); ++Count) {
+      Pos = Start;
+      EXPECT_TRUE(skipLEB128s(Pos, End, Count));
+      EXPECT_EQ(Pos, Count ? Bytes.data() + Ends[First + Count - 1U] : Start);
+    }
+    Pos = Start;
+    EXPECT_FALSE(skipLEB128s(Pos, End, Ends.size() - First + 1U));
+  }
+}
+
+TEST(Leb128, DISABLED_NumbersPerSecond) {
+  // Fill a buffer with copies of the abbreviation tables of the inputs.
+  std::vector<uint8_t> Abbrevs;
+  for (const char *Name : {"aggregate.o", "function.o", "inheritance.o",
+                           "members.o", "template.o", "type_units.elf"}) {
+    std::string Path(getTestInputFilePath(std::string("ElfDwarfReader/") +
+                                          Name));
+    LibScopeView::FileDescriptor FD(Path);
+    LibScopeView::MappedFile File;
+    ASSERT_TRUE(File.open(Path));
+    DwarfDebugData DebugData(*FD);
+    DebugData.setFileData(File.data(), File.size());
+    const DwarfSectionData &Section = DebugData.getAbbrevSection();
+    Abbrevs.insert(Abbrevs.end(), Section.Data, Section.Data + Section.Size);
+  }
+  ASSERT_FALSE(Abbrevs.empty());
+  std::vector<uint8_t> Bytes;
+  while (Bytes.size() < 64U * 1024U * 1024U)
+    Bytes.insert(Bytes.end(), Abbrevs.begin(), Abbrevs.end());
+
+  uint64_t LoopSum = 0U;
+  uint64_t LoopCount = measure(
+      "Loop", Bytes, [&](const uint8_t *Pos, const uint8_t *End) {
+        uint64_t Count = 0U;
+        uint64_t Sum = 0U;
+        while (Pos != End) {
+          uint64_t Value = 0U;
+          for (unsigned Shift = 0; Pos != End; Shift += 7) {
+            uint8_t Byte = *Pos++;
+            Value |= static_cast<uint64_t>(Byte & 0x7f) << (Shift & 63U);
+            if ((Byte & 0x80) == 0)
+              break;
+          }
+          Sum += Value;
+          ++Count;
+        }
+        LoopSum = Sum;
+        return Count;
+      });
+
+  uint64_t ReadSum = 0U;
+  uint64_t ReadCount = measure(
+      "readULEB128", Bytes, [&](const uint8_t *Pos, const uint8_t *End) {
+        uint64_t Count = 0U;
+        uint64_t Sum = 0U;
+        uint64_t Value;
+        while (readULEB128(Pos, End, Value)) {
+          Sum += Value;
+          ++Count;
+        }
+        ReadSum = Sum;
+        return Count;
+      });
+  EXPECT_EQ(ReadCount, LoopCount);
+  EXPECT_EQ(ReadSum, LoopSum);
+
+  uint64_t SkipCount = measure(
+      "skipLEB128", Bytes, [](const uint8_t *Pos, const uint8_t *End) {
+        uint64_t Count = 0U;
+        while (skipLEB128(Pos, End))
+          ++Count;
+        return Count;
+      });
+  EXPECT_EQ(SkipCount, LoopCount);
+
+  // Skip runs of 4, as for the LEB128 values of a Die.
+  uint64_t RunCount = measure(
+      "skipLEB128s", Bytes, [](const uint8_t *Pos, const uint8_t *End) {
+        uint64_t Count = 0U;
+        for (const uint8_t *Run = Pos; skipLEB128s(Run, End, 4U); Pos = Run)
+          Count += 4U;
+        while (skipLEB128(Pos, End))
+          ++Count;
+        return Count;
+      });
+  EXPECT_EQ(RunCount, LoopCount);
+}
@@ -27,12 +27,15 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "DwarfGenerator.h"
 #include "FileUtilities.h"
 #include "LibDwarfHelpers.h"
 #include "UtilsForTesting.h"
 
 #include "gtest/gtest.h"
 
+#include <sstream>
+
 using namespace ElfDwarfReader;
 
 // IMPORTANT.
@@ -163,6 +166,80 @@ TEST_F(LibDwarfHelpers, DwarfDie) {
             DwarfAttrValueKind::Empty);
 }
 
+TEST(DwarfHelpers, SelectedCompileUnits) {
+  // structure.elf has 3 compile units, structure1.cpp to structure3.cpp.
+  std::string TestElfPath =
+      getTestInputFilePath("ElfDwarfReader/structure.elf");
+  ASSERT_TRUE(LibScopeView::doesFileExist(TestElfPath));
+  LibScopeView::FileDescriptor FD(TestElfPath);
+  ASSERT_GT(*FD, 0);
+
+  DwarfDebugData DebugData(*FD);
+  auto AllUnits = DebugData.getCompileUnits();
+  ASSERT_EQ(AllUnits.size(), 3U);
+
+  // Each unit is offered by its name and compilation directory.
+  std::vector<std::string> Names;
+  auto Selected = DebugData.getCompileUnits(
+      [&](const std::string &Name, const std::string &CompDir) {
+        Names.push_back(Name);
+        EXPECT_FALSE(CompDir.empty());
+        return Name == "structure2.cpp";
+      });
+  EXPECT_EQ(Names, std::vector<std::string>(
+                       {"structure1.cpp", "structure2.cpp", "structure3.cpp"}));
+  ASSERT_EQ(Selected.size(), 1U);
+  EXPECT_EQ(Selected[0].CUDie.getName(), "structure2.cpp");
+  EXPECT_EQ(Selected[0].HeaderOffset, AllUnits[1].HeaderOffset);
+  EXPECT_EQ(Selected[0].NextHeaderOffset, AllUnits[1].NextHeaderOffset);
+  EXPECT_EQ(Selected[0].CUDie.getGlobalOffset(),
+            AllUnits[1].CUDie.getGlobalOffset());
+
+  EXPECT_TRUE(DebugData
+                  .getCompileUnits([](const std::string &,
+                                      const std::string &) { return false; })
+                  .empty());
+}
+
+TEST(DwarfHelpers, TypeUnits) {
+  // type_units.elf has 2 compile units that reference 1 type unit.
+  std::string TestElfPath =
+      getTestInputFilePath("ElfDwarfReader/type_units.elf");
+  ASSERT_TRUE(LibScopeView::doesFileExist(TestElfPath));
+  LibScopeView::FileDescriptor FD(TestElfPath);
+  ASSERT_GT(*FD, 0);
+
+  DwarfDebugData DebugData(*FD);
+  EXPECT_EQ(DebugData.getCompileUnits().size(), 2U);
+
+  auto TypeUnits = DebugData.getTypeUnits();
+  ASSERT_EQ(TypeUnits.size(), 1U);
+  EXPECT_EQ(TypeUnits[0].TUDie.getTag(), DW_TAG_type_unit);
+  EXPECT_FALSE(TypeUnits[0].TUDie.isInfo());
+  EXPECT_EQ(TypeUnits[0].Signature, 0xd80743045e7f4103U);
+  EXPECT_EQ(TypeUnits[0].HeaderOffset, 0U);
+  EXPECT_EQ(TypeUnits[0].TypeOffset, 0x25U);
+
+  // The type unit children are read from .debug_types.
+  auto IT = TypeUnits[0].TUDie.childrenBegin();
+  ASSERT_FALSE(IT.atEnd());
+  EXPECT_EQ(IT->getGlobalOffset(), 0x25U);
+  EXPECT_EQ(IT->getName(), "S");
+  ++IT;
+  ASSERT_FALSE(IT.atEnd());
+  EXPECT_EQ(IT->getTag(), DW_TAG_base_type);
+
+  // DW_FORM_ref_sig8 references are read as signatures.
+  auto CUChild = DebugData.getCompileUnits()[0].CUDie.childrenBegin();
+  while (!CUChild.atEnd() && CUChild->getTag() != DW_TAG_variable)
+    ++CUChild;
+  ASSERT_FALSE(CUChild.atEnd());
+  DwarfAttrValue Sig(CUChild->getAttr(DW_AT_type));
+  ASSERT_EQ(Sig.getKind(), DwarfAttrValueKind::Signature);
+  EXPECT_EQ(Sig.getForm(), DW_FORM_ref_sig8);
+  EXPECT_EQ(Sig.getSignature(), 0xd80743045e7f4103U);
+}
+
 // Simple tree of dwarf tags for testing.
 struct TagTree {
   TagTree(Dwarf_Half Tag) : Tag(Tag) {}
@@ -241,6 +318,315 @@ TEST_F(LibDwarfHelpers, DwarfDieChildIterator) {
   EXPECT_EQ(CU3_Type.Tag, DW_TAG_base_type);
 }
 
+// Record the offset and depth of Die and its descendants in pre-order.
+void walkWithIterator(const DwarfDie &Die, unsigned Depth,
+                      std::vector<std::pair<Dwarf_Off, unsigned>> &Walk) {
+  Walk.emplace_back(Die.getGlobalOffset(), Depth);
+  for (auto IT = Die.childrenBegin(), End = Die.childrenEnd(); IT != End;
+       ++IT)
+    walkWithIterator(*IT, Depth + 1, Walk);
+}
+
+// Record the same as walkWithIterator, starting at the Die at the Cursor.
+void walkWithCursor(DwarfDieCursor &Cursor,
+                    std::vector<std::pair<Dwarf_Off, unsigned>> &Walk) {
+  Walk.emplace_back(Cursor.getOffset(), Cursor.getDepth());
+  unsigned Depth = Cursor.getDepth();
+  while (Cursor.nextChild(Depth))
+    walkWithCursor(Cursor, Walk);
+}
+
+TEST_F(LibDwarfHelpers, DwarfDieCursor) {
+  LibScopeView::MappedFile File;
+  ASSERT_TRUE(File.open(getTestInputFilePath("DwarfHelpers/test.elf")));
+  TestDebugData.setFileData(File.data(), File.size());
+
+  for (const auto &CU : TestDebugData.getCompileUnits()) {
+    std::vector<std::pair<Dwarf_Off, unsigned>> Expected;
+    walkWithIterator(CU.CUDie, 1U, Expected);
+
+    DwarfDieCursor Cursor(TestDebugData, CU.CUDie, CU);
+    EXPECT_TRUE(Cursor.isDecoding());
+    EXPECT_EQ(Cursor.getDie().getTag(), DW_TAG_compile_unit);
+    std::vector<std::pair<Dwarf_Off, unsigned>> Walk;
+    walkWithCursor(Cursor, Walk);
+    EXPECT_EQ(Walk, Expected);
+
+    // Each byte of the unit's Dies is decoded once.
+    EXPECT_EQ(Cursor.getBytesDecoded(),
+              CU.NextHeaderOffset - CU.CUDie.getGlobalOffset());
+    EXPECT_FALSE(Cursor.nextChild(0U));
+  }
+
+  // Visit the children of the first unit without their subtrees.
+  auto CompileUnits = TestDebugData.getCompileUnits();
+  ASSERT_FALSE(CompileUnits.empty());
+  DwarfDieCursor Cursor(TestDebugData, CompileUnits[0].CUDie, CompileUnits[0]);
+  std::vector<Dwarf_Half> Tags;
+  while (Cursor.nextChild(1U)) {
+    EXPECT_EQ(Cursor.getDepth(), 2U);
+    Tags.push_back(Cursor.getDie().getTag());
+  }
+  EXPECT_EQ(Tags, std::vector<Dwarf_Half>({DW_TAG_subprogram,
+                                           DW_TAG_base_type}));
+  EXPECT_FALSE(Cursor.nextChild(1U));
+}
+
+TEST_F(LibDwarfHelpers, DwarfDieCursorFallback) {
+  // Without the file data the cursor walks the Dies with libdwarf.
+  for (const auto &CU : TestDebugData.getCompileUnits()) {
+    std::vector<std::pair<Dwarf_Off, unsigned>> Expected;
+    walkWithIterator(CU.CUDie, 1U, Expected);
+
+    DwarfDieCursor Cursor(TestDebugData, CU.CUDie, CU);
+    EXPECT_FALSE(Cursor.isDecoding());
+    std::vector<std::pair<Dwarf_Off, unsigned>> Walk;
+    walkWithCursor(Cursor, Walk);
+    EXPECT_EQ(Walk, Expected);
+    EXPECT_EQ(Cursor.getBytesDecoded(), 0U);
+  }
+}
+
+TEST(DwarfHelpers, DwarfDieCursorTypeUnits) {
+  std::string TestElfPath =
+      getTestInputFilePath("ElfDwarfReader/type_units.elf");
+  LibScopeView::FileDescriptor FD(TestElfPath);
+  ASSERT_GT(*FD, 0);
+  LibScopeView::MappedFile File;
+  ASSERT_TRUE(File.open(TestElfPath));
+  DwarfDebugData DebugData(*FD);
+  DebugData.setFileData(File.data(), File.size());
+
+  // The type unit is decoded from .debug_types.
+  auto TypeUnits = DebugData.getTypeUnits();
+  ASSERT_EQ(TypeUnits.size(), 1U);
+  std::vector<std::pair<Dwarf_Off, unsigned>> Expected;
+  walkWithIterator(TypeUnits[0].TUDie, 1U, Expected);
+  DwarfDieCursor Cursor(DebugData, TypeUnits[0].TUDie, TypeUnits[0]);
+  EXPECT_TRUE(Cursor.isDecoding());
+  std::vector<std::pair<Dwarf_Off, unsigned>> Walk;
+  walkWithCursor(Cursor, Walk);
+  EXPECT_EQ(Walk, Expected);
+  EXPECT_EQ(Cursor.getBytesDecoded(), TypeUnits[0].NextHeaderOffset -
+                                          TypeUnits[0].TUDie.getGlobalOffset());
+}
+
+TEST_F(LibDwarfHelpers, DwarfAbbrevTable) {
+  LibScopeView::MappedFile File;
+  ASSERT_TRUE(File.open(getTestInputFilePath("DwarfHelpers/test.elf")));
+  TestDebugData.setFileData(File.data(), File.size());
+  auto CompileUnits = TestDebugData.getCompileUnits();
+  ASSERT_FALSE(CompileUnits.empty());
+
+  const DwarfAbbrevTable *Table =
+      TestDebugData.getAbbrevTable(CompileUnits[0]);
+  ASSERT_NE(Table, nullptr);
+  EXPECT_EQ(TestDebugData.getAbbrevTable(CompileUnits[0]), Table);
+  EXPECT_EQ(Table->find(0U), nullptr);
+  EXPECT_EQ(Table->find(5U), nullptr);
+
+  // The compile unit's values all have fixed sizes.
+  const DwarfAbbrev *CUAbbrev = Table->find(1U);
+  ASSERT_NE(CUAbbrev, nullptr);
+  EXPECT_EQ(CUAbbrev->Tag, DW_TAG_compile_unit);
+  EXPECT_TRUE(CUAbbrev->HasChildren);
+  EXPECT_EQ(CUAbbrev->AttrCount, 7U);
+  EXPECT_EQ(CUAbbrev->FixedAttrCount, 7U);
+  EXPECT_EQ(CUAbbrev->FixedSize, 30U);
+  const DwarfAbbrevAttr *LowPC = CUAbbrev->findAttr(DW_AT_low_pc);
+  ASSERT_NE(LowPC, nullptr);
+  EXPECT_EQ(LowPC->Form, DW_FORM_addr);
+  EXPECT_EQ(LowPC->Size, 8);
+  EXPECT_EQ(LowPC->Offset, 18U);
+  EXPECT_EQ(CUAbbrev->Sibling, nullptr);
+
+  // The subprogram's DW_AT_frame_base ends the fixed size values.
+  const DwarfAbbrev *FuncAbbrev = Table->find(2U);
+  ASSERT_NE(FuncAbbrev, nullptr);
+  EXPECT_EQ(FuncAbbrev->Tag, DW_TAG_subprogram);
+  EXPECT_EQ(FuncAbbrev->AttrCount, 8U);
+  EXPECT_EQ(FuncAbbrev->FixedAttrCount, 2U);
+  EXPECT_EQ(FuncAbbrev->FixedSize, 12U);
+  EXPECT_EQ(FuncAbbrev->Attrs[2].Attr, DW_AT_frame_base);
+  EXPECT_EQ(FuncAbbrev->Attrs[2].Size, -1);
+  EXPECT_EQ(FuncAbbrev->findAttr(DW_AT_decl_line)->Form, DW_FORM_data1);
+
+  // Dies from the cursor answer with their abbreviation.
+  DwarfDieCursor Cursor(TestDebugData, CompileUnits[0].CUDie, CompileUnits[0]);
+  ASSERT_TRUE(Cursor.nextChild(1U));
+  EXPECT_EQ(Cursor.getTag(), DW_TAG_subprogram);
+  DwarfDie Func(Cursor.getDie());
+  EXPECT_EQ(Func.getTag(), DW_TAG_subprogram);
+  EXPECT_TRUE(Func.hasAttr(DW_AT_external));
+  EXPECT_FALSE(Func.hasAttr(DW_AT_declaration));
+  EXPECT_TRUE(Func.getAttr(DW_AT_declaration).empty());
+  EXPECT_EQ(Func.getAttr(DW_AT_low_pc).getAddress(), 0x004004e0U);
+}
+
+TEST(DwarfHelpers, DwarfAbbrevTableLEB128Runs) {
+  // A subprogram whose variable size values include runs of LEB128 numbers
+  // broken by a string, the sibling and a fixed size value.
+  const uint8_t Abbrevs[] = {
+      0x01, DW_TAG_subprogram, DW_CHILDREN_no,
+      DW_AT_decl_file, DW_FORM_data1,
+      DW_AT_name, DW_FORM_string,
+      DW_AT_decl_line, DW_FORM_udata,
+      DW_AT_decl_column, DW_FORM_sdata,
+      DW_AT_sibling, DW_FORM_ref_udata,
+      DW_AT_type, DW_FORM_ref_udata,
+      DW_AT_low_pc, DW_FORM_data1,
+      DW_AT_const_value, DW_FORM_sdata,
+      0x00, 0x00,
+      0x00};
+  DwarfSectionData Section;
+  Section.Data = Abbrevs;
+  Section.Size = sizeof(Abbrevs);
+  DwarfUnitHeader Header;
+  Header.Version = 4U;
+  Header.AddressSize = 8U;
+  Header.OffsetSize = 4U;
+  DwarfAbbrevTable Table;
+  ASSERT_TRUE(Table.compile(Section, Header));
+
+  const DwarfAbbrev *Func = Table.find(1U);
+  ASSERT_NE(Func, nullptr);
+  ASSERT_EQ(Func->AttrCount, 8U);
+  EXPECT_EQ(Func->FixedAttrCount, 1U);
+  std::vector<unsigned> Runs;
+  for (unsigned I = 0; I < Func->AttrCount; ++I)
+    Runs.push_back(Func->Attrs[I].LEB128Run);
+  EXPECT_EQ(Runs, std::vector<unsigned>({0U, 0U, 2U, 1U, 0U, 1U, 0U, 1U}));
+}
+
+TEST(DwarfHelpers, SharedAbbrevTables) {
+  // The generated compile units all use the same abbreviation table.
+  GeneratorOptions Options;
+  Options.CompileUnits = 3;
+  Options.Depth = 1;
+  const std::string Path(getTestOutputFilePath("shared_abbrevs.o"));
+  DwarfGenerator Generator(Options);
+  std::string Error;
+  ASSERT_TRUE(Generator.generate(Path, Error)) << Error;
+
+  LibScopeView::FileDescriptor FD(Path);
+  LibScopeView::MappedFile File;
+  ASSERT_TRUE(File.open(Path));
+  DwarfDebugData DebugData(*FD);
+  DebugData.setFileData(File.data(), File.size());
+
+  auto CompileUnits = DebugData.getCompileUnits();
+  ASSERT_EQ(CompileUnits.size(), 3U);
+  const DwarfAbbrevTable *Table = DebugData.getAbbrevTable(CompileUnits[0]);
+  ASSERT_NE(Table, nullptr);
+  for (const auto &CU : CompileUnits) {
+    EXPECT_EQ(DebugData.getAbbrevTable(CU), Table);
+    DwarfDieCursor Cursor(DebugData, CU.CUDie, CU);
+    EXPECT_TRUE(Cursor.isDecoding());
+  }
+}
+
+// Describe each Die from the Cursor down with all its attribute values.
+void describeDies(DwarfDieCursor &Cursor, std::vector<std::string> &Dies) {
+  const DwarfDie Die(Cursor.getDie());
+  const DwarfAbbrev *Abbrev = Cursor.getHandle().getAbbrev();
+  ASSERT_NE(Abbrev, nullptr);
+  std::ostringstream Text;
+  Text << std::hex << Die.getGlobalOffset() << ' ' << Die.getTag() << " \""
+       << Die.getName() << '"';
+  for (unsigned I = 0; I < Abbrev->AttrCount; ++I) {
+    DwarfAttrValue Value(Die.getAttr(Abbrev->Attrs[I].Attr));
+    Text << ' ' << Abbrev->Attrs[I].Attr << ':'
+         << static_cast<int>(Value.getKind()) << ':'
+         << (Value.empty() ? 0U : Value.getForm()) << '=';
+    switch (Value.getKind()) {
+    case DwarfAttrValueKind::Reference:
+      Text << Value.getReference();
+      break;
+    case DwarfAttrValueKind::Address:
+      Text << Value.getAddress();
+      break;
+    case DwarfAttrValueKind::Boolean:
+      Text << Value.getBool();
+      break;
+    case DwarfAttrValueKind::Unsigned:
+      Text << Value.getUnsigned();
+      break;
+    case DwarfAttrValueKind::Signed:
+      Text << Value.getSigned();
+      break;
+    case DwarfAttrValueKind::Bytes:
+    case DwarfAttrValueKind::Exprloc:
+      for (uint8_t Byte : Value.getKind() == DwarfAttrValueKind::Bytes
+                              ? Value.getBytes()
+                              : Value.getExprloc())
+        Text << static_cast<unsigned>(Byte) << ',';
+      break;
+    case DwarfAttrValueKind::String:
+      Text << Value.getString();
+      break;
+    case DwarfAttrValueKind::Signature:
+      Text << Value.getSignature();
+      break;
+    default:
+      break;
+    }
+  }
+  for (const DwarfAddressRange &Range : Die.getAddressRanges(0U))
+    Text << " [" << Range.Low << ',' << Range.High << ')';
+  Dies.push_back(Text.str());
+
+  unsigned Depth = Cursor.getDepth();
+  while (Cursor.nextChild(Depth))
+    describeDies(Cursor, Dies);
+}
+
+TEST(DwarfHelpers, DecodedValues) {
+  // A linked file, and object files whose sections need relocating.
+  for (const char *TestFile :
+       {"DwarfHelpers/test.elf", "ElfDwarfReader/members.o",
+        "ElfDwarfReader/template.o", "ElfDwarfReader/type_units.elf"}) {
+    SCOPED_TRACE(TestFile);
+    const std::string Path(getTestInputFilePath(TestFile));
+    LibScopeView::MappedFile File;
+    ASSERT_TRUE(File.open(Path));
+    LibScopeView::FileDescriptor FD(Path);
+    DwarfDebugData DebugData(*FD);
+    DebugData.setFileData(File.data(), File.size());
+    EXPECT_FALSE(DebugData.isDecodingValues());
+    LibScopeView::FileDescriptor NativeFD(Path);
+    DwarfDebugData NativeDebugData(*NativeFD);
+    NativeDebugData.setFileData(File.data(), File.size(), true);
+    EXPECT_TRUE(NativeDebugData.isDecodingValues());
+
+    // The values decoded from the bytes are the ones libdwarf reads.
+    auto TypeUnits = DebugData.getTypeUnits();
+    auto NativeTypeUnits = NativeDebugData.getTypeUnits();
+    auto CompileUnits = DebugData.getCompileUnits();
+    auto NativeCompileUnits = NativeDebugData.getCompileUnits();
+    ASSERT_EQ(TypeUnits.size(), NativeTypeUnits.size());
+    ASSERT_EQ(CompileUnits.size(), NativeCompileUnits.size());
+    ASSERT_FALSE(CompileUnits.empty());
+    std::vector<std::string> Expected;
+    std::vector<std::string> Decoded;
+    for (size_t I = 0; I < TypeUnits.size(); ++I) {
+      DwarfDieCursor Cursor(DebugData, TypeUnits[I].TUDie, TypeUnits[I]);
+      describeDies(Cursor, Expected);
+      DwarfDieCursor NativeCursor(NativeDebugData, NativeTypeUnits[I].TUDie,
+                                  NativeTypeUnits[I]);
+      describeDies(NativeCursor, Decoded);
+    }
+    for (size_t I = 0; I < CompileUnits.size(); ++I) {
+      DwarfDieCursor Cursor(DebugData, CompileUnits[I].CUDie,
+                            CompileUnits[I]);
+      describeDies(Cursor, Expected);
+      DwarfDieCursor NativeCursor(NativeDebugData, NativeCompileUnits[I].CUDie,
+                                  NativeCompileUnits[I]);
+      describeDies(NativeCursor, Decoded);
+    }
+    EXPECT_EQ(Decoded, Expected);
+  }
+}
+
 TEST_F(LibDwarfHelpers, DwarfLineTable) {
   auto CompileUnits = TestDebugData.getCompileUnits();
   ASSERT_FALSE(CompileUnits.empty());
@@ -321,3 +707,129 @@ TEST_F(LibDwarfHelpers, DwarfLineTable) {
   EXPECT_EQ(Line.ISA, 0U);
   EXPECT_EQ(Line.Discriminator, 0U);
 }
+
+namespace {
+
+// Describe each row, for comparing tables.
+std::vector<std::string> describeRows(const std::vector<DwarfLineRow> &Rows) {
+  std::vector<std::string> Descriptions;
+  for (const DwarfLineRow &Row : Rows) {
+    std::ostringstream Description;
+    Description << std::hex << Row.LineAddr << std::dec << " " << Row.LineNo
+                << " " << Row.SrcFileID << " " << Row.Discriminator << " "
+                << static_cast<unsigned>(Row.Flags);
+    Descriptions.push_back(Description.str());
+  }
+  return Descriptions;
+}
+
+} // namespace
+
+TEST(DwarfHelpers, DecodedLineRows) {
+  for (const char *TestFile :
+       {"DwarfHelpers/test.elf", "ElfDwarfReader/lines.o",
+        "ElfDwarfReader/members.o", "ElfDwarfReader/template.o"}) {
+    SCOPED_TRACE(TestFile);
+    const std::string Path(getTestInputFilePath(TestFile));
+    LibScopeView::MappedFile File;
+    ASSERT_TRUE(File.open(Path));
+    LibScopeView::FileDescriptor FD(Path);
+    DwarfDebugData DebugData(*FD);
+    DebugData.setFileData(File.data(), File.size(), true);
+    ASSERT_TRUE(DebugData.isDecodingValues());
+
+    // The rows run from the bytes are the ones libdwarf reads.
+    auto CompileUnits = DebugData.getCompileUnits();
+    ASSERT_FALSE(CompileUnits.empty());
+    for (const DwarfCompileUnit &CU : CompileUnits) {
+      std::vector<DwarfLineRow> Expected;
+      CU.CUDie.getLineTable().getRows(Expected);
+      EXPECT_FALSE(Expected.empty());
+      std::vector<DwarfLineRow> Decoded;
+      DwarfAttrValue StmtList = CU.CUDie.getAttr(DW_AT_stmt_list);
+      ASSERT_EQ(StmtList.getKind(), DwarfAttrValueKind::Reference);
+      EXPECT_TRUE(DwarfLineTable::decodeRows(
+          DebugData.getLineSection(), StmtList.getReference(), Decoded));
+      EXPECT_EQ(describeRows(Decoded), describeRows(Expected));
+      std::vector<DwarfLineRow> Rows;
+      CU.CUDie.getLineRows(Rows);
+      EXPECT_EQ(describeRows(Rows), describeRows(Expected));
+    }
+  }
+}
+
+TEST(DwarfHelpers, DwarfLineTableDecodeRows) {
+  // A DWARF 5 table with two sequences, which uses each standard opcode.
+  std::vector<uint8_t> Header = {
+      // Minimum instruction length, maximum operations per instruction,
+      // default is_stmt, line base, line range and opcode base.
+      1, 1, 1, static_cast<uint8_t>(-5), 14, 13,
+      // The standard opcode lengths.
+      0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1,
+      // One directory and two files, given by name and directory index.
+      1, DW_LNCT_path, DW_FORM_string, 1, '/', 0,
+      2, DW_LNCT_path, DW_FORM_string, DW_LNCT_directory_index, DW_FORM_udata,
+      2, 'a', 0, 0, 'b', 0, 0};
+  std::vector<uint8_t> Program = {
+      // The first sequence.
+      0, 9, DW_LNE_set_address, 0x00, 0x10, 0, 0, 0, 0, 0, 0,
+      DW_LNS_copy,
+      DW_LNS_advance_line, 4,
+      // Advance the address by 2 and the line by 1.
+      13 + (1 + 5) + 14 * 2,
+      0, 2, DW_LNE_set_discriminator, 3,
+      DW_LNS_negate_stmt,
+      DW_LNS_set_prologue_end,
+      DW_LNS_copy,
+      DW_LNS_advance_pc, 4,
+      0, 1, DW_LNE_end_sequence,
+      // The second sequence.
+      0, 9, DW_LNE_set_address, 0x00, 0x20, 0, 0, 0, 0, 0, 0,
+      DW_LNS_set_file, 2,
+      DW_LNS_advance_line, 9,
+      DW_LNS_const_add_pc,
+      DW_LNS_fixed_advance_pc, 0x10, 0x00,
+      DW_LNS_set_basic_block,
+      DW_LNS_set_epilogue_begin,
+      DW_LNS_set_column, 5,
+      DW_LNS_set_isa, 1,
+      DW_LNS_copy,
+      DW_LNS_advance_pc, 1,
+      0, 1, DW_LNE_end_sequence};
+
+  // Put a table before it, so that it is found by offset.
+  std::vector<uint8_t> Section(5U, 0U);
+  Section[0] = 1U;
+  size_t UnitLength = 2U + 2U + 4U + Header.size() + Program.size();
+  for (unsigned I = 0; I < 4U; ++I)
+    Section.push_back(static_cast<uint8_t>(UnitLength >> (8U * I)));
+  Section.insert(Section.end(), {5, 0, 8, 0});
+  for (unsigned I = 0; I < 4U; ++I)
+    Section.push_back(static_cast<uint8_t>(Header.size() >> (8U * I)));
+  Section.insert(Section.end(), Header.begin(), Header.end());
+  Section.insert(Section.end(), Program.begin(), Program.end());
+  DwarfSectionData Data;
+  Data.Data = Section.data();
+  Data.Size = Section.size();
+
+  std::vector<DwarfLineRow> Rows;
+  ASSERT_TRUE(DwarfLineTable::decodeRows(Data, 5U, Rows));
+  const unsigned Stmt = DwarfLineRow::IsBeginStatement;
+  EXPECT_EQ(describeRows(Rows),
+            describeRows({{0x1000U, 1U, 1U, 0U, Stmt},
+                          {0x1002U, 6U, 1U, 0U, Stmt},
+                          {0x1002U, 6U, 1U, 3U, DwarfLineRow::IsPrologEnd},
+                          {0x1006U, 6U, 1U, 0U, DwarfLineRow::IsEndSequence},
+                          {0x2021U, 10U, 2U, 0U,
+                           Stmt | DwarfLineRow::IsBeginBlock |
+                               DwarfLineRow::IsEpilogueBegin},
+                          {0x2022U, 10U, 2U, 0U,
+                           Stmt | DwarfLineRow::IsEndSequence}}));
+
+  // Tables that run past the end of the section aren't decoded.
+  Section.resize(Section.size() - 1U);
+  Data.Size = Section.size();
+  EXPECT_FALSE(DwarfLineTable::decodeRows(Data, 5U, Rows));
+  EXPECT_TRUE(Rows.empty());
+  EXPECT_FALSE(DwarfLineTable::decodeRows(Data, Data.Size, Rows));
+}
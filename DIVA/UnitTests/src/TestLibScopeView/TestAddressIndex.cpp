@@ -0,0 +1,133 @@
+//===-- UnitTests/TestLibScopeView/TestAddressIndex.cpp ---------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the code address index.
+///
+//===----------------------------------------------------------------------===//
+
+#include "AddressIndex.h"
+#include "Line.h"
+#include "Reader.h"
+#include "Scope.h"
+
+#include "gtest/gtest.h"
+
+using namespace LibScopeView;
+
+namespace {
+
+Line *addLine(Scope *Parent, Dwarf_Addr Address, uint64_t LineNumber,
+              bool EndSequence = false) {
+  Line *Ln = new Line;
+  Ln->setIsLineRecord();
+  Ln->setAddress(Address);
+  Ln->setLineNumber(LineNumber);
+  if (EndSequence)
+    Ln->setIsLineEndSequence();
+  Parent->addObject(Ln);
+  return Ln;
+}
+
+} // namespace
+
+TEST(AddressIndex, Find) {
+  Reader R;
+  setReader(&R);
+
+  // cu1.cpp [0x100, 0x200)
+  //   Func [0x100, 0x180)
+  //     Block [0x110, 0x140)
+  //       Inlined [0x120, 0x130) [0x138, 0x148)
+  // cu2.cpp [0x1f0, 0x300)
+  //   Other [0x1f0, 0x210)
+  ScopeRoot Root;
+  ScopeCompileUnit *CU1 = new ScopeCompileUnit;
+  CU1->setIsCompileUnit();
+  CU1->setCanHaveLines();
+  CU1->addAddressRange(0x100, 0x200);
+  Root.addObject(CU1);
+  ScopeFunction *Func = new ScopeFunction;
+  Func->addAddressRange(0x100, 0x180);
+  CU1->addObject(Func);
+  Scope *Block = new Scope;
+  Block->addAddressRange(0x110, 0x140);
+  Func->addObject(Block);
+  ScopeFunctionInlined *Inlined = new ScopeFunctionInlined;
+  Inlined->addAddressRange(0x138, 0x148);
+  Inlined->addAddressRange(0x120, 0x130);
+  Block->addObject(Inlined);
+  Line *Line1 = addLine(CU1, 0x100, 1);
+  Line *Line2 = addLine(CU1, 0x120, 2);
+  Line *Line3 = addLine(CU1, 0x130, 3);
+  addLine(CU1, 0x180, 4, /*EndSequence=*/true);
+
+  ScopeCompileUnit *CU2 = new ScopeCompileUnit;
+  CU2->setIsCompileUnit();
+  CU2->setCanHaveLines();
+  CU2->addAddressRange(0x1f0, 0x300);
+  Root.addObject(CU2);
+  ScopeFunction *Other = new ScopeFunction;
+  Other->addAddressRange(0x1f0, 0x210);
+  CU2->addObject(Other);
+
+  AddressIndex Index(&Root);
+  auto Expect = [&](Dwarf_Addr Address, const Scope *Innermost,
+                    const Line *Row) {
+    AddressIndex::Location Loc = Index.find(Address);
+    EXPECT_EQ(Loc.Innermost, Innermost) << std::hex << Address;
+    EXPECT_EQ(Loc.Row, Row) << std::hex << Address;
+  };
+  Expect(0x0ff, nullptr, nullptr);
+  Expect(0x100, Func, Line1);
+  Expect(0x110, Block, Line1);
+  Expect(0x120, Inlined, Line2);
+  Expect(0x12f, Inlined, Line2);
+  Expect(0x130, Block, Line3);
+  Expect(0x138, Inlined, Line3);
+  // A range going past the end of its parent's is clipped.
+  Expect(0x140, Func, Line3);
+  Expect(0x150, Func, Line3);
+  // After the end of the sequence there is no line.
+  Expect(0x180, CU1, nullptr);
+  // Overlapping units keep the addresses of the first one.
+  Expect(0x1f8, CU1, nullptr);
+  Expect(0x200, Other, nullptr);
+  Expect(0x210, CU2, nullptr);
+  Expect(0x300, nullptr, nullptr);
+
+  // The batch lookup returns the same locations in the order asked.
+  std::vector<Dwarf_Addr> Addresses;
+  for (Dwarf_Addr Address = 0x400; Address > 0xf0; Address -= 3)
+    Addresses.push_back(Address);
+  Addresses.push_back(0x120);
+  std::vector<AddressIndex::Location> Locations = Index.find(Addresses);
+  ASSERT_EQ(Locations.size(), Addresses.size());
+  for (size_t I = 0; I < Addresses.size(); ++I) {
+    AddressIndex::Location Loc = Index.find(Addresses[I]);
+    EXPECT_EQ(Locations[I].Innermost, Loc.Innermost) << I;
+    EXPECT_EQ(Locations[I].Row, Loc.Row) << I;
+  }
+  EXPECT_TRUE(Index.find(std::vector<Dwarf_Addr>()).empty());
+}
@@ -202,3 +202,56 @@ TEST(FileUtilities, isElfSucceedsOnElfs) {
   EXPECT_TRUE(isFileFormatElf(FileLocation));
 }
 
+
+TEST(FileUtilities, getElfBuildID) {
+  std::string BuildID;
+  const std::string FileLocation =
+      getTestInputFilePath("ElfDwarfReader/structure.elf");
+  ASSERT_TRUE(doesFileExist(FileLocation))<< FileNotFoundError << FileLocation;
+  EXPECT_TRUE(getElfBuildID(FileLocation, BuildID));
+  EXPECT_EQ(BuildID, "25cd34c0da8067d434f0fe0400ef10bd5abc28ad");
+
+  // Object files and non elf files do not have a build-id.
+  EXPECT_FALSE(getElfBuildID(getTestInputFilePath("test.o"), BuildID));
+  EXPECT_FALSE(getElfBuildID(getTestInputFilePath("Test.txt"), BuildID));
+  EXPECT_FALSE(getElfBuildID(getTestInputFilePath("3Bytes.o"), BuildID));
+}
+
+TEST(FileUtilities, getFileContentHash) {
+  uint64_t Hash1 = 0;
+  uint64_t Hash2 = 0;
+  uint64_t Hash3 = 0;
+  EXPECT_TRUE(getFileContentHash(getTestInputFilePath("test.o"), Hash1));
+  EXPECT_TRUE(getFileContentHash(getTestInputFilePath("test.o"), Hash2));
+  EXPECT_TRUE(getFileContentHash(getTestInputFilePath("Test.txt"), Hash3));
+  EXPECT_EQ(Hash1, Hash2);
+  EXPECT_NE(Hash1, Hash3);
+
+  // FNV-1a of " EL".
+  EXPECT_TRUE(getFileContentHash(getTestInputFilePath("3Bytes.o"), Hash1));
+  EXPECT_EQ(Hash1, 0xc3336817ce4878a6U);
+  EXPECT_FALSE(getFileContentHash(getTestInputFilePath("missing.o"), Hash1));
+}
+
+TEST(FileUtilities, getFileSizeAndTime) {
+  uint64_t Size = 0;
+  int64_t ModifiedTime = 0;
+  EXPECT_TRUE(
+      getFileSizeAndTime(getTestInputFilePath("3Bytes.o"), Size, ModifiedTime));
+  EXPECT_EQ(Size, 3U);
+  EXPECT_GT(ModifiedTime, 0);
+  EXPECT_FALSE(getFileSizeAndTime(getTestInputFilePath("missing.o"), Size,
+                                  ModifiedTime));
+}
+
+TEST(FileUtilities, MappedFile) {
+  MappedFile File;
+  ASSERT_TRUE(File.open(getTestInputFilePath("3Bytes.o")));
+  ASSERT_EQ(File.size(), 3U);
+  EXPECT_EQ(std::string(File.data(), File.size()), " EL");
+  File.close();
+  EXPECT_EQ(File.data(), nullptr);
+  EXPECT_EQ(File.size(), 0U);
+
+  EXPECT_FALSE(File.open(getTestInputFilePath("missing.o")));
+}
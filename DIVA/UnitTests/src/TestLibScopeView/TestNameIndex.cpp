@@ -0,0 +1,98 @@
+//===-- UnitTests/TestLibScopeView/TestNameIndex.cpp ------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the qualified-name index.
+///
+//===----------------------------------------------------------------------===//
+
+#include "NameIndex.h"
+#include "Reader.h"
+#include "Scope.h"
+#include "Symbol.h"
+
+#include "gtest/gtest.h"
+
+using namespace LibScopeView;
+
+namespace {
+
+void expectSplit(const std::string &QualifiedName,
+                 const std::string &ExpectedQualifiers,
+                 const std::string &ExpectedName) {
+  std::string Qualifiers, Name;
+  NameIndex::splitQualifiedName(QualifiedName, Qualifiers, Name);
+  EXPECT_EQ(Qualifiers, ExpectedQualifiers) << QualifiedName;
+  EXPECT_EQ(Name, ExpectedName) << QualifiedName;
+}
+
+} // namespace
+
+TEST(NameIndex, SplitQualifiedName) {
+  expectSplit("", "", "");
+  expectSplit("global", "", "global");
+  expectSplit("ns::Class::method", "ns::Class::", "method");
+  expectSplit("Class<ns::Type>::method", "Class<ns::Type>::", "method");
+  expectSplit("ns::Class<ns::Type>", "ns::", "Class<ns::Type>");
+  expectSplit("ns::func(int (*)(a::b))", "ns::", "func(int (*)(a::b))");
+  expectSplit("ns::operator<", "ns::", "operator<");
+}
+
+TEST(NameIndex, Find) {
+  Reader R;
+  setReader(&R);
+
+  ScopeRoot Root;
+  ScopeCompileUnit *CU = new ScopeCompileUnit;
+  CU->setIsCompileUnit();
+  CU->setName("cu.cpp");
+  Root.addObject(CU);
+
+  ScopeNamespace *NS = new ScopeNamespace;
+  NS->setName("ns");
+  CU->addObject(NS);
+  Symbol *First = new Symbol;
+  First->setName("var");
+  NS->addObject(First);
+  Symbol *Second = new Symbol;
+  Second->setName("var");
+  NS->addObject(Second);
+  Symbol *Global = new Symbol;
+  Global->setName("var");
+  CU->addObject(Global);
+  for (Object *Obj : {static_cast<Object *>(NS), static_cast<Object *>(First),
+                      static_cast<Object *>(Second),
+                      static_cast<Object *>(Global)})
+    Obj->resolveQualifiedName();
+
+  NameIndex Index(&Root);
+  EXPECT_EQ(Index.find("ns::var"), std::vector<Object *>({First, Second}));
+  EXPECT_EQ(Index.find("var"), std::vector<Object *>({Global}));
+  EXPECT_EQ(Index.find("ns"), std::vector<Object *>({NS}));
+  EXPECT_EQ(Index.find("cu.cpp"), std::vector<Object *>({CU}));
+  EXPECT_TRUE(Index.find("ns::missing").empty());
+  EXPECT_TRUE(Index.find("not_a_pooled_name::var").empty());
+  EXPECT_TRUE(Index.find("").empty());
+  EXPECT_EQ(Index.size(), 4U);
+}
@@ -47,11 +47,14 @@ public:
     static std::string Kind("ObjKind");
     return Kind.c_str();
   }
+  ObjectKind getKind() const override { return ObjectKind::Other; }
   const char *getName() const override { return Name.c_str(); }
   size_t getNameIndex() const override { return 0; }
   virtual void setNameIndex(size_t NameIndex) override {}
   void setName(const char *name) override { Name = name; }
   const char *getQualifiedName() const override { return QName.c_str(); }
+  size_t getQualifiedNameIndex() const override { return 0; }
+  void setQualifiedNameIndex(size_t QualifiedIndex) override {}
   void setQualifiedName(const char *name) override {
     setHasQualifiedName();
     QName = name;
@@ -0,0 +1,116 @@
+//===-- UnitTests/TestLibScopeView/TestQualifiedNamePool.cpp ----*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+///
+/// \file
+/// Tests for the Qualified Name Pool.
+///
+//===----------------------------------------------------------------------===//
+
+#include "QualifiedNamePool.h"
+#include "StringPool.h"
+
+#include "gtest/gtest.h"
+
+#include <thread>
+
+using namespace LibScopeView;
+
+TEST(QualifiedNamePool, SharedPrefixes) {
+  size_t Outer = QualifiedNamePool::getQualifiedIndex(
+      0, StringPool::getStringIndex("QNPOuter"));
+  size_t First = QualifiedNamePool::getQualifiedIndex(
+      Outer, StringPool::getStringIndex("First"));
+  size_t Second = QualifiedNamePool::getQualifiedIndex(
+      Outer, StringPool::getStringIndex("Second"));
+  EXPECT_NE(Outer, 0U);
+  EXPECT_NE(First, Second);
+  EXPECT_EQ(QualifiedNamePool::getQualifiedIndex(
+                Outer, StringPool::getStringIndex("First")),
+            First);
+
+  EXPECT_STREQ(QualifiedNamePool::getQualifiedText(0), "");
+  EXPECT_STREQ(QualifiedNamePool::getQualifiedText(Outer), "QNPOuter::");
+  EXPECT_STREQ(QualifiedNamePool::getQualifiedText(First),
+               "QNPOuter::First::");
+  EXPECT_STREQ(QualifiedNamePool::getQualifiedText(Second),
+               "QNPOuter::Second::");
+
+  // The text finds the same qualifiers.
+  EXPECT_EQ(QualifiedNamePool::getQualifiedIndex("QNPOuter::First::"), First);
+  EXPECT_EQ(QualifiedNamePool::getQualifiedIndex(""), 0U);
+}
+
+TEST(QualifiedNamePool, Lookup) {
+  bool Found = true;
+  QualifiedNamePool::lookupQualifiedIndex("QNPMissing::Name::", Found);
+  EXPECT_FALSE(Found);
+
+  size_t Index = QualifiedNamePool::getQualifiedIndex("QNPLookup::Name::");
+  EXPECT_EQ(QualifiedNamePool::lookupQualifiedIndex("QNPLookup::Name::", Found),
+            Index);
+  EXPECT_TRUE(Found);
+  QualifiedNamePool::lookupQualifiedIndex("QNPLookup::Other::", Found);
+  EXPECT_FALSE(Found);
+}
+
+TEST(QualifiedNamePool, SplitQualifiers) {
+  EXPECT_EQ(QualifiedNamePool::splitQualifiers("A::B::"),
+            std::vector<std::string>({"A", "B"}));
+  EXPECT_EQ(
+      QualifiedNamePool::splitQualifiers("A<B::C>::f(D::E)::F::"),
+      std::vector<std::string>({"A<B::C>", "f(D::E)", "F"}));
+  EXPECT_TRUE(QualifiedNamePool::splitQualifiers("").empty());
+
+  // Qualifiers with templates are kept whole in the pool.
+  size_t Index = QualifiedNamePool::getQualifiedIndex("QNPSplit<X::Y>::Z::");
+  EXPECT_STREQ(QualifiedNamePool::getQualifiedText(Index),
+               "QNPSplit<X::Y>::Z::");
+}
+
+TEST(QualifiedNamePool, ConcurrentInserts) {
+  // Each thread adds the same qualifiers, in a different order given by a
+  // step coprime with the number of qualifiers.
+  const size_t Count = 500;
+  const size_t Steps[] = {1, 3, 7, 11, 13, 17, 19, 23};
+  const unsigned ThreadCount = 8;
+  std::vector<std::vector<size_t>> Indexes(ThreadCount,
+                                           std::vector<size_t>(Count));
+  std::vector<std::thread> Threads;
+  for (unsigned Thread = 0; Thread < ThreadCount; ++Thread)
+    Threads.emplace_back([&, Thread]() {
+      for (size_t I = 0; I < Count; ++I) {
+        size_t N = (I * Steps[Thread]) % Count;
+        std::string Text("QNPConcurrent::N" + std::to_string(N) + "::");
+        Indexes[Thread][N] = QualifiedNamePool::getQualifiedIndex(Text);
+        EXPECT_EQ(QualifiedNamePool::getQualifiedText(Indexes[Thread][N]),
+                  Text);
+      }
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  for (unsigned Thread = 1; Thread < ThreadCount; ++Thread)
+    EXPECT_EQ(Indexes[Thread], Indexes[0]);
+}
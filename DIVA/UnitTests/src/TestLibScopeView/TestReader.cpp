@@ -0,0 +1,122 @@
+//===-- UnitTests/TestLibScopeView/TestReader.cpp ---------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the post-creation actions of the reader.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Reader.h"
+#include "Scope.h"
+#include "Type.h"
+
+#include "dwarf.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace LibScopeView;
+
+namespace {
+
+// Number of compile units created by CrossUnitReader, and of the pointer and
+// const types of each unit.
+const size_t UnitCount = 64;
+const size_t TypeCount = 64;
+
+// Creates compile units whose types refer to the types of the following units,
+// so that the units are resolved in several parallel rounds.
+class CrossUnitReader : public Reader {
+public:
+  // The types of each unit.
+  std::vector<std::vector<Type *>> Pointers;
+  std::vector<std::vector<Type *>> Consts;
+
+private:
+  bool createScopes(const PrintSettings &) override {
+    Scopes = new ScopeRoot;
+    std::vector<Type *> BaseTypes;
+    for (size_t Index = 0; Index < UnitCount; ++Index) {
+      auto *CU = new ScopeCompileUnit;
+      CU->setIsCompileUnit();
+      CU->setName(("cu" + std::to_string(Index) + ".cpp").c_str());
+      Scopes->addObject(CU);
+
+      auto *Base = new Type;
+      Base->setIsBaseType();
+      Base->setDieTag(DW_TAG_base_type);
+      Base->setName(("T" + std::to_string(Index)).c_str());
+      CU->addObject(Base);
+      BaseTypes.push_back(Base);
+
+      Pointers.emplace_back();
+      Consts.emplace_back();
+      for (size_t Count = 0; Count < TypeCount; ++Count) {
+        auto *Pointer = new Type;
+        Pointer->setIsPointerType();
+        Pointer->setDieTag(DW_TAG_pointer_type);
+        CU->addObject(Pointer);
+        Pointers.back().push_back(Pointer);
+
+        auto *Const = new Type;
+        Const->setIsConstType();
+        Const->setDieTag(DW_TAG_const_type);
+        CU->addObject(Const);
+        Consts.back().push_back(Const);
+      }
+    }
+
+    // Each pointer points to the base type of the next unit, and each const
+    // qualifies a pointer of the unit after that.
+    for (size_t Index = 0; Index < UnitCount; ++Index) {
+      for (size_t Count = 0; Count < TypeCount; ++Count) {
+        Pointers[Index][Count]->setType(BaseTypes[(Index + 1) % UnitCount]);
+        Consts[Index][Count]->setType(Pointers[(Index + 2) % UnitCount][Count]);
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+TEST(Reader, ResolveCrossUnitTypeNames) {
+  CrossUnitReader R;
+  PrintSettings Settings;
+  ASSERT_TRUE(R.loadFile("cross_unit.o", Settings));
+
+  for (size_t Index = 0; Index < UnitCount; ++Index) {
+    const std::string PointerName =
+        "T" + std::to_string((Index + 1) % UnitCount) + " *";
+    const std::string ConstName =
+        "const T" + std::to_string((Index + 3) % UnitCount) + " *";
+    for (size_t Count = 0; Count < TypeCount; ++Count) {
+      EXPECT_EQ(std::string(R.Pointers[Index][Count]->getName()), PointerName);
+      EXPECT_EQ(std::string(R.Consts[Index][Count]->getName()), ConstName);
+      EXPECT_TRUE(R.Pointers[Index][Count]->getIsResolved());
+      EXPECT_TRUE(R.Consts[Index][Count]->getIsResolved());
+    }
+  }
+}
@@ -29,6 +29,7 @@
 
 #include "Line.h"
 #include "Reader.h"
+#include "Symbol.h"
 #include "Type.h"
 
 #include "dwarf.h"
@@ -1066,3 +1067,124 @@ TEST(Scope, notPrintedAsObject) {
   EXPECT_FALSE(ScopeArray().getIsPrintedAsObject());
   EXPECT_FALSE(ScopeRoot().getIsPrintedAsObject());
 }
+
+TEST(Scope, propagateHasFlags) {
+  Reader R;
+  setReader(&R);
+
+  ScopeRoot Root;
+  auto *CU = new ScopeCompileUnit;
+  CU->setIsCompileUnit();
+  CU->setCanHaveLines();
+  Root.addObject(CU);
+  auto *Function = new ScopeFunction;
+  CU->addObject(Function);
+  auto *Block = new Scope;
+  Function->addObject(Block);
+  auto *Global = new Symbol;
+  Global->setIsGlobalReference();
+  Block->addObject(Global);
+  auto *Ty = new Type;
+  Function->addObject(Ty);
+  CU->addObject(new Line);
+
+  // Adding an object only flags the scope it is added to.
+  EXPECT_TRUE(Block->getHasGlobals());
+  EXPECT_TRUE(Block->getHasSymbols());
+  EXPECT_FALSE(Function->getHasGlobals());
+  EXPECT_FALSE(Root.getHasLines());
+
+  Root.propagateHasFlags();
+  for (const Scope *Scp : std::vector<const Scope *>({&Root, CU, Function,
+                                                     Block}))
+    EXPECT_TRUE(Scp->getHasGlobals() && Scp->getHasSymbols());
+  EXPECT_TRUE(Root.getHasLines() && CU->getHasLines());
+  EXPECT_FALSE(Function->getHasLines());
+  EXPECT_TRUE(Root.getHasTypes() && Function->getHasTypes());
+  EXPECT_FALSE(Block->getHasTypes());
+  EXPECT_TRUE(Root.getHasLocals() && Function->getHasLocals());
+  EXPECT_FALSE(Block->getHasLocals());
+  EXPECT_TRUE(Function->getHasScopes());
+  EXPECT_FALSE(Block->getHasScopes());
+}
+
+TEST(Scope, propagateChildHasFlags) {
+  Reader R;
+  setReader(&R);
+
+  ScopeRoot Root;
+  auto *CU = new ScopeCompileUnit;
+  Root.addObject(CU);
+  auto *Function = new ScopeFunction;
+  CU->addObject(Function);
+  auto *Block = new Scope;
+  Function->addObject(Block);
+  auto *Global = new Symbol;
+  Global->setIsGlobalReference();
+  Block->addObject(Global);
+
+  // The scopes under the CU are set, but not the CU itself.
+  CU->propagateChildHasFlags();
+  EXPECT_TRUE(Function->getHasGlobals() && Function->getHasSymbols());
+  EXPECT_FALSE(CU->getHasGlobals());
+  EXPECT_FALSE(CU->getHasSymbols());
+  EXPECT_FALSE(Root.getHasGlobals());
+}
+
+TEST(Scope, compactChildren) {
+  Reader R;
+  setReader(&R);
+
+  ScopeRoot Root;
+  auto *CU = new ScopeCompileUnit;
+  Root.addObject(CU);
+  auto *Sym = new Symbol;
+  CU->addObject(Sym);
+  auto *Function = new ScopeFunction;
+  CU->addObject(Function);
+  auto *Ty = new Type;
+  CU->addObject(Ty);
+  auto *Param = new Symbol;
+  Function->addObject(Param);
+
+  // The children keep their order, both before and after being compacted.
+  for (int Compacted = 0; Compacted < 2; ++Compacted) {
+    EXPECT_EQ(std::vector<Object *>(CU->getChildren().begin(),
+                                    CU->getChildren().end()),
+              std::vector<Object *>({Sym, Function, Ty}));
+    EXPECT_EQ(CU->getSymbols().size(), 1U);
+    EXPECT_EQ(CU->getSymbolAt(0), Sym);
+    EXPECT_EQ(CU->getScopeAt(0), Function);
+    EXPECT_EQ(CU->getTypes().front(), Ty);
+    EXPECT_EQ(Function->getSymbols().back(), Param);
+    EXPECT_TRUE(Function->getScopes().empty());
+    EXPECT_THROW(CU->getScopeAt(1), std::out_of_range);
+    Root.compactChildren();
+  }
+
+  // Objects can still be added once compacted.
+  auto *OtherSym = new Symbol;
+  CU->addObject(OtherSym);
+  EXPECT_EQ(std::vector<Object *>(CU->getChildren().begin(),
+                                  CU->getChildren().end()),
+            std::vector<Object *>({Sym, Function, Ty, OtherSym}));
+  EXPECT_EQ(CU->getSymbolAt(1), OtherSym);
+  EXPECT_EQ(CU->getTypes().size(), 1U);
+
+  // The order is kept past the children whose kinds fit in a byte.
+  std::vector<Object *> Expected({Sym, Function, Ty, OtherSym});
+  for (int Index = 0; Index < 6; ++Index) {
+    auto *MoreTy = new Type;
+    CU->addObject(MoreTy);
+    auto *MoreSym = new Symbol;
+    CU->addObject(MoreSym);
+    Expected.insert(Expected.end(), {MoreTy, MoreSym});
+  }
+  Root.compactChildren();
+  EXPECT_EQ(std::vector<Object *>(CU->getChildren().begin(),
+                                  CU->getChildren().end()),
+            Expected);
+  EXPECT_EQ(CU->getChildrenCount(), 16U);
+  EXPECT_EQ(CU->getTypes().size(), 7U);
+  EXPECT_EQ(CU->getSymbols().size(), 8U);
+}
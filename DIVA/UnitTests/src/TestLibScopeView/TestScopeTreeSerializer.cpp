@@ -0,0 +1,345 @@
+//===-- UnitTests/TestLibScopeView/TestScopeTreeSerializer.cpp --*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for LibScopeView::ScopeTreeSerializer.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Line.h"
+#include "Reader.h"
+#include "ScopeTreeFormat.h"
+#include "ScopeTreeSerializer.h"
+#include "ScopeTreeView.h"
+#include "Symbol.h"
+#include "Type.h"
+
+#include "dwarf.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+
+using namespace LibScopeView;
+
+namespace {
+
+// Test fixture with a Reader to count the objects added to the trees.
+class TestScopeTreeSerializer : public ::testing::Test {
+protected:
+  void SetUp() override { setReader(&TheReader); }
+  void TearDown() override { setReader(nullptr); }
+
+  // Build a small tree using most of the object classes and attributes.
+  std::unique_ptr<Scope> createTree() {
+    auto Root = std::make_unique<ScopeRoot>(0);
+    Root->setIsRoot();
+    Root->setName("test.o");
+
+    auto *CU = new ScopeCompileUnit(1);
+    CU->setIsCompileUnit();
+    CU->setCanHaveLines();
+    CU->setName("test.cpp");
+    CU->setDieOffset(0xb);
+    CU->setDieTag(DW_TAG_compile_unit);
+    Root->addObject(CU);
+
+    auto *Int = new Type(2);
+    Int->setIsBaseType();
+    Int->setName("int");
+    Int->setByteSize(4);
+    Int->setIsGlobalReference();
+    CU->addObject(Int);
+
+    auto *Class = new ScopeAggregate(2);
+    Class->setIsClassType();
+    Class->setName("C");
+    Class->setFileName("test.h");
+    Class->setLineNumber(3);
+    CU->addObject(Class);
+
+    auto *Member = new Symbol(3);
+    Member->setIsMember();
+    Member->setAccessSpecifier(AccessSpecifier::Protected);
+    Member->setIsStatic();
+    Member->setName("M");
+    Member->setType(Int);
+    Class->addObject(Member);
+
+    auto *Base = new TypeImport(3);
+    Base->setIsInheritance();
+    Base->setInheritanceAccess(AccessSpecifier::Private);
+    Base->setType(Int);
+    Class->addObject(Base);
+
+    auto *Enum = new ScopeEnumeration(2);
+    Enum->setIsEnumerationType();
+    Enum->setIsClass();
+    Enum->setName("E");
+    CU->addObject(Enum);
+
+    auto *Enumerator = new TypeEnumerator(3);
+    Enumerator->setIsEnumerator();
+    Enumerator->setName("A");
+    Enumerator->setValue("7");
+    Enum->addObject(Enumerator);
+
+    auto *Declaration = new ScopeFunction(3);
+    Declaration->setIsFunction();
+    Declaration->setIsDeclaration();
+    Declaration->setName("f");
+    Class->addObject(Declaration);
+
+    auto *Function = new ScopeFunction(2);
+    Function->setIsFunction();
+    Function->setIsStatic();
+    Function->setIsDeclaredInline();
+    Function->setReference(Declaration);
+    Function->setType(Int);
+    Function->addAddressRange(0x400, 0x440);
+    CU->addObject(Function);
+
+    auto *Inlined = new ScopeFunctionInlined(3);
+    Inlined->setIsInlinedSubroutine();
+    Inlined->setDiscriminator(2);
+    Inlined->setCallLineNumber(12);
+    Inlined->addAddressRange(0x408, 0x410);
+    Inlined->addAddressRange(0x420, 0x428);
+    Function->addObject(Inlined);
+
+    auto *Param = new Symbol(3);
+    Param->setIsParameter();
+    Param->setName("P");
+    Param->setFileNameIndex(9);
+    Param->setInvalidFileName();
+    Function->addObject(Param);
+
+    auto *Ln = new Line(2);
+    Ln->setIsLineRecord();
+    Ln->setIsNewStatement();
+    Ln->setAddress(0x400);
+    Ln->setLineNumber(11);
+    Ln->setDiscriminator(1);
+    CU->addObject(Ln);
+
+    return std::move(Root);
+  }
+
+  Reader TheReader;
+};
+
+// Pre-order list of the objects in a tree, lines after the other children.
+void collectObjects(Object *Obj, std::vector<Object *> &Objects) {
+  Objects.push_back(Obj);
+  if (auto *Scp = dynamic_cast<Scope *>(Obj)) {
+    for (Object *Child : Scp->getChildren())
+      collectObjects(Child, Objects);
+    for (Line *Ln : Scp->getLines())
+      collectObjects(Ln, Objects);
+  }
+}
+
+} // namespace
+
+TEST_F(TestScopeTreeSerializer, RoundTrip) {
+  std::unique_ptr<Scope> Tree = createTree();
+  std::vector<char> Data;
+  ASSERT_TRUE(ScopeTreeSerializer::write(*Tree, "key", Data));
+
+  std::unique_ptr<Scope> Copy(
+      ScopeTreeSerializer::read(Data.data(), Data.size(), "key"));
+  ASSERT_NE(Copy, nullptr);
+  EXPECT_STREQ(Copy->getName(), "test.o");
+
+  std::vector<Object *> Objects;
+  std::vector<Object *> CopyObjects;
+  collectObjects(Tree.get(), Objects);
+  collectObjects(Copy.get(), CopyObjects);
+  ASSERT_EQ(Objects.size(), CopyObjects.size());
+  for (size_t I = 0; I < Objects.size(); ++I) {
+    EXPECT_EQ(typeid(*Objects[I]), typeid(*CopyObjects[I]));
+    EXPECT_EQ(Objects[I]->getAsYAML(), CopyObjects[I]->getAsYAML());
+    EXPECT_EQ(Objects[I]->getAsText(PrintSettings()),
+              CopyObjects[I]->getAsText(PrintSettings()));
+  }
+
+  auto *CU = Copy->getScopeAt(0);
+  EXPECT_TRUE(CU->getHasGlobals());
+  EXPECT_TRUE(CU->getHasLines());
+  ASSERT_EQ(CU->getLineCount(), 1U);
+  EXPECT_EQ(CU->getLines()[0]->getAddress(), 0x400U);
+  EXPECT_EQ(CU->getLines()[0]->getDiscriminator(), 1U);
+
+  auto *Class = CU->getScopeAt(0);
+  auto *Member = Class->getSymbolAt(0);
+  EXPECT_EQ(Member->getType(), CU->getTypes()[0]);
+  EXPECT_EQ(Member->getAccessSpecifier(), AccessSpecifier::Protected);
+  EXPECT_TRUE(Member->getIsStatic());
+  auto *Base = dynamic_cast<TypeImport *>(Class->getTypes()[0]);
+  ASSERT_NE(Base, nullptr);
+  EXPECT_EQ(Base->getInheritanceAccess(), AccessSpecifier::Private);
+
+  auto *Function = dynamic_cast<ScopeFunction *>(CU->getScopeAt(2));
+  ASSERT_NE(Function, nullptr);
+  EXPECT_EQ(Function->getReference(), Class->getScopeAt(0));
+  EXPECT_TRUE(Function->getIsStatic());
+  EXPECT_TRUE(Function->getIsDeclaredInline());
+  EXPECT_FALSE(Function->getIsDeclaration());
+  EXPECT_EQ(Function->getScopeAt(0)->getCallLineNumber(), 12U);
+  EXPECT_EQ(Function->getScopeAt(0)->getDiscriminator(), 2U);
+  EXPECT_TRUE(Function->getSymbolAt(0)->getInvalidFileName());
+  EXPECT_EQ(Function->getSymbolAt(0)->getFileNameIndex(), 9U);
+
+  ASSERT_EQ(Function->getAddressRanges().size(), 1U);
+  EXPECT_EQ(Function->getAddressRanges()[0].Low, 0x400U);
+  EXPECT_EQ(Function->getAddressRanges()[0].High, 0x440U);
+  const std::vector<AddressRange> &Ranges =
+      Function->getScopeAt(0)->getAddressRanges();
+  ASSERT_EQ(Ranges.size(), 2U);
+  EXPECT_EQ(Ranges[1].Low, 0x420U);
+  EXPECT_EQ(Ranges[1].High, 0x428U);
+  EXPECT_TRUE(CU->getAddressRanges().empty());
+}
+
+TEST_F(TestScopeTreeSerializer, View) {
+  std::unique_ptr<Scope> Tree = createTree();
+  std::vector<char> Data;
+  ASSERT_TRUE(ScopeTreeSerializer::write(*Tree, "key", Data));
+
+  ScopeTreeView View;
+  ASSERT_TRUE(View.open(Data.data(), Data.size()));
+  EXPECT_STREQ(View.getKey(), "key");
+  EXPECT_EQ(View.getSize(), Data.size());
+
+  std::vector<Object *> Objects;
+  collectObjects(Tree.get(), Objects);
+  ASSERT_EQ(View.getObjectCount(), Objects.size());
+  for (uint32_t I = 0; I < View.getObjectCount(); ++I) {
+    ScopeTreeView::ObjectView Record = View.getObject(I);
+    const Object *Obj = Objects[I];
+    EXPECT_EQ(Record.getIndex(), I);
+    EXPECT_STREQ(Record.getKind(), Obj->getKindAsString());
+    EXPECT_EQ(Record.getFullName(), Obj->getPrintedName());
+    std::string TypeName;
+    Obj->getPrintedTypeName(TypeName);
+    EXPECT_EQ(Record.getTypeName(), TypeName);
+    EXPECT_STREQ(Record.getName(), Obj->getName());
+    EXPECT_EQ(Record.isPrintedAsObject(), Obj->getIsPrintedAsObject());
+    EXPECT_EQ(Record.isLine(), Obj->getIsLine());
+    EXPECT_EQ(Record.isScope(), Obj->getIsScope());
+    EXPECT_EQ(Record.getLevel(), Obj->getLevel());
+    EXPECT_EQ(Record.getLineNumber(), Obj->getLineNumber());
+    EXPECT_EQ(Record.getDieOffset(), Obj->getDieOffset());
+    EXPECT_EQ(Record.getDieTag(), Obj->getDieTag());
+    EXPECT_EQ(Record.hasParent(), Obj->getParent() != nullptr);
+    EXPECT_EQ(Record.hasType(), Obj->getType() != nullptr);
+    if (auto *Scp = dynamic_cast<const Scope *>(Obj)) {
+      EXPECT_EQ(Record.getChildCount(), Scp->getChildrenCount());
+      EXPECT_EQ(Record.getLineCount(), Scp->getLineCount());
+      EXPECT_EQ(Record.getRangeCount(), Scp->getAddressRanges().size());
+    }
+  }
+
+  ScopeTreeView::ObjectView CU = View.getRoot().getChild(0);
+  EXPECT_STREQ(CU.getKind(), "CompileUnit");
+  EXPECT_STREQ(CU.getFileName(), "");
+  ASSERT_EQ(CU.getLineCount(), 1U);
+  EXPECT_EQ(CU.getLine(0).getAddress(), 0x400U);
+  EXPECT_EQ(CU.getLine(0).getParent().getIndex(), CU.getIndex());
+
+  ScopeTreeView::ObjectView Class = CU.getChild(1);
+  EXPECT_STREQ(Class.getName(), "C");
+  EXPECT_STREQ(Class.getFileName(), "test.h");
+  EXPECT_EQ(Class.getChild(0).getType().getIndex(), CU.getChild(0).getIndex());
+
+  ScopeTreeView::ObjectView Function = CU.getChild(3);
+  EXPECT_STREQ(Function.getTypeName(), "int");
+  ASSERT_TRUE(Function.hasReference());
+  EXPECT_STREQ(Function.getReference().getName(), "f");
+  EXPECT_STREQ(Function.getChild(1).getFileName(), "?");
+  ASSERT_EQ(Function.getRangeCount(), 1U);
+  EXPECT_EQ(Function.getRangeLow(0), 0x400U);
+  EXPECT_EQ(Function.getRangeHigh(0), 0x440U);
+  ASSERT_EQ(Function.getChild(0).getRangeCount(), 2U);
+  EXPECT_EQ(Function.getChild(0).getRangeLow(1), 0x420U);
+}
+
+TEST_F(TestScopeTreeSerializer, RejectsInvalidData) {
+  std::unique_ptr<Scope> Tree = createTree();
+  std::vector<char> Data;
+  ASSERT_TRUE(ScopeTreeSerializer::write(*Tree, "key", Data));
+
+  // A different key.
+  EXPECT_EQ(ScopeTreeSerializer::read(Data.data(), Data.size(), "other"),
+            nullptr);
+
+  // Truncated data.
+  for (size_t Size : {size_t(0), size_t(ScopeTreeFormat::HeaderSize),
+                      Data.size() - 1})
+    EXPECT_EQ(ScopeTreeSerializer::read(Data.data(), Size, "key"), nullptr);
+
+  // A different format version.
+  std::vector<char> Changed(Data);
+  ScopeTreeFormat::writeLE<uint32_t>(&Changed[ScopeTreeFormat::HeaderVersion],
+                                     ScopeTreeFormat::Version + 1);
+  EXPECT_EQ(ScopeTreeSerializer::read(Changed.data(), Changed.size(), "key"),
+            nullptr);
+
+  // An object that claims to be its own child.
+  Changed = Data;
+  const size_t Objects = ScopeTreeFormat::readLE<uint64_t>(
+      &Changed[ScopeTreeFormat::HeaderObjectsOffset]);
+  const size_t ChildIndexes = ScopeTreeFormat::readLE<uint64_t>(
+      &Changed[ScopeTreeFormat::HeaderChildIndexOffset]);
+  ScopeTreeFormat::writeLE<uint32_t>(&Changed[ChildIndexes], 0);
+  EXPECT_EQ(ScopeTreeSerializer::read(Changed.data(), Changed.size(), "key"),
+            nullptr);
+
+  // An unknown object class.
+  Changed = Data;
+  Changed[Objects + ScopeTreeFormat::RecordSize +
+          ScopeTreeFormat::RecordClass] = char(0x7f);
+  EXPECT_EQ(ScopeTreeSerializer::read(Changed.data(), Changed.size(), "key"),
+            nullptr);
+}
+
+TEST_F(TestScopeTreeSerializer, RejectsReferencesOutsideTheTree) {
+  std::unique_ptr<Scope> Tree = createTree();
+  Type Outside;
+  Tree->getScopeAt(0)->getScopeAt(0)->getSymbols()[0]->setType(&Outside);
+
+  std::vector<char> Data;
+  EXPECT_FALSE(ScopeTreeSerializer::write(*Tree, "key", Data));
+
+  // They can be left out when only the names are needed.
+  Outside.setName("outside");
+  ASSERT_TRUE(ScopeTreeSerializer::write(*Tree, "key", Data,
+                                         /*DropExternalReferences=*/true));
+  ScopeTreeView View;
+  ASSERT_TRUE(View.open(Data.data(), Data.size()));
+  ScopeTreeView::ObjectView Member =
+      View.getRoot().getChild(0).getChild(1).getChild(0);
+  EXPECT_STREQ(Member.getName(), "M");
+  EXPECT_FALSE(Member.hasType());
+  EXPECT_STREQ(Member.getTypeName(), "outside");
+}
@@ -0,0 +1,102 @@
+//===-- UnitTests/TestLibScopeView/TestSort.cpp -----------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for sorting objects.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Reader.h"
+#include "Scope.h"
+#include "Sort.h"
+#include "Symbol.h"
+#include "Type.h"
+
+#include "gtest/gtest.h"
+
+using namespace LibScopeView;
+
+TEST(Sort, KeysSortLikeObjects) {
+  Reader R;
+  setReader(&R);
+
+  // Objects sharing lines, names and kinds in several combinations. Functions
+  // and inlined functions are different kind strings with the same text.
+  ScopeRoot Root;
+  ScopeCompileUnit *CU = new ScopeCompileUnit;
+  CU->setIsCompileUnit();
+  Root.addObject(CU);
+  std::vector<Object *> Objects;
+  Dwarf_Off Offset = 0x100;
+  for (const char *Name : {"b", "a", "", "B", "ab"})
+    for (uint64_t Line : {2, 1}) {
+      auto *Function = new ScopeFunction;
+      Function->setIsFunction();
+      auto *Inlined = new ScopeFunctionInlined;
+      Inlined->setIsInlinedSubroutine();
+      auto *Var = new Symbol;
+      Var->setIsVariable();
+      auto *Base = new Type;
+      Base->setIsBaseType();
+      for (Object *Obj : {static_cast<Object *>(Function),
+                          static_cast<Object *>(Inlined),
+                          static_cast<Object *>(Var),
+                          static_cast<Object *>(Base)}) {
+        Obj->setName(Name);
+        Obj->setLineNumber(Line);
+        Obj->setDieOffset(Offset -= 8);
+        Objects.push_back(Obj);
+      }
+      CU->addObject(Function);
+      CU->addObject(Inlined);
+      CU->addObject(Var);
+      CU->addObject(Base);
+    }
+
+  SortKeyBuilder Keys(&Root);
+  for (SortingKey SortKey :
+       {SortingKey::LINE, SortingKey::NAME, SortingKey::OFFSET}) {
+    SortFunction SortFunc = getSortFunction(SortKey);
+    SortKeyFunction SortKeyFunc = getSortKeyFunction(SortKey);
+    for (const Object *LHS : Objects)
+      for (const Object *RHS : Objects)
+        EXPECT_EQ(SortKeyFunc(Keys.getKey(LHS), Keys.getKey(RHS)),
+                  SortFunc(LHS, RHS))
+            << LHS->getName() << ' ' << LHS->getKindAsString() << ' '
+            << RHS->getName() << ' ' << RHS->getKindAsString();
+  }
+
+  // Sorting the tree orders the children as the object comparison does.
+  std::vector<Object *> Expected(CU->getChildren().begin(),
+                                 CU->getChildren().end());
+  std::sort(Expected.begin(), Expected.end(), sortByName);
+  Root.sortScopes(SortingKey::NAME);
+  EXPECT_EQ(std::vector<Object *>(CU->getChildren().begin(),
+                                  CU->getChildren().end()),
+            Expected);
+  EXPECT_TRUE(std::is_sorted(CU->getScopes().begin(), CU->getScopes().end(),
+                             sortByName));
+  EXPECT_TRUE(std::is_sorted(CU->getTypes().begin(), CU->getTypes().end(),
+                             sortByName));
+}
@@ -0,0 +1,85 @@
+//===-- UnitTests/TestLibScopeView/TestStringPool.cpp -----------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the String Pool.
+///
+//===----------------------------------------------------------------------===//
+
+#include "StringPool.h"
+
+#include "gtest/gtest.h"
+
+#include <thread>
+
+using namespace LibScopeView;
+
+TEST(StringPool, Deduplicates) {
+  size_t Index = StringPool::getStringIndex("StringPool.Deduplicates");
+  EXPECT_NE(Index, 0U);
+  EXPECT_EQ(StringPool::getStringIndex(std::string("StringPool.Deduplicates")),
+            Index);
+  EXPECT_STREQ(StringPool::getStringValue(Index), "StringPool.Deduplicates");
+  EXPECT_EQ(StringPool::getStringIndex(""), 0U);
+  EXPECT_STREQ(StringPool::getStringValue(0), "");
+}
+
+TEST(StringPool, LongStrings) {
+  // Strings longer than the storage chunks are still stored whole.
+  std::vector<size_t> Indexes;
+  for (char C : {'a', 'b', 'c'}) {
+    std::string Long(3 * 1024 * 1024 + 7, C);
+    Indexes.push_back(StringPool::getStringIndex(Long));
+    EXPECT_EQ(StringPool::getStringValue(Indexes.back()), Long);
+  }
+  size_t Short = StringPool::getStringIndex("StringPool.LongStrings");
+  EXPECT_STREQ(StringPool::getStringValue(Short), "StringPool.LongStrings");
+  EXPECT_EQ(StringPool::getStringValue(Indexes[0]),
+            std::string(3 * 1024 * 1024 + 7, 'a'));
+}
+
+TEST(StringPool, ConcurrentInserts) {
+  // Each thread adds the same strings, in a different order given by a step
+  // coprime with the number of strings.
+  const size_t Count = 2000;
+  const size_t Steps[] = {1, 3, 7, 11, 13, 17, 19, 23};
+  const unsigned ThreadCount = 8;
+  std::vector<std::vector<size_t>> Indexes(ThreadCount,
+                                           std::vector<size_t>(Count));
+  std::vector<std::thread> Threads;
+  for (unsigned Thread = 0; Thread < ThreadCount; ++Thread)
+    Threads.emplace_back([&, Thread]() {
+      for (size_t I = 0; I < Count; ++I) {
+        size_t N = (I * Steps[Thread]) % Count;
+        std::string Str("StringPool.ConcurrentInserts." + std::to_string(N));
+        Indexes[Thread][N] = StringPool::getStringIndex(Str);
+        EXPECT_EQ(StringPool::getStringValue(Indexes[Thread][N]), Str);
+      }
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  for (unsigned Thread = 1; Thread < ThreadCount; ++Thread)
+    EXPECT_EQ(Indexes[Thread], Indexes[0]);
+}
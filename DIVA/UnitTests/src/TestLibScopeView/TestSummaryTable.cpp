@@ -184,8 +184,8 @@ TEST(SummaryTable, OneIncrementStandardSummaryTable) {
 
   for (uint32_t Kind = 0; Kind != ObjectKindSize; ++Kind) {
     auto Obj = GenerateTestObject(Kind);
-    STab.incrementFound(Obj.get());
-    STab.incrementPrinted(Obj.get());
+    STab.incrementFound(Obj->getKind());
+    STab.incrementPrinted(Obj->getKind());
   }
 
   std::stringstream Result;
@@ -223,27 +223,27 @@ TEST(SummaryTable, MultipleIncrementsStandardSummaryTable) {
 
   for (uint32_t Kind = 0; Kind != ObjectKindSize; ++Kind) {
     auto Obj = GenerateTestObject(Kind);
-    STab.incrementFound(Obj.get());
-    STab.incrementPrinted(Obj.get());
+    STab.incrementFound(Obj->getKind());
+    STab.incrementPrinted(Obj->getKind());
   }
 
   const auto IncrementBy = 3;
   for (uint32_t Counter = 0; Counter != IncrementBy; ++Counter) {
     for (uint32_t Kind = ObjectKindSize / 2; Kind != ObjectKindSize; ++Kind) {
       auto Obj = GenerateTestObject(Kind);
-      STab.incrementFound(Obj.get());
-      STab.incrementPrinted(Obj.get());
+      STab.incrementFound(Obj->getKind());
+      STab.incrementPrinted(Obj->getKind());
     }
   }
 
   auto Obj = GenerateTestObject(ObjectKind::Block);
-  STab.incrementFound(Obj.get());
-  STab.incrementPrinted(Obj.get());
+  STab.incrementFound(Obj->getKind());
+  STab.incrementPrinted(Obj->getKind());
 
   Obj = GenerateTestObject(ObjectKind::Enum);
-  STab.incrementFound(Obj.get());
-  STab.incrementFound(Obj.get());
-  STab.incrementPrinted(Obj.get());
+  STab.incrementFound(Obj->getKind());
+  STab.incrementFound(Obj->getKind());
+  STab.incrementPrinted(Obj->getKind());
 
   std::stringstream Result;
   STab.getPrintedSummaryTable(Result);
@@ -274,3 +274,55 @@ TEST(SummaryTable, MultipleIncrementsStandardSummaryTable) {
 
   EXPECT_EQ(Result.str(), Expected);
 }
+
+TEST(SummaryTable, AddFoundByKind) {
+  // Adding counts by kind gives the same table as incrementing them for each
+  // object, and kinds without a row are not counted.
+  LibScopeView::SummaryTable Added;
+  LibScopeView::SummaryTable Incremented;
+  auto Pointer = std::make_unique<LibScopeView::Type>();
+  Pointer->setIsPointerType();
+  Added.addFound(Pointer->getKind(), 5U);
+  for (uint32_t Kind = 0; Kind != ObjectKindSize; ++Kind) {
+    auto Obj = GenerateTestObject(Kind);
+    Added.addFound(Obj->getKind(), Kind);
+    for (uint32_t Count = 0; Count != Kind; ++Count)
+      Incremented.incrementFound(Obj->getKind());
+  }
+
+  std::stringstream Result;
+  Added.getPrintedSummaryTable(Result);
+  std::stringstream Expected;
+  Incremented.getPrintedSummaryTable(Expected);
+  EXPECT_EQ(Result.str(), Expected.str());
+  EXPECT_NE(Result.str().find("Totals                   120        0"),
+            std::string::npos);
+}
+
+TEST(SummaryTable, ObjectKinds) {
+  // Each object's kind is the row labelled as getKindAsString names it.
+  for (uint32_t Kind = 0; Kind != ObjectKindSize; ++Kind)
+    EXPECT_EQ(static_cast<uint32_t>(GenerateTestObject(Kind)->getKind()),
+              Kind);
+
+  // Several kinds of object share a row.
+  LibScopeView::Scope Inlined;
+  Inlined.setIsInlinedSubroutine();
+  EXPECT_EQ(Inlined.getKind(), LibScopeView::ObjectKind::Function);
+  LibScopeView::Type Typedef;
+  Typedef.setIsTypedef();
+  EXPECT_EQ(Typedef.getKind(), LibScopeView::ObjectKind::Alias);
+  LibScopeView::Symbol Unspecified;
+  Unspecified.setIsUnspecifiedParameter();
+  EXPECT_EQ(Unspecified.getKind(), LibScopeView::ObjectKind::Parameter);
+
+  // The other kinds have no row.
+  LibScopeView::Scope Array;
+  Array.setIsArrayType();
+  EXPECT_EQ(Array.getKind(), LibScopeView::ObjectKind::Other);
+  LibScopeView::Type Const;
+  Const.setIsConstType();
+  EXPECT_EQ(Const.getKind(), LibScopeView::ObjectKind::Other);
+  LibScopeView::Line Ln;
+  EXPECT_EQ(Ln.getKind(), LibScopeView::ObjectKind::Other);
+}